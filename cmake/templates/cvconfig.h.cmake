@@ -169,6 +169,9 @@
 /* C= */
 #cmakedefine  HAVE_CSTRIPES
 
+/* pthreads-based parallel_for (built-in thread pool) */
+#cmakedefine  HAVE_PTHREADS_PF
+
 /* Eigen Matrix & Linear Algebra Library */
 #cmakedefine  HAVE_EIGEN
 
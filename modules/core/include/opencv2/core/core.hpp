@@ -118,7 +118,8 @@ CV_EXPORTS string tempfile( const char* suffix CV_DEFAULT(0));
 enum { DECOMP_LU=0, DECOMP_SVD=1, DECOMP_EIG=2, DECOMP_CHOLESKY=3, DECOMP_QR=4, DECOMP_NORMAL=16 };
 enum { NORM_INF=1, NORM_L1=2, NORM_L2=4, NORM_L2SQR=5, NORM_HAMMING=6, NORM_HAMMING2=7, NORM_TYPE_MASK=7, NORM_RELATIVE=8, NORM_MINMAX=32 };
 enum { CMP_EQ=0, CMP_GT=1, CMP_GE=2, CMP_LT=3, CMP_LE=4, CMP_NE=5 };
-enum { GEMM_1_T=1, GEMM_2_T=2, GEMM_3_T=4 };
+//! GEMM_FAST_32F lets the large CV_32FC1 products accumulate in single precision, see cv::gemm
+enum { GEMM_1_T=1, GEMM_2_T=2, GEMM_3_T=4, GEMM_FAST_32F=8 };
 enum { DFT_INVERSE=1, DFT_SCALE=2, DFT_ROWS=4, DFT_COMPLEX_OUTPUT=16, DFT_REAL_OUTPUT=32,
     DCT_INVERSE = DFT_INVERSE, DCT_ROWS=DFT_ROWS };
 
@@ -266,6 +267,8 @@ CV_EXPORTS_W int64 getCPUTickCount();
   - CV_CPU_SSE4_2 - SSE 4.2
   - CV_CPU_POPCNT - POPCOUNT
   - CV_CPU_AVX - AVX
+  - CV_CPU_AVX2 - AVX 2
+  - CV_CPU_FMA3 - FMA 3
 
   \note {Note that the function output is not static. Once you called cv::useOptimized(false),
   most of the hardware acceleration is disabled and thus the function will returns false,
@@ -273,6 +276,19 @@ CV_EXPORTS_W int64 getCPUTickCount();
 */
 CV_EXPORTS_W bool checkHardwareSupport(int feature);
 
+/*!
+  Reports the implementations used by the kernels that have CPU-specific variants
+
+  Such kernels register their variants (SSE2, SSE 4.2, AVX2 ...) at startup, and the best one supported
+  by the CPU is chosen once. The instruction sets above the one given by the OPENCV_CPU_DISPATCH
+  environment variable (BASELINE, SSE2, SSE3, SSSE3, SSE4_1, SSE4_2, AVX or AVX2) are not used by these
+  kernels and are not reported by cv::checkHardwareSupport().
+
+  \param kernels the kernel names
+  \param variants the instruction set of the variant used by each kernel, "baseline" for the generic code
+*/
+CV_EXPORTS void getDispatchedKernels(vector<string>& kernels, vector<string>& variants);
+
 //! returns the number of CPUs (including hyper-threading)
 CV_EXPORTS_W int getNumberOfCPUs();
 
@@ -296,6 +312,96 @@ CV_EXPORTS void* fastMalloc(size_t bufSize);
 */
 CV_EXPORTS void fastFree(void* ptr);
 
+/*!
+  Turns on/off the per-thread memory pool used by cv::fastMalloc()
+
+  When the pool is on, the blocks up to 64Mb are rounded up to one of the size classes
+  (4 classes per power of two) and the released blocks are kept in a free list of the thread
+  that releases them instead of being returned to the system. This removes malloc()/free()
+  and page fault costs from code that repeatedly creates temporary matrices of the same size.
+
+  \param onoff turns the pool on or off. Turning it off releases the memory cached by the calling thread;
+         other threads release their caches when they call cv::fastMalloc()/cv::fastFree() next time.
+  \param maxCachedBytesPerThread the maximum amount of memory kept in the cache of a single thread;
+         the blocks that do not fit are returned to the system.
+*/
+CV_EXPORTS void setUseMemoryPool(bool onoff, size_t maxCachedBytesPerThread=(size_t)64 << 20);
+
+//! returns true if the cv::fastMalloc() memory pool is on
+CV_EXPORTS bool useMemoryPool();
+
+/*!
+  Returns the memory cached by the cv::fastMalloc() pool to the system
+
+  The cache of the calling thread is released immediately,
+  the caches of other threads - when they call cv::fastMalloc()/cv::fastFree() next time.
+*/
+CV_EXPORTS void trimMemoryPool();
+
+//! statistics of the cv::fastMalloc() memory pool, see cv::getMemoryPoolStats()
+struct CV_EXPORTS MemoryPoolStats
+{
+    MemoryPoolStats();
+
+    int64 allocCount;        //!< the number of cv::fastMalloc() calls handled by the pool
+    int64 hitCount;          //!< how many of them were served from the cache without calling malloc()
+    int64 freeCount;         //!< the number of pooled blocks released by cv::fastFree()
+    int64 bytesCached;       //!< the memory currently kept in the thread caches
+    int64 peakBytesCached;   //!< the maximum amount of memory ever kept in a single thread cache
+    int64 bytesReserved;     //!< the memory currently taken from the system by the pool (used + cached)
+    int64 peakBytesReserved; //!< the maximum value of bytesReserved
+};
+
+/*!
+  Returns the statistics of the cv::fastMalloc() memory pool
+
+  The counters of other threads are read without synchronization, so the numbers are approximate
+  while other threads are allocating memory. The hit rate is hitCount/allocCount.
+*/
+CV_EXPORTS MemoryPoolStats getMemoryPoolStats();
+
+/*!
+  Turns on/off the tracing of the library hot paths
+
+  The main entry points (cv::parallel_for_, cv::cvtColor, cv::resize, cv::FilterEngine::apply,
+  cv::CascadeClassifier::detectMultiScale ...) are marked as traced regions. When the tracing is on,
+  every thread records the regions it executes into its own ring buffer and updates the per-region
+  counters returned by cv::getTraceStats(); when it is off, a region costs one check of a flag.
+  The tracing can also be turned on at startup by setting the OPENCV_TRACE environment variable to 1.
+  The regions are not compiled at all when the library is built with CV_ENABLE_TRACE=0.
+*/
+CV_EXPORTS void setTraceEnabled(bool enabled);
+
+//! returns true if the tracing is on
+CV_EXPORTS bool isTraceEnabled();
+
+//! the counters of a traced region, summed over all the threads, see cv::getTraceStats()
+struct CV_EXPORTS TraceStats
+{
+    TraceStats();
+
+    string name;       //!< the region name, e.g. "cv::resize"
+    int64 calls;       //!< how many times the region was executed
+    double totalTime;  //!< the total time spent in the region, in seconds (nested regions included)
+    double maxTime;    //!< the longest execution, in seconds
+    int64 bytes;       //!< the amount of data reported as processed by the region
+};
+
+//! returns the counters of all the regions executed since the last cv::resetTrace()
+CV_EXPORTS void getTraceStats(vector<TraceStats>& stats);
+
+/*!
+  Writes the recorded regions in the Chrome trace event format
+
+  The file can be loaded into chrome://tracing (or any viewer of that format) to see the regions
+  executed by each thread on the timeline. Only the most recent regions that fit into the
+  per-thread ring buffers are written.
+*/
+CV_EXPORTS void writeTrace(const string& filename);
+
+//! clears the recorded regions and the counters
+CV_EXPORTS void resetTrace();
+
 template<typename _Tp> static inline _Tp* allocate(size_t n)
 {
     return new _Tp[n];
@@ -1443,6 +1549,124 @@ public:
     virtual void deallocate(int* refcount, uchar* datastart, uchar* data) = 0;
 };
 
+/*!
+   Sets the process-wide default allocator
+
+   Mat::create() uses the default allocator for all the matrices that do not have an allocator
+   of their own, including the temporary matrices created inside OpenCV functions. The allocator
+   is kept in the created matrix (and its copies) until the data is released, so it must outlive
+   all the matrices allocated with it; the next Mat::create() takes the current default again.
+   NULL (the default) means cv::fastMalloc().
+*/
+CV_EXPORTS void setDefaultAllocator(MatAllocator* allocator);
+
+/*!
+   Sets the default allocator of the calling thread
+
+   The per-thread allocator takes priority over the process-wide one, see cv::setDefaultAllocator().
+   NULL resets the calling thread to the process-wide default allocator.
+*/
+CV_EXPORTS void setThreadDefaultAllocator(MatAllocator* allocator);
+
+//! returns the default allocator of the calling thread or NULL if cv::fastMalloc() is used
+CV_EXPORTS MatAllocator* getDefaultAllocator();
+
+/*!
+   The allocator that keeps track of the matrix memory
+
+   The allocator counts the live and peak matrix memory in total and per allocation site.
+   The site is set by AccountingMatAllocator::Site objects in the allocating thread:
+
+   \code
+   AccountingMatAllocator accounting;
+   setDefaultAllocator(&accounting);
+   {
+       AccountingMatAllocator::Site site("preprocessing");
+       resize(frame, small, Size(), 0.5, 0.5);   // all the matrices allocated here are counted as "preprocessing"
+   }
+   \endcode
+
+   The memory itself is allocated by another allocator passed to the constructor or by cv::fastMalloc().
+*/
+class CV_EXPORTS AccountingMatAllocator : public MatAllocator
+{
+public:
+    struct CV_EXPORTS SiteStats
+    {
+        SiteStats();
+
+        string name;
+        int64 allocCount;   //!< the number of allocated matrices
+        int64 totalBytes;   //!< the total size of the allocated matrices
+        int64 liveBytes;    //!< the memory currently used by the matrices allocated at the site
+        int64 peakBytes;    //!< the maximum value of liveBytes
+    };
+
+    //! marks the allocations made by the calling thread within the object scope with the site name
+    class CV_EXPORTS Site
+    {
+    public:
+        explicit Site(const char* name);
+        ~Site();
+    private:
+        Site(const Site&);
+        Site& operator = (const Site&);
+        const char* prevName;
+    };
+
+    explicit AccountingMatAllocator(MatAllocator* base=0);
+    virtual ~AccountingMatAllocator();
+
+    virtual void allocate(int dims, const int* sizes, int type, int*& refcount,
+                          uchar*& datastart, uchar*& data, size_t* step);
+    virtual void deallocate(int* refcount, uchar* datastart, uchar* data);
+
+    //! returns the total statistics; the name of the returned structure is empty
+    SiteStats getTotalStats() const;
+    //! returns the statistics of all the allocation sites
+    void getSiteStats(vector<SiteStats>& stats) const;
+    //! resets the counters, except for the live bytes
+    void resetStats();
+
+    struct Impl;
+protected:
+    AccountingMatAllocator(const AccountingMatAllocator&);
+    AccountingMatAllocator& operator = (const AccountingMatAllocator&);
+    Impl* impl;
+};
+
+/*!
+   The allocator that places the matrix data on the specified NUMA nodes
+
+   On Linux the big matrices are allocated with mmap() and bound with mbind():
+   - NumaMatAllocator::LOCAL puts the data on the node of the thread that allocates the matrix
+     (or on the node passed to the constructor);
+   - NumaMatAllocator::INTERLEAVE spreads the pages round-robin over all the nodes, which is the best
+     choice for the bandwidth-bound functions that process the matrix with parallel_for_ on all the cores.
+
+   The small matrices and all the matrices on other platforms are allocated with cv::fastMalloc().
+*/
+class CV_EXPORTS NumaMatAllocator : public MatAllocator
+{
+public:
+    enum { LOCAL=0, INTERLEAVE=1 };
+
+    explicit NumaMatAllocator(int policy=LOCAL, int node=-1);
+
+    virtual void allocate(int dims, const int* sizes, int type, int*& refcount,
+                          uchar*& datastart, uchar*& data, size_t* step);
+    virtual void deallocate(int* refcount, uchar* datastart, uchar* data);
+
+    //! returns the number of NUMA nodes in the system (1 if it can not be detected)
+    static int getNumberOfNodes();
+    //! returns the NUMA node of the calling thread (0 if it can not be detected)
+    static int getCurrentNode();
+
+protected:
+    int policy;
+    int node;
+};
+
 /*!
    The n-dimensional matrix class.
 
@@ -1917,11 +2141,13 @@ public:
     template<typename _Tp> MatConstIterator_<_Tp> begin() const;
     template<typename _Tp> MatConstIterator_<_Tp> end() const;
 
-    enum { MAGIC_VAL=0x42FF0000, AUTO_STEP=0, CONTINUOUS_FLAG=CV_MAT_CONT_FLAG, SUBMATRIX_FLAG=CV_SUBMAT_FLAG };
+    enum { MAGIC_VAL=0x42FF0000, AUTO_STEP=0, CONTINUOUS_FLAG=CV_MAT_CONT_FLAG, SUBMATRIX_FLAG=CV_SUBMAT_FLAG,
+           DEFAULT_ALLOCATOR_FLAG=1<<13 };
 
     /*! includes several bit-fields:
          - the magic signature
          - continuity flag
+         - the default allocator flag: allocator was taken from cv::getDefaultAllocator() and is reset by release()
          - depth
          - number of channels
      */
@@ -2303,6 +2529,9 @@ CV_EXPORTS bool eigen(InputArray src, OutputArray eigenvalues,
                       int lowindex=-1, int highindex=-1);
 CV_EXPORTS_W bool eigen(InputArray src, bool computeEigenvectors,
                         OutputArray eigenvalues, OutputArray eigenvectors);
+//! finds eigenvalues and eigenvectors of every symmetric matrix of the N x n x n batch
+CV_EXPORTS void eigenBatch(InputArray src, OutputArray eigenvalues,
+                           OutputArray eigenvectors=noArray());
 
 enum
 {
@@ -2470,6 +2699,11 @@ CV_EXPORTS_W void SVDecomp( InputArray src, CV_OUT OutputArray w,
 CV_EXPORTS_W void SVBackSubst( InputArray w, InputArray u, InputArray vt,
                                InputArray rhs, CV_OUT OutputArray dst );
 
+//! computes SVD of every matrix of the N x m x n batch.
+//! The singular vectors that correspond to the zero singular values are set to zeros.
+CV_EXPORTS void SVDecompBatch( InputArray src, OutputArray w,
+                               OutputArray u=noArray(), OutputArray vt=noArray() );
+
 //! computes Mahalanobis distance between two vectors: sqrt((v1-v2)'*icovar*(v1-v2)), where icovar is the inverse covariation matrix
 CV_EXPORTS_W double Mahalanobis(InputArray v1, InputArray v2, InputArray icovar);
 //! a synonym for Mahalanobis
@@ -2489,6 +2723,41 @@ CV_EXPORTS_W void mulSpectrums(InputArray a, InputArray b, OutputArray c,
 //! computes the minimal vector size vecsize1 >= vecsize so that the dft() of the vector of length vecsize1 can be computed efficiently
 CV_EXPORTS_W int getOptimalDFTSize(int vecsize);
 
+/*!
+ Precomputed Discrete Fourier Transform
+
+ Keeps the factorization, the permutation tables and the twiddle factors of dft() for one
+ source size, type and set of flags, so that they are computed once for a series of
+ same-size transforms. apply() gives the same result as dft(src, dst, flags, nonzeroRows).
+ The rows and the columns are transformed in parallel; with DFT_ROWS the plan depends on
+ the row length only, so one plan transforms any number of rows at once.
+ A plan is not modified by apply() and can be shared between threads.
+*/
+class CV_EXPORTS DFTPlan
+{
+public:
+    //! the default constructor
+    DFTPlan();
+    //! the constructor that calls create()
+    DFTPlan(Size size, int type, int flags=0);
+    //! prepares the transform of size x type matrices; the flags are those of dft()
+    void create(Size size, int type, int flags=0);
+    //! transforms src, which must have the size (or, with DFT_ROWS, the width) and type of the plan
+    void apply(InputArray src, OutputArray dst, int nonzeroRows=0) const;
+
+    bool empty() const;
+    Size size() const;
+    int type() const;
+    int flags() const;
+
+    class Impl;
+
+protected:
+    Ptr<Impl> impl;
+};
+
+template<> CV_EXPORTS void Ptr<DFTPlan::Impl>::delete_obj();
+
 /*!
  Various k-Means flags
 */
@@ -2502,6 +2771,10 @@ enum
 CV_EXPORTS_W double kmeans( InputArray data, int K, CV_OUT InputOutputArray bestLabels,
                             TermCriteria criteria, int attempts,
                             int flags, OutputArray centers=noArray() );
+//! clusters the input data using the mini-batch k-Means algorithm; criteria.maxCount is the number of batches
+CV_EXPORTS_W double kmeansMiniBatch( InputArray data, int K, CV_OUT InputOutputArray bestLabels,
+                                     TermCriteria criteria, int batchSize,
+                                     int flags, OutputArray centers=noArray() );
 
 //! returns the thread-local Random number generator
 CV_EXPORTS RNG& theRNG();
@@ -3999,7 +4272,8 @@ public:
         FORMAT_MASK=(7<<3),
         FORMAT_AUTO=0,
         FORMAT_XML=(1<<3),
-        FORMAT_YAML=(2<<3)
+        FORMAT_YAML=(2<<3),
+        FORMAT_BINARY=(3<<3) //! YAML tree + raw matrix data, the matrices are read without copying
     };
     enum
     {
@@ -4193,6 +4467,58 @@ public:
     size_t remaining;
 };
 
+/*!
+ Streaming File Storage Reader
+
+ Reads the top-level nodes of an XML, YAML or binary storage one by one instead of
+ building the whole file tree in memory like FileStorage does. next() moves to the next
+ top-level node and reads its name only; the value is parsed by node() on demand, so the
+ nodes that are not requested are skipped almost at the cost of reading the text.
+ The node returned by node() is valid until the following next() or release() call.
+
+ \code
+ FileStorageReader reader("features.yml.gz");
+ while( reader.next() )
+ {
+     if( reader.name() == "descriptors" )
+     {
+         Mat d;
+         reader.node() >> d;
+         ...
+     }
+ }
+ \endcode
+*/
+class CV_EXPORTS FileStorageReader
+{
+public:
+    //! the default constructor
+    FileStorageReader();
+    //! the constructor that calls open()
+    explicit FileStorageReader(const string& filename);
+    //! the destructor; closes the file
+    ~FileStorageReader();
+    //! opens the file storage for reading; returns false if the file can not be opened
+    bool open(const string& filename);
+    //! returns true if the storage is open
+    bool isOpened() const;
+    //! closes the file
+    void release();
+    //! moves to the next top-level node; returns false after the last node
+    bool next();
+    //! returns the name of the current top-level node
+    string name() const;
+    //! parses and returns the current top-level node
+    FileNode node();
+
+    class Impl;
+
+protected:
+    Ptr<Impl> impl;
+};
+
+template<> CV_EXPORTS void Ptr<FileStorageReader::Impl>::delete_obj();
+
 ////////////// convenient wrappers for operating old-style dynamic structures //////////////
 
 template<typename _Tp> class SeqIterator;
@@ -280,6 +280,59 @@ namespace cv
         return &classname##_info(); \
     }
 
+/* the tracing regions are compiled in unless the build sets CV_ENABLE_TRACE to 0 */
+#ifndef CV_ENABLE_TRACE
+#  define CV_ENABLE_TRACE 1
+#endif
+
+namespace cv
+{
+    // a traced place in the code; the instances are static and initialized at compile time
+    // (see CV_TRACE_REGION), the id is assigned when the region is entered for the first time
+    struct TraceSite
+    {
+        const char* name;
+        volatile int id;
+    };
+
+    // records the time spent in the enclosing scope when the tracing is on (see cv::setTraceEnabled)
+    class CV_EXPORTS TraceRegion
+    {
+    public:
+        explicit TraceRegion(TraceSite& site);
+        ~TraceRegion();
+
+        // adds to the bytes processed by the innermost open region of the calling thread
+        static void addBytes(size_t bytes);
+
+    private:
+        TraceRegion(const TraceRegion&);
+        TraceRegion& operator=(const TraceRegion&);
+
+        bool active;
+    };
+} //namespace cv
+
+#define CV_TRACE_CAT_(a, b) a##b
+#define CV_TRACE_CAT(a, b) CV_TRACE_CAT_(a, b)
+
+#if CV_ENABLE_TRACE
+#  define CV_TRACE_REGION(name) \
+    static ::cv::TraceSite CV_TRACE_CAT(cvTraceSite, __LINE__) = { name, -1 }; \
+    ::cv::TraceRegion CV_TRACE_CAT(cvTraceRegion, __LINE__)(CV_TRACE_CAT(cvTraceSite, __LINE__))
+#  define CV_TRACE_BYTES(bytes) ::cv::TraceRegion::addBytes(bytes)
+#else
+#  define CV_TRACE_REGION(name)
+#  define CV_TRACE_BYTES(bytes)
+#endif
+
+namespace cv
+{
+    // the fast path of the FileStorage number parser: converts the decimal numbers that can be
+    // converted exactly and returns false for the others, which are left to strtod()
+    CV_EXPORTS bool fastStrtod( const char* ptr, double* value, char** endptr );
+} //namespace cv
+
 #endif //__cplusplus
 
 /* maximal size of vector to run matrix operations on it inline (i.e. w/o ipp calls) */
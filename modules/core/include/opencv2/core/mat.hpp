@@ -365,6 +365,11 @@ inline void Mat::release()
 {
     if( refcount && CV_XADD(refcount, -1) == 1 )
         deallocate();
+    if( flags & DEFAULT_ALLOCATOR_FLAG )
+    {
+        allocator = 0;
+        flags &= ~DEFAULT_ALLOCATOR_FLAG;
+    }
     data = datastart = dataend = datalimit = 0;
     size.p[0] = 0;
     refcount = 0;
@@ -1166,6 +1171,9 @@ template<typename _Tp> inline _OutputArray::_OutputArray(const _Tp* vec, int n)
 
 //////////////////////////////////// Matrix Expressions /////////////////////////////////////////
 
+class MatExprProgram;
+template<> CV_EXPORTS void Ptr<MatExprProgram>::delete_obj();
+
 class CV_EXPORTS MatOp
 {
 public:
@@ -1253,6 +1261,9 @@ public:
     Mat a, b, c;
     double alpha, beta;
     Scalar s;
+
+    //! fused element-wise program; non-empty only for expressions evaluated in a single pass
+    Ptr<MatExprProgram> program;
 };
 
 
@@ -1298,34 +1309,74 @@ CV_EXPORTS MatExpr operator / (const MatExpr& e1, const MatExpr& e2);
 CV_EXPORTS MatExpr operator < (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator < (const Mat& a, double s);
 CV_EXPORTS MatExpr operator < (double s, const Mat& a);
+CV_EXPORTS MatExpr operator < (const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr operator < (const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr operator < (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator < (double s, const MatExpr& e);
+CV_EXPORTS MatExpr operator < (const MatExpr& e1, const MatExpr& e2);
 
 CV_EXPORTS MatExpr operator <= (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator <= (const Mat& a, double s);
 CV_EXPORTS MatExpr operator <= (double s, const Mat& a);
+CV_EXPORTS MatExpr operator <= (const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr operator <= (const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr operator <= (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator <= (double s, const MatExpr& e);
+CV_EXPORTS MatExpr operator <= (const MatExpr& e1, const MatExpr& e2);
 
 CV_EXPORTS MatExpr operator == (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator == (const Mat& a, double s);
 CV_EXPORTS MatExpr operator == (double s, const Mat& a);
+CV_EXPORTS MatExpr operator == (const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr operator == (const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr operator == (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator == (double s, const MatExpr& e);
+CV_EXPORTS MatExpr operator == (const MatExpr& e1, const MatExpr& e2);
 
 CV_EXPORTS MatExpr operator != (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator != (const Mat& a, double s);
 CV_EXPORTS MatExpr operator != (double s, const Mat& a);
+CV_EXPORTS MatExpr operator != (const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr operator != (const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr operator != (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator != (double s, const MatExpr& e);
+CV_EXPORTS MatExpr operator != (const MatExpr& e1, const MatExpr& e2);
 
 CV_EXPORTS MatExpr operator >= (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator >= (const Mat& a, double s);
 CV_EXPORTS MatExpr operator >= (double s, const Mat& a);
+CV_EXPORTS MatExpr operator >= (const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr operator >= (const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr operator >= (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator >= (double s, const MatExpr& e);
+CV_EXPORTS MatExpr operator >= (const MatExpr& e1, const MatExpr& e2);
 
 CV_EXPORTS MatExpr operator > (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator > (const Mat& a, double s);
 CV_EXPORTS MatExpr operator > (double s, const Mat& a);
+CV_EXPORTS MatExpr operator > (const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr operator > (const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr operator > (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator > (double s, const MatExpr& e);
+CV_EXPORTS MatExpr operator > (const MatExpr& e1, const MatExpr& e2);
 
 CV_EXPORTS MatExpr min(const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr min(const Mat& a, double s);
 CV_EXPORTS MatExpr min(double s, const Mat& a);
+CV_EXPORTS MatExpr min(const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr min(const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr min(const MatExpr& e, double s);
+CV_EXPORTS MatExpr min(double s, const MatExpr& e);
+CV_EXPORTS MatExpr min(const MatExpr& e1, const MatExpr& e2);
 
 CV_EXPORTS MatExpr max(const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr max(const Mat& a, double s);
 CV_EXPORTS MatExpr max(double s, const Mat& a);
+CV_EXPORTS MatExpr max(const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr max(const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr max(const MatExpr& e, double s);
+CV_EXPORTS MatExpr max(double s, const MatExpr& e);
+CV_EXPORTS MatExpr max(const MatExpr& e1, const MatExpr& e2);
 
 template<typename _Tp> static inline MatExpr min(const Mat_<_Tp>& a, const Mat_<_Tp>& b)
 {
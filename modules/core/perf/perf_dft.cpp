@@ -24,3 +24,20 @@ PERF_TEST_P(Size_MatType, dft, TEST_MATS_DFT)
 
     SANITY_CHECK(dst, 1e-5);
 }
+
+// a batch of same-size 1D transforms, the way filters and correlators use dft
+PERF_TEST_P(Size_MatType, dftPlan_rows, TEST_MATS_DFT)
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+
+    Mat src(sz, type);
+    Mat dst(sz, type);
+
+    declare.in(src, WARMUP_RNG).time(60);
+
+    DFTPlan plan(Size(sz.width, 1), type, DFT_ROWS);
+    TEST_CYCLE() plan.apply(src, dst);
+
+    SANITY_CHECK(dst, 1e-5);
+}
@@ -0,0 +1,83 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+CV_FLAGS(GemmFlags, 0, GEMM_1_T, GEMM_2_T, GEMM_3_T, GEMM_FAST_32F)
+
+typedef std::tr1::tuple<int, MatType, GemmFlags> Size_MatType_GemmFlags_t;
+typedef perf::TestBaseWithParam<Size_MatType_GemmFlags_t> Size_MatType_GemmFlags;
+
+PERF_TEST_P(Size_MatType_GemmFlags, gemm_square,
+            testing::Combine(
+                testing::Values(64, 256, 1024),
+                testing::Values(CV_32FC1, CV_64FC1),
+                testing::Values(0, (int)GEMM_1_T, (int)GEMM_2_T, (int)GEMM_FAST_32F)
+                )
+            )
+{
+    int n = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    int flags = get<2>(GetParam());
+
+    Mat a(n, n, type), b(n, n, type), c(n, n, type), d(n, n, type);
+    declare.in(a, b, c, WARMUP_RNG).out(d);
+    declare.time(100);
+
+    TEST_CYCLE() gemm(a, b, 1., c, 0.5, d, flags);
+
+    SANITY_CHECK(d, 1e-4, ERROR_RELATIVE);
+}
+
+typedef std::tr1::tuple<Size, MatType> Size_MatType_t;
+typedef perf::TestBaseWithParam<Size_MatType_t> Size_MatType;
+
+// A^T*A of a long list of samples, the shape of calcCovarMatrix and PCA
+PERF_TEST_P(Size_MatType, gemm_tallSkinny,
+            testing::Combine(
+                testing::Values(Size(32, 10000), Size(64, 20000), Size(256, 4096)),
+                testing::Values(CV_32FC1, CV_64FC1)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+
+    Mat a(sz, type), d(sz.width, sz.width, type);
+    declare.in(a, WARMUP_RNG).out(d);
+
+    TEST_CYCLE() gemm(a, a, 1., noArray(), 0., d, GEMM_1_T);
+
+    SANITY_CHECK(d, 1e-4, ERROR_RELATIVE);
+}
+
+// many products of small matrices, as in the projections done per sample in ml
+PERF_TEST_P(Size_MatType, gemm_batchedSmall,
+            testing::Combine(
+                testing::Values(Size(4, 4), Size(16, 16), Size(32, 32)),
+                testing::Values(CV_32FC1, CV_64FC1)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    const int batch = 1000;
+
+    vector<Mat> a(batch), b(batch), d(batch);
+    for( int i = 0; i < batch; i++ )
+    {
+        a[i].create(sz, type); b[i].create(sz, type); d[i].create(sz, type);
+        randu(a[i], -1, 1); randu(b[i], -1, 1);
+    }
+
+    TEST_CYCLE()
+    {
+        for( int i = 0; i < batch; i++ )
+            gemm(a[i], b[i], 1., noArray(), 0., d[i]);
+    }
+
+    SANITY_CHECK(d[batch - 1], 1e-4, ERROR_RELATIVE);
+}
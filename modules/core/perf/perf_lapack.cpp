@@ -0,0 +1,157 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+typedef std::tr1::tuple<int, MatType> Order_MatType_t;
+typedef perf::TestBaseWithParam<Order_MatType_t> Order_MatType;
+
+static void randomSymmetric( Mat& a, int n, int type )
+{
+    Mat t(n, n, type);
+    randu(t, -1, 1);
+    a = t + t.t();
+}
+
+PERF_TEST_P(Order_MatType, SVD_large,
+            testing::Combine(
+                testing::Values(64, 256, 512),
+                testing::Values(CV_32FC1, CV_64FC1)
+                )
+            )
+{
+    int n = get<0>(GetParam());
+    int type = get<1>(GetParam());
+
+    Mat a(n, n, type), w, u, vt;
+    declare.in(a, WARMUP_RNG).time(600);
+
+    TEST_CYCLE() SVD::compute(a, w, u, vt);
+
+    SANITY_CHECK(w, 1e-3, ERROR_RELATIVE);
+}
+
+PERF_TEST_P(Order_MatType, eigen_large,
+            testing::Combine(
+                testing::Values(64, 256, 1024),
+                testing::Values(CV_32FC1, CV_64FC1)
+                )
+            )
+{
+    int n = get<0>(GetParam());
+    int type = get<1>(GetParam());
+
+    Mat a, evals, evects;
+    randomSymmetric(a, n, type);
+    declare.in(a).time(600);
+
+    TEST_CYCLE() eigen(a, evals, evects);
+
+    SANITY_CHECK(evals, 1e-3, ERROR_RELATIVE);
+}
+
+PERF_TEST_P(Order_MatType, solve_LU,
+            testing::Combine(
+                testing::Values(64, 256, 1024),
+                testing::Values(CV_32FC1, CV_64FC1)
+                )
+            )
+{
+    int n = get<0>(GetParam());
+    int type = get<1>(GetParam());
+
+    Mat a(n, n, type), b(n, 1, type), x;
+    randu(a, -1, 1);
+    a += Mat::eye(n, n, type)*n;
+    declare.in(a).in(b, WARMUP_RNG).time(100);
+
+    TEST_CYCLE() solve(a, b, x, DECOMP_LU);
+
+    SANITY_CHECK(x, 1e-3, ERROR_RELATIVE);
+}
+
+PERF_TEST_P(Order_MatType, invert_LU,
+            testing::Combine(
+                testing::Values(64, 256, 1024),
+                testing::Values(CV_32FC1, CV_64FC1)
+                )
+            )
+{
+    int n = get<0>(GetParam());
+    int type = get<1>(GetParam());
+
+    Mat a(n, n, type), inv;
+    randu(a, -1, 1);
+    a += Mat::eye(n, n, type)*n;
+    declare.in(a).time(100);
+
+    TEST_CYCLE() invert(a, inv, DECOMP_LU);
+
+    SANITY_CHECK(inv, 1e-3, ERROR_RELATIVE);
+}
+
+// many small decompositions, as in the per-point refinement of calib3d
+PERF_TEST_P(Order_MatType, SVD_batch,
+            testing::Combine(
+                testing::Values(3, 6, 9),
+                testing::Values(CV_32FC1, CV_64FC1)
+                )
+            )
+{
+    int n = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    int sz[] = { 10000, n, n };
+
+    Mat src(3, sz, type), w, u, vt;
+    randu(src, -1, 1);
+
+    TEST_CYCLE() SVDecompBatch(src, w, u, vt);
+
+    SANITY_CHECK(w, 1e-3, ERROR_RELATIVE);
+}
+
+// the same decompositions done one by one, for comparison with SVD_batch
+PERF_TEST_P(Order_MatType, SVD_loop,
+            testing::Combine(
+                testing::Values(3, 6, 9),
+                testing::Values(CV_32FC1, CV_64FC1)
+                )
+            )
+{
+    int n = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    const int batch = 10000;
+
+    Mat src(batch, n*n, type), w, u, vt;
+    randu(src, -1, 1);
+
+    TEST_CYCLE()
+    {
+        for( int i = 0; i < batch; i++ )
+            SVD::compute(src.row(i).reshape(1, n), w, u, vt);
+    }
+
+    SANITY_CHECK(w, 1e-3, ERROR_RELATIVE);
+}
+
+PERF_TEST_P(Order_MatType, eigen_batch,
+            testing::Combine(
+                testing::Values(3, 6, 9),
+                testing::Values(CV_32FC1, CV_64FC1)
+                )
+            )
+{
+    int n = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    int sz[] = { 10000, n, n };
+
+    Mat src(3, sz, type), evals, evects;
+    randu(src, -1, 1);
+
+    TEST_CYCLE() eigenBatch(src, evals, evects);
+
+    SANITY_CHECK(evals, 1e-3, ERROR_RELATIVE);
+}
@@ -94,3 +94,35 @@ PERF_TEST_P(Size_MatType, Mat_Clone_Roi,
 
     SANITY_CHECK(destination, 1);
 }
+
+typedef std::tr1::tuple<Size, bool> Size_MemPool_t;
+typedef perf::TestBaseWithParam<Size_MemPool_t> Size_MemPool;
+
+PERF_TEST_P(Size_MemPool, Mat_Create_Temporaries,
+            testing::Combine(testing::Values(szVGA, sz1080p, sz2160p),
+                             testing::Bool())
+             )
+{
+    Size size = get<0>(GetParam());
+    bool usePool = get<1>(GetParam());
+    bool prevUsePool = useMemoryPool();
+    setUseMemoryPool(usePool);
+
+    Mat src(size, CV_8UC3), dst(size, CV_8UC1);
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE()
+    {
+        // a typical chain of per-frame temporaries
+        Mat gray(size, CV_8UC1), grayf(size, CV_32FC1), tmp(size, CV_8UC3);
+        gray.setTo(Scalar::all(1));
+        grayf.setTo(Scalar::all(1));
+        tmp.setTo(Scalar::all(1));
+        dst.create(size, CV_8UC1);
+    }
+
+    setUseMemoryPool(prevUsePool);
+    dst.setTo(Scalar::all(0));
+
+    SANITY_CHECK(dst);
+}
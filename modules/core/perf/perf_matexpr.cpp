@@ -0,0 +1,51 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+#define TYPICAL_MAT_SIZES_MATEXPR   szVGA, sz1080p
+#define TYPICAL_MAT_TYPES_MATEXPR   CV_8UC1, CV_16SC1, CV_8UC3, CV_32FC1
+#define TYPICAL_MATS_MATEXPR        testing::Combine(testing::Values(TYPICAL_MAT_SIZES_MATEXPR), testing::Values(TYPICAL_MAT_TYPES_MATEXPR))
+
+PERF_TEST_P(Size_MatType, MatExpr_scaleAdd_subtract, TYPICAL_MATS_MATEXPR)
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    Mat a(sz, type), b(sz, type), c(sz, type), dst(sz, type);
+
+    declare.in(a, b, c, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() dst = a*0.5 + b*0.25 - c;
+
+    SANITY_CHECK(dst, 1);
+}
+
+PERF_TEST_P(Size_MatType, MatExpr_mul_min_addScalar, TYPICAL_MATS_MATEXPR)
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    Mat a(sz, type), b(sz, type), c(sz, type), dst(sz, type);
+
+    declare.in(a, b, c, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() dst = min(a.mul(b, 1./256), c) + Scalar::all(16);
+
+    SANITY_CHECK(dst, 1);
+}
+
+PERF_TEST_P(Size_MatType, MatExpr_absdiff_threshold, testing::Combine(testing::Values(TYPICAL_MAT_SIZES_MATEXPR),
+                                                                        testing::Values(CV_8UC1, CV_16SC1, CV_32FC1)))
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    Mat a(sz, type), b(sz, type), mask(sz, CV_8UC1);
+
+    declare.in(a, b, WARMUP_RNG).out(mask);
+
+    TEST_CYCLE() mask = abs(a*2 - b) > 64;
+
+    SANITY_CHECK(mask);
+}
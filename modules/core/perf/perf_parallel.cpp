@@ -0,0 +1,125 @@
+#include "perf_precomp.hpp"
+#include "opencv2/imgproc/imgproc.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+// These tests measure how the configured parallel framework (TBB, OpenMP, built-in pthreads pool, ...)
+// scales on a few typical parallelized imgproc calls. Build OpenCV with different
+// WITH_TBB/WITH_PTHREADS_PF/OpenMP settings and compare the reports with the perf summary script.
+
+#define PARALLEL_THREADS 1, 2, 4, 0
+
+typedef std::tr1::tuple<Size, int> Size_Threads_t;
+typedef perf::TestBaseWithParam<Size_Threads_t> Size_Threads;
+
+namespace
+{
+    class ThreadsGuard
+    {
+    public:
+        explicit ThreadsGuard(int threads) : prev(getNumThreads())
+        {
+            setNumThreads(threads > 0 ? threads : -1);
+        }
+        ~ThreadsGuard() { setNumThreads(prev); }
+    private:
+        int prev;
+    };
+
+    class DummyLoopBody : public ParallelLoopBody
+    {
+    public:
+        DummyLoopBody(Mat& _m) : m(&_m) {}
+        void operator()(const Range& range) const
+        {
+            for( int i = range.start; i < range.end; i++ )
+            {
+                float* row = m->ptr<float>(i);
+                for( int j = 0; j < m->cols; j++ )
+                    row[j] = std::sqrt(row[j] + 1.f);
+            }
+        }
+    private:
+        Mat* m;
+    };
+}
+
+PERF_TEST_P(Size_Threads, parallel_for_overhead,
+            testing::Combine(
+                testing::Values(szVGA, sz1080p),
+                testing::Values(PARALLEL_THREADS)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    ThreadsGuard guard(get<1>(GetParam()));
+
+    Mat m(sz, CV_32FC1, Scalar::all(0));
+    declare.in(m).out(m);
+
+    TEST_CYCLE()
+    {
+        m.setTo(Scalar::all(0));
+        parallel_for_(Range(0, m.rows), DummyLoopBody(m));
+    }
+
+    SANITY_CHECK(m, 1e-6);
+}
+
+PERF_TEST_P(Size_Threads, parallel_cvtColor,
+            testing::Combine(
+                testing::Values(sz1080p, sz2160p),
+                testing::Values(PARALLEL_THREADS)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    ThreadsGuard guard(get<1>(GetParam()));
+
+    Mat src(sz, CV_8UC3), dst(sz, CV_8UC1);
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() cvtColor(src, dst, CV_BGR2GRAY);
+
+    SANITY_CHECK(dst, 1);
+}
+
+PERF_TEST_P(Size_Threads, parallel_resize,
+            testing::Combine(
+                testing::Values(sz1080p, sz2160p),
+                testing::Values(PARALLEL_THREADS)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    ThreadsGuard guard(get<1>(GetParam()));
+
+    Mat src(sz, CV_8UC3), dst(Size(sz.width/3, sz.height/3), CV_8UC3);
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() resize(src, dst, dst.size(), 0, 0, INTER_AREA);
+
+    SANITY_CHECK(dst, 1);
+}
+
+PERF_TEST_P(Size_Threads, parallel_GaussianBlur,
+            testing::Combine(
+                testing::Values(sz1080p, sz2160p),
+                testing::Values(PARALLEL_THREADS)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    ThreadsGuard guard(get<1>(GetParam()));
+
+    Mat src(sz, CV_8UC1), dst(sz, CV_8UC1);
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() GaussianBlur(src, dst, Size(5, 5), 0);
+
+    SANITY_CHECK(dst, 1);
+}
@@ -42,6 +42,16 @@
 
 #include "precomp.hpp"
 
+#if defined WIN32 || defined _WIN32 || defined WINCE
+    #include <windows.h>
+    #undef small
+    #undef min
+    #undef max
+    #undef abs
+#else
+    #include <pthread.h>
+#endif
+
 #define CV_USE_SYSTEM_MALLOC 1
 
 namespace cv
@@ -55,29 +65,336 @@ static void* OutOfMemoryError(size_t size)
 
 #if CV_USE_SYSTEM_MALLOC
 
-#if defined WIN32 || defined _WIN32
-void deleteThreadAllocData() {}
+/****************************************************************************************\
+*                        Optional per-thread pool of fastMalloc blocks                   *
+\****************************************************************************************/
+
+/*
+   Every block returned by fastMalloc() carries two hidden words in front of it:
+   the pointer returned by malloc() and the pool size class (0 for the blocks that
+   were allocated while the pool was off). When the pool is on (cv::setUseMemoryPool()),
+   the request is rounded up to the size class (4 classes per power of two, i.e.
+   at most 25% overhead) and the freed blocks are kept in the free list of the thread
+   that freed them, so the repeating Mat::create()/release() sequences of per-frame
+   processing are served without touching malloc() and without new page faults.
+*/
+
+enum
+{
+    MEM_POOL_MIN_SHIFT = 6,
+    MEM_POOL_MAX_SHIFT = 26,
+    MEM_POOL_MIN_SIZE = 1 << MEM_POOL_MIN_SHIFT,
+    MEM_POOL_MAX_SIZE = 1 << MEM_POOL_MAX_SHIFT,
+    MEM_POOL_CLASSES = (MEM_POOL_MAX_SHIFT - MEM_POOL_MIN_SHIFT)*4 + 1
+};
+
+static volatile bool useMemPool = false;
+static volatile size_t memPoolLimit = (size_t)64 << 20;
+static volatile int memPoolTrimEpoch = 0;
+
+static volatile int64 memPoolBytesReserved = 0;
+static volatile int64 memPoolPeakBytesReserved = 0;
+
+static inline int64 atomicAdd64(volatile int64* addr, int64 delta)
+{
+#if defined __GNUC__
+    return __sync_fetch_and_add(addr, delta);
+#elif defined WIN32 || defined _WIN32
+    return InterlockedExchangeAdd64((volatile LONGLONG*)addr, delta);
+#else
+    int64 prev = *addr; *addr += delta; return prev;
 #endif
+}
 
-void* fastMalloc( size_t size )
+// returns the size class index (1..MEM_POOL_CLASSES) and the rounded block size
+static inline int memPoolSizeClass(size_t size, size_t& classSize)
+{
+    if( size <= (size_t)MEM_POOL_MIN_SIZE )
+    {
+        classSize = MEM_POOL_MIN_SIZE;
+        return 1;
+    }
+    size_t s = size - 1;
+    int e = MEM_POOL_MIN_SHIFT;
+    while( (s >> (e + 1)) != 0 )
+        e++;
+    int k = (int)(s >> (e - 2)) & 3;
+    classSize = (size_t)(5 + k) << (e - 2);
+    return (e - MEM_POOL_MIN_SHIFT)*4 + k + 2;
+}
+
+static inline size_t memPoolClassSize(int idx)
 {
-    uchar* udata = (uchar*)malloc(size + sizeof(void*) + CV_MALLOC_ALIGN);
+    if( idx == 1 )
+        return MEM_POOL_MIN_SIZE;
+    int e = (idx - 2)/4 + MEM_POOL_MIN_SHIFT, k = (idx - 2) & 3;
+    return (size_t)(5 + k) << (e - 2);
+}
+
+static inline void* systemMalloc(size_t size, size_t tag)
+{
+    uchar* udata = (uchar*)malloc(size + sizeof(void*)*2 + CV_MALLOC_ALIGN);
     if(!udata)
         return OutOfMemoryError(size);
-    uchar** adata = alignPtr((uchar**)udata + 1, CV_MALLOC_ALIGN);
+    uchar** adata = alignPtr((uchar**)udata + 2, CV_MALLOC_ALIGN);
     adata[-1] = udata;
+    adata[-2] = (uchar*)tag;
     return adata;
 }
 
+static inline void systemFree(void* ptr)
+{
+    uchar* udata = ((uchar**)ptr)[-1];
+    CV_DbgAssert(udata < (uchar*)ptr &&
+           ((uchar*)ptr - udata) <= (ptrdiff_t)(sizeof(void*)*2+CV_MALLOC_ALIGN));
+    free(udata);
+}
+
+static inline void releasePooledBlock(void* ptr, size_t classSize)
+{
+    systemFree(ptr);
+    atomicAdd64(&memPoolBytesReserved, -(int64)classSize);
+}
+
+struct ThreadMemPool
+{
+    ThreadMemPool() : cachedBytes(0), peakCachedBytes(0), allocCount(0), hitCount(0), freeCount(0),
+        trimEpoch(memPoolTrimEpoch), prev(0), next(0)
+    {
+        memset(bins, 0, sizeof(bins));
+        registerPool(this);
+    }
+
+    ~ThreadMemPool()
+    {
+        trim();
+        unregisterPool(this);
+    }
+
+    void trim()
+    {
+        for( int i = 1; i <= MEM_POOL_CLASSES; i++ )
+        {
+            size_t classSize = memPoolClassSize(i);
+            while( bins[i] )
+            {
+                void* ptr = bins[i];
+                bins[i] = *(void**)ptr;
+                releasePooledBlock(ptr, classSize);
+            }
+        }
+        cachedBytes = 0;
+        trimEpoch = memPoolTrimEpoch;
+    }
+
+    void* alloc(size_t size)
+    {
+        if( trimEpoch != memPoolTrimEpoch )
+            trim();
+        size_t classSize = 0;
+        int idx = memPoolSizeClass(size, classSize);
+        allocCount++;
+        void* ptr = bins[idx];
+        if( ptr )
+        {
+            bins[idx] = *(void**)ptr;
+            cachedBytes -= classSize;
+            hitCount++;
+            return ptr;
+        }
+        ptr = systemMalloc(classSize, idx);
+        int64 reserved = atomicAdd64(&memPoolBytesReserved, (int64)classSize) + (int64)classSize;
+        if( reserved > memPoolPeakBytesReserved )
+            memPoolPeakBytesReserved = reserved; // racy, but good enough for the statistics
+        return ptr;
+    }
+
+    void free(void* ptr, int idx)
+    {
+        if( trimEpoch != memPoolTrimEpoch )
+            trim();
+        size_t classSize = memPoolClassSize(idx);
+        freeCount++;
+        if( !useMemPool || cachedBytes + classSize > memPoolLimit )
+        {
+            releasePooledBlock(ptr, classSize);
+            return;
+        }
+        *(void**)ptr = bins[idx];
+        bins[idx] = ptr;
+        cachedBytes += classSize;
+        if( cachedBytes > peakCachedBytes )
+            peakCachedBytes = cachedBytes;
+    }
+
+    static void registerPool(ThreadMemPool* pool);
+    static void unregisterPool(ThreadMemPool* pool);
+    static ThreadMemPool* get(bool create);
+
+    void* bins[MEM_POOL_CLASSES + 1];
+    volatile size_t cachedBytes;
+    volatile size_t peakCachedBytes;
+    volatile int64 allocCount;
+    volatile int64 hitCount;
+    volatile int64 freeCount;
+    int trimEpoch;
+    ThreadMemPool* prev;
+    ThreadMemPool* next;
+};
+
+// the list of live thread pools, used to collect the statistics
+static Mutex* memPoolListMutex = new Mutex;
+static ThreadMemPool* memPoolList = 0;
+// the statistics of the already finished threads
+static MemoryPoolStats memPoolRetiredStats;
+
+void ThreadMemPool::registerPool(ThreadMemPool* pool)
+{
+    AutoLock lock(*memPoolListMutex);
+    pool->next = memPoolList;
+    if( memPoolList )
+        memPoolList->prev = pool;
+    memPoolList = pool;
+}
+
+void ThreadMemPool::unregisterPool(ThreadMemPool* pool)
+{
+    AutoLock lock(*memPoolListMutex);
+    if( pool->prev )
+        pool->prev->next = pool->next;
+    else
+        memPoolList = pool->next;
+    if( pool->next )
+        pool->next->prev = pool->prev;
+    memPoolRetiredStats.allocCount += pool->allocCount;
+    memPoolRetiredStats.hitCount += pool->hitCount;
+    memPoolRetiredStats.freeCount += pool->freeCount;
+    memPoolRetiredStats.peakBytesCached = std::max(memPoolRetiredStats.peakBytesCached,
+                                                   (int64)pool->peakCachedBytes);
+}
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+#ifdef WINCE
+#   define TLS_OUT_OF_INDEXES ((DWORD)0xFFFFFFFF)
+#endif
+
+static DWORD tlsMemPoolKey = TLS_OUT_OF_INDEXES;
+
+void deleteThreadAllocData()
+{
+    if( tlsMemPoolKey != TLS_OUT_OF_INDEXES )
+    {
+        delete (ThreadMemPool*)TlsGetValue( tlsMemPoolKey );
+        TlsSetValue( tlsMemPoolKey, 0 );
+    }
+}
+
+ThreadMemPool* ThreadMemPool::get(bool create)
+{
+    if( tlsMemPoolKey == TLS_OUT_OF_INDEXES )
+    {
+        if( !create )
+            return 0;
+        tlsMemPoolKey = TlsAlloc();
+        CV_Assert(tlsMemPoolKey != TLS_OUT_OF_INDEXES);
+    }
+    ThreadMemPool* pool = (ThreadMemPool*)TlsGetValue( tlsMemPoolKey );
+    if( !pool && create )
+    {
+        pool = new ThreadMemPool;
+        TlsSetValue( tlsMemPoolKey, pool );
+    }
+    return pool;
+}
+#else
+static pthread_key_t tlsMemPoolKey = 0;
+static pthread_once_t tlsMemPoolKeyOnce = PTHREAD_ONCE_INIT;
+
+static void deleteThreadMemPool(void* data)
+{
+    delete (ThreadMemPool*)data;
+}
+
+static void makeMemPoolKey()
+{
+    int errcode = pthread_key_create(&tlsMemPoolKey, deleteThreadMemPool);
+    CV_Assert(errcode == 0);
+}
+
+ThreadMemPool* ThreadMemPool::get(bool create)
+{
+    pthread_once(&tlsMemPoolKeyOnce, makeMemPoolKey);
+    ThreadMemPool* pool = (ThreadMemPool*)pthread_getspecific(tlsMemPoolKey);
+    if( !pool && create )
+    {
+        pool = new ThreadMemPool;
+        pthread_setspecific(tlsMemPoolKey, pool);
+    }
+    return pool;
+}
+#endif
+
+void* fastMalloc( size_t size )
+{
+    if( useMemPool && size <= (size_t)MEM_POOL_MAX_SIZE )
+        return ThreadMemPool::get(true)->alloc(size);
+    return systemMalloc(size, 0);
+}
+
 void fastFree(void* ptr)
 {
     if(ptr)
     {
-        uchar* udata = ((uchar**)ptr)[-1];
-        CV_DbgAssert(udata < (uchar*)ptr &&
-               ((uchar*)ptr - udata) <= (ptrdiff_t)(sizeof(void*)+CV_MALLOC_ALIGN));
-        free(udata);
+        int idx = (int)(size_t)((uchar**)ptr)[-2];
+        if( idx == 0 )
+            systemFree(ptr);
+        else
+            ThreadMemPool::get(true)->free(ptr, idx);
+    }
+}
+
+MemoryPoolStats::MemoryPoolStats()
+    : allocCount(0), hitCount(0), freeCount(0), bytesCached(0),
+      peakBytesCached(0), bytesReserved(0), peakBytesReserved(0)
+{
+}
+
+void setUseMemoryPool(bool flag, size_t maxCachedBytesPerThread)
+{
+    memPoolLimit = maxCachedBytesPerThread;
+    useMemPool = flag;
+    if( !flag )
+        trimMemoryPool();
+}
+
+bool useMemoryPool()
+{
+    return useMemPool;
+}
+
+void trimMemoryPool()
+{
+    CV_XADD(&memPoolTrimEpoch, 1);
+    ThreadMemPool* pool = ThreadMemPool::get(false);
+    if( pool )
+        pool->trim();
+}
+
+MemoryPoolStats getMemoryPoolStats()
+{
+    AutoLock lock(*memPoolListMutex);
+    MemoryPoolStats stats = memPoolRetiredStats;
+    for( ThreadMemPool* pool = memPoolList; pool != 0; pool = pool->next )
+    {
+        stats.allocCount += pool->allocCount;
+        stats.hitCount += pool->hitCount;
+        stats.freeCount += pool->freeCount;
+        stats.bytesCached += pool->cachedBytes;
+        stats.peakBytesCached = std::max(stats.peakBytesCached, (int64)pool->peakCachedBytes);
     }
+    stats.bytesReserved = memPoolBytesReserved;
+    stats.peakBytesReserved = memPoolPeakBytesReserved;
+    return stats;
 }
 
 #else //CV_USE_SYSTEM_MALLOC
@@ -0,0 +1,433 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+    #include <windows.h>
+    #undef small
+    #undef min
+    #undef max
+    #undef abs
+#else
+    #include <pthread.h>
+#endif
+
+#if defined __linux__ && !defined ANDROID
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #if defined SYS_mbind && defined SYS_getcpu
+        #define HAVE_NUMA_SYSCALLS
+    #endif
+#endif
+
+#include <map>
+
+namespace cv
+{
+
+/****************************************************************************************\
+*                                 Default Mat allocator                                  *
+\****************************************************************************************/
+
+static MatAllocator* volatile processDefaultAllocator = 0;
+static volatile bool threadDefaultAllocatorsUsed = false;
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+#ifdef WINCE
+#   define TLS_OUT_OF_INDEXES ((DWORD)0xFFFFFFFF)
+#endif
+
+static DWORD tlsAllocatorKey = TLS_OUT_OF_INDEXES;
+static DWORD tlsSiteKey = TLS_OUT_OF_INDEXES;
+
+static void* getTlsValue(DWORD& key)
+{
+    return key != TLS_OUT_OF_INDEXES ? TlsGetValue(key) : 0;
+}
+
+static void setTlsValue(DWORD& key, void* value)
+{
+    if( key == TLS_OUT_OF_INDEXES )
+    {
+        key = TlsAlloc();
+        CV_Assert(key != TLS_OUT_OF_INDEXES);
+    }
+    TlsSetValue(key, value);
+}
+#else
+static pthread_key_t tlsAllocatorKey = 0;
+static pthread_key_t tlsSiteKey = 0;
+static pthread_once_t tlsAllocatorKeysOnce = PTHREAD_ONCE_INIT;
+
+static void makeAllocatorKeys()
+{
+    int errcode = pthread_key_create(&tlsAllocatorKey, 0);
+    CV_Assert(errcode == 0);
+    errcode = pthread_key_create(&tlsSiteKey, 0);
+    CV_Assert(errcode == 0);
+}
+
+static void* getTlsValue(pthread_key_t& key)
+{
+    pthread_once(&tlsAllocatorKeysOnce, makeAllocatorKeys);
+    return pthread_getspecific(key);
+}
+
+static void setTlsValue(pthread_key_t& key, void* value)
+{
+    pthread_once(&tlsAllocatorKeysOnce, makeAllocatorKeys);
+    pthread_setspecific(key, value);
+}
+#endif
+
+void setDefaultAllocator(MatAllocator* allocator)
+{
+    processDefaultAllocator = allocator;
+}
+
+void setThreadDefaultAllocator(MatAllocator* allocator)
+{
+    if( allocator )
+        threadDefaultAllocatorsUsed = true;
+    setTlsValue(tlsAllocatorKey, allocator);
+}
+
+MatAllocator* getDefaultAllocator()
+{
+    if( threadDefaultAllocatorsUsed )
+    {
+        MatAllocator* allocator = (MatAllocator*)getTlsValue(tlsAllocatorKey);
+        if( allocator )
+            return allocator;
+    }
+    return processDefaultAllocator;
+}
+
+// the same memory layout as Mat::create() uses: the data is followed by the reference counter
+static size_t computeSteps(int dims, const int* sizes, int type, size_t* step)
+{
+    size_t total = CV_ELEM_SIZE(type);
+    for( int i = dims-1; i >= 0; i-- )
+    {
+        if( step )
+            step[i] = total;
+        total *= sizes[i];
+    }
+    return alignSize(total, (int)sizeof(int));
+}
+
+/****************************************************************************************\
+*                                Accounting Mat allocator                                *
+\****************************************************************************************/
+
+AccountingMatAllocator::SiteStats::SiteStats()
+    : allocCount(0), totalBytes(0), liveBytes(0), peakBytes(0)
+{
+}
+
+AccountingMatAllocator::Site::Site(const char* name)
+{
+    prevName = (const char*)getTlsValue(tlsSiteKey);
+    setTlsValue(tlsSiteKey, (void*)name);
+}
+
+AccountingMatAllocator::Site::~Site()
+{
+    setTlsValue(tlsSiteKey, (void*)prevName);
+}
+
+struct AccountingMatAllocator::Impl
+{
+    struct Block
+    {
+        size_t size;
+        SiteStats* site;
+    };
+
+    Impl(MatAllocator* _base) : base(_base) {}
+
+    static void add(SiteStats& stats, int64 size)
+    {
+        if( size > 0 )
+        {
+            stats.allocCount++;
+            stats.totalBytes += size;
+        }
+        stats.liveBytes += size;
+        stats.peakBytes = std::max(stats.peakBytes, stats.liveBytes);
+    }
+
+    MatAllocator* base;
+    Mutex mutex;
+    SiteStats total;
+    std::map<string, SiteStats> sites;
+    std::map<const uchar*, Block> blocks;
+};
+
+AccountingMatAllocator::AccountingMatAllocator(MatAllocator* base)
+{
+    impl = new Impl(base);
+}
+
+AccountingMatAllocator::~AccountingMatAllocator()
+{
+    delete impl;
+}
+
+void AccountingMatAllocator::allocate(int dims, const int* sizes, int type, int*& refcount,
+                                      uchar*& datastart, uchar*& data, size_t* step)
+{
+    size_t size;
+    if( impl->base )
+    {
+        impl->base->allocate(dims, sizes, type, refcount, datastart, data, step);
+        size = step[0]*sizes[0];
+    }
+    else
+    {
+        size = computeSteps(dims, sizes, type, step);
+        data = datastart = (uchar*)fastMalloc(size + sizeof(*refcount));
+        refcount = (int*)(data + size);
+        *refcount = 1;
+    }
+
+    const char* name = (const char*)getTlsValue(tlsSiteKey);
+
+    AutoLock lock(impl->mutex);
+    SiteStats& site = impl->sites[name ? name : ""];
+    if( site.allocCount == 0 )
+        site.name = name ? name : "";
+    Impl::add(site, (int64)size);
+    Impl::add(impl->total, (int64)size);
+
+    Impl::Block& block = impl->blocks[datastart];
+    block.size = size;
+    block.site = &site;
+}
+
+void AccountingMatAllocator::deallocate(int* refcount, uchar* datastart, uchar* data)
+{
+    {
+    AutoLock lock(impl->mutex);
+    std::map<const uchar*, Impl::Block>::iterator it = impl->blocks.find(datastart);
+    CV_Assert( it != impl->blocks.end() );
+    Impl::add(*it->second.site, -(int64)it->second.size);
+    Impl::add(impl->total, -(int64)it->second.size);
+    impl->blocks.erase(it);
+    }
+
+    if( impl->base )
+        impl->base->deallocate(refcount, datastart, data);
+    else
+        fastFree(datastart);
+}
+
+AccountingMatAllocator::SiteStats AccountingMatAllocator::getTotalStats() const
+{
+    AutoLock lock(impl->mutex);
+    return impl->total;
+}
+
+void AccountingMatAllocator::getSiteStats(vector<SiteStats>& stats) const
+{
+    AutoLock lock(impl->mutex);
+    stats.clear();
+    for( std::map<string, SiteStats>::const_iterator it = impl->sites.begin(); it != impl->sites.end(); ++it )
+        stats.push_back(it->second);
+}
+
+void AccountingMatAllocator::resetStats()
+{
+    AutoLock lock(impl->mutex);
+    std::map<string, SiteStats>::iterator it = impl->sites.begin();
+    for( ; it != impl->sites.end(); ++it )
+    {
+        it->second.allocCount = it->second.totalBytes = 0;
+        it->second.peakBytes = it->second.liveBytes;
+    }
+    impl->total.allocCount = impl->total.totalBytes = 0;
+    impl->total.peakBytes = impl->total.liveBytes;
+}
+
+/****************************************************************************************\
+*                                   NUMA Mat allocator                                   *
+\****************************************************************************************/
+
+/*
+   The matrix data is preceded by a header that keeps the size of the mapping
+   (0 for the blocks allocated with fastMalloc). The header size keeps the data
+   aligned by the cache line.
+*/
+
+enum { NUMA_HDR_SIZE = 64, NUMA_MIN_MMAP_SIZE = 1 << 16 };
+
+#ifdef HAVE_NUMA_SYSCALLS
+enum { NUMA_MPOL_PREFERRED = 1, NUMA_MPOL_INTERLEAVE = 3 };
+
+// parses strings like "0-1,3" from /sys/devices/system/node/online
+static unsigned long getOnlineNodesMask()
+{
+    FILE* f = fopen("/sys/devices/system/node/online", "r");
+    if( !f )
+        return 1;
+    char buf[256];
+    char* pbuf = fgets(buf, sizeof(buf), f);
+    fclose(f);
+    if( !pbuf )
+        return 1;
+
+    unsigned long mask = 0;
+    while( *pbuf )
+    {
+        int start = 0, end = -1, n = 0;
+        if( sscanf(pbuf, "%d%n", &start, &n) != 1 )
+            break;
+        pbuf += n;
+        end = start;
+        if( *pbuf == '-' && sscanf(pbuf + 1, "%d%n", &end, &n) == 1 )
+            pbuf += n + 1;
+        for( int i = std::max(start, 0); i <= end && i < (int)sizeof(mask)*8; i++ )
+            mask |= 1UL << i;
+        if( *pbuf != ',' )
+            break;
+        pbuf++;
+    }
+    return mask ? mask : 1;
+}
+#endif
+
+NumaMatAllocator::NumaMatAllocator(int _policy, int _node) : policy(_policy), node(_node)
+{
+    CV_Assert( policy == LOCAL || policy == INTERLEAVE );
+    CV_Assert( node < getNumberOfNodes() );
+}
+
+int NumaMatAllocator::getNumberOfNodes()
+{
+#ifdef HAVE_NUMA_SYSCALLS
+    static int nnodes = 0;
+    if( nnodes == 0 )
+    {
+        unsigned long mask = getOnlineNodesMask();
+        int n = 0;
+        for( ; n < (int)sizeof(mask)*8 && (mask >> n) != 0; n++ )
+            ;
+        nnodes = n;
+    }
+    return nnodes;
+#else
+    return 1;
+#endif
+}
+
+int NumaMatAllocator::getCurrentNode()
+{
+#ifdef HAVE_NUMA_SYSCALLS
+    unsigned cpu = 0, cpuNode = 0;
+    if( syscall(SYS_getcpu, &cpu, &cpuNode, (void*)0) == 0 )
+        return (int)cpuNode;
+#endif
+    return 0;
+}
+
+void NumaMatAllocator::allocate(int dims, const int* sizes, int type, int*& refcount,
+                                uchar*& datastart, uchar*& data, size_t* step)
+{
+    size_t size = computeSteps(dims, sizes, type, step);
+    size_t totalSize = NUMA_HDR_SIZE + size + sizeof(*refcount);
+    uchar* block = 0;
+
+#ifdef HAVE_NUMA_SYSCALLS
+    if( totalSize >= (size_t)NUMA_MIN_MMAP_SIZE && getNumberOfNodes() > 1 )
+    {
+        void* ptr = mmap(0, totalSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if( ptr == MAP_FAILED )
+            CV_Error_(CV_StsNoMem, ("Failed to allocate %lu bytes", (unsigned long)totalSize));
+        block = (uchar*)ptr;
+
+        unsigned long mask;
+        int mode;
+        if( policy == INTERLEAVE )
+        {
+            mode = NUMA_MPOL_INTERLEAVE;
+            mask = getOnlineNodesMask();
+        }
+        else
+        {
+            mode = NUMA_MPOL_PREFERRED;
+            mask = 1UL << (node >= 0 ? node : getCurrentNode());
+        }
+        // the placement is a hint: if mbind() fails, the pages are placed by the default policy
+        syscall(SYS_mbind, ptr, totalSize, mode, &mask, sizeof(mask)*8 + 1, 0);
+        *(size_t*)block = totalSize;
+    }
+#endif
+
+    if( !block )
+    {
+        block = (uchar*)fastMalloc(totalSize);
+        *(size_t*)block = 0;
+    }
+
+    data = datastart = block + NUMA_HDR_SIZE;
+    refcount = (int*)(data + size);
+    *refcount = 1;
+}
+
+void NumaMatAllocator::deallocate(int*, uchar* datastart, uchar*)
+{
+    uchar* block = datastart - NUMA_HDR_SIZE;
+    size_t mappedSize = *(size_t*)block;
+#ifdef HAVE_NUMA_SYSCALLS
+    if( mappedSize != 0 )
+    {
+        munmap(block, mappedSize);
+        return;
+    }
+#endif
+    CV_Assert( mappedSize == 0 );
+    fastFree(block);
+}
+
+}
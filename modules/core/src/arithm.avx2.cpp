@@ -0,0 +1,364 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+/*
+   AVX2 kernels for add, subtract, absdiff and compare; see avx2.hpp for the rules
+   that apply to this file. The results are bit-exact with the generic code in arithm.cpp.
+*/
+
+#include "avx2.hpp"
+
+#if defined CV_TRY_AVX2 && CV_TRY_AVX2
+
+#include <immintrin.h>
+
+namespace cv { namespace avx2 {
+
+namespace
+{
+
+typedef unsigned char uchar;
+typedef signed char schar;
+typedef unsigned short ushort;
+
+// the values of cv::CMP_*
+enum { CMP_EQ = 0, CMP_GT = 1, CMP_GE = 2, CMP_LT = 3, CMP_LE = 4, CMP_NE = 5 };
+
+inline int sat8u(int v) { return v < 0 ? 0 : v > 255 ? 255 : v; }
+inline int sat8s(int v) { return v < -128 ? -128 : v > 127 ? 127 : v; }
+inline int sat16u(int v) { return v < 0 ? 0 : v > 65535 ? 65535 : v; }
+inline int sat16s(int v) { return v < -32768 ? -32768 : v > 32767 ? 32767 : v; }
+inline int iabs(int v) { return v < 0 ? -v : v; }
+
+// std::abs() would be an inline function shared with the rest of the library
+inline float fabs32f(float v)
+{
+    union { float f; unsigned i; } u;
+    u.f = v; u.i &= 0x7fffffff;
+    return u.f;
+}
+
+inline double fabs64f(double v)
+{
+    union { double f; unsigned long long i; } u;
+    u.f = v; u.i &= 0x7fffffffffffffffULL;
+    return u.f;
+}
+
+struct Add8u
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_adds_epu8(a, b); }
+    uchar operator()(uchar a, uchar b) const { return (uchar)sat8u(a + b); }
+};
+struct Sub8u
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_subs_epu8(a, b); }
+    uchar operator()(uchar a, uchar b) const { return (uchar)sat8u(a - b); }
+};
+struct AbsDiff8u
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const
+    { return _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a)); }
+    uchar operator()(uchar a, uchar b) const { return (uchar)iabs(a - b); }
+};
+
+struct Add8s
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_adds_epi8(a, b); }
+    schar operator()(schar a, schar b) const { return (schar)sat8s(a + b); }
+};
+struct Sub8s
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_subs_epi8(a, b); }
+    schar operator()(schar a, schar b) const { return (schar)sat8s(a - b); }
+};
+struct AbsDiff8s
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const
+    { return _mm256_max_epi8(_mm256_subs_epi8(a, b), _mm256_subs_epi8(b, a)); }
+    schar operator()(schar a, schar b) const { return (schar)sat8s(iabs(a - b)); }
+};
+
+struct Add16u
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_adds_epu16(a, b); }
+    ushort operator()(ushort a, ushort b) const { return (ushort)sat16u(a + b); }
+};
+struct Sub16u
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_subs_epu16(a, b); }
+    ushort operator()(ushort a, ushort b) const { return (ushort)sat16u(a - b); }
+};
+struct AbsDiff16u
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const
+    { return _mm256_or_si256(_mm256_subs_epu16(a, b), _mm256_subs_epu16(b, a)); }
+    ushort operator()(ushort a, ushort b) const { return (ushort)iabs(a - b); }
+};
+
+struct Add16s
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_adds_epi16(a, b); }
+    short operator()(short a, short b) const { return (short)sat16s(a + b); }
+};
+struct Sub16s
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_subs_epi16(a, b); }
+    short operator()(short a, short b) const { return (short)sat16s(a - b); }
+};
+struct AbsDiff16s
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const
+    { return _mm256_subs_epi16(_mm256_max_epi16(a, b), _mm256_min_epi16(a, b)); }
+    short operator()(short a, short b) const { return (short)sat16s(iabs(a - b)); }
+};
+
+// 32-bit integer arithmetic wraps around, as in the generic code
+struct Add32s
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_add_epi32(a, b); }
+    int operator()(int a, int b) const { return (int)((unsigned)a + (unsigned)b); }
+};
+struct Sub32s
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_sub_epi32(a, b); }
+    int operator()(int a, int b) const { return (int)((unsigned)a - (unsigned)b); }
+};
+struct AbsDiff32s
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const
+    { return _mm256_abs_epi32(_mm256_sub_epi32(a, b)); }
+    int operator()(int a, int b) const
+    {
+        unsigned d = (unsigned)a - (unsigned)b;
+        return (int)((int)d < 0 ? 0u - d : d);
+    }
+};
+
+struct Add32f
+{
+    __m256 operator()(const __m256& a, const __m256& b) const { return _mm256_add_ps(a, b); }
+    float operator()(float a, float b) const { return a + b; }
+};
+struct Sub32f
+{
+    __m256 operator()(const __m256& a, const __m256& b) const { return _mm256_sub_ps(a, b); }
+    float operator()(float a, float b) const { return a - b; }
+};
+struct AbsDiff32f
+{
+    __m256 operator()(const __m256& a, const __m256& b) const
+    { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), _mm256_sub_ps(a, b)); }
+    float operator()(float a, float b) const { return fabs32f(a - b); }
+};
+
+struct Add64f
+{
+    __m256d operator()(const __m256d& a, const __m256d& b) const { return _mm256_add_pd(a, b); }
+    double operator()(double a, double b) const { return a + b; }
+};
+struct Sub64f
+{
+    __m256d operator()(const __m256d& a, const __m256d& b) const { return _mm256_sub_pd(a, b); }
+    double operator()(double a, double b) const { return a - b; }
+};
+struct AbsDiff64f
+{
+    __m256d operator()(const __m256d& a, const __m256d& b) const
+    { return _mm256_andnot_pd(_mm256_set1_pd(-0.), _mm256_sub_pd(a, b)); }
+    double operator()(double a, double b) const { return fabs64f(a - b); }
+};
+
+inline __m256i load(const void* p) { return _mm256_loadu_si256((const __m256i*)p); }
+inline void store(void* p, const __m256i& v) { _mm256_storeu_si256((__m256i*)p, v); }
+inline __m256 load(const float* p) { return _mm256_loadu_ps(p); }
+inline void store(float* p, const __m256& v) { _mm256_storeu_ps(p, v); }
+inline __m256d load(const double* p) { return _mm256_loadu_pd(p); }
+inline void store(double* p, const __m256d& v) { _mm256_storeu_pd(p, v); }
+
+template<typename T> struct VecType { typedef __m256i type; };
+template<> struct VecType<float> { typedef __m256 type; };
+template<> struct VecType<double> { typedef __m256d type; };
+
+template<typename T, class Op> void
+binaryOp(const T* src1, size_t step1, const T* src2, size_t step2,
+         T* dst, size_t step, int width, int height)
+{
+    typedef typename VecType<T>::type VT;
+    const int nlanes = (int)(sizeof(VT)/sizeof(T));
+    Op op;
+
+    for( ; height--; src1 = (const T*)((const uchar*)src1 + step1),
+                     src2 = (const T*)((const uchar*)src2 + step2),
+                     dst = (T*)((uchar*)dst + step) )
+    {
+        int x = 0;
+        for( ; x <= width - nlanes*2; x += nlanes*2 )
+        {
+            VT r0 = op(load(src1 + x), load(src2 + x));
+            VT r1 = op(load(src1 + x + nlanes), load(src2 + x + nlanes));
+            store(dst + x, r0);
+            store(dst + x + nlanes, r1);
+        }
+        for( ; x <= width - nlanes; x += nlanes )
+            store(dst + x, op(load(src1 + x), load(src2 + x)));
+        for( ; x < width; x++ )
+            dst[x] = op(src1[x], src2[x]);
+    }
+}
+
+// mask of the elements with a > b (gt == true) or a == b, packed to 8 bits
+struct Cmp8u
+{
+    enum { nlanes = 32 };
+    __m256i operator()(const uchar* a, const uchar* b, bool gt) const
+    {
+        __m256i va = load(a), vb = load(b);
+        if( !gt )
+            return _mm256_cmpeq_epi8(va, vb);
+        // there is no unsigned comparison, so the values are shifted to the signed range
+        const __m256i delta = _mm256_set1_epi8((char)-128);
+        return _mm256_cmpgt_epi8(_mm256_xor_si256(va, delta), _mm256_xor_si256(vb, delta));
+    }
+};
+
+struct Cmp16s
+{
+    enum { nlanes = 32 };
+    __m256i operator()(const short* a, const short* b, bool gt) const
+    {
+        __m256i a0 = load(a), a1 = load(a + 16), b0 = load(b), b1 = load(b + 16);
+        __m256i r0 = gt ? _mm256_cmpgt_epi16(a0, b0) : _mm256_cmpeq_epi16(a0, b0);
+        __m256i r1 = gt ? _mm256_cmpgt_epi16(a1, b1) : _mm256_cmpeq_epi16(a1, b1);
+        // packs works within 128-bit lanes; restore the element order afterwards
+        return _mm256_permute4x64_epi64(_mm256_packs_epi16(r0, r1), 0xD8);
+    }
+};
+
+struct Cmp32f
+{
+    enum { nlanes = 32 };
+    __m256i operator()(const float* a, const float* b, bool gt) const
+    {
+        __m256i r[4];
+        for( int k = 0; k < 4; k++ )
+        {
+            __m256 va = load(a + k*8), vb = load(b + k*8);
+            r[k] = _mm256_castps_si256(gt ? _mm256_cmp_ps(va, vb, _CMP_GT_OQ) :
+                                            _mm256_cmp_ps(va, vb, _CMP_EQ_OQ));
+        }
+        __m256i r01 = _mm256_permute4x64_epi64(_mm256_packs_epi32(r[0], r[1]), 0xD8);
+        __m256i r23 = _mm256_permute4x64_epi64(_mm256_packs_epi32(r[2], r[3]), 0xD8);
+        return _mm256_permute4x64_epi64(_mm256_packs_epi16(r01, r23), 0xD8);
+    }
+};
+
+// same reduction of the comparison codes as cmp_() in arithm.cpp: GE and LT swap the operands,
+// LE and NE are the negated GT and EQ (so that they are true for NaNs)
+template<typename T, class Op> void
+compareOp(const T* src1, size_t step1, const T* src2, size_t step2,
+          uchar* dst, size_t step, int width, int height, int code)
+{
+    if( code == CMP_GE || code == CMP_LT )
+    {
+        const T* t = src1; src1 = src2; src2 = t;
+        size_t ts = step1; step1 = step2; step2 = ts;
+        code = code == CMP_GE ? CMP_LE : CMP_GT;
+    }
+
+    bool gt = code == CMP_GT || code == CMP_LE;
+    int m = code == CMP_GT || code == CMP_EQ ? 0 : 255;
+    __m256i vm = _mm256_set1_epi8((char)m);
+    Op op;
+
+    for( ; height--; src1 = (const T*)((const uchar*)src1 + step1),
+                     src2 = (const T*)((const uchar*)src2 + step2),
+                     dst += step )
+    {
+        int x = 0;
+        for( ; x <= width - Op::nlanes; x += Op::nlanes )
+            store(dst + x, _mm256_xor_si256(op(src1 + x, src2 + x, gt), vm));
+        if( gt )
+            for( ; x < width; x++ )
+                dst[x] = (uchar)(-(src1[x] > src2[x]) ^ m);
+        else
+            for( ; x < width; x++ )
+                dst[x] = (uchar)(-(src1[x] == src2[x]) ^ m);
+    }
+}
+
+}
+
+#define CV_AVX2_DEF_BINARY_FUNC(name, suffix, type, op) \
+void name##suffix(const type* src1, size_t step1, const type* src2, size_t step2, \
+                  type* dst, size_t step, int width, int height) \
+{ binaryOp<type, op>(src1, step1, src2, step2, dst, step, width, height); }
+
+#define CV_AVX2_DEF_BINARY_FUNCS(name, opname) \
+CV_AVX2_DEF_BINARY_FUNC(name, 8u, uchar, opname##8u) \
+CV_AVX2_DEF_BINARY_FUNC(name, 8s, schar, opname##8s) \
+CV_AVX2_DEF_BINARY_FUNC(name, 16u, ushort, opname##16u) \
+CV_AVX2_DEF_BINARY_FUNC(name, 16s, short, opname##16s) \
+CV_AVX2_DEF_BINARY_FUNC(name, 32s, int, opname##32s) \
+CV_AVX2_DEF_BINARY_FUNC(name, 32f, float, opname##32f) \
+CV_AVX2_DEF_BINARY_FUNC(name, 64f, double, opname##64f)
+
+CV_AVX2_DEF_BINARY_FUNCS(add, Add)
+CV_AVX2_DEF_BINARY_FUNCS(sub, Sub)
+CV_AVX2_DEF_BINARY_FUNCS(absdiff, AbsDiff)
+
+void cmp8u(const uchar* src1, size_t step1, const uchar* src2, size_t step2,
+           uchar* dst, size_t step, int width, int height, int cmpop)
+{ compareOp<uchar, Cmp8u>(src1, step1, src2, step2, dst, step, width, height, cmpop); }
+
+void cmp16s(const short* src1, size_t step1, const short* src2, size_t step2,
+            uchar* dst, size_t step, int width, int height, int cmpop)
+{ compareOp<short, Cmp16s>(src1, step1, src2, step2, dst, step, width, height, cmpop); }
+
+void cmp32f(const float* src1, size_t step1, const float* src2, size_t step2,
+            uchar* dst, size_t step, int width, int height, int cmpop)
+{ compareOp<float, Cmp32f>(src1, step1, src2, step2, dst, step, width, height, cmpop); }
+
+}}
+
+#endif
@@ -47,6 +47,7 @@
 // */
 
 #include "precomp.hpp"
+#include "avx2.hpp"
 
 namespace cv
 {
@@ -528,10 +529,53 @@ static inline void fixSteps(Size sz, size_t elemSize, size_t& step1, size_t& ste
         step1 = step2 = step = sz.width*elemSize;
 }
 
+template<typename T> struct BinaryKernel
+{
+    typedef void (*Func)(const T* src1, size_t step1, const T* src2, size_t step2,
+                         T* dst, size_t step, int width, int height);
+};
+
+template<typename T> struct CmpKernel
+{
+    typedef void (*Func)(const T* src1, size_t step1, const T* src2, size_t step2,
+                         uchar* dst, size_t step, int width, int height, int cmpop);
+};
+
+#define DEF_DISPATCHED_BINARY_FUNCS(name) \
+static DispatchedKernel<BinaryKernel<uchar>::Func> name##8uKernel(#name "8u", CV_AVX2_VARIANT(name##8u)); \
+static DispatchedKernel<BinaryKernel<schar>::Func> name##8sKernel(#name "8s", CV_AVX2_VARIANT(name##8s)); \
+static DispatchedKernel<BinaryKernel<ushort>::Func> name##16uKernel(#name "16u", CV_AVX2_VARIANT(name##16u)); \
+static DispatchedKernel<BinaryKernel<short>::Func> name##16sKernel(#name "16s", CV_AVX2_VARIANT(name##16s)); \
+static DispatchedKernel<BinaryKernel<int>::Func> name##32sKernel(#name "32s", CV_AVX2_VARIANT(name##32s)); \
+static DispatchedKernel<BinaryKernel<float>::Func> name##32fKernel(#name "32f", CV_AVX2_VARIANT(name##32f)); \
+static DispatchedKernel<BinaryKernel<double>::Func> name##64fKernel(#name "64f", CV_AVX2_VARIANT(name##64f))
+
+DEF_DISPATCHED_BINARY_FUNCS(add);
+DEF_DISPATCHED_BINARY_FUNCS(sub);
+DEF_DISPATCHED_BINARY_FUNCS(absdiff);
+
+static DispatchedKernel<CmpKernel<uchar>::Func> cmp8uKernel("cmp8u", CV_AVX2_VARIANT(cmp8u));
+static DispatchedKernel<CmpKernel<short>::Func> cmp16sKernel("cmp16s", CV_AVX2_VARIANT(cmp16s));
+static DispatchedKernel<CmpKernel<float>::Func> cmp32fKernel("cmp32f", CV_AVX2_VARIANT(cmp32f));
+
+#define CALL_DISPATCHED_BINARY_FUNC(func) \
+    if( func##Kernel.get() ) \
+    { \
+        func##Kernel.get()(src1, step1, src2, step2, dst, step, sz.width, sz.height); \
+        return; \
+    }
+#define CALL_DISPATCHED_CMP_FUNC(func) \
+    if( func##Kernel.get() ) \
+    { \
+        func##Kernel.get()(src1, step1, src2, step2, dst, step, size.width, size.height, *(int*)_cmpop); \
+        return; \
+    }
+
 static void add8u( const uchar* src1, size_t step1,
                    const uchar* src2, size_t step2,
                    uchar* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(add8u)
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAdd_8u_C1RSfs(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz, 0),
            (vBinOp8<uchar, OpAdd<uchar>, IF_SIMD(_VAdd8u)>(src1, step1, src2, step2, dst, step, sz)));
@@ -541,6 +585,7 @@ static void add8s( const schar* src1, size_t step1,
                    const schar* src2, size_t step2,
                    schar* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(add8s)
     vBinOp8<schar, OpAdd<schar>, IF_SIMD(_VAdd8s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
@@ -548,6 +593,7 @@ static void add16u( const ushort* src1, size_t step1,
                     const ushort* src2, size_t step2,
                     ushort* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(add16u)
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAdd_16u_C1RSfs(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz, 0),
             (vBinOp16<ushort, OpAdd<ushort>, IF_SIMD(_VAdd16u)>(src1, step1, src2, step2, dst, step, sz)));
@@ -557,6 +603,7 @@ static void add16s( const short* src1, size_t step1,
                     const short* src2, size_t step2,
                     short* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(add16s)
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAdd_16s_C1RSfs(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz, 0),
            (vBinOp16<short, OpAdd<short>, IF_SIMD(_VAdd16s)>(src1, step1, src2, step2, dst, step, sz)));
@@ -566,6 +613,7 @@ static void add32s( const int* src1, size_t step1,
                     const int* src2, size_t step2,
                     int* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(add32s)
     vBinOp32s<OpAdd<int>, IF_SIMD(_VAdd32s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
@@ -573,6 +621,7 @@ static void add32f( const float* src1, size_t step1,
                     const float* src2, size_t step2,
                     float* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(add32f)
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAdd_32f_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
            (vBinOp32f<OpAdd<float>, IF_SIMD(_VAdd32f)>(src1, step1, src2, step2, dst, step, sz)));
@@ -582,6 +631,7 @@ static void add64f( const double* src1, size_t step1,
                     const double* src2, size_t step2,
                     double* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(add64f)
     vBinOp64f<OpAdd<double>, IF_SIMD(_VAdd64f)>(src1, step1, src2, step2, dst, step, sz);
 }
 
@@ -589,6 +639,7 @@ static void sub8u( const uchar* src1, size_t step1,
                    const uchar* src2, size_t step2,
                    uchar* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(sub8u)
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiSub_8u_C1RSfs(src2, (int)step2, src1, (int)step1, dst, (int)step, (IppiSize&)sz, 0),
            (vBinOp8<uchar, OpSub<uchar>, IF_SIMD(_VSub8u)>(src1, step1, src2, step2, dst, step, sz)));
@@ -598,6 +649,7 @@ static void sub8s( const schar* src1, size_t step1,
                    const schar* src2, size_t step2,
                    schar* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(sub8s)
     vBinOp8<schar, OpSub<schar>, IF_SIMD(_VSub8s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
@@ -605,6 +657,7 @@ static void sub16u( const ushort* src1, size_t step1,
                     const ushort* src2, size_t step2,
                     ushort* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(sub16u)
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiSub_16u_C1RSfs(src2, (int)step2, src1, (int)step1, dst, (int)step, (IppiSize&)sz, 0),
            (vBinOp16<ushort, OpSub<ushort>, IF_SIMD(_VSub16u)>(src1, step1, src2, step2, dst, step, sz)));
@@ -614,6 +667,7 @@ static void sub16s( const short* src1, size_t step1,
                     const short* src2, size_t step2,
                     short* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(sub16s)
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiSub_16s_C1RSfs(src2, (int)step2, src1, (int)step1, dst, (int)step, (IppiSize&)sz, 0),
            (vBinOp16<short, OpSub<short>, IF_SIMD(_VSub16s)>(src1, step1, src2, step2, dst, step, sz)));
@@ -623,6 +677,7 @@ static void sub32s( const int* src1, size_t step1,
                     const int* src2, size_t step2,
                     int* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(sub32s)
     vBinOp32s<OpSub<int>, IF_SIMD(_VSub32s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
@@ -630,6 +685,7 @@ static void sub32f( const float* src1, size_t step1,
                    const float* src2, size_t step2,
                    float* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(sub32f)
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiSub_32f_C1R(src2, (int)step2, src1, (int)step1, dst, (int)step, (IppiSize&)sz),
            (vBinOp32f<OpSub<float>, IF_SIMD(_VSub32f)>(src1, step1, src2, step2, dst, step, sz)));
@@ -639,6 +695,7 @@ static void sub64f( const double* src1, size_t step1,
                     const double* src2, size_t step2,
                     double* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(sub64f)
     vBinOp64f<OpSub<double>, IF_SIMD(_VSub64f)>(src1, step1, src2, step2, dst, step, sz);
 }
 
@@ -865,6 +922,7 @@ static void absdiff8u( const uchar* src1, size_t step1,
                        const uchar* src2, size_t step2,
                        uchar* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(absdiff8u)
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAbsDiff_8u_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
            (vBinOp8<uchar, OpAbsDiff<uchar>, IF_SIMD(_VAbsDiff8u)>(src1, step1, src2, step2, dst, step, sz)));
@@ -874,6 +932,7 @@ static void absdiff8s( const schar* src1, size_t step1,
                        const schar* src2, size_t step2,
                        schar* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(absdiff8s)
     vBinOp8<schar, OpAbsDiff<schar>, IF_SIMD(_VAbsDiff8s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
@@ -881,6 +940,7 @@ static void absdiff16u( const ushort* src1, size_t step1,
                         const ushort* src2, size_t step2,
                         ushort* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(absdiff16u)
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAbsDiff_16u_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
            (vBinOp16<ushort, OpAbsDiff<ushort>, IF_SIMD(_VAbsDiff16u)>(src1, step1, src2, step2, dst, step, sz)));
@@ -890,6 +950,7 @@ static void absdiff16s( const short* src1, size_t step1,
                         const short* src2, size_t step2,
                         short* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(absdiff16s)
     vBinOp16<short, OpAbsDiff<short>, IF_SIMD(_VAbsDiff16s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
@@ -897,6 +958,7 @@ static void absdiff32s( const int* src1, size_t step1,
                         const int* src2, size_t step2,
                         int* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(absdiff32s)
     vBinOp32s<OpAbsDiff<int>, IF_SIMD(_VAbsDiff32s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
@@ -904,6 +966,7 @@ static void absdiff32f( const float* src1, size_t step1,
                         const float* src2, size_t step2,
                         float* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(absdiff32f)
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAbsDiff_32f_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
            (vBinOp32f<OpAbsDiff<float>, IF_SIMD(_VAbsDiff32f)>(src1, step1, src2, step2, dst, step, sz)));
@@ -913,6 +976,7 @@ static void absdiff64f( const double* src1, size_t step1,
                         const double* src2, size_t step2,
                         double* dst, size_t step, Size sz, void* )
 {
+    CALL_DISPATCHED_BINARY_FUNC(absdiff64f)
     vBinOp64f<OpAbsDiff<double>, IF_SIMD(_VAbsDiff64f)>(src1, step1, src2, step2, dst, step, sz);
 }
 
@@ -2120,6 +2184,7 @@ cmp_(const T* src1, size_t step1, const T* src2, size_t step2,
 static void cmp8u(const uchar* src1, size_t step1, const uchar* src2, size_t step2,
                   uchar* dst, size_t step, Size size, void* _cmpop)
 {
+    CALL_DISPATCHED_CMP_FUNC(cmp8u)
   //vz optimized  cmp_(src1, step1, src2, step2, dst, step, size, *(int*)_cmpop);
     int code = *(int*)_cmpop;
     step1 /= sizeof(src1[0]);
@@ -2200,6 +2265,7 @@ static void cmp16u(const ushort* src1, size_t step1, const ushort* src2, size_t
 static void cmp16s(const short* src1, size_t step1, const short* src2, size_t step2,
                   uchar* dst, size_t step, Size size, void* _cmpop)
 {
+    CALL_DISPATCHED_CMP_FUNC(cmp16s)
    //vz optimized cmp_(src1, step1, src2, step2, dst, step, size, *(int*)_cmpop);
 
     int code = *(int*)_cmpop;
@@ -2297,6 +2363,7 @@ static void cmp32s(const int* src1, size_t step1, const int* src2, size_t step2,
 static void cmp32f(const float* src1, size_t step1, const float* src2, size_t step2,
                   uchar* dst, size_t step, Size size, void* _cmpop)
 {
+    CALL_DISPATCHED_CMP_FUNC(cmp32f)
     cmp_(src1, step1, src2, step2, dst, step, size, *(int*)_cmpop);
 }
 
@@ -0,0 +1,140 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+#ifndef __OPENCV_CORE_AVX2_HPP__
+#define __OPENCV_CORE_AVX2_HPP__
+
+#include <stddef.h>
+
+/*
+   AVX2 versions of the most used core kernels (see *.avx2.cpp).
+
+   The kernels are compiled with AVX2/FMA code generation enabled, so they may be called
+   only when USE_AVX2 is set. Their translation units deliberately include nothing from
+   OpenCV: every inline function pulled in from the common headers would be emitted there
+   with AVX2 instructions too, and the linker is free to keep that copy for all the callers.
+   That is also why the interface uses plain C types only.
+
+   Matrix depths are passed as the CV_8U ... CV_64F values; the kernels process single-channel
+   rows, multi-channel data is handled by the callers as a wider row.
+*/
+
+#if defined CV_TRY_AVX2 && CV_TRY_AVX2
+
+namespace cv { namespace avx2 {
+
+#define CV_AVX2_DECL_BINARY_FUNC(name, type) \
+void name(const type* src1, size_t step1, const type* src2, size_t step2, \
+          type* dst, size_t step, int width, int height)
+
+#define CV_AVX2_DECL_BINARY_FUNCS(name) \
+CV_AVX2_DECL_BINARY_FUNC(name##8u, unsigned char); \
+CV_AVX2_DECL_BINARY_FUNC(name##8s, signed char); \
+CV_AVX2_DECL_BINARY_FUNC(name##16u, unsigned short); \
+CV_AVX2_DECL_BINARY_FUNC(name##16s, short); \
+CV_AVX2_DECL_BINARY_FUNC(name##32s, int); \
+CV_AVX2_DECL_BINARY_FUNC(name##32f, float); \
+CV_AVX2_DECL_BINARY_FUNC(name##64f, double)
+
+CV_AVX2_DECL_BINARY_FUNCS(add);
+CV_AVX2_DECL_BINARY_FUNCS(sub);
+CV_AVX2_DECL_BINARY_FUNCS(absdiff);
+
+#undef CV_AVX2_DECL_BINARY_FUNCS
+#undef CV_AVX2_DECL_BINARY_FUNC
+
+// cmpop is one of cv::CMP_EQ ... cv::CMP_NE
+void cmp8u(const unsigned char* src1, size_t step1, const unsigned char* src2, size_t step2,
+           unsigned char* dst, size_t step, int width, int height, int cmpop);
+void cmp16s(const short* src1, size_t step1, const short* src2, size_t step2,
+            unsigned char* dst, size_t step, int width, int height, int cmpop);
+void cmp32f(const float* src1, size_t step1, const float* src2, size_t step2,
+            unsigned char* dst, size_t step, int width, int height, int cmpop);
+
+// dst = saturate(src*alpha + beta), computed in single precision like cvtScale_<T, DT, float>
+typedef void (*CvtScaleFunc)(const unsigned char* src, size_t sstep, unsigned char* dst, size_t dstep,
+                             int width, int height, float alpha, float beta);
+// returns 0 for the depth combinations that have no AVX2 kernel
+CvtScaleFunc getCvtScaleFunc(int sdepth, int ddepth);
+CvtScaleFunc getCvtFunc(int sdepth, int ddepth);
+
+int countNonZero8u(const unsigned char* src, int len);
+int countNonZero16u(const unsigned short* src, int len);
+int countNonZero32s(const int* src, int len);
+int countNonZero32f(const float* src, int len);
+
+int normInf8u(const unsigned char* src, int len);
+int normL1_8u(const unsigned char* src, int len);
+int normL2Sqr8u(const unsigned char* src, int len);
+int normInf16s(const short* src, int len);
+int normL1_16s(const short* src, int len);
+float normInf32f(const float* src, int len);
+double normL1_32f(const float* src, int len);
+double normL2Sqr32f(const float* src, int len);
+
+int normDiffInf8u(const unsigned char* src1, const unsigned char* src2, int len);
+int normDiffL1_8u(const unsigned char* src1, const unsigned char* src2, int len);
+int normDiffL2Sqr8u(const unsigned char* src1, const unsigned char* src2, int len);
+float normDiffInf32f(const float* src1, const float* src2, int len);
+double normDiffL1_32f(const float* src1, const float* src2, int len);
+double normDiffL2Sqr32f(const float* src1, const float* src2, int len);
+
+// the same contract as minMaxIdx_() in stat.cpp for the case without a mask
+void minMaxIdx8u(const unsigned char* src, int* minVal, int* maxVal,
+                 size_t* minIdx, size_t* maxIdx, int len, size_t startIdx);
+void minMaxIdx16s(const short* src, int* minVal, int* maxVal,
+                  size_t* minIdx, size_t* maxIdx, int len, size_t startIdx);
+void minMaxIdx32f(const float* src, float* minVal, float* maxVal,
+                  size_t* minIdx, size_t* maxIdx, int len, size_t startIdx);
+
+// GEMM microkernels working on the packed panels of matmul.cpp:
+// c[i*ldc + j] (+)= sum_k a[k*GEMM_MR + i]*b[k*NR + j], i < GEMM_MR, j < NR
+enum { GEMM_MR = 6, GEMM_NR_32F = 16, GEMM_NR_64F = 8 };
+void gemmKernel32f(int kc, const float* a, const float* b, float* c, size_t ldc, bool accumulate);
+void gemmKernel64f(int kc, const double* a, const double* b, double* c, size_t ldc, bool accumulate);
+
+}}
+
+#endif
+
+#endif
@@ -0,0 +1,265 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+/*
+   AVX2 kernels for convertTo(); see avx2.hpp for the rules that apply to this file.
+
+   Eight elements at a time are converted to single precision, scaled and shifted
+   (with separate multiply and add, as in cvtScale_<T, DT, float>), rounded to the nearest
+   integer and packed with saturation, so the results match the generic code exactly.
+*/
+
+#include "avx2.hpp"
+
+#if defined CV_TRY_AVX2 && CV_TRY_AVX2
+
+#include <immintrin.h>
+
+namespace cv { namespace avx2 {
+
+namespace
+{
+
+typedef unsigned char uchar;
+typedef signed char schar;
+typedef unsigned short ushort;
+
+inline int roundf32(float v) { return _mm_cvtss_si32(_mm_set_ss(v)); }
+
+struct Load8u
+{
+    typedef uchar type;
+    __m256 operator()(const uchar* p) const
+    { return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)p))); }
+};
+
+struct Load8s
+{
+    typedef schar type;
+    __m256 operator()(const schar* p) const
+    { return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)p))); }
+};
+
+struct Load16u
+{
+    typedef ushort type;
+    __m256 operator()(const ushort* p) const
+    { return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)p))); }
+};
+
+struct Load16s
+{
+    typedef short type;
+    __m256 operator()(const short* p) const
+    { return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)p))); }
+};
+
+struct Load32s
+{
+    typedef int type;
+    __m256 operator()(const int* p) const
+    { return _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)p)); }
+};
+
+struct Load32f
+{
+    typedef float type;
+    __m256 operator()(const float* p) const { return _mm256_loadu_ps(p); }
+};
+
+// the rounded values packed to 16 bits with signed saturation
+inline __m128i packs16(const __m256& v)
+{
+    __m256i i = _mm256_cvtps_epi32(v);
+    return _mm_packs_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1));
+}
+
+struct Store8u
+{
+    typedef uchar type;
+    void operator()(uchar* p, const __m256& v) const
+    {
+        __m128i w = packs16(v);
+        _mm_storel_epi64((__m128i*)p, _mm_packus_epi16(w, w));
+    }
+    static uchar cast(float v) { int i = roundf32(v); return (uchar)(i < 0 ? 0 : i > 255 ? 255 : i); }
+};
+
+struct Store8s
+{
+    typedef schar type;
+    void operator()(schar* p, const __m256& v) const
+    {
+        __m128i w = packs16(v);
+        _mm_storel_epi64((__m128i*)p, _mm_packs_epi16(w, w));
+    }
+    static schar cast(float v) { int i = roundf32(v); return (schar)(i < -128 ? -128 : i > 127 ? 127 : i); }
+};
+
+struct Store16u
+{
+    typedef ushort type;
+    void operator()(ushort* p, const __m256& v) const
+    {
+        __m256i i = _mm256_cvtps_epi32(v);
+        _mm_storeu_si128((__m128i*)p, _mm_packus_epi32(_mm256_castsi256_si128(i),
+                                                       _mm256_extracti128_si256(i, 1)));
+    }
+    static ushort cast(float v) { int i = roundf32(v); return (ushort)(i < 0 ? 0 : i > 65535 ? 65535 : i); }
+};
+
+struct Store16s
+{
+    typedef short type;
+    void operator()(short* p, const __m256& v) const { _mm_storeu_si128((__m128i*)p, packs16(v)); }
+    static short cast(float v) { int i = roundf32(v); return (short)(i < -32768 ? -32768 : i > 32767 ? 32767 : i); }
+};
+
+struct Store32s
+{
+    typedef int type;
+    void operator()(int* p, const __m256& v) const { _mm256_storeu_si256((__m256i*)p, _mm256_cvtps_epi32(v)); }
+    static int cast(float v) { return roundf32(v); }
+};
+
+struct Store32f
+{
+    typedef float type;
+    void operator()(float* p, const __m256& v) const { _mm256_storeu_ps(p, v); }
+    static float cast(float v) { return v; }
+};
+
+template<class Load, class Store, bool scaled> void
+cvtRows(const uchar* src, size_t sstep, uchar* dst, size_t dstep,
+        int width, int height, float alpha, float beta)
+{
+    typedef typename Load::type T;
+    typedef typename Store::type DT;
+    Load load;
+    Store store;
+    __m256 valpha = _mm256_set1_ps(alpha), vbeta = _mm256_set1_ps(beta);
+
+    for( ; height--; src += sstep, dst += dstep )
+    {
+        const T* s = (const T*)src;
+        DT* d = (DT*)dst;
+        int x = 0;
+
+        for( ; x <= width - 16; x += 16 )
+        {
+            __m256 v0 = load(s + x), v1 = load(s + x + 8);
+            if( scaled )
+            {
+                v0 = _mm256_add_ps(_mm256_mul_ps(v0, valpha), vbeta);
+                v1 = _mm256_add_ps(_mm256_mul_ps(v1, valpha), vbeta);
+            }
+            store(d + x, v0);
+            store(d + x + 8, v1);
+        }
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m256 v = load(s + x);
+            if( scaled )
+                v = _mm256_add_ps(_mm256_mul_ps(v, valpha), vbeta);
+            store(d + x, v);
+        }
+        for( ; x < width; x++ )
+        {
+            float v = (float)s[x];
+            if( scaled )
+                v = v*alpha + beta;
+            d[x] = Store::cast(v);
+        }
+    }
+}
+
+#define CV_AVX2_CVT_ROW(load, store) \
+    cvtRows<Load##load, Store##store, true>, cvtRows<Load##load, Store##store, false>
+
+// [ddepth][sdepth][unscaled]; the combinations that convertTo() scales in double precision
+// (32s -> 32s, 32s -> 32f and everything involving 64f) are left out
+static const CvtScaleFunc cvtTab[][7][2] =
+{
+    {
+        { CV_AVX2_CVT_ROW(8u, 8u) }, { CV_AVX2_CVT_ROW(8s, 8u) }, { CV_AVX2_CVT_ROW(16u, 8u) },
+        { CV_AVX2_CVT_ROW(16s, 8u) }, { CV_AVX2_CVT_ROW(32s, 8u) }, { CV_AVX2_CVT_ROW(32f, 8u) }, { 0, 0 }
+    },
+    {
+        { CV_AVX2_CVT_ROW(8u, 8s) }, { CV_AVX2_CVT_ROW(8s, 8s) }, { CV_AVX2_CVT_ROW(16u, 8s) },
+        { CV_AVX2_CVT_ROW(16s, 8s) }, { CV_AVX2_CVT_ROW(32s, 8s) }, { CV_AVX2_CVT_ROW(32f, 8s) }, { 0, 0 }
+    },
+    {
+        { CV_AVX2_CVT_ROW(8u, 16u) }, { CV_AVX2_CVT_ROW(8s, 16u) }, { CV_AVX2_CVT_ROW(16u, 16u) },
+        { CV_AVX2_CVT_ROW(16s, 16u) }, { CV_AVX2_CVT_ROW(32s, 16u) }, { CV_AVX2_CVT_ROW(32f, 16u) }, { 0, 0 }
+    },
+    {
+        { CV_AVX2_CVT_ROW(8u, 16s) }, { CV_AVX2_CVT_ROW(8s, 16s) }, { CV_AVX2_CVT_ROW(16u, 16s) },
+        { CV_AVX2_CVT_ROW(16s, 16s) }, { CV_AVX2_CVT_ROW(32s, 16s) }, { CV_AVX2_CVT_ROW(32f, 16s) }, { 0, 0 }
+    },
+    {
+        { CV_AVX2_CVT_ROW(8u, 32s) }, { CV_AVX2_CVT_ROW(8s, 32s) }, { CV_AVX2_CVT_ROW(16u, 32s) },
+        { CV_AVX2_CVT_ROW(16s, 32s) }, { 0, 0 }, { CV_AVX2_CVT_ROW(32f, 32s) }, { 0, 0 }
+    },
+    {
+        { CV_AVX2_CVT_ROW(8u, 32f) }, { CV_AVX2_CVT_ROW(8s, 32f) }, { CV_AVX2_CVT_ROW(16u, 32f) },
+        { CV_AVX2_CVT_ROW(16s, 32f) }, { 0, cvtRows<Load32s, Store32f, false> }, { CV_AVX2_CVT_ROW(32f, 32f) }, { 0, 0 }
+    }
+};
+
+#undef CV_AVX2_CVT_ROW
+
+}
+
+CvtScaleFunc getCvtScaleFunc(int sdepth, int ddepth)
+{
+    return sdepth < 7 && ddepth < 6 ? cvtTab[ddepth][sdepth][0] : 0;
+}
+
+CvtScaleFunc getCvtFunc(int sdepth, int ddepth)
+{
+    return sdepth < 7 && ddepth < 6 && sdepth != ddepth ? cvtTab[ddepth][sdepth][1] : 0;
+}
+
+}}
+
+#endif
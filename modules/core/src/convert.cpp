@@ -41,6 +41,7 @@
 //M*/
 
 #include "precomp.hpp"
+#include "avx2.hpp"
 
 namespace cv
 {
@@ -784,6 +785,26 @@ cpy_( const T* src, size_t sstep, T* dst, size_t dstep, Size size )
         memcpy(dst, src, size.width*sizeof(src[0]));
 }
 
+// dst = saturate(src*alpha + beta) for the given depths, 0 when there is no such kernel
+typedef void (*CvtScaleKernelFunc)(const uchar* src, size_t sstep, uchar* dst, size_t dstep,
+                                   int width, int height, float alpha, float beta);
+typedef CvtScaleKernelFunc (*GetCvtScaleKernelFunc)(int sdepth, int ddepth);
+
+static DispatchedKernel<GetCvtScaleKernelFunc> cvtScaleKernel("convertScale", CV_AVX2_VARIANT(getCvtScaleFunc));
+static DispatchedKernel<GetCvtScaleKernelFunc> cvtKernel("convert", CV_AVX2_VARIANT(getCvtFunc));
+
+template<typename T, typename DT> static inline bool
+cvtDispatched( const T* src, size_t sstep, DT* dst, size_t dstep, Size size, const double* scale )
+{
+    GetCvtScaleKernelFunc getFunc = scale ? cvtScaleKernel.get() : cvtKernel.get();
+    CvtScaleKernelFunc func = getFunc ? getFunc(DataType<T>::depth, DataType<DT>::depth) : 0;
+    if( !func )
+        return false;
+    func((const uchar*)src, sstep, (uchar*)dst, dstep, size.width, size.height,
+         scale ? (float)scale[0] : 1.f, scale ? (float)scale[1] : 0.f);
+    return true;
+}
+
 #define DEF_CVT_SCALE_ABS_FUNC(suffix, tfunc, stype, dtype, wtype) \
 static void cvtScaleAbs##suffix( const stype* src, size_t sstep, const uchar*, size_t, \
                          dtype* dst, size_t dstep, Size size, double* scale) \
@@ -795,7 +816,8 @@ static void cvtScaleAbs##suffix( const stype* src, size_t sstep, const uchar*, s
 static void cvtScale##suffix( const stype* src, size_t sstep, const uchar*, size_t, \
 dtype* dst, size_t dstep, Size size, double* scale) \
 { \
-    cvtScale_(src, sstep, dst, dstep, size, (wtype)scale[0], (wtype)scale[1]); \
+    if( !cvtDispatched(src, sstep, dst, dstep, size, scale) ) \
+        cvtScale_(src, sstep, dst, dstep, size, (wtype)scale[0], (wtype)scale[1]); \
 }
 
 
@@ -803,7 +825,8 @@ dtype* dst, size_t dstep, Size size, double* scale) \
 static void cvt##suffix( const stype* src, size_t sstep, const uchar*, size_t, \
                          dtype* dst, size_t dstep, Size size, double*) \
 { \
-    cvt_(src, sstep, dst, dstep, size); \
+    if( !cvtDispatched(src, sstep, dst, dstep, size, 0) ) \
+        cvt_(src, sstep, dst, dstep, size); \
 }
 
 #define DEF_CPY_FUNC(suffix, stype) \
@@ -78,30 +78,64 @@ copyMask_(const uchar* _src, size_t sstep, const uchar* mask, size_t mstep, ucha
     }
 }
 
+#if CV_SSE4_2
+#  define COPY_MASK_SSE4_2_VARIANT(func) CV_CPU_SSE4_2, func
+#else
+#  define COPY_MASK_SSE4_2_VARIANT(func) CV_CPU_NONE, 0
+#endif
+
+#if CV_SSE4_2
+// copy the masked elements of the row prefix and return its length
+static int copyMaskRow8u_SSE4_2(const uchar* src, const uchar* mask, uchar* dst, int width)
+{
+    __m128i zero = _mm_setzero_si128 ();
+    int x = 0;
+
+    for( ; x <= width - 16; x += 16 )
+    {
+        const __m128i rSrc = _mm_lddqu_si128((const __m128i*)(src+x));
+        __m128i _mask = _mm_lddqu_si128((const __m128i*)(mask+x));
+        __m128i rDst = _mm_lddqu_si128((__m128i*)(dst+x));
+        __m128i _negMask = _mm_cmpeq_epi8(_mask, zero);
+        rDst = _mm_blendv_epi8(rSrc, rDst, _negMask);
+        _mm_storeu_si128((__m128i*)(dst + x), rDst);
+    }
+    return x;
+}
+
+static int copyMaskRow16u_SSE4_2(const ushort* src, const uchar* mask, ushort* dst, int width)
+{
+    __m128i zero = _mm_setzero_si128 ();
+    int x = 0;
+
+    for( ; x <= width - 8; x += 8 )
+    {
+        const __m128i rSrc =_mm_lddqu_si128((const __m128i*)(src+x));
+        __m128i _mask = _mm_loadl_epi64((const __m128i*)(mask+x));
+        _mask = _mm_unpacklo_epi8(_mask, _mask);
+        __m128i rDst = _mm_lddqu_si128((const __m128i*)(dst+x));
+        __m128i _negMask = _mm_cmpeq_epi8(_mask, zero);
+        rDst = _mm_blendv_epi8(rSrc, rDst, _negMask);
+        _mm_storeu_si128((__m128i*)(dst + x), rDst);
+    }
+    return x;
+}
+#endif
+
+static DispatchedKernel<int (*)(const uchar*, const uchar*, uchar*, int)>
+    copyMask8uKernel("copyMask8u", COPY_MASK_SSE4_2_VARIANT(copyMaskRow8u_SSE4_2));
+static DispatchedKernel<int (*)(const ushort*, const uchar*, ushort*, int)>
+    copyMask16uKernel("copyMask16u", COPY_MASK_SSE4_2_VARIANT(copyMaskRow16u_SSE4_2));
+
 template<> void
 copyMask_<uchar>(const uchar* _src, size_t sstep, const uchar* mask, size_t mstep, uchar* _dst, size_t dstep, Size size)
 {
+    int (*vecRow)(const uchar*, const uchar*, uchar*, int) = copyMask8uKernel.get();
     for( ; size.height--; mask += mstep, _src += sstep, _dst += dstep )
     {
         const uchar* src = (const uchar*)_src;
         uchar* dst = (uchar*)_dst;
-        int x = 0;
-        #if CV_SSE4_2
-        if(USE_SSE4_2)//
-        {
-            __m128i zero = _mm_setzero_si128 ();
-
-             for( ; x <= size.width - 16; x += 16 )
-             {
-                 const __m128i rSrc = _mm_lddqu_si128((const __m128i*)(src+x));
-                 __m128i _mask = _mm_lddqu_si128((const __m128i*)(mask+x));
-                 __m128i rDst = _mm_lddqu_si128((__m128i*)(dst+x));
-                 __m128i _negMask = _mm_cmpeq_epi8(_mask, zero);
-                 rDst = _mm_blendv_epi8(rSrc, rDst, _negMask);
-                 _mm_storeu_si128((__m128i*)(dst + x), rDst);
-             }
-        }
-        #endif
+        int x = vecRow ? vecRow(src, mask, dst, size.width) : 0;
         for( ; x < size.width; x++ )
             if( mask[x] )
                 dst[x] = src[x];
@@ -111,27 +145,12 @@ copyMask_<uchar>(const uchar* _src, size_t sstep, const uchar* mask, size_t mste
 template<> void
 copyMask_<ushort>(const uchar* _src, size_t sstep, const uchar* mask, size_t mstep, uchar* _dst, size_t dstep, Size size)
 {
+    int (*vecRow)(const ushort*, const uchar*, ushort*, int) = copyMask16uKernel.get();
     for( ; size.height--; mask += mstep, _src += sstep, _dst += dstep )
     {
         const ushort* src = (const ushort*)_src;
         ushort* dst = (ushort*)_dst;
-        int x = 0;
-        #if CV_SSE4_2
-        if(USE_SSE4_2)//
-        {
-            __m128i zero = _mm_setzero_si128 ();
-            for( ; x <= size.width - 8; x += 8 )
-            {
-                 const __m128i rSrc =_mm_lddqu_si128((const __m128i*)(src+x));
-                 __m128i _mask = _mm_loadl_epi64((const __m128i*)(mask+x));
-                 _mask = _mm_unpacklo_epi8(_mask, _mask);
-                 __m128i rDst = _mm_lddqu_si128((const __m128i*)(dst+x));
-                 __m128i _negMask = _mm_cmpeq_epi8(_mask, zero);
-                 rDst = _mm_blendv_epi8(rSrc, rDst, _negMask);
-                 _mm_storeu_si128((__m128i*)(dst + x), rDst);
-             }
-        }
-        #endif
+        int x = vecRow ? vecRow(src, mask, dst, size.width) : 0;
         for( ; x < size.width; x++ )
             if( mask[x] )
                 dst[x] = src[x];
@@ -979,7 +979,10 @@ RealDFT( const T* src, T* dst, int n, int nf, int* factors, const int* itab,
 
     if( n == 1 )
     {
+        dst -= complex_output;
         dst[0] = src[0]*scale;
+        if( complex_output )
+            dst[1] = 0;
     }
     else if( n == 2 )
     {
@@ -1456,51 +1459,362 @@ static void CCSIDFT_64f( const double* src, double* dst, int n, int nf, int* fac
     CCSIDFT( src, dst, n, nf, factors, itab, wave, tab_size, spec, buf, flags, scale);
 }
 
-}
 
+/****************************************************************************************\
+                                          DFT plan
+\****************************************************************************************/
 
-void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
+// the tables of the 1D transforms of one length
+struct DFTStage
 {
-    static DFTFunc dft_tbl[6] =
-    {
-        (DFTFunc)DFT_32f,
-        (DFTFunc)RealDFT_32f,
-        (DFTFunc)CCSIDFT_32f,
-        (DFTFunc)DFT_64f,
-        (DFTFunc)RealDFT_64f,
-        (DFTFunc)CCSIDFT_64f
-    };
+    DFTStage() : len(0), nf(0), inplace(false), bufSize(0), spec(0), specReal(false), depth(CV_32F) {}
+    ~DFTStage();
 
-    AutoBuffer<uchar> buf;
-    void *spec = 0;
+    void init( int _len, int _depth, bool invItab, bool useIpp, bool ippReal, int ippNormFlag );
 
-    Mat src0 = _src0.getMat(), src = src0;
-    int prev_len = 0, stage = 0;
-    bool inv = (flags & DFT_INVERSE) != 0;
-    int nf = 0, real_transform = src.channels() == 1 || (inv && (flags & DFT_REAL_OUTPUT)!=0);
-    int type = src.type(), depth = src.depth();
-    int elem_size = (int)src.elemSize1(), complex_elem_size = elem_size*2;
+    int len, nf;
     int factors[34];
-    bool inplace_transform = false;
+    bool inplace;
+    std::vector<int> itab;
+    Mat wave;
+    // the scratch memory (in bytes) needed by one call of a DFTFunc
+    int bufSize;
+    void* spec;
+    bool specReal;
+    int depth;
+
+private:
+    DFTStage(const DFTStage&);
+    DFTStage& operator = (const DFTStage&);
+};
+
+void DFTStage::init( int _len, int _depth, bool invItab, bool useIpp, bool ippReal, int ippNormFlag )
+{
+    int complex_elem_size = CV_ELEM_SIZE(CV_MAKETYPE(_depth, 2));
+    int i;
+
+    len = _len;
+    depth = _depth;
+    nf = DFTFactorize( len, factors );
+    inplace = factors[0] == factors[nf-1];
+
+    bufSize = 0;
+    i = nf > 1 && (factors[0] & 1) == 0;
+    if( (factors[i] & 1) != 0 && factors[i] > 5 )
+        bufSize = (factors[i]+1)*complex_elem_size;
+
+    itab.resize(len);
+    wave.create(1, len, CV_MAKETYPE(depth, 2));
+    DFTInit( len, nf, factors, &itab[0], complex_elem_size, wave.data, invItab );
+
 #ifdef HAVE_IPP
-    void *spec_r = 0, *spec_c = 0;
-    int ipp_norm_flag = !(flags & DFT_SCALE) ? 8 : inv ? 2 : 1;
+    if( useIpp )
+    {
+        int ipp_sz = 0;
+        specReal = ippReal;
+        if( ippReal )
+        {
+            if( depth == CV_32F )
+            {
+                IPPI_CALL( ippsDFTInitAlloc_R_32f(
+                    (IppsDFTSpec_R_32f**)&spec, len, ippNormFlag, ippAlgHintNone ));
+                IPPI_CALL( ippsDFTGetBufSize_R_32f( (IppsDFTSpec_R_32f*)spec, &ipp_sz ));
+            }
+            else
+            {
+                IPPI_CALL( ippsDFTInitAlloc_R_64f(
+                    (IppsDFTSpec_R_64f**)&spec, len, ippNormFlag, ippAlgHintNone ));
+                IPPI_CALL( ippsDFTGetBufSize_R_64f( (IppsDFTSpec_R_64f*)spec, &ipp_sz ));
+            }
+        }
+        else
+        {
+            if( depth == CV_32F )
+            {
+                IPPI_CALL( ippsDFTInitAlloc_C_32fc(
+                    (IppsDFTSpec_C_32fc**)&spec, len, ippNormFlag, ippAlgHintNone ));
+                IPPI_CALL( ippsDFTGetBufSize_C_32fc( (IppsDFTSpec_C_32fc*)spec, &ipp_sz ));
+            }
+            else
+            {
+                IPPI_CALL( ippsDFTInitAlloc_C_64fc(
+                    (IppsDFTSpec_C_64fc**)&spec, len, ippNormFlag, ippAlgHintNone ));
+                IPPI_CALL( ippsDFTGetBufSize_C_64fc( (IppsDFTSpec_C_64fc*)spec, &ipp_sz ));
+            }
+        }
+        bufSize += ipp_sz;
+    }
+#else
+    (void)useIpp; (void)ippReal; (void)ippNormFlag;
 #endif
+}
+
+DFTStage::~DFTStage()
+{
+#ifdef HAVE_IPP
+    if( spec )
+    {
+        if( specReal )
+        {
+            if( depth == CV_32F )
+                ippsDFTFree_R_32f( (IppsDFTSpec_R_32f*)spec );
+            else
+                ippsDFTFree_R_64f( (IppsDFTSpec_R_64f*)spec );
+        }
+        else
+        {
+            if( depth == CV_32F )
+                ippsDFTFree_C_32fc( (IppsDFTSpec_C_32fc*)spec );
+            else
+                ippsDFTFree_C_64fc( (IppsDFTSpec_C_64fc*)spec );
+        }
+    }
+#endif
+}
+
+// the number of stripes for count transforms of length len; a stripe should do enough work
+// to pay for the thread synchronization
+static inline double getDFTStripes( int count, int len )
+{
+    return (double)count*len/(1 << 13);
+}
+
+// fills the second half of the complex spectrum of a real 1D sequence of length n
+template<typename T> static void
+completeDFTRow( T* p, int n )
+{
+    for( int j = 1; j < (n+1)/2; j++ )
+    {
+        p[(n-j)*2] = p[j*2];
+        p[(n-j)*2+1] = -p[j*2+1];
+    }
+}
+
+// transforms each row separately
+class DFTRowsInvoker : public ParallelLoopBody
+{
+public:
+    DFTRowsInvoker( const Mat& _src, Mat& _dst, const DFTStage& _tab, DFTFunc _func, int _flags,
+                    double _scale, bool _use_buf, int _dptr_offset, int _dst_full_len, int _complex_elem_size,
+                    bool _complete )
+        : src(&_src), dst(&_dst), tab(&_tab), func(_func), flags(_flags), scale(_scale), use_buf(_use_buf),
+          dptr_offset(_dptr_offset), dst_full_len(_dst_full_len), complex_elem_size(_complex_elem_size),
+          complete(_complete)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int len = tab->len;
+        AutoBuffer<uchar> _buf(len*complex_elem_size + tab->bufSize + 32);
+        uchar* ptr = alignPtr((uchar*)_buf, 16);
+        uchar* tmp_buf = 0;
+
+        if( use_buf )
+        {
+            tmp_buf = ptr;
+            ptr += len*complex_elem_size;
+        }
+
+        // the real transforms modify the factors temporarily, so each thread needs its own copy
+        int factors[34];
+        memcpy( factors, tab->factors, sizeof(factors) );
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            const uchar* sptr = src->data + i*src->step;
+            uchar* dptr0 = dst->data + i*dst->step;
+            uchar* dptr = tmp_buf ? tmp_buf : dptr0;
+
+            func( sptr, dptr, len, tab->nf, factors, &tab->itab[0], tab->wave.data,
+                  len, tab->spec, ptr, flags, scale );
+            if( dptr != dptr0 )
+                memcpy( dptr0, dptr + dptr_offset, dst_full_len );
+            if( complete )
+            {
+                if( tab->depth == CV_32F )
+                    completeDFTRow( (float*)dptr0, len );
+                else
+                    completeDFTRow( (double*)dptr0, len );
+            }
+        }
+    }
 
+private:
+    const Mat* src;
+    Mat* dst;
+    const DFTStage* tab;
+    DFTFunc func;
+    int flags;
+    double scale;
+    bool use_buf;
+    int dptr_offset, dst_full_len, complex_elem_size;
+    bool complete;
+};
+
+// the buffers for the column-wise transforms: buf0/buf1 take two source columns,
+// dbuf0/dbuf1 receive the results; returns the scratch memory left for the DFTFunc
+static uchar* getDFTColumnBuffers( uchar* ptr, int len, int complex_elem_size, bool use_buf,
+                                   uchar*& buf0, uchar*& buf1, uchar*& dbuf0, uchar*& dbuf1 )
+{
+    buf0 = ptr;
+    ptr += len*complex_elem_size;
+    buf1 = ptr;
+    ptr += len*complex_elem_size;
+    dbuf0 = buf0, dbuf1 = buf1;
+
+    if( use_buf )
+    {
+        dbuf1 = ptr;
+        dbuf0 = buf1;
+        ptr += len*complex_elem_size;
+    }
+    return ptr;
+}
+
+// transforms the complex columns [a, b) in pairs; sptr0 and dptr0 point to the column a
+class DFTColumnsInvoker : public ParallelLoopBody
+{
+public:
+    DFTColumnsInvoker( const uchar* _sptr0, size_t _sstep, uchar* _dptr0, size_t _dstep, int _a, int _b,
+                       const DFTStage& _tab, DFTFunc _func, int _inv, double _scale, bool _use_buf,
+                       int _complex_elem_size )
+        : sptr0(_sptr0), sstep(_sstep), dptr0(_dptr0), dstep(_dstep), a(_a), b(_b), tab(&_tab),
+          func(_func), inv(_inv), scale(_scale), use_buf(_use_buf), complex_elem_size(_complex_elem_size)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int len = tab->len;
+        AutoBuffer<uchar> _buf(3*len*complex_elem_size + tab->bufSize + 32);
+        uchar *buf0, *buf1, *dbuf0, *dbuf1;
+        uchar* ptr = getDFTColumnBuffers( alignPtr((uchar*)_buf, 16), len, complex_elem_size,
+                                          use_buf, buf0, buf1, dbuf0, dbuf1 );
+        int nf = tab->nf, factors[34];
+        memcpy( factors, tab->factors, sizeof(factors) );
+        const int* itab = &tab->itab[0];
+        const uchar* wave = tab->wave.data;
+
+        for( int p = range.start; p < range.end; p++ )
+        {
+            int i = a + p*2;
+            const uchar* sptr = sptr0 + p*2*complex_elem_size;
+            uchar* dptr = dptr0 + p*2*complex_elem_size;
+
+            if( i+1 < b )
+            {
+                CopyFrom2Columns( sptr, sstep, buf0, buf1, len, complex_elem_size );
+                func( buf1, dbuf1, len, nf, factors, itab, wave, len, tab->spec, ptr, inv, scale );
+            }
+            else
+                CopyColumn( sptr, sstep, buf0, complex_elem_size, len, complex_elem_size );
+
+            func( buf0, dbuf0, len, nf, factors, itab, wave, len, tab->spec, ptr, inv, scale );
+
+            if( i+1 < b )
+                CopyTo2Columns( dbuf0, dbuf1, dptr, dstep, len, complex_elem_size );
+            else
+                CopyColumn( dbuf0, complex_elem_size, dptr, dstep, len, complex_elem_size );
+        }
+    }
+
+private:
+    const uchar* sptr0;
+    size_t sstep;
+    uchar* dptr0;
+    size_t dstep;
+    int a, b;
+    const DFTStage* tab;
+    DFTFunc func;
+    int inv;
+    double scale;
+    bool use_buf;
+    int complex_elem_size;
+};
+
+// fills the second half of the complex spectrum of a real 2D matrix from the first one
+template<typename T> static void
+completeDFTSpectrum( Mat& dst, int len )
+{
+    T* p0 = (T*)dst.data;
+    size_t dstep = dst.step/sizeof(p0[0]);
+    int n = dst.cols;
+
+    for( int i = 0; i < len; i++ )
+    {
+        T* p = p0 + dstep*i;
+        T* q = i == 0 || i*2 == len ? p : p0 + dstep*(len-i);
+
+        for( int j = 1; j < (n+1)/2; j++ )
+        {
+            p[(n-j)*2] = q[j*2];
+            p[(n-j)*2+1] = -q[j*2+1];
+        }
+    }
+}
+
+class DFTPlan::Impl
+{
+public:
+    Impl( Size _size, int _type, int _flags );
+    void apply( const Mat& src0, Mat& dst, int nonzero_rows ) const;
+
+    Size size;
+    int type, flags, dstType;
+    int depth, elem_size, complex_elem_size;
+    bool inv, real_transform;
+    DFTStage rowStage, colStage;
+};
+
+DFTPlan::Impl::Impl( Size _size, int _type, int _flags ) : size(_size), type(_type), flags(_flags)
+{
     CV_Assert( type == CV_32FC1 || type == CV_32FC2 || type == CV_64FC1 || type == CV_64FC2 );
+    CV_Assert( size.width > 0 && size.height > 0 );
 
-    if( !inv && src.channels() == 1 && (flags & DFT_COMPLEX_OUTPUT) )
-        _dst.create( src.size(), CV_MAKETYPE(depth, 2) );
-    else if( inv && src.channels() == 2 && (flags & DFT_REAL_OUTPUT) )
-        _dst.create( src.size(), depth );
-    else
-        _dst.create( src.size(), type );
+    int cn = CV_MAT_CN(type);
+    depth = CV_MAT_DEPTH(type);
+    inv = (flags & DFT_INVERSE) != 0;
+    real_transform = cn == 1 || (inv && (flags & DFT_REAL_OUTPUT) != 0);
 
-    Mat dst = _dst.getMat();
+    if( !inv && cn == 1 && (flags & DFT_COMPLEX_OUTPUT) )
+        dstType = CV_MAKETYPE(depth, 2);
+    else if( inv && cn == 2 && (flags & DFT_REAL_OUTPUT) )
+        dstType = depth;
+    else
+        dstType = type;
 
+    elem_size = CV_ELEM_SIZE1(type);
+    complex_elem_size = elem_size*2;
     if( !real_transform )
         elem_size = complex_elem_size;
 
+    // a single column is transformed as a row, unless it is not continuous
+    int len = size.width, count = size.height;
+    int ipp_norm_flag = !(flags & DFT_SCALE) ? 8 : inv ? 2 : 1;
+    if( len == 1 && !(flags & DFT_ROWS) )
+        len = size.height, count = 1;
+
+    rowStage.init( len, depth, inv && real_transform, len*count >= 64, real_transform, ipp_norm_flag );
+    if( !(flags & DFT_ROWS) && size.height > 1 )
+        colStage.init( size.height, depth, false, size.height*size.width >= 64, false, ipp_norm_flag );
+}
+
+void DFTPlan::Impl::apply( const Mat& src0, Mat& dst, int nonzero_rows ) const
+{
+    static DFTFunc dft_tbl[6] =
+    {
+        (DFTFunc)DFT_32f,
+        (DFTFunc)RealDFT_32f,
+        (DFTFunc)CCSIDFT_32f,
+        (DFTFunc)DFT_64f,
+        (DFTFunc)RealDFT_64f,
+        (DFTFunc)CCSIDFT_64f
+    };
+
+    Mat src = src0;
+    int stage = 0;
+
     if( src.cols == 1 && nonzero_rows > 0 )
         CV_Error( CV_StsNotImplemented,
         "This mode (using nonzero_rows with a single-column matrix) breaks the function's logic, so it is prohibited.\n"
@@ -1516,15 +1830,11 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
     for(;;)
     {
         double scale = 1;
-        uchar* wave = 0;
-        int* itab = 0;
-        uchar* ptr;
-        int i, len, count, sz = 0;
-        int use_buf = 0, odd_real = 0;
-        DFTFunc dft_func;
+        int i, len, count;
 
         if( stage == 0 ) // row-wise transform
         {
+            const DFTStage& tab = rowStage;
             len = !inv ? src.cols : dst.cols;
             count = src.rows;
             if( len == 1 && !(flags & DFT_ROWS) )
@@ -1532,124 +1842,22 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
                 len = !inv ? src.rows : dst.rows;
                 count = 1;
             }
-            odd_real = real_transform && (len & 1);
-        }
-        else
-        {
-            len = dst.rows;
-            count = !inv ? src0.cols : dst.cols;
-            sz = 2*len*complex_elem_size;
-        }
-
-        spec = 0;
-#ifdef HAVE_IPP
-        if( len*count >= 64 ) // use IPP DFT if available
-        {
-            int ipp_sz = 0;
-
-            if( real_transform && stage == 0 )
-            {
-                if( depth == CV_32F )
-                {
-                    if( spec_r )
-                        IPPI_CALL( ippsDFTFree_R_32f( (IppsDFTSpec_R_32f*)spec_r ));
-                    IPPI_CALL( ippsDFTInitAlloc_R_32f(
-                        (IppsDFTSpec_R_32f**)&spec_r, len, ipp_norm_flag, ippAlgHintNone ));
-                    IPPI_CALL( ippsDFTGetBufSize_R_32f( (IppsDFTSpec_R_32f*)spec_r, &ipp_sz ));
-                }
-                else
-                {
-                    if( spec_r )
-                        IPPI_CALL( ippsDFTFree_R_64f( (IppsDFTSpec_R_64f*)spec_r ));
-                    IPPI_CALL( ippsDFTInitAlloc_R_64f(
-                        (IppsDFTSpec_R_64f**)&spec_r, len, ipp_norm_flag, ippAlgHintNone ));
-                    IPPI_CALL( ippsDFTGetBufSize_R_64f( (IppsDFTSpec_R_64f*)spec_r, &ipp_sz ));
-                }
-                spec = spec_r;
-            }
-            else
-            {
-                if( depth == CV_32F )
-                {
-                    if( spec_c )
-                        IPPI_CALL( ippsDFTFree_C_32fc( (IppsDFTSpec_C_32fc*)spec_c ));
-                    IPPI_CALL( ippsDFTInitAlloc_C_32fc(
-                        (IppsDFTSpec_C_32fc**)&spec_c, len, ipp_norm_flag, ippAlgHintNone ));
-                    IPPI_CALL( ippsDFTGetBufSize_C_32fc( (IppsDFTSpec_C_32fc*)spec_c, &ipp_sz ));
-                }
-                else
-                {
-                    if( spec_c )
-                        IPPI_CALL( ippsDFTFree_C_64fc( (IppsDFTSpec_C_64fc*)spec_c ));
-                    IPPI_CALL( ippsDFTInitAlloc_C_64fc(
-                        (IppsDFTSpec_C_64fc**)&spec_c, len, ipp_norm_flag, ippAlgHintNone ));
-                    IPPI_CALL( ippsDFTGetBufSize_C_64fc( (IppsDFTSpec_C_64fc*)spec_c, &ipp_sz ));
-                }
-                spec = spec_c;
-            }
+            CV_Assert( len == tab.len );
 
-            sz += ipp_sz;
-        }
-        else
-#endif
-        {
-            if( len != prev_len )
-                nf = DFTFactorize( len, factors );
-
-            inplace_transform = factors[0] == factors[nf-1];
-            sz += len*(complex_elem_size + sizeof(int));
-            i = nf > 1 && (factors[0] & 1) == 0;
-            if( (factors[i] & 1) != 0 && factors[i] > 5 )
-                sz += (factors[i]+1)*complex_elem_size;
-
-            if( (stage == 0 && ((src.data == dst.data && !inplace_transform) || odd_real)) ||
-                (stage == 1 && !inplace_transform) )
-            {
-                use_buf = 1;
-                sz += len*complex_elem_size;
-            }
-        }
-
-        ptr = (uchar*)buf;
-        buf.allocate( sz + 32 );
-        if( ptr != (uchar*)buf )
-            prev_len = 0; // because we release the buffer,
-                          // force recalculation of
-                          // twiddle factors and permutation table
-        ptr = (uchar*)buf;
-        if( !spec )
-        {
-            wave = ptr;
-            ptr += len*complex_elem_size;
-            itab = (int*)ptr;
-            ptr = (uchar*)cvAlignPtr( ptr + len*sizeof(int), 16 );
-
-            if( len != prev_len || (!inplace_transform && inv && real_transform))
-                DFTInit( len, nf, factors, itab, complex_elem_size,
-                            wave, stage == 0 && inv && real_transform );
-            // otherwise reuse the tables calculated on the previous stage
-        }
-
-        if( stage == 0 )
-        {
-            uchar* tmp_buf = 0;
+            int odd_real = real_transform && (len & 1);
+            bool use_buf = (src.data == dst.data && !tab.inplace) || odd_real;
             int dptr_offset = 0;
             int dst_full_len = len*elem_size;
             int _flags = (int)inv + (src.channels() != dst.channels() ?
                          DFT_COMPLEX_INPUT_OR_OUTPUT : 0);
-            if( use_buf )
-            {
-                tmp_buf = ptr;
-                ptr += len*complex_elem_size;
-                if( odd_real && !inv && len > 1 &&
-                    !(_flags & DFT_COMPLEX_INPUT_OR_OUTPUT))
-                    dptr_offset = elem_size;
-            }
+            if( use_buf && odd_real && !inv && len > 1 &&
+                !(_flags & DFT_COMPLEX_INPUT_OR_OUTPUT) )
+                dptr_offset = elem_size;
 
             if( !inv && (_flags & DFT_COMPLEX_INPUT_OR_OUTPUT) )
                 dst_full_len += (len & 1) ? elem_size : complex_elem_size;
 
-            dft_func = dft_tbl[(!real_transform ? 0 : !inv ? 1 : 2) + (depth == CV_64F)*3];
+            DFTFunc dft_func = dft_tbl[(!real_transform ? 0 : !inv ? 1 : 2) + (depth == CV_64F)*3];
 
             if( count > 1 && !(flags & DFT_ROWS) && (!inv || !real_transform) )
                 stage = 1;
@@ -1659,24 +1867,18 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
             if( nonzero_rows <= 0 || nonzero_rows > count )
                 nonzero_rows = count;
 
-            for( i = 0; i < nonzero_rows; i++ )
-            {
-                uchar* sptr = src.data + i*src.step;
-                uchar* dptr0 = dst.data + i*dst.step;
-                uchar* dptr = dptr0;
-
-                if( tmp_buf )
-                    dptr = tmp_buf;
+            // the rows that are not transformed by columns after this get the full complex spectrum here
+            bool complete = !inv && (_flags & DFT_COMPLEX_INPUT_OR_OUTPUT) && stage != 1 && len > 2;
 
-                dft_func( sptr, dptr, len, nf, factors, itab, wave, len, spec, ptr, _flags, scale );
-                if( dptr != dptr0 )
-                    memcpy( dptr0, dptr + dptr_offset, dst_full_len );
-            }
+            parallel_for_(Range(0, nonzero_rows),
+                          DFTRowsInvoker(src, dst, tab, dft_func, _flags, scale, use_buf,
+                                         dptr_offset, dst_full_len, complex_elem_size, complete),
+                          getDFTStripes(nonzero_rows, len));
 
-            for( ; i < count; i++ )
+            for( i = nonzero_rows; i < count; i++ )
             {
                 uchar* dptr0 = dst.data + i*dst.step;
-                memset( dptr0, 0, dst_full_len );
+                memset( dptr0, 0, complete ? len*complex_elem_size : dst_full_len );
             }
 
             if( stage != 1 )
@@ -1685,24 +1887,18 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
         }
         else
         {
-            int a = 0, b = count;
-            uchar *buf0, *buf1, *dbuf0, *dbuf1;
+            const DFTStage& tab = colStage;
+            int a = 0, b;
             uchar* sptr0 = src.data;
             uchar* dptr0 = dst.data;
-            buf0 = ptr;
-            ptr += len*complex_elem_size;
-            buf1 = ptr;
-            ptr += len*complex_elem_size;
-            dbuf0 = buf0, dbuf1 = buf1;
+            bool use_buf = !tab.inplace;
 
-            if( use_buf )
-            {
-                dbuf1 = ptr;
-                dbuf0 = buf1;
-                ptr += len*complex_elem_size;
-            }
+            len = dst.rows;
+            count = !inv ? src0.cols : dst.cols;
+            b = count;
+            CV_Assert( len == tab.len );
 
-            dft_func = dft_tbl[(depth == CV_64F)*3];
+            DFTFunc dft_func = dft_tbl[(depth == CV_64F)*3];
 
             if( real_transform && inv && src.cols > 1 )
                 stage = 0;
@@ -1712,6 +1908,15 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
             if( real_transform )
             {
                 int even;
+                AutoBuffer<uchar> _buf(3*len*complex_elem_size + tab.bufSize + 32);
+                uchar *buf0, *buf1, *dbuf0, *dbuf1;
+                uchar* ptr = getDFTColumnBuffers( alignPtr((uchar*)_buf, 16), len, complex_elem_size,
+                                                  use_buf, buf0, buf1, dbuf0, dbuf1 );
+                int nf = tab.nf, factors[34];
+                memcpy( factors, tab.factors, sizeof(factors) );
+                const int* itab = &tab.itab[0];
+                const uchar* wave = tab.wave.data;
+
                 a = 1;
                 even = (count & 1) == 0;
                 b = (count+1)/2;
@@ -1752,9 +1957,9 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
 
                 if( even )
                     dft_func( buf1, dbuf1, len, nf, factors, itab,
-                              wave, len, spec, ptr, inv, scale );
+                              wave, len, tab.spec, ptr, inv, scale );
                 dft_func( buf0, dbuf0, len, nf, factors, itab,
-                          wave, len, spec, ptr, inv, scale );
+                          wave, len, tab.spec, ptr, inv, scale );
 
                 if( dst.channels() == 1 )
                 {
@@ -1797,165 +2002,146 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
                 }
             }
 
-            for( i = a; i < b; i += 2 )
-            {
-                if( i+1 < b )
-                {
-                    CopyFrom2Columns( sptr0, src.step, buf0, buf1, len, complex_elem_size );
-                    dft_func( buf1, dbuf1, len, nf, factors, itab,
-                              wave, len, spec, ptr, inv, scale );
-                }
-                else
-                    CopyColumn( sptr0, src.step, buf0, complex_elem_size, len, complex_elem_size );
-
-                dft_func( buf0, dbuf0, len, nf, factors, itab,
-                          wave, len, spec, ptr, inv, scale );
-
-                if( i+1 < b )
-                    CopyTo2Columns( dbuf0, dbuf1, dptr0, dst.step, len, complex_elem_size );
-                else
-                    CopyColumn( dbuf0, complex_elem_size, dptr0, dst.step, len, complex_elem_size );
-                sptr0 += 2*complex_elem_size;
-                dptr0 += 2*complex_elem_size;
-            }
+            if( a < b )
+                parallel_for_(Range(0, (b - a + 1)/2),
+                              DFTColumnsInvoker(sptr0, src.step, dptr0, dst.step, a, b, tab, dft_func,
+                                                inv, scale, use_buf, complex_elem_size),
+                              getDFTStripes(b - a, len));
 
             if( stage != 0 )
             {
                 if( !inv && real_transform && dst.channels() == 2 && len > 1 )
                 {
-                    int n = dst.cols;
-                    if( elem_size == (int)sizeof(float) )
-                    {
-                        float* p0 = (float*)dst.data;
-                        size_t dstep = dst.step/sizeof(p0[0]);
-                        for( i = 0; i < len; i++ )
-                        {
-                            float* p = p0 + dstep*i;
-                            float* q = i == 0 || i*2 == len ? p : p0 + dstep*(len-i);
-
-                            for( int j = 1; j < (n+1)/2; j++ )
-                            {
-                                p[(n-j)*2] = q[j*2];
-                                p[(n-j)*2+1] = -q[j*2+1];
-                            }
-                        }
-                    }
+                    if( depth == CV_32F )
+                        completeDFTSpectrum<float>( dst, len );
                     else
-                    {
-                        double* p0 = (double*)dst.data;
-                        size_t dstep = dst.step/sizeof(p0[0]);
-                        for( i = 0; i < len; i++ )
-                        {
-                            double* p = p0 + dstep*i;
-                            double* q = i == 0 || i*2 == len ? p : p0 + dstep*(len-i);
-
-                            for( int j = 1; j < (n+1)/2; j++ )
-                            {
-                                p[(n-j)*2] = q[j*2];
-                                p[(n-j)*2+1] = -q[j*2+1];
-                            }
-                        }
-                    }
+                        completeDFTSpectrum<double>( dst, len );
                 }
                 break;
             }
             src = dst;
         }
     }
+}
 
-#ifdef HAVE_IPP
-    if( spec_c )
-    {
-        if( depth == CV_32F )
-            ippsDFTFree_C_32fc( (IppsDFTSpec_C_32fc*)spec_c );
-        else
-            ippsDFTFree_C_64fc( (IppsDFTSpec_C_64fc*)spec_c );
-    }
+}
 
-    if( spec_r )
-    {
-        if( depth == CV_32F )
-            ippsDFTFree_R_32f( (IppsDFTSpec_R_32f*)spec_r );
-        else
-            ippsDFTFree_R_64f( (IppsDFTSpec_R_64f*)spec_r );
-    }
-#endif
+template<> void cv::Ptr<cv::DFTPlan::Impl>::delete_obj()
+{
+    delete obj;
 }
 
+cv::DFTPlan::DFTPlan()
+{
+}
 
-void cv::idft( InputArray src, OutputArray dst, int flags, int nonzero_rows )
+cv::DFTPlan::DFTPlan( Size size, int type, int flags )
 {
-    dft( src, dst, flags | DFT_INVERSE, nonzero_rows );
+    create( size, type, flags );
 }
 
-void cv::mulSpectrums( InputArray _srcA, InputArray _srcB,
-                       OutputArray _dst, int flags, bool conjB )
+void cv::DFTPlan::create( Size size, int type, int flags )
 {
-    Mat srcA = _srcA.getMat(), srcB = _srcB.getMat();
-    int depth = srcA.depth(), cn = srcA.channels(), type = srcA.type();
-    int rows = srcA.rows, cols = srcA.cols;
-    int j, k;
+    impl = new Impl( size, type, flags );
+}
 
-    CV_Assert( type == srcB.type() && srcA.size() == srcB.size() );
-    CV_Assert( type == CV_32FC1 || type == CV_32FC2 || type == CV_64FC1 || type == CV_64FC2 );
+void cv::DFTPlan::apply( InputArray _src, OutputArray _dst, int nonzeroRows ) const
+{
+    CV_Assert( !empty() );
 
-    _dst.create( srcA.rows, srcA.cols, type );
+    Mat src = _src.getMat();
+    CV_Assert( src.type() == impl->type && src.cols == impl->size.width &&
+               (src.rows == impl->size.height || (impl->flags & DFT_ROWS)) );
+
+    _dst.create( src.size(), impl->dstType );
     Mat dst = _dst.getMat();
+    impl->apply( src, dst, nonzeroRows );
+}
 
-    bool is_1d = (flags & DFT_ROWS) || (rows == 1 || (cols == 1 &&
-             srcA.isContinuous() && srcB.isContinuous() && dst.isContinuous()));
+bool cv::DFTPlan::empty() const { return impl.empty(); }
+cv::Size cv::DFTPlan::size() const { return impl.empty() ? Size() : impl->size; }
+int cv::DFTPlan::type() const { return impl.empty() ? -1 : impl->type; }
+int cv::DFTPlan::flags() const { return impl.empty() ? 0 : impl->flags; }
 
-    if( is_1d && !(flags & DFT_ROWS) )
-        cols = cols + rows - 1, rows = 1;
 
-    int ncols = cols*cn;
-    int j0 = cn == 1;
-    int j1 = ncols - (cols % 2 == 0 && cn == 1);
+void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
+{
+    Mat src = _src0.getMat();
+    DFTPlan plan( src.size(), src.type(), flags );
+    plan.apply( src, _dst, nonzero_rows );
+}
+
 
-    if( depth == CV_32F )
-    {
-        const float* dataA = (const float*)srcA.data;
-        const float* dataB = (const float*)srcB.data;
-        float* dataC = (float*)dst.data;
+void cv::idft( InputArray src, OutputArray dst, int flags, int nonzero_rows )
+{
+    dft( src, dst, flags | DFT_INVERSE, nonzero_rows );
+}
+
+namespace cv
+{
+
+// the first and the last column of a 2D CCS-packed spectrum are CCS-packed 1D spectra themselves
+template<typename T> static void
+mulSpectrumsCCSColumns( const Mat& srcA, const Mat& srcB, Mat& dst, int rows, int cols, bool conjB )
+{
+    const T* dataA = (const T*)srcA.data;
+    const T* dataB = (const T*)srcB.data;
+    T* dataC = (T*)dst.data;
 
-        size_t stepA = srcA.step/sizeof(dataA[0]);
-        size_t stepB = srcB.step/sizeof(dataB[0]);
-        size_t stepC = dst.step/sizeof(dataC[0]);
+    size_t stepA = srcA.step/sizeof(dataA[0]);
+    size_t stepB = srcB.step/sizeof(dataB[0]);
+    size_t stepC = dst.step/sizeof(dataC[0]);
 
-        if( !is_1d && cn == 1 )
-        {
-            for( k = 0; k < (cols % 2 ? 1 : 2); k++ )
+    for( int k = 0; k < (cols % 2 ? 1 : 2); k++ )
+    {
+        if( k == 1 )
+            dataA += cols - 1, dataB += cols - 1, dataC += cols - 1;
+        dataC[0] = dataA[0]*dataB[0];
+        if( rows % 2 == 0 )
+            dataC[(rows-1)*stepC] = dataA[(rows-1)*stepA]*dataB[(rows-1)*stepB];
+        if( !conjB )
+            for( int j = 1; j <= rows - 2; j += 2 )
             {
-                if( k == 1 )
-                    dataA += cols - 1, dataB += cols - 1, dataC += cols - 1;
-                dataC[0] = dataA[0]*dataB[0];
-                if( rows % 2 == 0 )
-                    dataC[(rows-1)*stepC] = dataA[(rows-1)*stepA]*dataB[(rows-1)*stepB];
-                if( !conjB )
-                    for( j = 1; j <= rows - 2; j += 2 )
-                    {
-                        double re = (double)dataA[j*stepA]*dataB[j*stepB] -
-                                    (double)dataA[(j+1)*stepA]*dataB[(j+1)*stepB];
-                        double im = (double)dataA[j*stepA]*dataB[(j+1)*stepB] +
-                                    (double)dataA[(j+1)*stepA]*dataB[j*stepB];
-                        dataC[j*stepC] = (float)re; dataC[(j+1)*stepC] = (float)im;
-                    }
-                else
-                    for( j = 1; j <= rows - 2; j += 2 )
-                    {
-                        double re = (double)dataA[j*stepA]*dataB[j*stepB] +
-                                    (double)dataA[(j+1)*stepA]*dataB[(j+1)*stepB];
-                        double im = (double)dataA[(j+1)*stepA]*dataB[j*stepB] -
-                                    (double)dataA[j*stepA]*dataB[(j+1)*stepB];
-                        dataC[j*stepC] = (float)re; dataC[(j+1)*stepC] = (float)im;
-                    }
-                if( k == 1 )
-                    dataA -= cols - 1, dataB -= cols - 1, dataC -= cols - 1;
+                double re = (double)dataA[j*stepA]*dataB[j*stepB] -
+                            (double)dataA[(j+1)*stepA]*dataB[(j+1)*stepB];
+                double im = (double)dataA[j*stepA]*dataB[(j+1)*stepB] +
+                            (double)dataA[(j+1)*stepA]*dataB[j*stepB];
+                dataC[j*stepC] = (T)re; dataC[(j+1)*stepC] = (T)im;
             }
-        }
+        else
+            for( int j = 1; j <= rows - 2; j += 2 )
+            {
+                double re = (double)dataA[j*stepA]*dataB[j*stepB] +
+                            (double)dataA[(j+1)*stepA]*dataB[(j+1)*stepB];
+                double im = (double)dataA[(j+1)*stepA]*dataB[j*stepB] -
+                            (double)dataA[j*stepA]*dataB[(j+1)*stepB];
+                dataC[j*stepC] = (T)re; dataC[(j+1)*stepC] = (T)im;
+            }
+        if( k == 1 )
+            dataA -= cols - 1, dataB -= cols - 1, dataC -= cols - 1;
+    }
+}
+
+// multiplies the elements [j0, j1) of each row; they never overlap the columns done above
+template<typename T> class MulSpectrumsRowsInvoker : public ParallelLoopBody
+{
+public:
+    MulSpectrumsRowsInvoker( const Mat& _srcA, const Mat& _srcB, Mat& _dst,
+                             int _cols, bool _is_1d, bool _conjB ) :
+        srcA(&_srcA), srcB(&_srcB), dst(&_dst), cols(_cols), is_1d(_is_1d), conjB(_conjB) {}
+
+    void operator()( const Range& range ) const
+    {
+        int cn = srcA->channels(), ncols = cols*cn;
+        int j0 = cn == 1;
+        int j1 = ncols - (cols % 2 == 0 && cn == 1);
 
-        for( ; rows--; dataA += stepA, dataB += stepB, dataC += stepC )
+        for( int i = range.start; i < range.end; i++ )
         {
+            const T* dataA = (const T*)(srcA->data + srcA->step*i);
+            const T* dataB = (const T*)(srcB->data + srcB->step*i);
+            T* dataC = (T*)(dst->data + dst->step*i);
+
             if( is_1d && cn == 1 )
             {
                 dataC[0] = dataA[0]*dataB[0];
@@ -1964,88 +2150,64 @@ void cv::mulSpectrums( InputArray _srcA, InputArray _srcB,
             }
 
             if( !conjB )
-                for( j = j0; j < j1; j += 2 )
+                for( int j = j0; j < j1; j += 2 )
                 {
                     double re = (double)dataA[j]*dataB[j] - (double)dataA[j+1]*dataB[j+1];
                     double im = (double)dataA[j+1]*dataB[j] + (double)dataA[j]*dataB[j+1];
-                    dataC[j] = (float)re; dataC[j+1] = (float)im;
+                    dataC[j] = (T)re; dataC[j+1] = (T)im;
                 }
             else
-                for( j = j0; j < j1; j += 2 )
+                for( int j = j0; j < j1; j += 2 )
                 {
                     double re = (double)dataA[j]*dataB[j] + (double)dataA[j+1]*dataB[j+1];
                     double im = (double)dataA[j+1]*dataB[j] - (double)dataA[j]*dataB[j+1];
-                    dataC[j] = (float)re; dataC[j+1] = (float)im;
+                    dataC[j] = (T)re; dataC[j+1] = (T)im;
                 }
         }
     }
-    else
-    {
-        const double* dataA = (const double*)srcA.data;
-        const double* dataB = (const double*)srcB.data;
-        double* dataC = (double*)dst.data;
 
-        size_t stepA = srcA.step/sizeof(dataA[0]);
-        size_t stepB = srcB.step/sizeof(dataB[0]);
-        size_t stepC = dst.step/sizeof(dataC[0]);
+protected:
+    const Mat* srcA;
+    const Mat* srcB;
+    Mat* dst;
+    int cols;
+    bool is_1d, conjB;
+};
 
-        if( !is_1d && cn == 1 )
-        {
-            for( k = 0; k < (cols % 2 ? 1 : 2); k++ )
-            {
-                if( k == 1 )
-                    dataA += cols - 1, dataB += cols - 1, dataC += cols - 1;
-                dataC[0] = dataA[0]*dataB[0];
-                if( rows % 2 == 0 )
-                    dataC[(rows-1)*stepC] = dataA[(rows-1)*stepA]*dataB[(rows-1)*stepB];
-                if( !conjB )
-                    for( j = 1; j <= rows - 2; j += 2 )
-                    {
-                        double re = dataA[j*stepA]*dataB[j*stepB] -
-                                    dataA[(j+1)*stepA]*dataB[(j+1)*stepB];
-                        double im = dataA[j*stepA]*dataB[(j+1)*stepB] +
-                                    dataA[(j+1)*stepA]*dataB[j*stepB];
-                        dataC[j*stepC] = re; dataC[(j+1)*stepC] = im;
-                    }
-                else
-                    for( j = 1; j <= rows - 2; j += 2 )
-                    {
-                        double re = dataA[j*stepA]*dataB[j*stepB] +
-                                    dataA[(j+1)*stepA]*dataB[(j+1)*stepB];
-                        double im = dataA[(j+1)*stepA]*dataB[j*stepB] -
-                                    dataA[j*stepA]*dataB[(j+1)*stepB];
-                        dataC[j*stepC] = re; dataC[(j+1)*stepC] = im;
-                    }
-                if( k == 1 )
-                    dataA -= cols - 1, dataB -= cols - 1, dataC -= cols - 1;
-            }
-        }
+}
 
-        for( ; rows--; dataA += stepA, dataB += stepB, dataC += stepC )
-        {
-            if( is_1d && cn == 1 )
-            {
-                dataC[0] = dataA[0]*dataB[0];
-                if( cols % 2 == 0 )
-                    dataC[j1] = dataA[j1]*dataB[j1];
-            }
+void cv::mulSpectrums( InputArray _srcA, InputArray _srcB,
+                       OutputArray _dst, int flags, bool conjB )
+{
+    Mat srcA = _srcA.getMat(), srcB = _srcB.getMat();
+    int depth = srcA.depth(), cn = srcA.channels(), type = srcA.type();
+    int rows = srcA.rows, cols = srcA.cols;
 
-            if( !conjB )
-                for( j = j0; j < j1; j += 2 )
-                {
-                    double re = dataA[j]*dataB[j] - dataA[j+1]*dataB[j+1];
-                    double im = dataA[j+1]*dataB[j] + dataA[j]*dataB[j+1];
-                    dataC[j] = re; dataC[j+1] = im;
-                }
-            else
-                for( j = j0; j < j1; j += 2 )
-                {
-                    double re = dataA[j]*dataB[j] + dataA[j+1]*dataB[j+1];
-                    double im = dataA[j+1]*dataB[j] - dataA[j]*dataB[j+1];
-                    dataC[j] = re; dataC[j+1] = im;
-                }
-        }
+    CV_Assert( type == srcB.type() && srcA.size() == srcB.size() );
+    CV_Assert( type == CV_32FC1 || type == CV_32FC2 || type == CV_64FC1 || type == CV_64FC2 );
+
+    _dst.create( srcA.rows, srcA.cols, type );
+    Mat dst = _dst.getMat();
+
+    bool is_1d = (flags & DFT_ROWS) || (rows == 1 || (cols == 1 &&
+             srcA.isContinuous() && srcB.isContinuous() && dst.isContinuous()));
+
+    if( is_1d && !(flags & DFT_ROWS) )
+        cols = cols + rows - 1, rows = 1;
+
+    if( !is_1d && cn == 1 )
+    {
+        if( depth == CV_32F )
+            mulSpectrumsCCSColumns<float>( srcA, srcB, dst, rows, cols, conjB );
+        else
+            mulSpectrumsCCSColumns<double>( srcA, srcB, dst, rows, cols, conjB );
     }
+
+    double nstripes = (double)rows*cols*cn/(1 << 16);
+    if( depth == CV_32F )
+        parallel_for_( Range(0, rows), MulSpectrumsRowsInvoker<float>(srcA, srcB, dst, cols, is_1d, conjB), nstripes );
+    else
+        parallel_for_( Range(0, rows), MulSpectrumsRowsInvoker<double>(srcA, srcB, dst, cols, is_1d, conjB), nstripes );
 }
 
 
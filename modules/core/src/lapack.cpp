@@ -109,16 +109,150 @@ LUImpl(_Tp* A, size_t astep, int m, _Tp* b, size_t bstep, int n)
     return p;
 }
 
+// the width of the panels in LUBlockedImpl; the matrices of at least LU_BLOCKED_MIN rows use it
+enum { LU_BLOCK_SIZE = 64, LU_BLOCKED_MIN = 192 };
+
+// solves U*x = b for the stripes of LU_BLOCK_SIZE columns of b; U has the inverted diagonal
+template<typename _Tp> class LUBackSubstInvoker : public ParallelLoopBody
+{
+public:
+    LUBackSubstInvoker( const _Tp* _A, size_t _astep, int _m, _Tp* _b, size_t _bstep, int _n )
+        : A(_A), astep(_astep), m(_m), b(_b), bstep(_bstep), n(_n) {}
+
+    void operator()( const Range& range ) const
+    {
+        int j0 = range.start*LU_BLOCK_SIZE, j1 = std::min(range.end*LU_BLOCK_SIZE, n);
+
+        for( int i = m-1; i >= 0; i-- )
+        {
+            _Tp* bi = b + i*bstep;
+            for( int k = i+1; k < m; k++ )
+            {
+                _Tp alpha = A[i*astep + k];
+                const _Tp* bk = b + k*bstep;
+                for( int j = j0; j < j1; j++ )
+                    bi[j] -= alpha*bk[j];
+            }
+            _Tp d = A[i*astep + i];
+            for( int j = j0; j < j1; j++ )
+                bi[j] *= d;
+        }
+    }
+
+private:
+    LUBackSubstInvoker& operator=(const LUBackSubstInvoker&); // to quiet MSVC
+
+    const _Tp* A;
+    size_t astep;
+    int m;
+    _Tp* b;
+    size_t bstep;
+    int n;
+};
+
+/*
+Right-looking blocked LU: each panel of LU_BLOCK_SIZE columns is factorized as in LUImpl,
+then the rows of the panel are solved for the rest of the columns and the trailing submatrix
+is updated by a single (parallel) gemm. The output is the same as from LUImpl:
+the strict upper triangle of U, the inverted diagonal of U and the solution in b.
+*/
+template<typename _Tp> static int
+LUBlockedImpl(_Tp* A, size_t astep, int m, _Tp* b, size_t bstep, int n)
+{
+    int i, j, k, i0, p = 1, type = DataType<_Tp>::type;
+    size_t astep0 = astep, bstep0 = bstep;
+    astep /= sizeof(A[0]);
+    bstep /= sizeof(b[0]);
+
+    for( i0 = 0; i0 < m; i0 += LU_BLOCK_SIZE )
+    {
+        int i1 = std::min(i0 + LU_BLOCK_SIZE, m);
+
+        // factorize the panel; the multipliers are stored below the diagonal
+        for( i = i0; i < i1; i++ )
+        {
+            k = i;
+
+            for( j = i+1; j < m; j++ )
+                if( std::abs(A[j*astep + i]) > std::abs(A[k*astep + i]) )
+                    k = j;
+
+            if( std::abs(A[k*astep + i]) < std::numeric_limits<_Tp>::epsilon() )
+                return 0;
+
+            if( k != i )
+            {
+                for( j = 0; j < m; j++ )
+                    std::swap(A[i*astep + j], A[k*astep + j]);
+                if( b )
+                    for( j = 0; j < n; j++ )
+                        std::swap(b[i*bstep + j], b[k*bstep + j]);
+                p = -p;
+            }
+
+            _Tp d = 1/A[i*astep + i];
+
+            for( j = i+1; j < m; j++ )
+            {
+                _Tp alpha = A[j*astep + i]*d;
+                A[j*astep + i] = alpha;
+
+                for( k = i+1; k < i1; k++ )
+                    A[j*astep + k] -= alpha*A[i*astep + k];
+            }
+        }
+
+        // the rows of the panel: U12 = inv(L11)*A12, the same for b
+        for( i = i0 + 1; i < i1; i++ )
+            for( k = i0; k < i; k++ )
+            {
+                _Tp alpha = A[i*astep + k];
+                for( j = i1; j < m; j++ )
+                    A[i*astep + j] -= alpha*A[k*astep + j];
+                if( b )
+                    for( j = 0; j < n; j++ )
+                        b[i*bstep + j] -= alpha*b[k*bstep + j];
+            }
+
+        if( i1 == m )
+            break;
+
+        // the trailing submatrix: A22 -= L21*U12, b2 -= L21*b1
+        Mat L21(m - i1, i1 - i0, type, A + i1*astep + i0, astep0);
+        Mat U12(i1 - i0, m - i1, type, A + i0*astep + i1, astep0);
+        Mat A22(m - i1, m - i1, type, A + i1*astep + i1, astep0);
+        gemm(L21, U12, -1, A22, 1, A22);
+        if( b )
+        {
+            Mat b1(i1 - i0, n, type, b + i0*bstep, bstep0);
+            Mat b2(m - i1, n, type, b + i1*bstep, bstep0);
+            gemm(L21, b1, -1, b2, 1, b2);
+        }
+    }
+
+    for( i = 0; i < m; i++ )
+        A[i*astep + i] = 1/A[i*astep + i];
+
+    if( b )
+        parallel_for_(Range(0, (n + LU_BLOCK_SIZE - 1)/LU_BLOCK_SIZE),
+                      LUBackSubstInvoker<_Tp>(A, astep, m, b, bstep, n),
+                      (double)m*m*n/(1 << 20));
+
+    return p;
+}
+
 
 int LU(float* A, size_t astep, int m, float* b, size_t bstep, int n)
 {
-    return LUImpl(A, astep, m, b, bstep, n);
+    return m >= LU_BLOCKED_MIN ? LUBlockedImpl(A, astep, m, b, bstep, n) :
+                                 LUImpl(A, astep, m, b, bstep, n);
 }
 
 
 int LU(double* A, size_t astep, int m, double* b, size_t bstep, int n)
 {
-    return LUImpl(A, astep, m, b, bstep, n);
+    return m >= LU_BLOCKED_MIN ? LUBlockedImpl(A, astep, m, b, bstep, n) :
+                                 LUImpl(A, astep, m, b, bstep, n);
 }
 
 
@@ -373,14 +507,323 @@ JacobiImpl_( _Tp* A, size_t astep, _Tp* W, _Tp* V, size_t vstep, int n, uchar* b
     return true;
 }
 
+/*
+The symmetric matrices of at least EIGEN_TRIDIAG_MIN rows are reduced to the tridiagonal form
+by Householder reflections, and the tridiagonal matrix is diagonalized by the implicit QL method
+(as tred2/tql2 from EISPACK). This takes several times fewer operations than the Jacobi method
+on large matrices; the rank-2 updates, the accumulation of the reflections and the QL rotations
+of the eigenvectors run in parallel.
+*/
+enum { EIGEN_TRIDIAG_MIN = 64, EIGEN_COL_BLOCK = 64 };
+
+// p[i] = beta*dot(A[i][k:n], v) for the rows i of the trailing submatrix
+class TridiagMatVecInvoker : public ParallelLoopBody
+{
+public:
+    TridiagMatVecInvoker( const double* _A, size_t _astep, int _k, int _n,
+                          const double* _v, double _beta, double* _p )
+        : A(_A), astep(_astep), k(_k), n(_n), v(_v), beta(_beta), p(_p) {}
+
+    void operator()( const Range& range ) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            const double* Ai = A + astep*i + k;
+            double s = 0;
+            for( int j = 0; j < n - k; j++ )
+                s += Ai[j]*v[j];
+            p[i - k] = s*beta;
+        }
+    }
+
+private:
+    TridiagMatVecInvoker& operator=(const TridiagMatVecInvoker&); // to quiet MSVC
+
+    const double* A;
+    size_t astep;
+    int k, n;
+    const double* v;
+    double beta;
+    double* p;
+};
+
+// A[k:n][k:n] -= v*w' + w*v'
+class TridiagRank2Invoker : public ParallelLoopBody
+{
+public:
+    TridiagRank2Invoker( double* _A, size_t _astep, int _k, int _n, const double* _v, const double* _w )
+        : A(_A), astep(_astep), k(_k), n(_n), v(_v), w(_w) {}
+
+    void operator()( const Range& range ) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            double* Ai = A + astep*i + k;
+            double vi = v[i - k], wi = w[i - k];
+            for( int j = 0; j < n - k; j++ )
+                Ai[j] -= vi*w[j] + wi*v[j];
+        }
+    }
+
+private:
+    TridiagRank2Invoker& operator=(const TridiagRank2Invoker&); // to quiet MSVC
+
+    double* A;
+    size_t astep;
+    int k, n;
+    const double *v, *w;
+};
+
+// Q[k:n][k:n] = (I - beta*v*v')*Q[k:n][k:n], for the stripes of EIGEN_COL_BLOCK columns
+class HouseholderApplyInvoker : public ParallelLoopBody
+{
+public:
+    HouseholderApplyInvoker( double* _Q, size_t _qstep, int _k, int _n, const double* _v, double _beta )
+        : Q(_Q), qstep(_qstep), k(_k), n(_n), v(_v), beta(_beta) {}
+
+    void operator()( const Range& range ) const
+    {
+        int j0 = k + range.start*EIGEN_COL_BLOCK, j1 = std::min(k + range.end*EIGEN_COL_BLOCK, n);
+        double t[EIGEN_COL_BLOCK];
+
+        for( int j = j0; j < j1; j += EIGEN_COL_BLOCK )
+        {
+            int j2 = std::min(j + EIGEN_COL_BLOCK, j1), i, l;
+            for( l = 0; l < j2 - j; l++ )
+                t[l] = 0;
+            for( i = k; i < n; i++ )
+            {
+                const double* Qi = Q + qstep*i + j;
+                double vi = v[i - k];
+                for( l = 0; l < j2 - j; l++ )
+                    t[l] += vi*Qi[l];
+            }
+            for( i = k; i < n; i++ )
+            {
+                double* Qi = Q + qstep*i + j;
+                double vi = v[i - k]*beta;
+                for( l = 0; l < j2 - j; l++ )
+                    Qi[l] -= vi*t[l];
+            }
+        }
+    }
+
+private:
+    HouseholderApplyInvoker& operator=(const HouseholderApplyInvoker&); // to quiet MSVC
+
+    double* Q;
+    size_t qstep;
+    int k, n;
+    const double* v;
+    double beta;
+};
+
+// applies the sequence of QL rotations to the rows of V (the eigenvectors), by stripes of columns
+class QLRotationsInvoker : public ParallelLoopBody
+{
+public:
+    QLRotationsInvoker( double* _V, size_t _vstep, int _n, int _l, int _m, const double* _cs )
+        : V(_V), vstep(_vstep), n(_n), l(_l), m(_m), cs(_cs) {}
+
+    void operator()( const Range& range ) const
+    {
+        int j0 = range.start*EIGEN_COL_BLOCK, j1 = std::min(range.end*EIGEN_COL_BLOCK, n);
+        for( int i = m - 1; i >= l; i-- )
+        {
+            double c = cs[i*2], s = cs[i*2+1];
+            double *V0 = V + vstep*i, *V1 = V0 + vstep;
+            for( int j = j0; j < j1; j++ )
+            {
+                double h = V1[j];
+                V1[j] = s*V0[j] + c*h;
+                V0[j] = c*V0[j] - s*h;
+            }
+        }
+    }
+
+private:
+    QLRotationsInvoker& operator=(const QLRotationsInvoker&); // to quiet MSVC
+
+    double* V;
+    size_t vstep;
+    int n, l, m;
+    const double* cs;
+};
+
+// A is destroyed; the eigenvectors are stored in the rows of V
+static bool EigenTridiagQL( double* A, size_t astep, double* d, double* V, size_t vstep, int n )
+{
+    const double eps = DBL_EPSILON;
+    const int maxIters = 60;
+    int i, j, k, l, m;
+
+    astep /= sizeof(A[0]);
+    vstep /= sizeof(V[0]);
+
+    AutoBuffer<double> _buf(n*6);
+    double *e = _buf, *beta = e + n, *p = beta + n, *w = p + n, *cs = w + n;
+
+    // only the upper triangle is used by the other methods
+    for( i = 0; i < n; i++ )
+        for( j = i + 1; j < n; j++ )
+            A[astep*j + i] = A[astep*i + j];
+
+    // Householder reduction: the reflection k zeroes A[k][k+2:n] and A[k+2:n][k];
+    // its vector is stored in A[k][k+1:n]
+    for( k = 0; k < n - 2; k++ )
+    {
+        double* v = A + astep*k + k + 1;
+        int len = n - k - 1;
+        double sigma = 0, x0 = v[0];
+        for( j = 1; j < len; j++ )
+            sigma += v[j]*v[j];
+
+        d[k] = A[astep*k + k];
+        if( sigma == 0 )
+        {
+            e[k] = x0;
+            beta[k] = 0;
+            continue;
+        }
+
+        double alpha = std::sqrt(x0*x0 + sigma);
+        if( x0 > 0 )
+            alpha = -alpha;
+        v[0] = x0 - alpha;
+        beta[k] = 2/(v[0]*v[0] + sigma);
+        e[k] = alpha;
+
+        // B = H*B*H, where H = I - beta*v*v': p = beta*B*v, w = p - (beta/2)*(p'*v)*v, B -= v*w' + w*v'
+        parallel_for_(Range(k + 1, n), TridiagMatVecInvoker(A, astep, k + 1, n, v, beta[k], p),
+                      (double)len*len/(1 << 16));
+        double pv = 0;
+        for( j = 0; j < len; j++ )
+            pv += p[j]*v[j];
+        pv *= beta[k]*0.5;
+        for( j = 0; j < len; j++ )
+            w[j] = p[j] - pv*v[j];
+        parallel_for_(Range(k + 1, n), TridiagRank2Invoker(A, astep, k + 1, n, v, w),
+                      (double)len*len/(1 << 16));
+    }
+    if( n > 1 )
+    {
+        d[n-2] = A[astep*(n-2) + n-2];
+        e[n-2] = A[astep*(n-2) + n-1];
+    }
+    d[n-1] = A[astep*(n-1) + n-1];
+    e[n-1] = 0;
+
+    if( V )
+    {
+        // Q = H_0*H_1*...*H_(n-3); the eigenvectors of A are Q times those of the tridiagonal matrix,
+        // so the rows of V start from the rows of Q'
+        Mat Q(n, n, CV_64F);
+        setIdentity(Q);
+        for( k = n - 3; k >= 0; k-- )
+            if( beta[k] != 0 )
+                parallel_for_(Range(0, (n - k - 1 + EIGEN_COL_BLOCK - 1)/EIGEN_COL_BLOCK),
+                              HouseholderApplyInvoker(Q.ptr<double>(), Q.step/sizeof(double), k + 1, n,
+                                                      A + astep*k + k + 1, beta[k]),
+                              (double)(n - k)*(n - k)/(1 << 16));
+        transpose(Q, Mat(n, n, CV_64F, V, vstep*sizeof(V[0])));
+    }
+
+    // implicit QL with Wilkinson shifts
+    double f = 0, tst1 = 0;
+    for( l = 0; l < n; l++ )
+    {
+        tst1 = std::max(tst1, std::abs(d[l]) + std::abs(e[l]));
+        for( m = l; m < n - 1; m++ )
+            if( std::abs(e[m]) <= eps*tst1 )
+                break;
+
+        if( m > l )
+        {
+            for( int iter = 0; iter < maxIters; iter++ )
+            {
+                double g = d[l], q = (d[l+1] - g)/(2*e[l]), r = hypot(q, 1.);
+                if( q < 0 )
+                    r = -r;
+                d[l] = e[l]/(q + r);
+                d[l+1] = e[l]*(q + r);
+                double dl1 = d[l+1], h = g - d[l];
+                for( i = l + 2; i < n; i++ )
+                    d[i] -= h;
+                f += h;
+
+                double pp = d[m], c = 1, c2 = c, c3 = c, el1 = e[l+1], s = 0, s2 = 0;
+                for( i = m - 1; i >= l; i-- )
+                {
+                    c3 = c2;
+                    c2 = c;
+                    s2 = s;
+                    g = c*e[i];
+                    h = c*pp;
+                    r = hypot(pp, e[i]);
+                    e[i+1] = s*r;
+                    s = e[i]/r;
+                    c = pp/r;
+                    pp = c*d[i] - s*g;
+                    d[i+1] = h + s*(c*g + s*d[i]);
+                    cs[i*2] = c;
+                    cs[i*2+1] = s;
+                }
+                if( V )
+                    parallel_for_(Range(0, (n + EIGEN_COL_BLOCK - 1)/EIGEN_COL_BLOCK),
+                                  QLRotationsInvoker(V, vstep, n, l, m, cs), (double)n*(m - l)/(1 << 16));
+                pp = -s*s2*c3*el1*e[l]/dl1;
+                e[l] = s*pp;
+                d[l] = c*pp;
+                if( std::abs(e[l]) <= eps*tst1 )
+                    break;
+            }
+        }
+        d[l] += f;
+        e[l] = 0;
+    }
+
+    // sort eigenvalues & eigenvectors
+    for( k = 0; k < n-1; k++ )
+    {
+        m = k;
+        for( i = k+1; i < n; i++ )
+        {
+            if( d[m] < d[i] )
+                m = i;
+        }
+        if( k != m )
+        {
+            std::swap(d[m], d[k]);
+            if( V )
+                for( i = 0; i < n; i++ )
+                    std::swap(V[vstep*m + i], V[vstep*k + i]);
+        }
+    }
+
+    return true;
+}
+
 static bool Jacobi( float* S, size_t sstep, float* e, float* E, size_t estep, int n, uchar* buf )
 {
-    return JacobiImpl_(S, sstep, e, E, estep, n, buf);
+    if( n < EIGEN_TRIDIAG_MIN )
+        return JacobiImpl_(S, sstep, e, E, estep, n, buf);
+
+    Mat S64, W64(n, 1, CV_64F), E64;
+    Mat(n, n, CV_32F, S, sstep).convertTo(S64, CV_64F);
+    if( E )
+        E64.create(n, n, CV_64F);
+    bool ok = EigenTridiagQL(S64.ptr<double>(), S64.step, W64.ptr<double>(),
+                             E ? E64.ptr<double>() : 0, E64.step, n);
+    W64.convertTo(Mat(n, 1, CV_32F, e), CV_32F);
+    if( E )
+        E64.convertTo(Mat(n, n, CV_32F, E, estep), CV_32F);
+    return ok;
 }
 
 static bool Jacobi( double* S, size_t sstep, double* e, double* E, size_t estep, int n, uchar* buf )
 {
-    return JacobiImpl_(S, sstep, e, E, estep, n, buf);
+    return n >= EIGEN_TRIDIAG_MIN ? EigenTridiagQL(S, sstep, e, E, estep, n) :
+                                    JacobiImpl_(S, sstep, e, E, estep, n, buf);
 }
 
 
@@ -526,15 +969,134 @@ template<> inline int VBLAS<double>::givensx(double* a, double* b, int n, double
 }
 #endif
 
+// orthogonalizes the rows Ai and Aj of At (and rotates Vi, Vj); returns false if they are already orthogonal
+template<typename _Tp> static bool
+JacobiSVDRotate_(_Tp* Ai, _Tp* Aj, _Tp* Vi, _Tp* Vj, double* Wi, double* Wj, int m, int n, int iter)
+{
+    VBLAS<_Tp> vblas;
+    // the rows of a float matrix can not be made orthogonal beyond the float precision
+    _Tp eps = (_Tp)(sizeof(_Tp) == sizeof(float) ? FLT_EPSILON : DBL_EPSILON*10);
+    _Tp c, s;
+    double a = *Wi, p = 0, b = *Wj;
+    int k;
+
+    for( k = 0; k < m; k++ )
+        p += (double)Ai[k]*Aj[k];
+
+    if( std::abs(p) <= eps*std::sqrt((double)a*b) )
+        return false;
+
+    p *= 2;
+    double beta = a - b, gamma = hypot((double)p, beta), delta;
+    if( beta < 0 )
+    {
+        delta = (gamma - beta)*0.5;
+        s = (_Tp)std::sqrt(delta/gamma);
+        c = (_Tp)(p/(gamma*s*2));
+    }
+    else
+    {
+        c = (_Tp)std::sqrt((gamma + beta)/(gamma*2));
+        s = (_Tp)(p/(gamma*c*2));
+        delta = p*p*0.5/(gamma + beta);
+    }
+
+    *Wi += delta;
+    *Wj -= delta;
+
+    if( iter % 2 != 0 && *Wi > 0 && *Wj > 0 )
+    {
+        k = vblas.givens(Ai, Aj, m, c, s);
+
+        for( ; k < m; k++ )
+        {
+            _Tp t0 = c*Ai[k] + s*Aj[k];
+            _Tp t1 = -s*Ai[k] + c*Aj[k];
+            Ai[k] = t0; Aj[k] = t1;
+        }
+    }
+    else
+    {
+        a = b = 0;
+        for( k = 0; k < m; k++ )
+        {
+            _Tp t0 = c*Ai[k] + s*Aj[k];
+            _Tp t1 = -s*Ai[k] + c*Aj[k];
+            Ai[k] = t0; Aj[k] = t1;
+
+            a += (double)t0*t0; b += (double)t1*t1;
+        }
+        *Wi = a; *Wj = b;
+    }
+
+    if( Vi )
+    {
+        k = vblas.givens(Vi, Vj, n, c, s);
+
+        for( ; k < n; k++ )
+        {
+            _Tp t0 = c*Vi[k] + s*Vj[k];
+            _Tp t1 = -s*Vi[k] + c*Vj[k];
+            Vi[k] = t0; Vj[k] = t1;
+        }
+    }
+
+    return true;
+}
+
+/*
+The pairs of rows processed at the same step of a round-robin (tournament) ordering:
+during the step r of a sweep the rows i and j with (i + j) % n1 == r form a pair, where n1 is
+n rounded up to odd; the row left without a pair is skipped. Every sweep visits all the pairs,
+and the pairs of one step do not intersect, so they are rotated in parallel.
+The matrices of at least JACOBI_PARALLEL_MIN rows use this ordering instead of the cyclic one.
+*/
+enum { JACOBI_PARALLEL_MIN = 64 };
+
+static inline int roundRobinPair( int n1, int r, int i )
+{
+    return (r - i + n1) % n1;
+}
+
+template<typename _Tp> class JacobiSVDStepInvoker : public ParallelLoopBody
+{
+public:
+    JacobiSVDStepInvoker( _Tp* _At, size_t _astep, _Tp* _Vt, size_t _vstep, double* _W,
+                          int _m, int _n, int _iter, int _step, uchar* _changed )
+        : At(_At), Vt(_Vt), astep(_astep), vstep(_vstep), W(_W),
+          m(_m), n(_n), iter(_iter), step(_step), changed(_changed) {}
+
+    void operator()( const Range& range ) const
+    {
+        int n1 = n | 1;
+        for( int i = range.start; i < range.end; i++ )
+        {
+            int j = roundRobinPair(n1, step, i);
+            if( j <= i || j >= n )
+                continue;
+            if( JacobiSVDRotate_(At + i*astep, At + j*astep, Vt ? Vt + i*vstep : 0,
+                                 Vt ? Vt + j*vstep : 0, W + i, W + j, m, n, iter) )
+                changed[i] = 1;
+        }
+    }
+
+private:
+    JacobiSVDStepInvoker& operator=(const JacobiSVDStepInvoker&); // to quiet MSVC
+
+    _Tp *At, *Vt;
+    size_t astep, vstep;
+    double* W;
+    int m, n, iter, step;
+    uchar* changed;
+};
+
 template<typename _Tp> void
 JacobiSVDImpl_(_Tp* At, size_t astep, _Tp* _W, _Tp* Vt, size_t vstep, int m, int n, int n1, double minval)
 {
-    VBLAS<_Tp> vblas;
     AutoBuffer<double> Wbuf(n);
     double* W = Wbuf;
-    _Tp eps = DBL_EPSILON*10;
     int i, j, k, iter, max_iter = std::max(m, 30);
-    _Tp c, s;
+    _Tp s;
     double sd;
     astep /= sizeof(At[0]);
     vstep /= sizeof(Vt[0]);
@@ -556,79 +1118,32 @@ JacobiSVDImpl_(_Tp* At, size_t astep, _Tp* _W, _Tp* Vt, size_t vstep, int m, int
         }
     }
 
-    for( iter = 0; iter < max_iter; iter++ )
+    if( n >= JACOBI_PARALLEL_MIN )
+    {
+        AutoBuffer<uchar> _changed(n);
+        uchar* changed = _changed;
+        for( iter = 0; iter < max_iter; iter++ )
+        {
+            memset(changed, 0, n);
+            for( int step = 0; step < (n | 1); step++ )
+                parallel_for_(Range(0, n), JacobiSVDStepInvoker<_Tp>(At, astep, Vt, vstep, W, m, n,
+                              iter, step, changed), (double)n*(m + (Vt ? n : 0))/(1 << 16));
+            for( i = 0; i < n && !changed[i]; i++ )
+                ;
+            if( i == n )
+                break;
+        }
+    }
+    else for( iter = 0; iter < max_iter; iter++ )
     {
         bool changed = false;
 
         for( i = 0; i < n-1; i++ )
             for( j = i+1; j < n; j++ )
             {
-                _Tp *Ai = At + i*astep, *Aj = At + j*astep;
-                double a = W[i], p = 0, b = W[j];
-
-                for( k = 0; k < m; k++ )
-                    p += (double)Ai[k]*Aj[k];
-
-                if( std::abs(p) <= eps*std::sqrt((double)a*b) )
-                    continue;
-
-                p *= 2;
-                double beta = a - b, gamma = hypot((double)p, beta), delta;
-                if( beta < 0 )
-                {
-                    delta = (gamma - beta)*0.5;
-                    s = (_Tp)std::sqrt(delta/gamma);
-                    c = (_Tp)(p/(gamma*s*2));
-                }
-                else
-                {
-                    c = (_Tp)std::sqrt((gamma + beta)/(gamma*2));
-                    s = (_Tp)(p/(gamma*c*2));
-                    delta = p*p*0.5/(gamma + beta);
-                }
-
-                W[i] += delta;
-                W[j] -= delta;
-
-                if( iter % 2 != 0 && W[i] > 0 && W[j] > 0 )
-                {
-                    k = vblas.givens(Ai, Aj, m, c, s);
-
-                    for( ; k < m; k++ )
-                    {
-                        _Tp t0 = c*Ai[k] + s*Aj[k];
-                        _Tp t1 = -s*Ai[k] + c*Aj[k];
-                        Ai[k] = t0; Aj[k] = t1;
-                    }
-                }
-                else
-                {
-                    a = b = 0;
-                    for( k = 0; k < m; k++ )
-                    {
-                        _Tp t0 = c*Ai[k] + s*Aj[k];
-                        _Tp t1 = -s*Ai[k] + c*Aj[k];
-                        Ai[k] = t0; Aj[k] = t1;
-
-                        a += (double)t0*t0; b += (double)t1*t1;
-                    }
-                    W[i] = a; W[j] = b;
-                }
-
-                changed = true;
-
-                if( Vt )
-                {
-                    _Tp *Vi = Vt + i*vstep, *Vj = Vt + j*vstep;
-                    k = vblas.givens(Vi, Vj, n, c, s);
-
-                    for( ; k < n; k++ )
-                    {
-                        _Tp t0 = c*Vi[k] + s*Vj[k];
-                        _Tp t1 = -s*Vi[k] + c*Vj[k];
-                        Vi[k] = t0; Vj[k] = t1;
-                    }
-                }
+                if( JacobiSVDRotate_(At + i*astep, At + j*astep, Vt ? Vt + i*vstep : 0,
+                                     Vt ? Vt + j*vstep : 0, W + i, W + j, m, n, iter) )
+                    changed = true;
             }
         if( !changed )
             break;
@@ -1653,6 +2168,469 @@ void cv::SVBackSubst(InputArray w, InputArray u, InputArray vt, InputArray rhs,
     SVD::backSubst(w, u, vt, rhs, dst);
 }
 
+/****************************************************************************************\
+*                     Batched decompositions of small matrices                           *
+\****************************************************************************************/
+
+namespace cv
+{
+
+/*
+The matrices of a batch are processed by groups of BatchVec<T>::LANES, with the elements
+of the same position in the group interleaved, so that every operation of the Jacobi method
+is done on all the matrices of the group at once. The rotations are computed without branches:
+the matrices that have already converged get the identity rotations.
+*/
+template<typename T> struct BatchVec
+{
+    enum { LANES = 4 };
+    BatchVec() {}
+    explicit BatchVec( T x ) { for( int i = 0; i < LANES; i++ ) v[i] = x; }
+    static BatchVec load( const T* p ) { BatchVec r; for( int i = 0; i < LANES; i++ ) r.v[i] = p[i]; return r; }
+    void store( T* p ) const { for( int i = 0; i < LANES; i++ ) p[i] = v[i]; }
+    T v[LANES];
+};
+
+#define CV_BATCHVEC_OP(op) \
+template<typename T> static inline BatchVec<T> operator op( const BatchVec<T>& a, const BatchVec<T>& b ) \
+{ BatchVec<T> r; for( int i = 0; i < BatchVec<T>::LANES; i++ ) r.v[i] = a.v[i] op b.v[i]; return r; }
+
+CV_BATCHVEC_OP(+)
+CV_BATCHVEC_OP(-)
+CV_BATCHVEC_OP(*)
+CV_BATCHVEC_OP(/)
+
+#undef CV_BATCHVEC_OP
+
+template<typename T> static inline BatchVec<T> batchSqrt( const BatchVec<T>& a )
+{ BatchVec<T> r; for( int i = 0; i < BatchVec<T>::LANES; i++ ) r.v[i] = std::sqrt(a.v[i]); return r; }
+
+template<typename T> static inline BatchVec<T> batchAbs( const BatchVec<T>& a )
+{ BatchVec<T> r; for( int i = 0; i < BatchVec<T>::LANES; i++ ) r.v[i] = std::abs(a.v[i]); return r; }
+
+template<typename T> static inline BatchVec<T> batchMax( const BatchVec<T>& a, const BatchVec<T>& b )
+{ BatchVec<T> r; for( int i = 0; i < BatchVec<T>::LANES; i++ ) r.v[i] = std::max(a.v[i], b.v[i]); return r; }
+
+// a with the sign flipped where b is negative
+template<typename T> static inline BatchVec<T> batchMulSign( const BatchVec<T>& a, const BatchVec<T>& b )
+{ BatchVec<T> r; for( int i = 0; i < BatchVec<T>::LANES; i++ ) r.v[i] = b.v[i] < 0 ? -a.v[i] : a.v[i]; return r; }
+
+#if CV_SSE2
+template<> struct BatchVec<float>
+{
+    enum { LANES = 4 };
+    BatchVec() {}
+    explicit BatchVec( float x ) : v(_mm_set1_ps(x)) {}
+    explicit BatchVec( __m128 x ) : v(x) {}
+    static BatchVec load( const float* p ) { return BatchVec(_mm_loadu_ps(p)); }
+    void store( float* p ) const { _mm_storeu_ps(p, v); }
+    __m128 v;
+};
+
+static inline BatchVec<float> operator + ( const BatchVec<float>& a, const BatchVec<float>& b )
+{ return BatchVec<float>(_mm_add_ps(a.v, b.v)); }
+static inline BatchVec<float> operator - ( const BatchVec<float>& a, const BatchVec<float>& b )
+{ return BatchVec<float>(_mm_sub_ps(a.v, b.v)); }
+static inline BatchVec<float> operator * ( const BatchVec<float>& a, const BatchVec<float>& b )
+{ return BatchVec<float>(_mm_mul_ps(a.v, b.v)); }
+static inline BatchVec<float> operator / ( const BatchVec<float>& a, const BatchVec<float>& b )
+{ return BatchVec<float>(_mm_div_ps(a.v, b.v)); }
+template<> inline BatchVec<float> batchSqrt( const BatchVec<float>& a )
+{ return BatchVec<float>(_mm_sqrt_ps(a.v)); }
+template<> inline BatchVec<float> batchAbs( const BatchVec<float>& a )
+{ return BatchVec<float>(_mm_andnot_ps(_mm_set1_ps(-0.f), a.v)); }
+template<> inline BatchVec<float> batchMax( const BatchVec<float>& a, const BatchVec<float>& b )
+{ return BatchVec<float>(_mm_max_ps(a.v, b.v)); }
+template<> inline BatchVec<float> batchMulSign( const BatchVec<float>& a, const BatchVec<float>& b )
+{ return BatchVec<float>(_mm_xor_ps(a.v, _mm_and_ps(b.v, _mm_set1_ps(-0.f)))); }
+
+template<> struct BatchVec<double>
+{
+    enum { LANES = 4 };
+    BatchVec() {}
+    explicit BatchVec( double x ) : v0(_mm_set1_pd(x)), v1(v0) {}
+    BatchVec( __m128d x0, __m128d x1 ) : v0(x0), v1(x1) {}
+    static BatchVec load( const double* p ) { return BatchVec(_mm_loadu_pd(p), _mm_loadu_pd(p + 2)); }
+    void store( double* p ) const { _mm_storeu_pd(p, v0); _mm_storeu_pd(p + 2, v1); }
+    __m128d v0, v1;
+};
+
+static inline BatchVec<double> operator + ( const BatchVec<double>& a, const BatchVec<double>& b )
+{ return BatchVec<double>(_mm_add_pd(a.v0, b.v0), _mm_add_pd(a.v1, b.v1)); }
+static inline BatchVec<double> operator - ( const BatchVec<double>& a, const BatchVec<double>& b )
+{ return BatchVec<double>(_mm_sub_pd(a.v0, b.v0), _mm_sub_pd(a.v1, b.v1)); }
+static inline BatchVec<double> operator * ( const BatchVec<double>& a, const BatchVec<double>& b )
+{ return BatchVec<double>(_mm_mul_pd(a.v0, b.v0), _mm_mul_pd(a.v1, b.v1)); }
+static inline BatchVec<double> operator / ( const BatchVec<double>& a, const BatchVec<double>& b )
+{ return BatchVec<double>(_mm_div_pd(a.v0, b.v0), _mm_div_pd(a.v1, b.v1)); }
+template<> inline BatchVec<double> batchSqrt( const BatchVec<double>& a )
+{ return BatchVec<double>(_mm_sqrt_pd(a.v0), _mm_sqrt_pd(a.v1)); }
+template<> inline BatchVec<double> batchAbs( const BatchVec<double>& a )
+{
+    __m128d m = _mm_set1_pd(-0.);
+    return BatchVec<double>(_mm_andnot_pd(m, a.v0), _mm_andnot_pd(m, a.v1));
+}
+template<> inline BatchVec<double> batchMax( const BatchVec<double>& a, const BatchVec<double>& b )
+{ return BatchVec<double>(_mm_max_pd(a.v0, b.v0), _mm_max_pd(a.v1, b.v1)); }
+template<> inline BatchVec<double> batchMulSign( const BatchVec<double>& a, const BatchVec<double>& b )
+{
+    __m128d m = _mm_set1_pd(-0.);
+    return BatchVec<double>(_mm_xor_pd(a.v0, _mm_and_pd(b.v0, m)), _mm_xor_pd(a.v1, _mm_and_pd(b.v1, m)));
+}
+#endif
+
+/*
+the Jacobi rotation [c s; -s c] that diagonalizes the symmetric 2x2 matrix [a p; p b]:
+t = tan(theta) = 2p*sign(b - a)/(|b - a| + sqrt((b - a)^2 + 4p^2)), c = 1/sqrt(1 + t^2), s = t*c
+*/
+template<typename T> static inline void
+batchJacobiRotation( const BatchVec<T>& a, const BatchVec<T>& b, const BatchVec<T>& p,
+                     BatchVec<T>& t, BatchVec<T>& c, BatchVec<T>& s )
+{
+    BatchVec<T> one((T)1), theta = b - a;
+    BatchVec<T> den = batchAbs(theta) + batchSqrt(theta*theta + p*p*BatchVec<T>((T)4));
+    den = batchMax(den, BatchVec<T>(std::numeric_limits<T>::min()));
+    t = batchMulSign(p + p, theta)/den;
+    c = one/batchSqrt(one + t*t);
+    s = t*c;
+}
+
+template<typename T> static bool batchConverged( const BatchVec<T>& off, const BatchVec<T>& total, T eps )
+{
+    T o[BatchVec<T>::LANES], s[BatchVec<T>::LANES];
+    off.store(o);
+    total.store(s);
+    for( int i = 0; i < BatchVec<T>::LANES; i++ )
+        if( o[i] > s[i]*eps*eps )
+            return false;
+    return true;
+}
+
+enum { BATCH_MAX_SWEEPS = 30 };
+
+// cyclic Jacobi for a group of n x n symmetric matrices; the rows of V get the eigenvectors
+template<typename T> static void
+eigenBatchGroup( BatchVec<T>* A, BatchVec<T>* V, int n )
+{
+    typedef BatchVec<T> VT;
+    const T eps = std::numeric_limits<T>::epsilon();
+    int i, j, k, l, r;
+
+    for( i = 0; V && i < n; i++ )
+        for( j = 0; j < n; j++ )
+            V[i*n + j] = VT((T)(i == j));
+
+    for( int sweep = 0; sweep < BATCH_MAX_SWEEPS; sweep++ )
+    {
+        VT off((T)0), total((T)0);
+        for( i = 0; i < n; i++ )
+            for( j = 0; j < n; j++ )
+            {
+                VT x = A[i*n + j]*A[i*n + j];
+                total = total + x;
+                if( i != j )
+                    off = off + x;
+            }
+        if( batchConverged(off, total, eps) )
+            break;
+
+        for( k = 0; k < n - 1; k++ )
+            for( l = k + 1; l < n; l++ )
+            {
+                VT a = A[k*n + k], b = A[l*n + l], p = A[k*n + l], t, c, s;
+                batchJacobiRotation(a, b, p, t, c, s);
+
+                VT tp = t*p;
+                A[k*n + k] = a - tp;
+                A[l*n + l] = b + tp;
+                A[k*n + l] = A[l*n + k] = VT((T)0);
+
+                for( r = 0; r < n; r++ )
+                {
+                    if( r == k || r == l )
+                        continue;
+                    VT x = A[r*n + k], y = A[r*n + l];
+                    A[r*n + k] = A[k*n + r] = c*x - s*y;
+                    A[r*n + l] = A[l*n + r] = s*x + c*y;
+                }
+                for( r = 0; V && r < n; r++ )
+                {
+                    VT x = V[k*n + r], y = V[l*n + r];
+                    V[k*n + r] = c*x - s*y;
+                    V[l*n + r] = s*x + c*y;
+                }
+            }
+    }
+}
+
+// one-sided Jacobi for a group of matrices, given by the n rows of X of m elements each;
+// the rows become orthogonal, and the rotations are accumulated in the rows of V
+template<typename T> static void
+SVDBatchGroup( BatchVec<T>* X, BatchVec<T>* V, int m, int n )
+{
+    typedef BatchVec<T> VT;
+    const T eps = std::numeric_limits<T>::epsilon()*(sizeof(T) == sizeof(float) ? 1 : 10);
+    int i, j, k;
+
+    for( i = 0; i < n; i++ )
+        for( j = 0; j < n; j++ )
+            V[i*n + j] = VT((T)(i == j));
+
+    for( int sweep = 0; sweep < BATCH_MAX_SWEEPS; sweep++ )
+    {
+        VT maxRatio((T)0);
+        for( i = 0; i < n - 1; i++ )
+            for( j = i + 1; j < n; j++ )
+            {
+                VT *Xi = X + i*m, *Xj = X + j*m, *Vi = V + i*n, *Vj = V + j*n;
+                VT a((T)0), b((T)0), p((T)0), t, c, s;
+                for( k = 0; k < m; k++ )
+                {
+                    a = a + Xi[k]*Xi[k];
+                    b = b + Xj[k]*Xj[k];
+                    p = p + Xi[k]*Xj[k];
+                }
+                maxRatio = batchMax(maxRatio, p*p/batchMax(a*b, VT(std::numeric_limits<T>::min())));
+                batchJacobiRotation(a, b, p, t, c, s);
+
+                for( k = 0; k < m; k++ )
+                {
+                    VT x = Xi[k], y = Xj[k];
+                    Xi[k] = c*x - s*y;
+                    Xj[k] = s*x + c*y;
+                }
+                for( k = 0; k < n; k++ )
+                {
+                    VT x = Vi[k], y = Vj[k];
+                    Vi[k] = c*x - s*y;
+                    Vj[k] = s*x + c*y;
+                }
+            }
+        if( batchConverged(maxRatio, VT((T)1), eps) )
+            break;
+    }
+}
+
+// the indices of the values of the lane sorted in the descending order
+template<typename T> static void
+sortBatchLane( const T* vals, int lane, int n, int* idx )
+{
+    const int L = BatchVec<T>::LANES;
+    for( int i = 0; i < n; i++ )
+        idx[i] = i;
+    for( int i = 0; i < n - 1; i++ )
+    {
+        int m = i;
+        for( int j = i + 1; j < n; j++ )
+            if( vals[idx[j]*L + lane] > vals[idx[m]*L + lane] )
+                m = j;
+        std::swap(idx[i], idx[m]);
+    }
+}
+
+template<typename T> class EigenBatchInvoker : public ParallelLoopBody
+{
+public:
+    EigenBatchInvoker( const Mat& _src, Mat& _evals, Mat& _evects )
+        : src(_src), evals(_evals), evects(_evects) {}
+
+    void operator()( const Range& range ) const
+    {
+        typedef BatchVec<T> VT;
+        const int L = VT::LANES;
+        int N = src.size[0], n = src.size[1], i, j, l;
+        bool computeEvects = evects.data != 0;
+        AutoBuffer<VT> _buf(n*n*2);
+        VT *A = _buf, *V = computeEvects ? A + n*n : 0;
+        AutoBuffer<T> _vals(n*n*L + n*L);
+        T *vals = _vals, *w = vals + n*n*L;
+        AutoBuffer<int> _idx(n);
+        int* idx = _idx;
+
+        for( int g = range.start; g < range.end; g++ )
+        {
+            int b0 = g*L, nb = std::min(L, N - b0);
+
+            // the upper triangle is used; the missing matrices of the last group are zeros
+            for( i = 0; i < n; i++ )
+                for( j = i; j < n; j++ )
+                {
+                    for( l = 0; l < L; l++ )
+                        vals[l] = l < nb ? ((const T*)(src.data + src.step[0]*(b0 + l) + src.step[1]*i))[j] : 0;
+                    A[i*n + j] = A[j*n + i] = VT::load(vals);
+                }
+
+            eigenBatchGroup(A, V, n);
+
+            for( i = 0; i < n; i++ )
+                A[i*n + i].store(w + i*L);
+            for( i = 0; V && i < n*n; i++ )
+                V[i].store(vals + i*L);
+
+            for( l = 0; l < nb; l++ )
+            {
+                sortBatchLane(w, l, n, idx);
+                T* dstw = evals.ptr<T>(b0 + l);
+                for( i = 0; i < n; i++ )
+                    dstw[i] = w[idx[i]*L + l];
+                if( !computeEvects )
+                    continue;
+                for( i = 0; i < n; i++ )
+                {
+                    T* dstv = (T*)(evects.data + evects.step[0]*(b0 + l) + evects.step[1]*i);
+                    for( j = 0; j < n; j++ )
+                        dstv[j] = vals[(idx[i]*n + j)*L + l];
+                }
+            }
+        }
+    }
+
+private:
+    EigenBatchInvoker& operator=(const EigenBatchInvoker&); // to quiet MSVC
+
+    const Mat& src;
+    Mat& evals;
+    Mat& evects;
+};
+
+template<typename T> class SVDBatchInvoker : public ParallelLoopBody
+{
+public:
+    SVDBatchInvoker( const Mat& _src, Mat& _w, Mat& _u, Mat& _vt )
+        : src(_src), w(_w), u(_u), vt(_vt) {}
+
+    void operator()( const Range& range ) const
+    {
+        typedef BatchVec<T> VT;
+        const int L = VT::LANES;
+        int N = src.size[0], m = src.size[1], n = src.size[2], i, j, l;
+        bool at = m < n, computeU = u.data != 0, computeVt = vt.data != 0;
+        bool computeUV = computeU || computeVt;
+        int mm = std::max(m, n), nn = std::min(m, n);
+        size_t esz = src.elemSize();
+        AutoBuffer<VT> _buf(nn*mm + nn*nn);
+        VT *X = _buf, *V = X + nn*mm;
+        AutoBuffer<T> _vals(nn*mm*L + nn*nn*L + nn*L);
+        T *xvals = _vals, *vvals = xvals + nn*mm*L, *sv = vvals + nn*nn*L;
+        AutoBuffer<int> _idx(nn);
+        int* idx = _idx;
+
+        for( int g = range.start; g < range.end; g++ )
+        {
+            int b0 = g*L, nb = std::min(L, N - b0);
+
+            // the rows of X are the columns of the matrix, or the rows if it is wide
+            for( i = 0; i < nn; i++ )
+                for( j = 0; j < mm; j++ )
+                {
+                    size_t ofs = at ? src.step[1]*i + esz*j : src.step[1]*j + esz*i;
+                    for( l = 0; l < L; l++ )
+                        xvals[l] = l < nb ? *(const T*)(src.data + src.step[0]*(b0 + l) + ofs) : 0;
+                    X[i*mm + j] = VT::load(xvals);
+                }
+
+            SVDBatchGroup(X, V, mm, nn);
+
+            for( i = 0; i < nn; i++ )
+            {
+                VT s((T)0);
+                for( j = 0; j < mm; j++ )
+                    s = s + X[i*mm + j]*X[i*mm + j];
+                batchSqrt(s).store(sv + i*L);
+            }
+            for( i = 0; computeUV && i < nn*mm; i++ )
+                X[i].store(xvals + i*L);
+            for( i = 0; computeUV && i < nn*nn; i++ )
+                V[i].store(vvals + i*L);
+
+            for( l = 0; l < nb; l++ )
+            {
+                int b = b0 + l;
+                sortBatchLane(sv, l, nn, idx);
+                T* dstw = w.ptr<T>(b);
+                for( i = 0; i < nn; i++ )
+                    dstw[i] = sv[idx[i]*L + l];
+                if( !computeUV )
+                    continue;
+
+                // the left singular vectors are the normalized rows of X, the right ones are the rows of V
+                for( i = 0; i < nn; i++ )
+                {
+                    T s = sv[idx[i]*L + l];
+                    s = s > 0 ? 1/s : 0;
+                    const T* x = xvals + idx[i]*mm*L + l;
+                    const T* v = vvals + idx[i]*nn*L + l;
+                    for( j = 0; computeU && j < m; j++ )
+                        *(T*)(u.data + u.step[0]*b + u.step[1]*j + esz*i) = !at ? x[j*L]*s : v[j*L];
+                    for( j = 0; computeVt && j < n; j++ )
+                        *(T*)(vt.data + vt.step[0]*b + vt.step[1]*i + esz*j) = !at ? v[j*L] : x[j*L]*s;
+                }
+            }
+        }
+    }
+
+private:
+    SVDBatchInvoker& operator=(const SVDBatchInvoker&); // to quiet MSVC
+
+    const Mat& src;
+    Mat& w;
+    Mat& u;
+    Mat& vt;
+};
+
+}
+
+void cv::eigenBatch( InputArray _src, OutputArray _evals, OutputArray _evects )
+{
+    Mat src = _src.getMat();
+    int type = src.type();
+    CV_Assert( src.dims == 3 && src.size[1] == src.size[2] && (type == CV_32F || type == CV_64F) );
+
+    int N = src.size[0], n = src.size[1];
+    _evals.create(N, n, type);
+    Mat evals = _evals.getMat(), evects;
+    if( _evects.needed() )
+    {
+        _evects.create(3, src.size.p, type);
+        evects = _evects.getMat();
+    }
+
+    int ngroups = (N + BatchVec<float>::LANES - 1)/BatchVec<float>::LANES;
+    if( type == CV_32F )
+        parallel_for_(Range(0, ngroups), EigenBatchInvoker<float>(src, evals, evects));
+    else
+        parallel_for_(Range(0, ngroups), EigenBatchInvoker<double>(src, evals, evects));
+}
+
+void cv::SVDecompBatch( InputArray _src, OutputArray _w, OutputArray _u, OutputArray _vt )
+{
+    Mat src = _src.getMat();
+    int type = src.type();
+    CV_Assert( src.dims == 3 && (type == CV_32F || type == CV_64F) );
+
+    int N = src.size[0], m = src.size[1], n = src.size[2], nm = std::min(m, n);
+    _w.create(N, nm, type);
+    Mat w = _w.getMat(), u, vt;
+    if( _u.needed() )
+    {
+        int usz[] = { N, m, nm };
+        _u.create(3, usz, type);
+        u = _u.getMat();
+    }
+    if( _vt.needed() )
+    {
+        int vsz[] = { N, nm, n };
+        _vt.create(3, vsz, type);
+        vt = _vt.getMat();
+    }
+
+    int ngroups = (N + BatchVec<float>::LANES - 1)/BatchVec<float>::LANES;
+    if( type == CV_32F )
+        parallel_for_(Range(0, ngroups), SVDBatchInvoker<float>(src, w, u, vt));
+    else
+        parallel_for_(Range(0, ngroups), SVDBatchInvoker<double>(src, w, u, vt));
+}
+
 
 CV_IMPL double
 cvDet( const CvArr* arr )
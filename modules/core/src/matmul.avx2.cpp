@@ -0,0 +1,148 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+/*
+   AVX2/FMA microkernels of the blocked GEMM in matmul.cpp; see avx2.hpp for the rules
+   that apply to this file. Each call computes a 6 x NR tile from a packed A panel
+   (6 values per k) and a packed B panel (NR values per k) with all the partial sums
+   kept in 12 ymm registers.
+*/
+
+#include "avx2.hpp"
+
+#if defined CV_TRY_AVX2 && CV_TRY_AVX2
+
+#include <immintrin.h>
+
+namespace cv { namespace avx2 {
+
+namespace
+{
+
+inline void storeRow32f(float* c, __m256 s0, __m256 s1, bool accumulate)
+{
+    if( accumulate )
+    {
+        s0 = _mm256_add_ps(s0, _mm256_loadu_ps(c));
+        s1 = _mm256_add_ps(s1, _mm256_loadu_ps(c + 8));
+    }
+    _mm256_storeu_ps(c, s0);
+    _mm256_storeu_ps(c + 8, s1);
+}
+
+inline void storeRow64f(double* c, __m256d s0, __m256d s1, bool accumulate)
+{
+    if( accumulate )
+    {
+        s0 = _mm256_add_pd(s0, _mm256_loadu_pd(c));
+        s1 = _mm256_add_pd(s1, _mm256_loadu_pd(c + 4));
+    }
+    _mm256_storeu_pd(c, s0);
+    _mm256_storeu_pd(c + 4, s1);
+}
+
+}
+
+void gemmKernel32f(int kc, const float* a, const float* b, float* c, size_t ldc, bool accumulate)
+{
+    __m256 s00 = _mm256_setzero_ps(), s01 = s00, s10 = s00, s11 = s00, s20 = s00, s21 = s00;
+    __m256 s30 = s00, s31 = s00, s40 = s00, s41 = s00, s50 = s00, s51 = s00;
+
+    for( int k = 0; k < kc; k++, a += GEMM_MR, b += GEMM_NR_32F )
+    {
+        __m256 b0 = _mm256_loadu_ps(b), b1 = _mm256_loadu_ps(b + 8);
+        __m256 t = _mm256_broadcast_ss(a);
+        s00 = _mm256_fmadd_ps(t, b0, s00); s01 = _mm256_fmadd_ps(t, b1, s01);
+        t = _mm256_broadcast_ss(a + 1);
+        s10 = _mm256_fmadd_ps(t, b0, s10); s11 = _mm256_fmadd_ps(t, b1, s11);
+        t = _mm256_broadcast_ss(a + 2);
+        s20 = _mm256_fmadd_ps(t, b0, s20); s21 = _mm256_fmadd_ps(t, b1, s21);
+        t = _mm256_broadcast_ss(a + 3);
+        s30 = _mm256_fmadd_ps(t, b0, s30); s31 = _mm256_fmadd_ps(t, b1, s31);
+        t = _mm256_broadcast_ss(a + 4);
+        s40 = _mm256_fmadd_ps(t, b0, s40); s41 = _mm256_fmadd_ps(t, b1, s41);
+        t = _mm256_broadcast_ss(a + 5);
+        s50 = _mm256_fmadd_ps(t, b0, s50); s51 = _mm256_fmadd_ps(t, b1, s51);
+    }
+
+    storeRow32f(c, s00, s01, accumulate);
+    storeRow32f(c + ldc, s10, s11, accumulate);
+    storeRow32f(c + ldc*2, s20, s21, accumulate);
+    storeRow32f(c + ldc*3, s30, s31, accumulate);
+    storeRow32f(c + ldc*4, s40, s41, accumulate);
+    storeRow32f(c + ldc*5, s50, s51, accumulate);
+}
+
+void gemmKernel64f(int kc, const double* a, const double* b, double* c, size_t ldc, bool accumulate)
+{
+    __m256d s00 = _mm256_setzero_pd(), s01 = s00, s10 = s00, s11 = s00, s20 = s00, s21 = s00;
+    __m256d s30 = s00, s31 = s00, s40 = s00, s41 = s00, s50 = s00, s51 = s00;
+
+    for( int k = 0; k < kc; k++, a += GEMM_MR, b += GEMM_NR_64F )
+    {
+        __m256d b0 = _mm256_loadu_pd(b), b1 = _mm256_loadu_pd(b + 4);
+        __m256d t = _mm256_broadcast_sd(a);
+        s00 = _mm256_fmadd_pd(t, b0, s00); s01 = _mm256_fmadd_pd(t, b1, s01);
+        t = _mm256_broadcast_sd(a + 1);
+        s10 = _mm256_fmadd_pd(t, b0, s10); s11 = _mm256_fmadd_pd(t, b1, s11);
+        t = _mm256_broadcast_sd(a + 2);
+        s20 = _mm256_fmadd_pd(t, b0, s20); s21 = _mm256_fmadd_pd(t, b1, s21);
+        t = _mm256_broadcast_sd(a + 3);
+        s30 = _mm256_fmadd_pd(t, b0, s30); s31 = _mm256_fmadd_pd(t, b1, s31);
+        t = _mm256_broadcast_sd(a + 4);
+        s40 = _mm256_fmadd_pd(t, b0, s40); s41 = _mm256_fmadd_pd(t, b1, s41);
+        t = _mm256_broadcast_sd(a + 5);
+        s50 = _mm256_fmadd_pd(t, b0, s50); s51 = _mm256_fmadd_pd(t, b1, s51);
+    }
+
+    storeRow64f(c, s00, s01, accumulate);
+    storeRow64f(c + ldc, s10, s11, accumulate);
+    storeRow64f(c + ldc*2, s20, s21, accumulate);
+    storeRow64f(c + ldc*3, s30, s31, accumulate);
+    storeRow64f(c + ldc*4, s40, s41, accumulate);
+    storeRow64f(c + ldc*5, s50, s51, accumulate);
+}
+
+}}
+
+#endif
@@ -41,6 +41,7 @@
 //M*/
 
 #include "precomp.hpp"
+#include "avx2.hpp"
 
 #ifdef HAVE_IPP
 #include "ippversion.h"
@@ -695,6 +696,334 @@ static void GEMMStore_64fc( const Complexd* c_data, size_t c_step,
 
 }
 
+/****************************************************************************************\
+*                              Blocked GEMM for large matrices                           *
+\****************************************************************************************/
+
+/*
+   Large real matrices are multiplied in macro-tiles of (at most) GEMM_MC x GEMM_NC elements
+   of D. For every step of KC along the inner dimension the corresponding parts of A and B are
+   packed into panels of MR rows and NR columns (zero-padded at the borders), so that the
+   register-tiled microkernel reads both operands sequentially whatever the transposition flags.
+   The macro-tiles are processed in parallel. When there are too few of them to keep all the
+   threads busy (tall-skinny products such as A^T*A in calcCovarMatrix) the inner dimension
+   is split as well and the partial sums are added up before the final store.
+   The products of single-precision matrices are accumulated in double precision, like the
+   rest of gemm() does, unless GEMM_FAST_32F is passed: then the float kernel is used.
+*/
+
+namespace cv
+{
+
+enum { GEMM_MC = 96, GEMM_NC = 256 };
+
+template<typename T> struct GEMMKernel
+{
+    typedef void (*Func)( int kc, const T* a, const T* b, T* c, size_t ldc, bool accumulate );
+    int MR, NR, KC;
+    Func func;
+};
+
+// c[i*ldc + j] (+)= sum_k a[k*MR + i]*b[k*NR + j]
+template<typename T, int MR, int NR> static void
+GEMMKernel_( int kc, const T* a, const T* b, T* c, size_t ldc, bool accumulate )
+{
+    T s[MR*NR];
+    int i, j, k;
+    for( i = 0; i < MR*NR; i++ )
+        s[i] = 0;
+    for( k = 0; k < kc; k++, a += MR, b += NR )
+        for( i = 0; i < MR; i++ )
+        {
+            T ai = a[i];
+            for( j = 0; j < NR; j++ )
+                s[i*NR + j] += ai*b[j];
+        }
+    for( i = 0; i < MR; i++, c += ldc )
+        for( j = 0; j < NR; j++ )
+            c[j] = accumulate ? c[j] + s[i*NR + j] : s[i*NR + j];
+}
+
+#if CV_SSE2
+
+// 4 x 8 tile
+static void GEMMKernel_32f_SSE2( int kc, const float* a, const float* b, float* c, size_t ldc, bool accumulate )
+{
+    __m128 s00 = _mm_setzero_ps(), s01 = s00, s10 = s00, s11 = s00;
+    __m128 s20 = s00, s21 = s00, s30 = s00, s31 = s00;
+
+    for( int k = 0; k < kc; k++, a += 4, b += 8 )
+    {
+        __m128 b0 = _mm_loadu_ps(b), b1 = _mm_loadu_ps(b + 4);
+        __m128 a4 = _mm_loadu_ps(a), t;
+        t = _mm_shuffle_ps(a4, a4, 0);
+        s00 = _mm_add_ps(s00, _mm_mul_ps(t, b0)); s01 = _mm_add_ps(s01, _mm_mul_ps(t, b1));
+        t = _mm_shuffle_ps(a4, a4, 0x55);
+        s10 = _mm_add_ps(s10, _mm_mul_ps(t, b0)); s11 = _mm_add_ps(s11, _mm_mul_ps(t, b1));
+        t = _mm_shuffle_ps(a4, a4, 0xaa);
+        s20 = _mm_add_ps(s20, _mm_mul_ps(t, b0)); s21 = _mm_add_ps(s21, _mm_mul_ps(t, b1));
+        t = _mm_shuffle_ps(a4, a4, 0xff);
+        s30 = _mm_add_ps(s30, _mm_mul_ps(t, b0)); s31 = _mm_add_ps(s31, _mm_mul_ps(t, b1));
+    }
+
+    if( accumulate )
+    {
+        s00 = _mm_add_ps(s00, _mm_loadu_ps(c)); s01 = _mm_add_ps(s01, _mm_loadu_ps(c + 4));
+        s10 = _mm_add_ps(s10, _mm_loadu_ps(c + ldc)); s11 = _mm_add_ps(s11, _mm_loadu_ps(c + ldc + 4));
+        s20 = _mm_add_ps(s20, _mm_loadu_ps(c + ldc*2)); s21 = _mm_add_ps(s21, _mm_loadu_ps(c + ldc*2 + 4));
+        s30 = _mm_add_ps(s30, _mm_loadu_ps(c + ldc*3)); s31 = _mm_add_ps(s31, _mm_loadu_ps(c + ldc*3 + 4));
+    }
+    _mm_storeu_ps(c, s00); _mm_storeu_ps(c + 4, s01);
+    _mm_storeu_ps(c + ldc, s10); _mm_storeu_ps(c + ldc + 4, s11);
+    _mm_storeu_ps(c + ldc*2, s20); _mm_storeu_ps(c + ldc*2 + 4, s21);
+    _mm_storeu_ps(c + ldc*3, s30); _mm_storeu_ps(c + ldc*3 + 4, s31);
+}
+
+// 4 x 4 tile
+static void GEMMKernel_64f_SSE2( int kc, const double* a, const double* b, double* c, size_t ldc, bool accumulate )
+{
+    __m128d s00 = _mm_setzero_pd(), s01 = s00, s10 = s00, s11 = s00;
+    __m128d s20 = s00, s21 = s00, s30 = s00, s31 = s00;
+
+    for( int k = 0; k < kc; k++, a += 4, b += 4 )
+    {
+        __m128d b0 = _mm_loadu_pd(b), b1 = _mm_loadu_pd(b + 2), t;
+        t = _mm_load1_pd(a);
+        s00 = _mm_add_pd(s00, _mm_mul_pd(t, b0)); s01 = _mm_add_pd(s01, _mm_mul_pd(t, b1));
+        t = _mm_load1_pd(a + 1);
+        s10 = _mm_add_pd(s10, _mm_mul_pd(t, b0)); s11 = _mm_add_pd(s11, _mm_mul_pd(t, b1));
+        t = _mm_load1_pd(a + 2);
+        s20 = _mm_add_pd(s20, _mm_mul_pd(t, b0)); s21 = _mm_add_pd(s21, _mm_mul_pd(t, b1));
+        t = _mm_load1_pd(a + 3);
+        s30 = _mm_add_pd(s30, _mm_mul_pd(t, b0)); s31 = _mm_add_pd(s31, _mm_mul_pd(t, b1));
+    }
+
+    if( accumulate )
+    {
+        s00 = _mm_add_pd(s00, _mm_loadu_pd(c)); s01 = _mm_add_pd(s01, _mm_loadu_pd(c + 2));
+        s10 = _mm_add_pd(s10, _mm_loadu_pd(c + ldc)); s11 = _mm_add_pd(s11, _mm_loadu_pd(c + ldc + 2));
+        s20 = _mm_add_pd(s20, _mm_loadu_pd(c + ldc*2)); s21 = _mm_add_pd(s21, _mm_loadu_pd(c + ldc*2 + 2));
+        s30 = _mm_add_pd(s30, _mm_loadu_pd(c + ldc*3)); s31 = _mm_add_pd(s31, _mm_loadu_pd(c + ldc*3 + 2));
+    }
+    _mm_storeu_pd(c, s00); _mm_storeu_pd(c + 2, s01);
+    _mm_storeu_pd(c + ldc, s10); _mm_storeu_pd(c + ldc + 2, s11);
+    _mm_storeu_pd(c + ldc*2, s20); _mm_storeu_pd(c + ldc*2 + 2, s21);
+    _mm_storeu_pd(c + ldc*3, s30); _mm_storeu_pd(c + ldc*3 + 2, s31);
+}
+
+#endif
+
+#if CV_SSE2
+#  define GEMM_SSE2_VARIANT(func) CV_CPU_SSE2, func
+#else
+#  define GEMM_SSE2_VARIANT(func) CV_CPU_NONE, 0
+#endif
+
+static DispatchedKernel<GEMMKernel<float>::Func>
+    gemm32fKernel("gemm32f", GEMM_SSE2_VARIANT(GEMMKernel_32f_SSE2), CV_AVX2_VARIANT(gemmKernel32f));
+static DispatchedKernel<GEMMKernel<double>::Func>
+    gemm64fKernel("gemm64f", GEMM_SSE2_VARIANT(GEMMKernel_64f_SSE2), CV_AVX2_VARIANT(gemmKernel64f));
+
+static void getGEMMKernel( GEMMKernel<float>& k )
+{
+    k.KC = 256;
+    k.MR = 4; k.NR = 8;
+    k.func = gemm32fKernel.get();
+    if( !k.func )
+        k.func = GEMMKernel_<float, 4, 8>;
+#if CV_TRY_AVX2
+    else if( gemm32fKernel.feature() == CV_CPU_AVX2 )
+    {
+        k.MR = avx2::GEMM_MR; k.NR = avx2::GEMM_NR_32F;
+    }
+#endif
+}
+
+static void getGEMMKernel( GEMMKernel<double>& k )
+{
+    k.KC = 128;
+    k.MR = 4; k.NR = 4;
+    k.func = gemm64fKernel.get();
+    if( !k.func )
+        k.func = GEMMKernel_<double, 4, 4>;
+#if CV_TRY_AVX2
+    else if( gemm64fKernel.feature() == CV_CPU_AVX2 )
+    {
+        k.MR = avx2::GEMM_MR; k.NR = avx2::GEMM_NR_64F;
+    }
+#endif
+}
+
+// packs the n x kc block src[i*istep + k*kstep] into panels of w rows stored k-major;
+// the last panel is padded with zeros
+template<typename T, typename WT> static void
+GEMMPackPanels( const T* src, size_t istep, size_t kstep, int n, int kc, int w, WT* buf )
+{
+    for( int i = 0; i < n; i += w, src += istep*w )
+    {
+        int r, m = std::min(w, n - i);
+        const T* s = src;
+        for( int k = 0; k < kc; k++, s += kstep, buf += w )
+        {
+            for( r = 0; r < m; r++ )
+                buf[r] = s[r*istep];
+            for( ; r < w; r++ )
+                buf[r] = 0;
+        }
+    }
+}
+
+// T is the matrix type, WT is the accumulator type
+template<typename T, typename WT> class GEMMBlockedInvoker : public ParallelLoopBody
+{
+public:
+    // steps are in elements; (i, j, k) address A(i,k), B(k,j), C(i,j) in the order of the flags
+    GEMMBlockedInvoker( const T* _a, size_t _astep0, size_t _astep1,
+                        const T* _b, size_t _bstep0, size_t _bstep1,
+                        const T* _c, size_t _cstep0, size_t _cstep1,
+                        T* _d, size_t _dstep, int _M, int _N, int _K,
+                        double _alpha, double _beta )
+        : a(_a), b(_b), c(_c), d(_d), astep0(_astep0), astep1(_astep1),
+          bstep0(_bstep0), bstep1(_bstep1), cstep0(_cstep0), cstep1(_cstep1), dstep(_dstep),
+          M(_M), N(_N), K(_K), alpha(_alpha), beta(_beta), ksplit(1), partial(0)
+    {
+        getGEMMKernel(kernel);
+        ntilesN = (N + GEMM_NC - 1)/GEMM_NC;
+        ntiles = ((M + GEMM_MC - 1)/GEMM_MC)*ntilesN;
+        kblocks = (K + kernel.KC - 1)/kernel.KC;
+        mcPad = alignSize(GEMM_MC, kernel.MR);
+    }
+
+    int tiles() const { return ntiles; }
+
+    void run()
+    {
+        int nthreads = getNumThreads();
+        AutoBuffer<WT> partialBuf;
+        if( ntiles < nthreads && kblocks > 1 )
+        {
+            ksplit = std::min(kblocks, (nthreads + ntiles - 1)/ntiles);
+            partialBuf.allocate((size_t)ntiles*ksplit*mcPad*GEMM_NC);
+            partial = partialBuf;
+        }
+
+        parallel_for_(Range(0, ntiles*ksplit), *this);
+
+        for( int t = 0; ksplit > 1 && t < ntiles; t++ )
+        {
+            WT* acc = partial + (size_t)t*ksplit*mcPad*GEMM_NC;
+            int i0, j0, mc, nc;
+            getTile(t, i0, j0, mc, nc);
+            for( int ks = 1; ks < ksplit; ks++ )
+            {
+                const WT* p = acc + (size_t)ks*mcPad*GEMM_NC;
+                for( int i = 0; i < mc; i++ )
+                    for( int j = 0; j < nc; j++ )
+                        acc[i*GEMM_NC + j] += p[i*GEMM_NC + j];
+            }
+            store(acc, i0, j0, mc, nc);
+        }
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int MR = kernel.MR, NR = kernel.NR, KC = kernel.KC;
+        AutoBuffer<WT> _buf((size_t)mcPad*KC + (size_t)KC*GEMM_NC + (ksplit == 1 ? mcPad*GEMM_NC : 0));
+        WT* abuf = _buf;
+        WT* bbuf = abuf + (size_t)mcPad*KC;
+
+        for( int t = range.start; t < range.end; t++ )
+        {
+            int tile = t / ksplit, ks = t % ksplit;
+            int i0, j0, mc, nc;
+            getTile(tile, i0, j0, mc, nc);
+            WT* acc = ksplit == 1 ? bbuf + (size_t)KC*GEMM_NC : partial + (size_t)t*mcPad*GEMM_NC;
+            int kb0 = kblocks*ks/ksplit, kb1 = kblocks*(ks + 1)/ksplit;
+
+            for( int kb = kb0; kb < kb1; kb++ )
+            {
+                int k0 = kb*KC, kc = std::min(KC, K - k0);
+                GEMMPackPanels(a + i0*astep0 + k0*astep1, astep0, astep1, mc, kc, MR, abuf);
+                GEMMPackPanels(b + k0*bstep0 + j0*bstep1, bstep1, bstep0, nc, kc, NR, bbuf);
+
+                for( int j = 0; j < nc; j += NR )
+                    for( int i = 0; i < mc; i += MR )
+                        kernel.func(kc, abuf + i*kc, bbuf + j*kc, acc + i*GEMM_NC + j,
+                                    GEMM_NC, kb > kb0);
+            }
+
+            if( ksplit == 1 )
+                store(acc, i0, j0, mc, nc);
+        }
+    }
+
+private:
+    void getTile( int tile, int& i0, int& j0, int& mc, int& nc ) const
+    {
+        i0 = (tile / ntilesN)*GEMM_MC;
+        j0 = (tile % ntilesN)*GEMM_NC;
+        mc = std::min((int)GEMM_MC, M - i0);
+        nc = std::min((int)GEMM_NC, N - j0);
+    }
+
+    // D = alpha*acc + beta*C
+    void store( const WT* acc, int i0, int j0, int mc, int nc ) const
+    {
+        for( int i = 0; i < mc; i++, acc += GEMM_NC )
+        {
+            T* dst = d + (i0 + i)*dstep + j0;
+            if( c )
+            {
+                const T* src = c + (i0 + i)*cstep0 + j0*cstep1;
+                for( int j = 0; j < nc; j++ )
+                    dst[j] = saturate_cast<T>(acc[j]*alpha + src[j*cstep1]*beta);
+            }
+            else
+                for( int j = 0; j < nc; j++ )
+                    dst[j] = saturate_cast<T>(acc[j]*alpha);
+        }
+    }
+
+    const T *a, *b, *c;
+    T* d;
+    size_t astep0, astep1, bstep0, bstep1, cstep0, cstep1, dstep;
+    int M, N, K;
+    double alpha, beta;
+    GEMMKernel<WT> kernel;
+    int ntiles, ntilesN, kblocks, mcPad, ksplit;
+    WT* partial;
+};
+
+// packing pays off already for rather small products; the tiny ones keep the direct loops
+static inline bool useBlockedGEMM( int type, int M, int N, int K )
+{
+    return (type == CV_32FC1 || type == CV_64FC1) && M >= 8 && N >= 8 && K >= 8 &&
+           (double)M*N*K >= 16*16*16;
+}
+
+template<typename T, typename WT> static void
+blockedGEMM( const Mat& A, const Mat& B, double alpha, const Mat& C, double beta,
+             Mat& D, int flags, int len )
+{
+    size_t esz = sizeof(T);
+    size_t astep0 = A.step/esz, astep1 = 1, bstep0 = B.step/esz, bstep1 = 1;
+    size_t cstep0 = C.data ? C.step/esz : 0, cstep1 = 1;
+
+    if( flags & GEMM_1_T )
+        std::swap(astep0, astep1);
+    if( flags & GEMM_2_T )
+        std::swap(bstep0, bstep1);
+    if( flags & GEMM_3_T )
+        std::swap(cstep0, cstep1);
+
+    GEMMBlockedInvoker<T, WT> invoker((const T*)A.data, astep0, astep1, (const T*)B.data, bstep0, bstep1,
+                                  C.data ? (const T*)C.data : 0, cstep0, cstep1,
+                                  (T*)D.data, D.step/esz, D.rows, D.cols, len, alpha, beta);
+    invoker.run();
+}
+
+}
+
 void cv::gemm( InputArray matA, InputArray matB, double alpha,
            InputArray matC, double beta, OutputArray _matD, int flags )
 {
@@ -707,6 +1036,8 @@ void cv::gemm( InputArray matA, InputArray matB, double alpha,
     Mat A = matA.getMat(), B = matB.getMat(), C = beta != 0 ? matC.getMat() : Mat();
     Size a_size = A.size(), d_size;
     int i, len = 0, type = A.type();
+    bool fast32f = (flags & GEMM_FAST_32F) != 0;
+    flags &= ~GEMM_FAST_32F;
 
     CV_Assert( type == B.type() && (type == CV_32FC1 || type == CV_64FC1 || type == CV_32FC2 || type == CV_64FC2) );
 
@@ -1050,6 +1381,19 @@ void cv::gemm( InputArray matA, InputArray matB, double alpha,
         matD = &tmat;
     }
 
+    if( useBlockedGEMM(type, d_size.height, d_size.width, len) )
+    {
+        if( type == CV_32FC1 && fast32f )
+            blockedGEMM<float, float>(A, B, alpha, C, beta, *matD, flags, len);
+        else if( type == CV_32FC1 )
+            blockedGEMM<float, double>(A, B, alpha, C, beta, *matD, flags, len);
+        else
+            blockedGEMM<double, double>(A, B, alpha, C, beta, *matD, flags, len);
+        if( matD != &D )
+            matD->copyTo(D);
+        return;
+    }
+
     if( (d_size.width == 1 || len == 1) && !(flags & GEMM_2_T) && B.isContinuous() )
     {
         b_step = d_size.width == 1 ? 0 : CV_ELEM_SIZE(type);
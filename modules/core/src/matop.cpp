@@ -204,6 +204,26 @@ public:
 
 static MatOp_Initializer g_MatOp_Initializer;
 
+class MatOp_Fused : public MatOp
+{
+public:
+    MatOp_Fused() {}
+    virtual ~MatOp_Fused() {}
+
+    bool elementWise(const MatExpr& /*expr*/) const { return true; }
+    void assign(const MatExpr& expr, Mat& m, int type=-1) const;
+
+    void roi(const MatExpr& expr, const Range& rowRange, const Range& colRange, MatExpr& res) const;
+    void diag(const MatExpr& expr, int d, MatExpr& res) const;
+
+    Size size(const MatExpr& expr) const;
+    int type(const MatExpr& expr) const;
+
+    static void makeExpr(MatExpr& res, const Ptr<MatExprProgram>& program);
+};
+
+static MatOp_Fused g_MatOp_Fused;
+
 static inline bool isIdentity(const MatExpr& e) { return e.op == &g_MatOp_Identity; }
 static inline bool isAddEx(const MatExpr& e) { return e.op == &g_MatOp_AddEx; }
 static inline bool isScaled(const MatExpr& e) { return isAddEx(e) && (!e.b.data || e.beta == 0) && e.s == Scalar(); }
@@ -216,6 +236,228 @@ static inline bool isSolve(const MatExpr& e) { return e.op == &g_MatOp_Solve; }
 static inline bool isGEMM(const MatExpr& e) { return e.op == &g_MatOp_GEMM; }
 static inline bool isMatProd(const MatExpr& e) { return e.op == &g_MatOp_GEMM && (!e.c.data || e.beta == 0); }
 static inline bool isInitializer(const MatExpr& e) { return e.op == &g_MatOp_Initializer; }
+static inline bool isFused(const MatExpr& e) { return e.op == &g_MatOp_Fused; }
+
+/*
+   Single-pass evaluation of element-wise expressions.
+
+   Chains like a*alpha + b*beta - c, abs(a - b) > thresh or min(a.mul(b), c) are recorded
+   as a list of nodes over the input matrices instead of being computed one operation
+   at a time. The whole list is then evaluated by rows, in blocks of BLOCK_SIZE elements,
+   so the intermediate results stay in the cache and every input is read only once.
+   Each node saturates its result to the depth that the standalone operation would
+   produce, so the fused expression gives the same result as the step-by-step one.
+*/
+class MatExprProgram
+{
+public:
+    enum { OP_LOAD=0, OP_ADD, OP_MUL, OP_ABSDIFF, OP_MIN, OP_MAX, OP_CMP };
+    // longer chains are split by evaluating the already fused part into a temporary matrix
+    enum { MAX_NODES = 32 };
+
+    struct Node
+    {
+        int op;
+        int a, b;       // operand nodes (or the input index for OP_LOAD); b < 0 means "use s"
+        int depth;      // depth of the result
+        int cmpop;
+        bool scalarAll; // s[0] is applied to all the channels, as in convertTo() or addWeighted()
+        double alpha, beta;
+        Scalar s;
+    };
+
+    MatExprProgram() : cn(-1) {}
+
+    int load(const Mat& m);
+    int append(const MatExpr& e);
+    int addEx(int a, int b, double alpha, double beta, const Scalar& s);
+    int binary(int op, int a, int b, double alpha=1, int cmpop=0);
+    int binary(int op, int a, const Scalar& s, bool scalarAll);
+    int compare(int cmpop, int a, double s);
+
+    void run(Mat& dst, int type=-1) const;
+    int resultType() const { return CV_MAKETYPE(nodes.back().depth, cn); }
+    bool isProfitable() const;
+
+    std::vector<Mat> inputs;
+    std::vector<Node> nodes;
+    Size size;
+    int cn;
+
+private:
+    int addNode(int op, int a, int b, int depth, double alpha=1, double beta=0,
+                const Scalar& s=Scalar(), bool scalarAll=false, int cmpop=0);
+};
+
+template<> void Ptr<MatExprProgram>::delete_obj()
+{
+    delete obj;
+}
+
+// the operations that MatExprProgram can evaluate without a temporary matrix
+static inline bool isFusable(const MatExpr& e)
+{
+    return isFused(e) || isAddEx(e) || isCmp(e) ||
+           isBin(e, '*') || isBin(e, 'm') || isBin(e, 'M') || isBin(e, 'a');
+}
+
+static inline bool makeFusedExpr(MatExpr& res, const Ptr<MatExprProgram>& p)
+{
+    if( !p->isProfitable() )
+        return false;
+    MatOp_Fused::makeExpr(res, p);
+    return true;
+}
+
+static inline bool isAbsorbedByAddEx(const MatExpr& e)
+{
+    return isAddEx(e) && (!e.b.data || e.beta == 0);
+}
+
+// e1 + e2*sign, with the scaled operands absorbed the same way as in MatOp::add()
+static bool fuseAddEx(const MatExpr& e1, const MatExpr& e2, double sign, MatExpr& res)
+{
+    bool scaled1 = isAbsorbedByAddEx(e1), scaled2 = isAbsorbedByAddEx(e2);
+    if( !(!scaled1 && isFusable(e1)) && !(!scaled2 && isFusable(e2)) )
+        return false;
+
+    Ptr<MatExprProgram> p = new MatExprProgram;
+    double alpha = 1, beta = sign;
+    Scalar s;
+    int n1 = -1, n2 = -1;
+    if( scaled1 )
+    {
+        n1 = p->load(e1.a);
+        alpha = e1.alpha;
+        s = e1.s;
+    }
+    else
+        n1 = p->append(e1);
+
+    if( n1 >= 0 && scaled2 )
+    {
+        n2 = p->load(e2.a);
+        beta = sign*e2.alpha;
+        s += e2.s*sign;
+    }
+    else if( n1 >= 0 )
+        n2 = p->append(e2);
+
+    if( n2 < 0 || p->addEx(n1, n2, alpha, beta, s) < 0 )
+        return false;
+    return makeFusedExpr(res, p);
+}
+
+// e*alpha + s
+static bool fuseAddEx(const MatExpr& e, double alpha, const Scalar& s, MatExpr& res)
+{
+    if( !isFusable(e) )
+        return false;
+    Ptr<MatExprProgram> p = new MatExprProgram;
+    if( p->addEx(p->append(e), -1, alpha, 0, s) < 0 )
+        return false;
+    return makeFusedExpr(res, p);
+}
+
+// e1.mul(e2, scale), with the scaled operands absorbed the same way as in MatOp::multiply()
+static bool fuseMul(const MatExpr& e1, const MatExpr& e2, double scale, MatExpr& res)
+{
+    bool scaled1 = isScaled(e1), scaled2 = isScaled(e2);
+    if( !(!scaled1 && isFusable(e1)) && !(!scaled2 && isFusable(e2)) )
+        return false;
+
+    Ptr<MatExprProgram> p = new MatExprProgram;
+    int n1 = scaled1 ? p->load(e1.a) : p->append(e1);
+    int n2 = n1 < 0 ? -1 : scaled2 ? p->load(e2.a) : p->append(e2);
+    if( scaled1 )
+        scale *= e1.alpha;
+    if( scaled2 )
+        scale *= e2.alpha;
+    if( p->binary(MatExprProgram::OP_MUL, n1, n2, scale) < 0 )
+        return false;
+    return makeFusedExpr(res, p);
+}
+
+static bool fuseAbs(const MatExpr& e, MatExpr& res)
+{
+    if( !isFusable(e) )
+        return false;
+    Ptr<MatExprProgram> p = new MatExprProgram;
+    if( p->binary(MatExprProgram::OP_ABSDIFF, p->append(e), Scalar(), false) < 0 )
+        return false;
+    return makeFusedExpr(res, p);
+}
+
+// m += e*sign, computed in-place without the temporary matrix for e
+static bool fuseAugAssign(const MatExpr& e, Mat& m, double sign)
+{
+    if( !isFusable(e) || !m.data || m.dims > 2 || m.size() != e.size() || m.type() != e.type() )
+        return false;
+    MatExprProgram p;
+    int n0 = p.load(m);
+    if( p.addEx(n0, n0 < 0 ? -1 : p.append(e), 1, sign, Scalar()) < 0 || !p.isProfitable() )
+        return false;
+    p.run(m, m.type());
+    return true;
+}
+
+static void makeMinMaxExpr(MatExpr& res, char op, const MatExpr& e1, const MatExpr& e2)
+{
+    if( isFusable(e1) || isFusable(e2) )
+    {
+        Ptr<MatExprProgram> p = new MatExprProgram;
+        int n1 = p->append(e1), n2 = n1 < 0 ? -1 : p->append(e2);
+        if( p->binary(op == 'm' ? MatExprProgram::OP_MIN : MatExprProgram::OP_MAX, n1, n2) >= 0 &&
+            makeFusedExpr(res, p) )
+            return;
+    }
+    Mat m1, m2;
+    e1.op->assign(e1, m1);
+    e2.op->assign(e2, m2);
+    MatOp_Bin::makeExpr(res, op, m1, m2);
+}
+
+static void makeMinMaxExpr(MatExpr& res, char op, const MatExpr& e, double s)
+{
+    if( isFusable(e) )
+    {
+        Ptr<MatExprProgram> p = new MatExprProgram;
+        if( p->binary(op == 'm' ? MatExprProgram::OP_MIN : MatExprProgram::OP_MAX,
+                      p->append(e), Scalar::all(s), true) >= 0 && makeFusedExpr(res, p) )
+            return;
+    }
+    Mat m;
+    e.op->assign(e, m);
+    MatOp_Bin::makeExpr(res, op, m, s);
+}
+
+static void makeCmpExpr(MatExpr& res, int cmpop, const MatExpr& e1, const MatExpr& e2)
+{
+    if( isFusable(e1) || isFusable(e2) )
+    {
+        Ptr<MatExprProgram> p = new MatExprProgram;
+        int n1 = p->append(e1), n2 = n1 < 0 ? -1 : p->append(e2);
+        if( p->binary(MatExprProgram::OP_CMP, n1, n2, 1, cmpop) >= 0 && makeFusedExpr(res, p) )
+            return;
+    }
+    Mat m1, m2;
+    e1.op->assign(e1, m1);
+    e2.op->assign(e2, m2);
+    MatOp_Cmp::makeExpr(res, cmpop, m1, m2);
+}
+
+static void makeCmpExpr(MatExpr& res, int cmpop, const MatExpr& e, double s)
+{
+    if( isFusable(e) )
+    {
+        Ptr<MatExprProgram> p = new MatExprProgram;
+        if( p->compare(cmpop, p->append(e), s) >= 0 && makeFusedExpr(res, p) )
+            return;
+    }
+    Mat m;
+    e.op->assign(e, m);
+    MatOp_Cmp::makeExpr(res, cmpop, m, s);
+}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -269,6 +511,8 @@ void MatOp::diag(const MatExpr& expr, int d, MatExpr& e) const
 
 void MatOp::augAssignAdd(const MatExpr& expr, Mat& m) const
 {
+    if( fuseAugAssign(expr, m, 1) )
+        return;
     Mat temp;
     expr.op->assign(expr, temp);
     m += temp;
@@ -277,6 +521,8 @@ void MatOp::augAssignAdd(const MatExpr& expr, Mat& m) const
 
 void MatOp::augAssignSubtract(const MatExpr& expr, Mat& m) const
 {
+    if( fuseAugAssign(expr, m, -1) )
+        return;
     Mat temp;
     expr.op->assign(expr, temp);
     m -= temp;
@@ -327,6 +573,9 @@ void MatOp::add(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 {
     if( this == e2.op )
     {
+        if( fuseAddEx(e1, e2, 1, res) )
+            return;
+
         double alpha = 1, beta = 1;
         Scalar s;
         Mat m1, m2;
@@ -356,6 +605,8 @@ void MatOp::add(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 
 void MatOp::add(const MatExpr& expr1, const Scalar& s, MatExpr& res) const
 {
+    if( fuseAddEx(expr1, 1, s, res) )
+        return;
     Mat m1;
     expr1.op->assign(expr1, m1);
     MatOp_AddEx::makeExpr(res, m1, Mat(), 1, 0, s);
@@ -366,6 +617,9 @@ void MatOp::subtract(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 {
     if( this == e2.op )
     {
+        if( fuseAddEx(e1, e2, -1, res) )
+            return;
+
         double alpha = 1, beta = -1;
         Scalar s;
         Mat m1, m2;
@@ -395,6 +649,8 @@ void MatOp::subtract(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 
 void MatOp::subtract(const Scalar& s, const MatExpr& expr, MatExpr& res) const
 {
+    if( fuseAddEx(expr, -1, s, res) )
+        return;
     Mat m;
     expr.op->assign(expr, m);
     MatOp_AddEx::makeExpr(res, m, Mat(), -1, 0, s);
@@ -419,6 +675,8 @@ void MatOp::multiply(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double
 
             MatOp_Bin::makeExpr(res, '/', m2, e1.a, scale/e1.alpha);
         }
+        else if( !isReciprocal(e2) && fuseMul(e1, e2, scale, res) )
+            return;
         else
         {
             char op = '*';
@@ -454,6 +712,8 @@ void MatOp::multiply(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double
 
 void MatOp::multiply(const MatExpr& expr, double s, MatExpr& res) const
 {
+    if( fuseAddEx(expr, s, Scalar(), res) )
+        return;
     Mat m;
     expr.op->assign(expr, m);
     MatOp_AddEx::makeExpr(res, m, Mat(), s, 0);
@@ -510,6 +770,8 @@ void MatOp::divide(double s, const MatExpr& expr, MatExpr& res) const
 
 void MatOp::abs(const MatExpr& expr, MatExpr& res) const
 {
+    if( fuseAbs(expr, res) )
+        return;
     Mat m;
     expr.op->assign(expr, m);
     MatOp_Bin::makeExpr(res, 'a', m, Mat());
@@ -923,6 +1185,41 @@ MatExpr operator < (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator < (const MatExpr& e, const Mat& m)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LT, e, MatExpr(m));
+    return en;
+}
+
+MatExpr operator < (const Mat& m, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LT, MatExpr(m), e);
+    return en;
+}
+
+MatExpr operator < (const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LT, e, s);
+    return en;
+}
+
+MatExpr operator < (double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GT, e, s);
+    return en;
+}
+
+MatExpr operator < (const MatExpr& e1, const MatExpr& e2)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LT, e1, e2);
+    return en;
+}
+
 MatExpr operator <= (const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -944,6 +1241,41 @@ MatExpr operator <= (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator <= (const MatExpr& e, const Mat& m)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LE, e, MatExpr(m));
+    return en;
+}
+
+MatExpr operator <= (const Mat& m, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LE, MatExpr(m), e);
+    return en;
+}
+
+MatExpr operator <= (const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LE, e, s);
+    return en;
+}
+
+MatExpr operator <= (double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GE, e, s);
+    return en;
+}
+
+MatExpr operator <= (const MatExpr& e1, const MatExpr& e2)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LE, e1, e2);
+    return en;
+}
+
 MatExpr operator == (const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -965,6 +1297,41 @@ MatExpr operator == (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator == (const MatExpr& e, const Mat& m)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_EQ, e, MatExpr(m));
+    return en;
+}
+
+MatExpr operator == (const Mat& m, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_EQ, MatExpr(m), e);
+    return en;
+}
+
+MatExpr operator == (const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_EQ, e, s);
+    return en;
+}
+
+MatExpr operator == (double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_EQ, e, s);
+    return en;
+}
+
+MatExpr operator == (const MatExpr& e1, const MatExpr& e2)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_EQ, e1, e2);
+    return en;
+}
+
 MatExpr operator != (const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -986,6 +1353,41 @@ MatExpr operator != (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator != (const MatExpr& e, const Mat& m)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_NE, e, MatExpr(m));
+    return en;
+}
+
+MatExpr operator != (const Mat& m, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_NE, MatExpr(m), e);
+    return en;
+}
+
+MatExpr operator != (const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_NE, e, s);
+    return en;
+}
+
+MatExpr operator != (double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_NE, e, s);
+    return en;
+}
+
+MatExpr operator != (const MatExpr& e1, const MatExpr& e2)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_NE, e1, e2);
+    return en;
+}
+
 MatExpr operator >= (const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -1007,6 +1409,41 @@ MatExpr operator >= (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator >= (const MatExpr& e, const Mat& m)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GE, e, MatExpr(m));
+    return en;
+}
+
+MatExpr operator >= (const Mat& m, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GE, MatExpr(m), e);
+    return en;
+}
+
+MatExpr operator >= (const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GE, e, s);
+    return en;
+}
+
+MatExpr operator >= (double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LE, e, s);
+    return en;
+}
+
+MatExpr operator >= (const MatExpr& e1, const MatExpr& e2)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GE, e1, e2);
+    return en;
+}
+
 MatExpr operator > (const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -1028,6 +1465,41 @@ MatExpr operator > (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator > (const MatExpr& e, const Mat& m)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GT, e, MatExpr(m));
+    return en;
+}
+
+MatExpr operator > (const Mat& m, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GT, MatExpr(m), e);
+    return en;
+}
+
+MatExpr operator > (const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GT, e, s);
+    return en;
+}
+
+MatExpr operator > (double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LT, e, s);
+    return en;
+}
+
+MatExpr operator > (const MatExpr& e1, const MatExpr& e2)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GT, e1, e2);
+    return en;
+}
+
 MatExpr min(const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -1049,6 +1521,41 @@ MatExpr min(double s, const Mat& a)
     return e;
 }
 
+MatExpr min(const MatExpr& e, const Mat& m)
+{
+    MatExpr en;
+    makeMinMaxExpr(en, 'm', e, MatExpr(m));
+    return en;
+}
+
+MatExpr min(const Mat& m, const MatExpr& e)
+{
+    MatExpr en;
+    makeMinMaxExpr(en, 'm', MatExpr(m), e);
+    return en;
+}
+
+MatExpr min(const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeMinMaxExpr(en, 'm', e, s);
+    return en;
+}
+
+MatExpr min(double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeMinMaxExpr(en, 'm', e, s);
+    return en;
+}
+
+MatExpr min(const MatExpr& e1, const MatExpr& e2)
+{
+    MatExpr en;
+    makeMinMaxExpr(en, 'm', e1, e2);
+    return en;
+}
+
 MatExpr max(const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -1070,6 +1577,41 @@ MatExpr max(double s, const Mat& a)
     return e;
 }
 
+MatExpr max(const MatExpr& e, const Mat& m)
+{
+    MatExpr en;
+    makeMinMaxExpr(en, 'M', e, MatExpr(m));
+    return en;
+}
+
+MatExpr max(const Mat& m, const MatExpr& e)
+{
+    MatExpr en;
+    makeMinMaxExpr(en, 'M', MatExpr(m), e);
+    return en;
+}
+
+MatExpr max(const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeMinMaxExpr(en, 'M', e, s);
+    return en;
+}
+
+MatExpr max(double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeMinMaxExpr(en, 'M', e, s);
+    return en;
+}
+
+MatExpr max(const MatExpr& e1, const MatExpr& e2)
+{
+    MatExpr en;
+    makeMinMaxExpr(en, 'M', e1, e2);
+    return en;
+}
+
 MatExpr operator & (const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -1573,6 +2115,656 @@ inline void MatOp_Initializer::makeExpr(MatExpr& res, int method, Size sz, int t
     res = MatExpr(&g_MatOp_Initializer, method, Mat(sz, type, (void*)0), Mat(), Mat(), alpha, 0);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int MatExprProgram::addNode(int op, int a, int b, int depth, double alpha, double beta,
+                            const Scalar& s, bool scalarAll, int cmpop)
+{
+    Node n;
+    n.op = op;
+    n.a = a;
+    n.b = b;
+    n.depth = depth;
+    n.cmpop = cmpop;
+    n.scalarAll = scalarAll;
+    n.alpha = alpha;
+    n.beta = beta;
+    n.s = s;
+    nodes.push_back(n);
+    return (int)nodes.size() - 1;
+}
+
+int MatExprProgram::load(const Mat& m)
+{
+    if( !m.data || m.dims > 2 )
+        return -1;
+    if( cn < 0 )
+    {
+        size = m.size();
+        cn = m.channels();
+    }
+    else if( m.size() != size || m.channels() != cn )
+        return -1;
+
+    // every matrix is read only once, however many times it is used in the expression
+    for( size_t i = 0; i < nodes.size(); i++ )
+    {
+        if( nodes[i].op != OP_LOAD )
+            continue;
+        const Mat& in = inputs[nodes[i].a];
+        if( in.data == m.data && in.step[0] == m.step[0] && in.type() == m.type() )
+            return (int)i;
+    }
+
+    inputs.push_back(m);
+    return addNode(OP_LOAD, (int)inputs.size() - 1, -1, m.depth());
+}
+
+// a*alpha + b*beta + s, the same sequence of saturations as in MatOp_AddEx::assign()
+int MatExprProgram::addEx(int a, int b, double alpha, double beta, const Scalar& s)
+{
+    if( a < 0 )
+        return -1;
+    int depth = nodes[a].depth;
+
+    if( b >= 0 )
+    {
+        if( nodes[b].depth != depth )
+            return -1;
+        if( s.isReal() )
+            return addNode(OP_ADD, a, b, depth, alpha, beta, s, true);
+        a = addNode(OP_ADD, a, b, depth, alpha, beta);
+        return addNode(OP_ADD, a, -1, depth, 1, 0, s);
+    }
+
+    if( fabs(alpha) != 1 )
+    {
+        if( s.isReal() )
+            return addNode(OP_ADD, a, -1, depth, alpha, 0, s, true);
+        a = addNode(OP_ADD, a, -1, depth, alpha, 0);
+        alpha = 1;
+    }
+    return addNode(OP_ADD, a, -1, depth, alpha, 0, s);
+}
+
+int MatExprProgram::binary(int op, int a, int b, double alpha, int cmpop)
+{
+    if( a < 0 || b < 0 || nodes[a].depth != nodes[b].depth )
+        return -1;
+    return addNode(op, a, b, op == OP_CMP ? CV_8U : nodes[a].depth, alpha, 0, Scalar(), false, cmpop);
+}
+
+int MatExprProgram::binary(int op, int a, const Scalar& s, bool scalarAll)
+{
+    if( a < 0 )
+        return -1;
+    return addNode(op, a, -1, nodes[a].depth, 1, 0, s, scalarAll);
+}
+
+int MatExprProgram::compare(int cmpop, int a, double s)
+{
+    // comparison with a scalar is defined for single-channel arrays only
+    if( a < 0 || cn != 1 )
+        return -1;
+
+    int depth = nodes[a].depth;
+    if( depth == CV_32F )
+        s = (float)s;
+    else if( depth <= CV_32S )
+    {
+        // integer elements are compared with the nearest integer threshold, like in cv::compare()
+        double fs = std::floor(s);
+        if( fs != s )
+        {
+            if( cmpop == CMP_GT || cmpop == CMP_LE )
+                s = fs;
+            else if( cmpop == CMP_GE || cmpop == CMP_LT )
+                s = fs + 1;
+            else
+                // no element is equal to a fractional value; take one below the range instead
+                s = depth == CV_8U || depth == CV_16U ? -1. : depth == CV_8S ? SCHAR_MIN - 1. :
+                    depth == CV_16S ? SHRT_MIN - 1. : INT_MIN - 1.;
+        }
+    }
+    return addNode(OP_CMP, a, -1, CV_8U, 1, 0, Scalar::all(s), true, cmpop);
+}
+
+int MatExprProgram::append(const MatExpr& e)
+{
+    if( isFused(e) && nodes.size() + e.program->nodes.size() <= (size_t)MAX_NODES )
+    {
+        const MatExprProgram& p = *e.program;
+        std::vector<int> idx(p.nodes.size());
+        for( size_t i = 0; i < p.nodes.size(); i++ )
+        {
+            Node n = p.nodes[i];
+            if( n.op == OP_LOAD )
+                idx[i] = load(p.inputs[n.a]);
+            else
+            {
+                n.a = idx[n.a];
+                if( n.b >= 0 )
+                    n.b = idx[n.b];
+                nodes.push_back(n);
+                idx[i] = (int)nodes.size() - 1;
+            }
+            if( idx[i] < 0 )
+                return -1;
+        }
+        return idx.back();
+    }
+
+    if( isIdentity(e) )
+        return load(e.a);
+
+    if( isAddEx(e) )
+    {
+        int a = load(e.a), b = -1;
+        if( e.b.data && (b = load(e.b)) < 0 )
+            return -1;
+        return addEx(a, b, e.alpha, e.beta, e.s);
+    }
+
+    if( isBin(e, '*') )
+        return binary(OP_MUL, load(e.a), load(e.b), e.alpha);
+
+    if( isBin(e, 'm') || isBin(e, 'M') || isBin(e, 'a') )
+    {
+        int op = e.flags == 'm' ? OP_MIN : e.flags == 'M' ? OP_MAX : OP_ABSDIFF;
+        if( e.b.data )
+            return binary(op, load(e.a), load(e.b));
+        // min() and max() take a single value, absdiff() takes a per-channel scalar
+        return binary(op, load(e.a), e.s, op != OP_ABSDIFF);
+    }
+
+    if( isCmp(e) && (e.b.data || e.a.channels() == 1) )
+        return e.b.data ? binary(OP_CMP, load(e.a), load(e.b), 1, e.flags) :
+                          compare(e.flags, load(e.a), e.alpha);
+
+    // everything else (including too long chains) is evaluated into a temporary matrix
+    Mat m;
+    e.op->assign(e, m);
+    return load(m);
+}
+
+static double saturateToDepth(double v, int depth)
+{
+    switch( depth )
+    {
+    case CV_8U: return saturate_cast<uchar>(v);
+    case CV_8S: return saturate_cast<schar>(v);
+    case CV_16U: return saturate_cast<ushort>(v);
+    case CV_16S: return saturate_cast<short>(v);
+    case CV_32S: return saturate_cast<int>(v);
+    case CV_32F: return (float)v;
+    default: return v;
+    }
+}
+
+static void getDepthRange(int depth, double& minval, double& maxval)
+{
+    static const double tab[][2] =
+    {
+        { 0, UCHAR_MAX }, { SCHAR_MIN, SCHAR_MAX }, { 0, USHRT_MAX },
+        { SHRT_MIN, SHRT_MAX }, { INT_MIN, INT_MAX }
+    };
+    minval = tab[depth][0];
+    maxval = tab[depth][1];
+}
+
+static void saturateRow(double* d, int len, int depth)
+{
+    int j = 0;
+    if( depth == CV_32F )
+    {
+        for( ; j < len; j++ )
+            d[j] = (float)d[j];
+        return;
+    }
+
+    double minval, maxval;
+    getDepthRange(depth, minval, maxval);
+    for( ; j < len; j++ )
+        d[j] = cvRound(std::min(std::max(d[j], minval), maxval));
+}
+
+static void saturateRow(float* d, int len, int depth)
+{
+    double _minval, _maxval;
+    getDepthRange(depth, _minval, _maxval);
+    float minval = (float)_minval, maxval = (float)_maxval;
+    int j = 0;
+
+#if CV_SSE2
+    if( USE_SSE2 )
+    {
+        __m128 vmin = _mm_set1_ps(minval), vmax = _mm_set1_ps(maxval);
+        for( ; j <= len - 4; j += 4 )
+        {
+            __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(d + j), vmin), vmax);
+            _mm_storeu_ps(d + j, _mm_cvtepi32_ps(_mm_cvtps_epi32(v)));
+        }
+    }
+#endif
+
+    for( ; j < len; j++ )
+        d[j] = (float)cvRound(std::min(std::max(d[j], minval), maxval));
+}
+
+static void loadRow(const uchar* src, int sdepth, double* d, int len)
+{
+    getConvertFunc(sdepth, CV_64F)(src, 0, 0, 0, (uchar*)d, 0, Size(len, 1), 0);
+}
+
+template<typename T> static inline void loadRowTail(const T* src, float* d, int j, int len)
+{
+    for( ; j < len; j++ )
+        d[j] = (float)src[j];
+}
+
+static void loadRow(const uchar* src, int sdepth, float* d, int len)
+{
+    int j = 0;
+
+#if CV_SSE2
+    if( USE_SSE2 )
+    {
+        __m128i z = _mm_setzero_si128();
+        if( sdepth == CV_8U || sdepth == CV_8S )
+        {
+            for( ; j <= len - 16; j += 16 )
+            {
+                __m128i v = _mm_loadu_si128((const __m128i*)(src + j)), w0, w1;
+                if( sdepth == CV_8U )
+                {
+                    w0 = _mm_unpacklo_epi8(v, z);
+                    w1 = _mm_unpackhi_epi8(v, z);
+                }
+                else
+                {
+                    w0 = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+                    w1 = _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);
+                }
+                _mm_storeu_ps(d + j, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(w0, w0), 16)));
+                _mm_storeu_ps(d + j + 4, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(w0, w0), 16)));
+                _mm_storeu_ps(d + j + 8, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(w1, w1), 16)));
+                _mm_storeu_ps(d + j + 12, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(w1, w1), 16)));
+            }
+        }
+        else if( sdepth == CV_16U )
+        {
+            for( ; j <= len - 8; j += 8 )
+            {
+                __m128i v = _mm_loadu_si128((const __m128i*)(src + j*2));
+                _mm_storeu_ps(d + j, _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, z)));
+                _mm_storeu_ps(d + j + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(v, z)));
+            }
+        }
+        else if( sdepth == CV_16S )
+        {
+            for( ; j <= len - 8; j += 8 )
+            {
+                __m128i v = _mm_loadu_si128((const __m128i*)(src + j*2));
+                _mm_storeu_ps(d + j, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)));
+                _mm_storeu_ps(d + j + 4, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)));
+            }
+        }
+    }
+#endif
+
+    switch( sdepth )
+    {
+    case CV_8U: loadRowTail((const uchar*)src, d, j, len); break;
+    case CV_8S: loadRowTail((const schar*)src, d, j, len); break;
+    case CV_16U: loadRowTail((const ushort*)src, d, j, len); break;
+    case CV_16S: loadRowTail((const short*)src, d, j, len); break;
+    default: CV_Error(CV_StsUnsupportedFormat, "");
+    }
+}
+
+static void storeRow(const double* s, uchar* dst, int ddepth, int len)
+{
+    getConvertFunc(CV_64F, ddepth)((const uchar*)s, 0, 0, 0, dst, 0, Size(len, 1), 0);
+}
+
+template<typename T> static inline void storeRowTail(const float* s, T* dst, int j, int len,
+                                                     float minval, float maxval)
+{
+    for( ; j < len; j++ )
+        dst[j] = saturate_cast<T>(std::min(std::max(s[j], minval), maxval));
+}
+
+// the values are clipped before the conversion, so that the packing instructions never overflow
+static void storeRow(const float* s, uchar* dst, int ddepth, int len)
+{
+    if( ddepth == CV_32F )
+    {
+        memcpy(dst, s, len*sizeof(float));
+        return;
+    }
+
+    double _minval, _maxval;
+    getDepthRange(ddepth, _minval, _maxval);
+    float minval = (float)_minval, maxval = (float)_maxval;
+    int j = 0;
+
+#if CV_SSE2
+    if( USE_SSE2 )
+    {
+        __m128 vmin = _mm_set1_ps(minval), vmax = _mm_set1_ps(maxval);
+        if( ddepth == CV_8U || ddepth == CV_8S )
+        {
+            for( ; j <= len - 16; j += 16 )
+            {
+                __m128i v0 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(s + j), vmin), vmax));
+                __m128i v1 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(s + j + 4), vmin), vmax));
+                __m128i v2 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(s + j + 8), vmin), vmax));
+                __m128i v3 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(s + j + 12), vmin), vmax));
+                v0 = _mm_packs_epi32(v0, v1);
+                v2 = _mm_packs_epi32(v2, v3);
+                _mm_storeu_si128((__m128i*)(dst + j), ddepth == CV_8U ? _mm_packus_epi16(v0, v2) : _mm_packs_epi16(v0, v2));
+            }
+        }
+        else if( ddepth == CV_16S || ddepth == CV_16U )
+        {
+            // SSE2 has no unsigned 32->16 bit pack, so 16U values are shifted to the signed range and back
+            __m128i delta32 = _mm_set1_epi32(ddepth == CV_16U ? 32768 : 0);
+            __m128i delta16 = _mm_set1_epi16(ddepth == CV_16U ? (short)-32768 : 0);
+            for( ; j <= len - 8; j += 8 )
+            {
+                __m128i v0 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(s + j), vmin), vmax));
+                __m128i v1 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(s + j + 4), vmin), vmax));
+                v0 = _mm_packs_epi32(_mm_sub_epi32(v0, delta32), _mm_sub_epi32(v1, delta32));
+                _mm_storeu_si128((__m128i*)(dst + j*2), _mm_xor_si128(v0, delta16));
+            }
+        }
+    }
+#endif
+
+    switch( ddepth )
+    {
+    case CV_8U: storeRowTail(s, (uchar*)dst, j, len, minval, maxval); break;
+    case CV_8S: storeRowTail(s, (schar*)dst, j, len, minval, maxval); break;
+    case CV_16U: storeRowTail(s, (ushort*)dst, j, len, minval, maxval); break;
+    case CV_16S: storeRowTail(s, (short*)dst, j, len, minval, maxval); break;
+    default: CV_Error(CV_StsUnsupportedFormat, "");
+    }
+}
+
+template<typename WT> class FusedExprInvoker : public ParallelLoopBody
+{
+public:
+    typedef MatExprProgram::Node Node;
+
+    FusedExprInvoker(const std::vector<Node>& _nodes, const std::vector<Mat>& _inputs, Mat& _dst)
+        : nodes(&_nodes), inputs(&_inputs), dst(&_dst) {}
+
+    void operator()(const Range& range) const
+    {
+        const std::vector<Node>& prog = *nodes;
+        const std::vector<Mat>& src = *inputs;
+        int i, j, nnodes = (int)prog.size();
+        int cn = dst->channels(), width = dst->cols*cn, ddepth = dst->depth();
+        int wdepth = DataDepth<WT>::value;
+        int blockSize = std::max(BLOCK_SIZE/cn, 1)*cn;
+        size_t esz1 = dst->elemSize1();
+
+        // the results of the nodes, followed by the unrolled scalar arguments
+        AutoBuffer<WT> _buf(blockSize*nnodes*2);
+        AutoBuffer<const WT*> _ptrs(nnodes);
+        WT* buf = _buf;
+        WT* sbuf = buf + blockSize*nnodes;
+        const WT** ptrs = _ptrs;
+
+        for( i = 0; i < nnodes; i++ )
+        {
+            const Node& n = prog[i];
+            if( n.op == MatExprProgram::OP_LOAD || n.b >= 0 )
+                continue;
+            // like the standalone operations, saturate the scalar to the depth of the matrix,
+            // except for convertTo(), addWeighted() and compare() that use it as is
+            bool sat = n.op != MatExprProgram::OP_CMP && !(n.op == MatExprProgram::OP_ADD && n.scalarAll);
+            WT* s = sbuf + blockSize*i;
+            for( j = 0; j < blockSize; j++ )
+            {
+                int c = j % cn;
+                double v = n.scalarAll ? n.s[0] : c < 4 ? n.s[c] : 0.;
+                s[j] = (WT)(sat ? saturateToDepth(v, prog[n.a].depth) : v);
+            }
+        }
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            for( int x = 0; x < width; x += blockSize )
+            {
+                int len = std::min(blockSize, width - x);
+
+                for( i = 0; i < nnodes; i++ )
+                {
+                    const Node& n = prog[i];
+                    WT* d = buf + blockSize*i;
+
+                    if( n.op == MatExprProgram::OP_LOAD )
+                    {
+                        const Mat& m = src[n.a];
+                        const uchar* sptr = m.ptr(y) + x*m.elemSize1();
+                        if( m.depth() == wdepth )
+                            ptrs[i] = (const WT*)sptr;
+                        else
+                        {
+                            loadRow(sptr, m.depth(), d, len);
+                            ptrs[i] = d;
+                        }
+                        continue;
+                    }
+
+                    const WT* a = ptrs[n.a];
+                    const WT* b = n.b >= 0 ? ptrs[n.b] : sbuf + blockSize*i;
+                    WT alpha = (WT)n.alpha, beta = (WT)n.beta, gamma = (WT)n.s[0];
+
+                    switch( n.op )
+                    {
+                    case MatExprProgram::OP_ADD:
+                        if( n.b >= 0 )
+                            for( j = 0; j < len; j++ )
+                                d[j] = a[j]*alpha + b[j]*beta + gamma;
+                        else
+                            for( j = 0; j < len; j++ )
+                                d[j] = a[j]*alpha + b[j];
+                        break;
+                    case MatExprProgram::OP_MUL:
+                        for( j = 0; j < len; j++ )
+                            d[j] = alpha*a[j]*b[j];
+                        break;
+                    case MatExprProgram::OP_ABSDIFF:
+                        for( j = 0; j < len; j++ )
+                            d[j] = std::abs(a[j] - b[j]);
+                        break;
+                    case MatExprProgram::OP_MIN:
+                        for( j = 0; j < len; j++ )
+                            d[j] = std::min(a[j], b[j]);
+                        break;
+                    case MatExprProgram::OP_MAX:
+                        for( j = 0; j < len; j++ )
+                            d[j] = std::max(a[j], b[j]);
+                        break;
+                    case MatExprProgram::OP_CMP:
+                        compareRow(a, b, d, len, n.cmpop);
+                        break;
+                    default:
+                        CV_Error(CV_StsError, "Unknown operation");
+                    }
+
+                    // min, max and compare can not leave the range of the operands;
+                    // the final result is saturated by storeRow()
+                    if( n.depth != wdepth && n.op != MatExprProgram::OP_MIN &&
+                        n.op != MatExprProgram::OP_MAX && n.op != MatExprProgram::OP_CMP &&
+                        (i < nnodes - 1 || n.depth != ddepth) )
+                        saturateRow(d, len, n.depth);
+                    ptrs[i] = d;
+                }
+
+                uchar* dptr = dst->ptr(y) + x*esz1;
+                if( ddepth == wdepth )
+                    memcpy(dptr, ptrs[nnodes-1], len*sizeof(WT));
+                else
+                    storeRow(ptrs[nnodes-1], dptr, ddepth, len);
+            }
+        }
+    }
+
+private:
+    static void compareRow(const WT* a, const WT* b, WT* d, int len, int cmpop)
+    {
+        int j;
+        WT t = (WT)255, f = (WT)0;
+        switch( cmpop )
+        {
+        case CMP_EQ:
+            for( j = 0; j < len; j++ )
+                d[j] = a[j] == b[j] ? t : f;
+            break;
+        case CMP_GT:
+            for( j = 0; j < len; j++ )
+                d[j] = a[j] > b[j] ? t : f;
+            break;
+        case CMP_GE:
+            for( j = 0; j < len; j++ )
+                d[j] = a[j] >= b[j] ? t : f;
+            break;
+        case CMP_LT:
+            for( j = 0; j < len; j++ )
+                d[j] = a[j] < b[j] ? t : f;
+            break;
+        case CMP_LE:
+            for( j = 0; j < len; j++ )
+                d[j] = a[j] <= b[j] ? t : f;
+            break;
+        case CMP_NE:
+            for( j = 0; j < len; j++ )
+                d[j] = a[j] != b[j] ? t : f;
+            break;
+        default:
+            CV_Error(CV_StsBadArg, "Unknown comparison method");
+        }
+    }
+
+    const std::vector<Node>* nodes;
+    const std::vector<Mat>* inputs;
+    Mat* dst;
+};
+
+static bool isOverlapped(const Mat& a, const Mat& b)
+{
+    const uchar* aend = a.data + a.step[0]*(a.rows - 1) + a.cols*a.elemSize();
+    const uchar* bend = b.data + b.step[0]*(b.rows - 1) + b.cols*b.elemSize();
+    return a.data < bend && b.data < aend;
+}
+
+// 8-bit chains are left to the step-by-step evaluation: the SIMD kernels in arithm.cpp
+// process 16 such elements at once and outrun the floating-point evaluation of the program
+bool MatExprProgram::isProfitable() const
+{
+    for( size_t i = 0; i < nodes.size(); i++ )
+        if( nodes[i].depth > CV_8S )
+            return true;
+    return false;
+}
+
+void MatExprProgram::run(Mat& dst, int _type) const
+{
+    CV_Assert( !nodes.empty() );
+
+    std::vector<Node> prog(nodes);
+    Node& root = prog.back();
+    int ddepth = _type < 0 ? root.depth : CV_MAT_DEPTH(_type);
+
+    // MatOp_AddEx::assign() converts the scaled matrix directly to the requested type
+    if( root.op == OP_ADD && root.b < 0 && root.s.isReal() && ddepth != root.depth )
+    {
+        root.depth = ddepth;
+        root.scalarAll = true;
+    }
+
+    int wdepth = ddepth == CV_32S || ddepth == CV_64F ? CV_64F : CV_32F;
+    for( size_t i = 0; i < prog.size(); i++ )
+        if( prog[i].depth == CV_32S || prog[i].depth == CV_64F )
+            wdepth = CV_64F;
+
+    dst.create(size, CV_MAKETYPE(ddepth, cn));
+
+    // the destination may be one of the inputs, but not a different view of the same data
+    Mat out = dst;
+    for( size_t i = 0; i < inputs.size(); i++ )
+        if( isOverlapped(inputs[i], dst) &&
+            (inputs[i].data != dst.data || inputs[i].step[0] != dst.step[0]) )
+        {
+            out = Mat(size, dst.type());
+            break;
+        }
+
+    Range rows(0, size.height);
+    double nstripes = (double)size.width*size.height*cn/(1 << 16);
+    if( wdepth == CV_32F )
+    {
+        FusedExprInvoker<float> body(prog, inputs, out);
+        if( nstripes > 1 && size.height > 1 )
+            parallel_for_(rows, body, nstripes);
+        else
+            body(rows);
+    }
+    else
+    {
+        FusedExprInvoker<double> body(prog, inputs, out);
+        if( nstripes > 1 && size.height > 1 )
+            parallel_for_(rows, body, nstripes);
+        else
+            body(rows);
+    }
+
+    if( out.data != dst.data )
+        out.copyTo(dst);
+}
+
+void MatOp_Fused::assign(const MatExpr& e, Mat& m, int _type) const
+{
+    e.program->run(m, _type);
+}
+
+void MatOp_Fused::roi(const MatExpr& e, const Range& rowRange, const Range& colRange, MatExpr& res) const
+{
+    Ptr<MatExprProgram> p = new MatExprProgram(*e.program);
+    for( size_t i = 0; i < p->inputs.size(); i++ )
+        p->inputs[i] = p->inputs[i](rowRange, colRange);
+    p->size = p->inputs[0].size();
+    makeExpr(res, p);
+}
+
+void MatOp_Fused::diag(const MatExpr& e, int d, MatExpr& res) const
+{
+    Ptr<MatExprProgram> p = new MatExprProgram(*e.program);
+    for( size_t i = 0; i < p->inputs.size(); i++ )
+        p->inputs[i] = p->inputs[i].diag(d);
+    p->size = p->inputs[0].size();
+    makeExpr(res, p);
+}
+
+Size MatOp_Fused::size(const MatExpr& e) const
+{
+    return e.program->size;
+}
+
+int MatOp_Fused::type(const MatExpr& e) const
+{
+    return e.program->resultType();
+}
+
+inline void MatOp_Fused::makeExpr(MatExpr& res, const Ptr<MatExprProgram>& program)
+{
+    res = MatExpr(&g_MatOp_Fused, 0);
+    res.program = program;
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -205,6 +205,8 @@ void Mat::create(int d, const int* _sizes, int _type)
 
     if( total() > 0 )
     {
+        if( !allocator && (allocator = getDefaultAllocator()) != 0 )
+            flags |= DEFAULT_ALLOCATOR_FLAG;
 #ifdef HAVE_TGPU
         if( !allocator || allocator == tegra::getAllocator() ) allocator = tegra::getAllocator(d, _sizes, _type);
 #endif
@@ -225,6 +227,7 @@ void Mat::create(int d, const int* _sizes, int _type)
             }catch(...)
             {
                 allocator = 0;
+                flags &= ~DEFAULT_ALLOCATOR_FLAG;
                 size_t totalSize = alignSize(step.p[0]*size.p[0], (int)sizeof(*refcount));
                 data = datastart = (uchar*)fastMalloc(totalSize + (int)sizeof(*refcount));
                 refcount = (int*)(data + totalSize);
@@ -2507,30 +2510,44 @@ static void generateRandomCenter(const vector<Vec2f>& box, float* center, RNG& r
         center[j] = ((float)rng*(1.f+margin*2.f)-margin)*(box[j][1] - box[j][0]) + box[j][0];
 }
 
-class KMeansPPDistanceComputer
+// the number of samples summed together by KMeansPPDistanceComputer;
+// the sums do not depend on the number of threads, so neither do the chosen centers
+enum { KMEANS_PP_BLOCK = 4096 };
+
+class KMeansPPDistanceComputer : public ParallelLoopBody
 {
 public:
     KMeansPPDistanceComputer( float *_tdist2,
+                              double *_blockSums,
                               const float *_data,
                               const float *_dist,
                               int _dims,
+                              int _N,
                               size_t _step,
                               size_t _stepci )
         : tdist2(_tdist2),
+          blockSums(_blockSums),
           data(_data),
           dist(_dist),
           dims(_dims),
+          N(_N),
           step(_step),
           stepci(_stepci) { }
 
-    void operator()( const cv::BlockedRange& range ) const
+    void operator()( const Range& range ) const
     {
-        const int begin = range.begin();
-        const int end = range.end();
-
-        for ( int i = begin; i<end; i++ )
+        for( int b = range.start; b < range.end; b++ )
         {
-            tdist2[i] = std::min(normL2Sqr_(data + step*i, data + stepci, dims), dist[i]);
+            int i = b*KMEANS_PP_BLOCK, i1 = std::min(i + KMEANS_PP_BLOCK, N);
+            double s = 0;
+
+            for( ; i < i1; i++ )
+            {
+                float d = normL2Sqr_(data + step*i, data + stepci, dims);
+                tdist2[i] = dist ? std::min(d, dist[i]) : d;
+                s += tdist2[i];
+            }
+            blockSums[b] = s;
         }
     }
 
@@ -2538,13 +2555,29 @@ private:
     KMeansPPDistanceComputer& operator=(const KMeansPPDistanceComputer&); // to quiet MSVC
 
     float *tdist2;
+    double *blockSums;
     const float *data;
     const float *dist;
     const int dims;
+    const int N;
     const size_t step;
     const size_t stepci;
 };
 
+// picks the sample i with the probability dist[i]/sum(dist); p is uniform in [0, sum(dist))
+static int sampleKMeansPP( const float* dist, const double* blockSums, int N, double p )
+{
+    int b = 0, nblocks = (N + KMEANS_PP_BLOCK - 1)/KMEANS_PP_BLOCK;
+    for( ; b < nblocks - 1 && p > blockSums[b]; b++ )
+        p -= blockSums[b];
+
+    int i = b*KMEANS_PP_BLOCK, i1 = std::min(i + KMEANS_PP_BLOCK, N) - 1;
+    for( ; i < i1; i++ )
+        if( (p -= dist[i]) <= 0 )
+            break;
+    return i;
+}
+
 /*
 k-means center initialization using the following algorithm:
 Arthur & Vassilvitskii (2007) k-means++: The Advantages of Careful Seeding
@@ -2553,21 +2586,23 @@ static void generateCentersPP(const Mat& _data, Mat& _out_centers,
                               int K, RNG& rng, int trials)
 {
     int i, j, k, dims = _data.cols, N = _data.rows;
+    int nblocks = (N + KMEANS_PP_BLOCK - 1)/KMEANS_PP_BLOCK;
     const float* data = _data.ptr<float>(0);
     size_t step = _data.step/sizeof(data[0]);
     vector<int> _centers(K);
     int* centers = &_centers[0];
     vector<float> _dist(N*3);
     float* dist = &_dist[0], *tdist = dist + N, *tdist2 = tdist + N;
+    vector<double> _sums(nblocks*3);
+    double* sums = &_sums[0], *tsums = sums + nblocks, *tsums2 = tsums + nblocks;
     double sum0 = 0;
 
     centers[0] = (unsigned)rng % N;
 
-    for( i = 0; i < N; i++ )
-    {
-        dist[i] = normL2Sqr_(data + step*i, data + step*centers[0], dims);
-        sum0 += dist[i];
-    }
+    parallel_for_(Range(0, nblocks),
+                  KMeansPPDistanceComputer(dist, sums, data, 0, dims, N, step, step*centers[0]));
+    for( i = 0; i < nblocks; i++ )
+        sum0 += sums[i];
 
     for( k = 1; k < K; k++ )
     {
@@ -2577,28 +2612,25 @@ static void generateCentersPP(const Mat& _data, Mat& _out_centers,
         for( j = 0; j < trials; j++ )
         {
             double p = (double)rng*sum0, s = 0;
-            for( i = 0; i < N-1; i++ )
-                if( (p -= dist[i]) <= 0 )
-                    break;
-            int ci = i;
+            int ci = sampleKMeansPP(dist, sums, N, p);
 
-            parallel_for(BlockedRange(0, N),
-                         KMeansPPDistanceComputer(tdist2, data, dist, dims, step, step*ci));
-            for( i = 0; i < N; i++ )
-            {
-                s += tdist2[i];
-            }
+            parallel_for_(Range(0, nblocks),
+                          KMeansPPDistanceComputer(tdist2, tsums2, data, dist, dims, N, step, step*ci));
+            for( i = 0; i < nblocks; i++ )
+                s += tsums2[i];
 
             if( s < bestSum )
             {
                 bestSum = s;
                 bestCenter = ci;
                 std::swap(tdist, tdist2);
+                std::swap(tsums, tsums2);
             }
         }
         centers[k] = bestCenter;
         sum0 = bestSum;
         std::swap(dist, tdist);
+        std::swap(sums, tsums);
     }
 
     for( k = 0; k < K; k++ )
@@ -2610,24 +2642,54 @@ static void generateCentersPP(const Mat& _data, Mat& _out_centers,
     }
 }
 
-class KMeansDistanceComputer
+/*
+assigns each sample to the nearest center.
+
+When the bounds are given, the distance computations are skipped as in
+Hamerly (2010) Making k-means even faster: lower[i] is a lower bound of the distance
+from the i-th sample to all the centers except the one it is assigned to. It is decreased
+by the maximum shift of the other centers since the previous assignment; if the distance
+to the own center is still below it, or below the half distance from the own center
+to the nearest other one, the sample keeps its label. The labels are the same
+as without the bounds, up to the rounding errors on the ties.
+*/
+class KMeansDistanceComputer : public ParallelLoopBody
 {
 public:
     KMeansDistanceComputer( double *_distances,
                             int *_labels,
                             const Mat& _data,
-                            const Mat& _centers )
+                            const Mat& _centers,
+                            double *_lower=0,
+                            const double *_halfGaps=0,
+                            const double *_shifts=0 )
         : distances(_distances),
           labels(_labels),
           data(_data),
-          centers(_centers)
-    {
+          centers(_centers),
+          lower(_lower),
+          halfGaps(_halfGaps),
+          shifts(_shifts)
+    {
+        maxShift[0] = maxShift[1] = 0;
+        maxShiftIdx = -1;
+        for( int k = 0; shifts && k < centers.rows; k++ )
+        {
+            if( shifts[k] > maxShift[0] )
+            {
+                maxShift[1] = maxShift[0];
+                maxShift[0] = shifts[k];
+                maxShiftIdx = k;
+            }
+            else
+                maxShift[1] = std::max(maxShift[1], shifts[k]);
+        }
     }
 
-    void operator()( const BlockedRange& range ) const
+    void operator()( const Range& range ) const
     {
-        const int begin = range.begin();
-        const int end = range.end();
+        const int begin = range.start;
+        const int end = range.end;
         const int K = centers.rows;
         const int dims = centers.cols;
 
@@ -2635,8 +2697,24 @@ public:
         for( int i = begin; i<end; ++i)
         {
             sample = data.ptr<float>(i);
+
+            if( shifts )
+            {
+                int a = labels[i];
+                double l = lower[i] - maxShift[a == maxShiftIdx];
+                double d = normL2Sqr_(sample, centers.ptr<float>(a), dims);
+                double bound = std::max(halfGaps[a], l);
+
+                lower[i] = l;
+                if( bound > 0 && d < bound*bound )
+                {
+                    distances[i] = d;
+                    continue;
+                }
+            }
+
             int k_best = 0;
-            double min_dist = DBL_MAX;
+            double min_dist = DBL_MAX, min_dist2 = DBL_MAX;
 
             for( int k = 0; k < K; k++ )
             {
@@ -2645,13 +2723,18 @@ public:
 
                 if( min_dist > dist )
                 {
+                    min_dist2 = min_dist;
                     min_dist = dist;
                     k_best = k;
                 }
+                else if( min_dist2 > dist )
+                    min_dist2 = dist;
             }
 
             distances[i] = min_dist;
             labels[i] = k_best;
+            if( lower )
+                lower[i] = std::sqrt(min_dist2);
         }
     }
 
@@ -2662,29 +2745,123 @@ private:
     int *labels;
     const Mat& data;
     const Mat& centers;
+    double *lower;
+    const double *halfGaps;
+    const double *shifts;
+    double maxShift[2];
+    int maxShiftIdx;
+};
+
+// halfGaps[k] = the half distance from the k-th center to the nearest other center
+class KMeansCenterGapComputer : public ParallelLoopBody
+{
+public:
+    KMeansCenterGapComputer( const Mat& _centers, double* _halfGaps )
+        : centers(_centers), halfGaps(_halfGaps) {}
+
+    void operator()( const Range& range ) const
+    {
+        int K = centers.rows, dims = centers.cols;
+        for( int k = range.start; k < range.end; k++ )
+        {
+            const float* center = centers.ptr<float>(k);
+            double min_dist = DBL_MAX;
+            for( int k1 = 0; k1 < K; k1++ )
+                if( k1 != k )
+                    min_dist = std::min(min_dist, (double)normL2Sqr_(center, centers.ptr<float>(k1), dims));
+            halfGaps[k] = std::sqrt(min_dist)*0.5;
+        }
+    }
+
+private:
+    KMeansCenterGapComputer& operator=(const KMeansCenterGapComputer&); // to quiet MSVC
+
+    const Mat& centers;
+    double* halfGaps;
+};
+
+/*
+sums the samples of each cluster and counts them. The centers are split between the threads,
+so every sum is accumulated in the order of the samples, the same as in the serial loop.
+*/
+class KMeansCenterAccumulator : public ParallelLoopBody
+{
+public:
+    KMeansCenterAccumulator( const Mat& _data, const int* _labels, Mat& _centers, int* _counters )
+        : data(_data), labels(_labels), centers(_centers), counters(_counters) {}
+
+    void operator()( const Range& range ) const
+    {
+        int N = data.rows, dims = data.cols;
+        for( int i = 0; i < N; i++ )
+        {
+            int k = labels[i];
+            if( k < range.start || k >= range.end )
+                continue;
+            const float* sample = data.ptr<float>(i);
+            float* center = centers.ptr<float>(k);
+            int j = 0;
+            #if CV_ENABLE_UNROLLED
+            for(; j <= dims - 4; j += 4 )
+            {
+                float t0 = center[j] + sample[j];
+                float t1 = center[j+1] + sample[j+1];
+
+                center[j] = t0;
+                center[j+1] = t1;
+
+                t0 = center[j+2] + sample[j+2];
+                t1 = center[j+3] + sample[j+3];
+
+                center[j+2] = t0;
+                center[j+3] = t1;
+            }
+            #endif
+            for( ; j < dims; j++ )
+                center[j] += sample[j];
+            counters[k]++;
+        }
+    }
+
+private:
+    KMeansCenterAccumulator& operator=(const KMeansCenterAccumulator&); // to quiet MSVC
+
+    const Mat& data;
+    const int* labels;
+    Mat& centers;
+    int* counters;
 };
 
+static void accumulateCenters( const Mat& data, const int* labels, Mat& centers, int* counters )
+{
+    int K = centers.rows;
+    centers = Scalar(0);
+    for( int k = 0; k < K; k++ )
+        counters[k] = 0;
+    // every stripe reads all the labels, so there are not more stripes than threads
+    parallel_for_(Range(0, K), KMeansCenterAccumulator(data, labels, centers, counters),
+                  std::min((double)std::min(K, getNumThreads()), (double)data.rows*data.cols/65536));
 }
 
-double cv::kmeans( InputArray _data, int K,
-                   InputOutputArray _bestLabels,
-                   TermCriteria criteria, int attempts,
-                   int flags, OutputArray _centers )
+// the samples of the 1-row multi-channel array are treated as rows of a single-channel one
+static Mat getKMeansSamples( InputArray _data )
 {
-    const int SPP_TRIALS = 3;
     Mat data = _data.getMat();
     bool isrow = data.rows == 1 && data.channels() > 1;
-    int N = !isrow ? data.rows : data.cols;
-    int dims = (!isrow ? data.cols : 1)*data.channels();
-    int type = data.depth();
-
-    attempts = std::max(attempts, 1);
-    CV_Assert( data.dims <= 2 && type == CV_32F && K > 0 );
-    CV_Assert( N >= K );
+    CV_Assert( data.dims <= 2 && data.depth() == CV_32F );
+    if( isrow )
+        data = data.reshape(1, data.cols);
+    else if( data.channels() > 1 )
+        data = data.reshape(1, data.rows);
+    return data;
+}
 
+static void createKMeansLabels( InputOutputArray _bestLabels, int N, int flags,
+                                Mat& best_labels, Mat& _labels )
+{
     _bestLabels.create(N, 1, CV_32S, -1, true);
 
-    Mat _labels, best_labels = _bestLabels.getMat();
+    best_labels = _bestLabels.getMat();
     if( flags & CV_KMEANS_USE_INITIAL_LABELS )
     {
         CV_Assert( (best_labels.cols == 1 || best_labels.rows == 1) &&
@@ -2702,12 +2879,35 @@ double cv::kmeans( InputArray _data, int K,
             best_labels.create(N, 1, CV_32S);
         _labels.create(best_labels.size(), best_labels.type());
     }
+}
+
+}
+
+double cv::kmeans( InputArray _data, int K,
+                   InputOutputArray _bestLabels,
+                   TermCriteria criteria, int attempts,
+                   int flags, OutputArray _centers )
+{
+    const int SPP_TRIALS = 3;
+    Mat data = getKMeansSamples(_data);
+    int N = data.rows;
+    int dims = data.cols;
+    int type = data.depth();
+
+    attempts = std::max(attempts, 1);
+    CV_Assert( K > 0 );
+    CV_Assert( N >= K );
+
+    Mat _labels, best_labels;
+    createKMeansLabels(_bestLabels, N, flags, best_labels, _labels);
     int* labels = _labels.ptr<int>();
 
     Mat centers(K, dims, type), old_centers(K, dims, type), temp(1, dims, type);
     vector<int> counters(K);
     vector<Vec2f> _box(dims);
     Vec2f* box = &_box[0];
+    // the bounds of the assignment step, see KMeansDistanceComputer
+    vector<double> lower(N), shifts(K), halfGaps(K);
     double best_compactness = DBL_MAX, compactness = 0;
     RNG& rng = theRNG();
     int a, iter, i, j, k;
@@ -2770,36 +2970,7 @@ double cv::kmeans( InputArray _data, int K,
                 }
 
                 // compute centers
-                centers = Scalar(0);
-                for( k = 0; k < K; k++ )
-                    counters[k] = 0;
-
-                for( i = 0; i < N; i++ )
-                {
-                    sample = data.ptr<float>(i);
-                    k = labels[i];
-                    float* center = centers.ptr<float>(k);
-                    j=0;
-                    #if CV_ENABLE_UNROLLED
-                    for(; j <= dims - 4; j += 4 )
-                    {
-                        float t0 = center[j] + sample[j];
-                        float t1 = center[j+1] + sample[j+1];
-
-                        center[j] = t0;
-                        center[j+1] = t1;
-
-                        t0 = center[j+2] + sample[j+2];
-                        t1 = center[j+3] + sample[j+3];
-
-                        center[j+2] = t0;
-                        center[j+3] = t1;
-                    }
-                    #endif
-                    for( ; j < dims; j++ )
-                        center[j] += sample[j];
-                    counters[k]++;
-                }
+                accumulateCenters(data, labels, centers, &counters[0]);
 
                 if( iter > 0 )
                     max_center_shift = 0;
@@ -2846,6 +3017,8 @@ double cv::kmeans( InputArray _data, int K,
                     counters[max_k]--;
                     counters[k]++;
                     labels[farthest_i] = k;
+                    // the lower bound was computed for the old label
+                    lower[farthest_i] = 0;
                     sample = data.ptr<float>(farthest_i);
 
                     for( j = 0; j < dims; j++ )
@@ -2874,6 +3047,7 @@ double cv::kmeans( InputArray _data, int K,
                             dist += t*t;
                         }
                         max_center_shift = std::max(max_center_shift, dist);
+                        shifts[k] = std::sqrt(dist);
                     }
                 }
             }
@@ -2881,11 +3055,21 @@ double cv::kmeans( InputArray _data, int K,
             if( ++iter == MAX(criteria.maxCount, 2) || max_center_shift <= criteria.epsilon )
                 break;
 
-            // assign labels
+            // assign labels; the bounds are valid after the first assignment of the attempt
             Mat dists(1, N, CV_64F);
             double* dist = dists.ptr<double>(0);
-            parallel_for(BlockedRange(0, N),
-                         KMeansDistanceComputer(dist, labels, data, centers));
+            double nstripes = (double)N*K*dims/65536;
+            if( iter > 1 )
+            {
+                parallel_for_(Range(0, K), KMeansCenterGapComputer(centers, &halfGaps[0]),
+                              (double)K*K*dims/65536);
+                parallel_for_(Range(0, N),
+                              KMeansDistanceComputer(dist, labels, data, centers,
+                                                     &lower[0], &halfGaps[0], &shifts[0]), nstripes);
+            }
+            else
+                parallel_for_(Range(0, N),
+                              KMeansDistanceComputer(dist, labels, data, centers, &lower[0]), nstripes);
             compactness = 0;
             for( i = 0; i < N; i++ )
             {
@@ -2905,6 +3089,156 @@ double cv::kmeans( InputArray _data, int K,
     return best_compactness;
 }
 
+double cv::kmeansMiniBatch( InputArray _data, int K,
+                            InputOutputArray _bestLabels,
+                            TermCriteria criteria, int batchSize,
+                            int flags, OutputArray _centers )
+{
+    const int SPP_TRIALS = 3;
+    Mat data = getKMeansSamples(_data);
+    int N = data.rows;
+    int dims = data.cols;
+    int type = data.depth();
+    int i, j, k, iter;
+
+    CV_Assert( K > 0 && batchSize > 0 );
+    CV_Assert( N >= K );
+    batchSize = std::min(batchSize, N);
+
+    Mat _labels, best_labels;
+    createKMeansLabels(_bestLabels, N, flags, best_labels, _labels);
+    int* labels = _labels.ptr<int>();
+
+    Mat centers(K, dims, type);
+    vector<int> counters(K);
+    RNG& rng = theRNG();
+
+    bool checkEps = (criteria.type & TermCriteria::EPS) != 0;
+    criteria.epsilon = std::max(criteria.epsilon, 0.);
+    criteria.epsilon *= criteria.epsilon;
+    criteria.maxCount = criteria.type & TermCriteria::COUNT ? std::max(criteria.maxCount, 1) : 100;
+
+    if( flags & KMEANS_USE_INITIAL_LABELS )
+    {
+        for( i = 0; i < N; i++ )
+            CV_Assert( (unsigned)labels[i] < (unsigned)K );
+        accumulateCenters(data, labels, centers, &counters[0]);
+        for( k = 0; k < K; k++ )
+        {
+            float* center = centers.ptr<float>(k);
+            if( counters[k] == 0 )
+            {
+                // an empty cluster starts from a random sample
+                const float* sample = data.ptr<float>(rng.uniform(0, N));
+                std::copy(sample, sample + dims, center);
+                continue;
+            }
+            float scale = 1.f/counters[k];
+            for( j = 0; j < dims; j++ )
+                center[j] *= scale;
+        }
+    }
+    else
+    {
+        // the initial centers are chosen from a random subset of the samples
+        int initSize = std::min(N, std::max(batchSize*3, K*3));
+        Mat initSamples(initSize, dims, type);
+        for( i = 0; i < initSize; i++ )
+            data.row(initSize < N ? rng.uniform(0, N) : i).copyTo(initSamples.row(i));
+
+        if( flags & KMEANS_PP_CENTERS )
+            generateCentersPP(initSamples, centers, K, rng, SPP_TRIALS);
+        else
+        {
+            vector<Vec2f> box(dims);
+            for( j = 0; j < dims; j++ )
+                box[j] = Vec2f(FLT_MAX, -FLT_MAX);
+            for( i = 0; i < initSize; i++ )
+            {
+                const float* sample = initSamples.ptr<float>(i);
+                for( j = 0; j < dims; j++ )
+                {
+                    box[j][0] = std::min(box[j][0], sample[j]);
+                    box[j][1] = std::max(box[j][1], sample[j]);
+                }
+            }
+            for( k = 0; k < K; k++ )
+                generateRandomCenter(box, centers.ptr<float>(k), rng);
+        }
+    }
+    std::fill(counters.begin(), counters.end(), 0);
+
+    /*
+    Sculley (2010) Web-scale k-means clustering: each batch of random samples is assigned
+    to the nearest centers, and every center moves towards the mean of its samples in the batch
+    with the learning rate of 1/(the number of samples the center has got so far).
+    */
+    Mat batch(batchSize, dims, type), sums(K, dims, CV_64F);
+    vector<int> batchLabels(batchSize), batchCounters(K);
+    vector<double> batchDist(batchSize);
+
+    for( iter = 0; iter < criteria.maxCount; iter++ )
+    {
+        for( i = 0; i < batchSize; i++ )
+        {
+            const float* sample = data.ptr<float>(rng.uniform(0, N));
+            std::copy(sample, sample + dims, batch.ptr<float>(i));
+        }
+
+        parallel_for_(Range(0, batchSize),
+                      KMeansDistanceComputer(&batchDist[0], &batchLabels[0], batch, centers),
+                      (double)batchSize*K*dims/65536);
+
+        sums = Scalar(0);
+        std::fill(batchCounters.begin(), batchCounters.end(), 0);
+        for( i = 0; i < batchSize; i++ )
+        {
+            const float* sample = batch.ptr<float>(i);
+            double* sum = sums.ptr<double>(batchLabels[i]);
+            for( j = 0; j < dims; j++ )
+                sum[j] += sample[j];
+            batchCounters[batchLabels[i]]++;
+        }
+
+        double max_center_shift = 0;
+        for( k = 0; k < K; k++ )
+        {
+            int n = batchCounters[k];
+            if( n == 0 )
+                continue;
+            counters[k] += n;
+
+            float* center = centers.ptr<float>(k);
+            const double* sum = sums.ptr<double>(k);
+            double scale = 1./counters[k], dist = 0;
+            for( j = 0; j < dims; j++ )
+            {
+                double t = (sum[j] - n*(double)center[j])*scale;
+                center[j] = (float)(center[j] + t);
+                dist += t*t;
+            }
+            max_center_shift = std::max(max_center_shift, dist);
+        }
+
+        if( checkEps && max_center_shift <= criteria.epsilon )
+            break;
+    }
+
+    // the final assignment of all the samples
+    Mat dists(1, N, CV_64F);
+    double* dist = dists.ptr<double>(0);
+    parallel_for_(Range(0, N), KMeansDistanceComputer(dist, labels, data, centers),
+                  (double)N*K*dims/65536);
+    double compactness = 0;
+    for( i = 0; i < N; i++ )
+        compactness += dist[i];
+
+    if( _centers.needed() )
+        centers.copyTo(_centers);
+    _labels.copyTo(best_labels);
+    return compactness;
+}
+
 
 CV_IMPL void cvSetIdentity( CvArr* arr, CvScalar value )
 {
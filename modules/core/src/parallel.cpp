@@ -79,6 +79,7 @@
    3. HAVE_OPENMP      - integrated to compiler, should be explicitly enabled
    4. HAVE_GCD         - system wide, used automatically        (APPLE only)
    5. HAVE_CONCURRENCY - part of runtime, used automatically    (Windows only - MSVS 10, MSVS 11)
+   6. HAVE_PTHREADS_PF - built-in pthreads-based thread pool, enabled by default (see parallel_pthreads.cpp)
 */
 
 #if defined HAVE_TBB
@@ -110,7 +111,8 @@
     #endif
 #endif
 
-#if defined HAVE_TBB || defined HAVE_CSTRIPES || defined HAVE_OPENMP || defined HAVE_GCD || defined HAVE_CONCURRENCY
+#if defined HAVE_TBB || defined HAVE_CSTRIPES || defined HAVE_OPENMP || defined HAVE_GCD || defined HAVE_CONCURRENCY \
+    || defined HAVE_PTHREADS_PF
    #define HAVE_PARALLEL_FRAMEWORK
 #endif
 
@@ -134,6 +136,7 @@ namespace
         }
         void operator()(const cv::Range& sr) const
         {
+            CV_TRACE_REGION("cv::parallel_for_ stripe");
             cv::Range r;
             r.start = (int)(wholeRange.start +
                             ((size_t)sr.start*(wholeRange.end - wholeRange.start) + nstripes/2)/nstripes);
@@ -184,6 +187,19 @@ namespace
             this->ParallelLoopBodyWrapper::operator()(cv::Range(i, i + 1));
         }
     };
+#elif defined HAVE_PTHREADS_PF
+    class ProxyLoopBody : public cv::ParallelLoopBody, public ParallelLoopBodyWrapper
+    {
+    public:
+        ProxyLoopBody(const cv::ParallelLoopBody& _body, const cv::Range& _r, double _nstripes)
+        : ParallelLoopBodyWrapper(_body, _r, _nstripes)
+        {}
+
+        void operator ()(const cv::Range& range) const
+        {
+            this->ParallelLoopBodyWrapper::operator()(range);
+        }
+    };
 #else
     typedef ParallelLoopBodyWrapper ProxyLoopBody;
 #endif
@@ -216,6 +232,8 @@ public:
     ~SchedPtr() { *this = 0; }
 };
 static SchedPtr pplScheduler;
+#elif defined HAVE_PTHREADS_PF
+// the thread pool lives in parallel_pthreads.cpp
 #endif
 
 #endif // HAVE_PARALLEL_FRAMEWORK
@@ -226,6 +244,8 @@ static SchedPtr pplScheduler;
 
 void cv::parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body, double nstripes)
 {
+    CV_TRACE_REGION("cv::parallel_for_");
+
 #ifdef HAVE_PARALLEL_FRAMEWORK
 
     if(numThreads != 0)
@@ -272,6 +292,10 @@ void cv::parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body,
             Concurrency::CurrentScheduler::Detach();
         }
 
+#elif defined HAVE_PTHREADS_PF
+
+        parallel_for_pthreads(stripeRange, pbody);
+
 #else
 
 #error You have hacked and compiling with unsupported parallel framework
@@ -321,6 +345,10 @@ int cv::getNumThreads(void)
                 ? Concurrency::CurrentScheduler::Get()->GetNumberOfVirtualProcessors()
                 : pplScheduler->GetNumberOfVirtualProcessors());
 
+#elif defined HAVE_PTHREADS_PF
+
+    return parallel_pthreads_get_threads_num();
+
 #else
 
     return 1;
@@ -374,6 +402,10 @@ void cv::setNumThreads( int threads )
                        Concurrency::MaxConcurrency, threads-1));
     }
 
+#elif defined HAVE_PTHREADS_PF
+
+    parallel_pthreads_set_threads_num(threads);
+
 #endif
 }
 
@@ -394,6 +426,8 @@ int cv::getThreadNum(void)
     return (int)(size_t)(void*)pthread_self(); // no zero-based indexing
 #elif defined HAVE_CONCURRENCY
     return std::max(0, (int)Concurrency::Context::VirtualProcessorId()); // zero for master thread, unique number for others but not necessary 1,2,3,...
+#elif defined HAVE_PTHREADS_PF
+    return parallel_pthreads_get_thread_num(); // zero for the calling thread, 1..N-1 for the pool workers
 #else
     return 0;
 #endif
@@ -0,0 +1,397 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+
+#if defined HAVE_PTHREADS_PF
+
+#include <pthread.h>
+
+/*
+   Built-in parallel_for_ backend on top of plain pthreads.
+
+   The pool keeps (nthreads - 1) workers alive between calls; the calling thread
+   takes part in every job as worker #0. Each job is a range of stripe indices
+   that is split evenly between the per-worker queues. A worker consumes its own
+   queue from the front and, once it runs dry, steals the upper half of another
+   worker's queue, so that uneven stripes get rebalanced without a central counter.
+
+   Only one job runs at a time. parallel_for_ called while the pool is busy
+   (from inside a loop body or from another application thread) is executed
+   serially by the calling thread, which keeps nested loops from oversubscribing
+   the CPU.
+*/
+
+namespace cv
+{
+
+namespace
+{
+
+class StripeQueue
+{
+public:
+    StripeQueue() : begin(0), end(0) { pthread_mutex_init(&mutex, 0); }
+    ~StripeQueue() { pthread_mutex_destroy(&mutex); }
+
+    void reset(int _begin, int _end)
+    {
+        pthread_mutex_lock(&mutex);
+        begin = _begin; end = _end;
+        pthread_mutex_unlock(&mutex);
+    }
+
+    // the owner takes stripes one by one from the front
+    bool pop(int& stripe)
+    {
+        bool ok = false;
+        pthread_mutex_lock(&mutex);
+        if( begin < end )
+        {
+            stripe = begin++;
+            ok = true;
+        }
+        pthread_mutex_unlock(&mutex);
+        return ok;
+    }
+
+    // a thief takes the upper half of the remaining stripes
+    bool steal(int& _begin, int& _end)
+    {
+        bool ok = false;
+        pthread_mutex_lock(&mutex);
+        int len = end - begin;
+        if( len > 0 )
+        {
+            _end = end;
+            _begin = end - (len + 1)/2;
+            end = _begin;
+            ok = true;
+        }
+        pthread_mutex_unlock(&mutex);
+        return ok;
+    }
+
+private:
+    StripeQueue(const StripeQueue&);
+    StripeQueue& operator = (const StripeQueue&);
+
+    pthread_mutex_t mutex;
+    int begin, end;
+    // keep the queues of different workers in different cache lines
+    char padding[64];
+};
+
+class ThreadPool
+{
+public:
+    ThreadPool();
+    ~ThreadPool();
+
+    void run(const Range& stripeRange, const ParallelLoopBody& body);
+
+    int getNumThreads() const { return numThreads; }
+    void setNumThreads(int n) { numThreads = n > 0 ? n : getNumberOfCPUs(); }
+
+    static int getThreadNum();
+
+private:
+    struct WorkerArg
+    {
+        ThreadPool* pool;
+        int idx;
+        unsigned generation;
+    };
+
+    static void* workerMain(void* arg);
+
+    void startWorkers(int n);
+    void stopWorkers();
+    void processStripes(int idx);
+
+    volatile int numThreads;
+    int numWorkers;
+
+    std::vector<pthread_t> threads;
+    std::vector<WorkerArg> args;
+    StripeQueue* queues;
+
+    // serializes jobs; a failed trylock means "already inside parallel_for_"
+    pthread_mutex_t jobMutex;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t jobCond;
+    pthread_cond_t doneCond;
+    unsigned generation;
+    int pendingWorkers;
+    bool stopping;
+    const ParallelLoopBody* body;
+
+    bool hasException;
+    Exception exception;
+};
+
+static pthread_key_t threadNumKey;
+static pthread_once_t threadNumKeyOnce = PTHREAD_ONCE_INIT;
+
+static void createThreadNumKey()
+{
+    pthread_key_create(&threadNumKey, 0);
+}
+
+ThreadPool::ThreadPool()
+    : numThreads(0), numWorkers(0), queues(0), generation(0),
+      pendingWorkers(0), stopping(false), body(0), hasException(false)
+{
+    pthread_once(&threadNumKeyOnce, createThreadNumKey);
+    pthread_mutex_init(&jobMutex, 0);
+    pthread_mutex_init(&mutex, 0);
+    pthread_cond_init(&jobCond, 0);
+    pthread_cond_init(&doneCond, 0);
+    setNumThreads(0);
+}
+
+ThreadPool::~ThreadPool()
+{
+    stopWorkers();
+    pthread_cond_destroy(&doneCond);
+    pthread_cond_destroy(&jobCond);
+    pthread_mutex_destroy(&mutex);
+    pthread_mutex_destroy(&jobMutex);
+}
+
+int ThreadPool::getThreadNum()
+{
+    pthread_once(&threadNumKeyOnce, createThreadNumKey);
+    return (int)(size_t)pthread_getspecific(threadNumKey);
+}
+
+void ThreadPool::startWorkers(int n)
+{
+    numWorkers = n;
+    stopping = false;
+    queues = new StripeQueue[n + 1];
+    threads.resize(n);
+    args.resize(n);
+
+    for( int i = 0; i < n; i++ )
+    {
+        args[i].pool = this;
+        args[i].idx = i + 1;
+        args[i].generation = generation;
+        if( pthread_create(&threads[i], 0, workerMain, &args[i]) != 0 )
+        {
+            // could not spawn all the requested threads; run with the ones we have
+            numWorkers = i;
+            threads.resize(i);
+            break;
+        }
+    }
+}
+
+void ThreadPool::stopWorkers()
+{
+    pthread_mutex_lock(&mutex);
+    stopping = true;
+    pthread_cond_broadcast(&jobCond);
+    pthread_mutex_unlock(&mutex);
+
+    for( size_t i = 0; i < threads.size(); i++ )
+        pthread_join(threads[i], 0);
+
+    threads.clear();
+    numWorkers = 0;
+    delete[] queues;
+    queues = 0;
+}
+
+void* ThreadPool::workerMain(void* _arg)
+{
+    WorkerArg* arg = (WorkerArg*)_arg;
+    ThreadPool* pool = arg->pool;
+    pthread_setspecific(threadNumKey, (void*)(size_t)arg->idx);
+
+    // a worker joins only the jobs submitted after it has been started
+    unsigned seen = arg->generation;
+    for(;;)
+    {
+        pthread_mutex_lock(&pool->mutex);
+        while( !pool->stopping && pool->generation == seen )
+            pthread_cond_wait(&pool->jobCond, &pool->mutex);
+        if( pool->stopping )
+        {
+            pthread_mutex_unlock(&pool->mutex);
+            break;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->mutex);
+
+        pool->processStripes(arg->idx);
+
+        pthread_mutex_lock(&pool->mutex);
+        if( --pool->pendingWorkers == 0 )
+            pthread_cond_signal(&pool->doneCond);
+        pthread_mutex_unlock(&pool->mutex);
+    }
+    return 0;
+}
+
+void ThreadPool::processStripes(int idx)
+{
+    int nqueues = numWorkers + 1;
+    StripeQueue& own = queues[idx];
+
+    for(;;)
+    {
+        int stripe = 0, stolenBegin = 0, stolenEnd = 0;
+        if( !own.pop(stripe) )
+        {
+            bool stolen = false;
+            for( int i = 1; i < nqueues && !stolen; i++ )
+                stolen = queues[(idx + i) % nqueues].steal(stolenBegin, stolenEnd);
+            if( !stolen )
+                break;
+            stripe = stolenBegin;
+            own.reset(stolenBegin + 1, stolenEnd);
+        }
+
+        try
+        {
+            (*body)(Range(stripe, stripe + 1));
+        }
+        catch(const Exception& e)
+        {
+            pthread_mutex_lock(&mutex);
+            if( !hasException )
+            {
+                hasException = true;
+                exception = e;
+            }
+            pthread_mutex_unlock(&mutex);
+        }
+        catch(...)
+        {
+            pthread_mutex_lock(&mutex);
+            if( !hasException )
+            {
+                hasException = true;
+                exception = Exception(CV_StsError, "Unknown exception in parallel loop body",
+                                      "parallel_for_", __FILE__, __LINE__);
+            }
+            pthread_mutex_unlock(&mutex);
+        }
+    }
+}
+
+void ThreadPool::run(const Range& stripeRange, const ParallelLoopBody& _body)
+{
+    int nstripes = stripeRange.end - stripeRange.start;
+    if( nstripes <= 1 || numThreads <= 1 || pthread_mutex_trylock(&jobMutex) != 0 )
+    {
+        _body(stripeRange);
+        return;
+    }
+
+    if( numWorkers + 1 != numThreads )
+    {
+        stopWorkers();
+        startWorkers(numThreads - 1);
+    }
+
+    int nqueues = numWorkers + 1;
+    for( int i = 0; i < nqueues; i++ )
+        queues[i].reset(stripeRange.start + (int)((int64)nstripes*i/nqueues),
+                        stripeRange.start + (int)((int64)nstripes*(i + 1)/nqueues));
+
+    pthread_mutex_lock(&mutex);
+    body = &_body;
+    hasException = false;
+    pendingWorkers = numWorkers;
+    generation++;
+    pthread_cond_broadcast(&jobCond);
+    pthread_mutex_unlock(&mutex);
+
+    processStripes(0);
+
+    pthread_mutex_lock(&mutex);
+    while( pendingWorkers > 0 )
+        pthread_cond_wait(&doneCond, &mutex);
+    body = 0;
+    bool rethrow = hasException;
+    Exception e;
+    if( rethrow )
+        e = exception;
+    pthread_mutex_unlock(&mutex);
+
+    pthread_mutex_unlock(&jobMutex);
+
+    if( rethrow )
+        throw e;
+}
+
+static ThreadPool threadPool;
+
+}
+
+void parallel_for_pthreads(const Range& stripeRange, const ParallelLoopBody& body)
+{
+    threadPool.run(stripeRange, body);
+}
+
+int parallel_pthreads_get_threads_num()
+{
+    return threadPool.getNumThreads();
+}
+
+void parallel_pthreads_set_threads_num(int num)
+{
+    threadPool.setNumThreads(num);
+}
+
+int parallel_pthreads_get_thread_num()
+{
+    return ThreadPool::getThreadNum();
+}
+
+}
+
+#endif
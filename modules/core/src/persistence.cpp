@@ -68,6 +68,21 @@
 #  include <zlib.h>
 #endif
 
+#if (defined WIN32 || defined _WIN32) && !defined WINCE
+#  include <windows.h>
+#  undef small
+#  undef min
+#  undef max
+#  undef abs
+#  define HAVE_WIN32_FILE_MAPPING
+#elif defined __unix__ || defined __APPLE__
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  define HAVE_MMAP
+#endif
+
 /****************************************************************************************\
 *                            Common macros and type definitions                          *
 \****************************************************************************************/
@@ -199,6 +214,69 @@ typedef void (*CvWriteString)( struct CvFileStorage* fs, const char* key,
 typedef void (*CvWriteComment)( struct CvFileStorage* fs, const char* comment, int eol_comment );
 typedef void (*CvStartNextStream)( struct CvFileStorage* fs );
 
+namespace cv
+{
+
+/*
+   A private (copy-on-write) mapping of a whole file, used to read the binary file storages.
+   It is also the allocator of the Mat views into the mapping: every view holds a reference,
+   so the mapping stays alive after the file storage is released. On the platforms without
+   file mapping the file is read into memory.
+*/
+class FileMapping : public MatAllocator
+{
+public:
+    // returns 0 if the file can not be opened
+    static FileMapping* open( const char* filename );
+
+    void addref() { CV_XADD(&refcount, 1); }
+    void release() { if( CV_XADD(&refcount, -1) == 1 ) delete this; }
+
+    const uchar* data() const { return ptr; }
+    size_t size() const { return len; }
+
+    // the matrix header for the mapped data at p, which must be inside the mapping
+    Mat view( int dims, const int* sizes, int type, const uchar* p );
+
+    void allocate( int dims, const int* sizes, int type, int*& refcount,
+                   uchar*& datastart, uchar*& data, size_t* step );
+    void deallocate( int* refcount, uchar* datastart, uchar* data );
+
+protected:
+    FileMapping() : refcount(1), ptr(0), len(0) {}
+    ~FileMapping();
+
+    int refcount;
+    uchar* ptr;
+    size_t len;
+#ifdef HAVE_WIN32_FILE_MAPPING
+    HANDLE file, mapping;
+#endif
+};
+
+}
+
+/*
+   The binary file storage starts with this header, followed by the matrix data blocks, each
+   aligned to CV_FS_BLOB_ALIGN bytes. The file node tree is stored after the data as YAML text,
+   where the matrices have "blob_offset" (the file offset of the data) instead of "data".
+   The signature is a text line, so the format is detected the same way as XML and YAML.
+*/
+typedef struct CvBinaryStorageHeader
+{
+    char signature[16];
+    unsigned byte_order;
+    unsigned header_size;
+    uint64 tree_offset;
+    uint64 tree_size;
+    char reserved[24];
+}
+CvBinaryStorageHeader;
+
+#define CV_FS_BINARY_SIGNATURE "%BINARY:1.0\n"
+#define CV_FS_BYTE_ORDER_MARK  0x01020304
+#define CV_FS_BLOB_ALIGN       64
+
 typedef struct CvFileStorage
 {
     int flags;
@@ -240,6 +318,9 @@ typedef struct CvFileStorage
     std::deque<char>* outbuf;
 
     bool is_opened;
+
+    cv::FileMapping* mapping;
+    uint64 blob_pos;
 }
 CvFileStorage;
 
@@ -326,6 +407,196 @@ static void icvRewind( CvFileStorage* fs )
     fs->strbufpos = 0;
 }
 
+/****************************************************************************************\
+*                                  Binary file storage                                   *
+\****************************************************************************************/
+
+cv::FileMapping* cv::FileMapping::open( const char* filename )
+{
+    FileMapping* m = new FileMapping;
+
+#if defined HAVE_WIN32_FILE_MAPPING
+    LARGE_INTEGER fsize;
+    m->mapping = 0;
+    m->file = CreateFileA( filename, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, 0 );
+    if( m->file != INVALID_HANDLE_VALUE && GetFileSizeEx( m->file, &fsize ) && fsize.QuadPart > 0 )
+    {
+        m->mapping = CreateFileMappingA( m->file, 0, PAGE_WRITECOPY, 0, 0, 0 );
+        if( m->mapping )
+        {
+            m->ptr = (uchar*)MapViewOfFile( m->mapping, FILE_MAP_COPY, 0, 0, 0 );
+            m->len = (size_t)fsize.QuadPart;
+        }
+    }
+#elif defined HAVE_MMAP
+    struct stat st;
+    int fd = ::open( filename, O_RDONLY );
+    if( fd >= 0 && fstat( fd, &st ) == 0 && st.st_size > 0 )
+    {
+        void* p = mmap( 0, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+        if( p != MAP_FAILED )
+        {
+            m->ptr = (uchar*)p;
+            m->len = (size_t)st.st_size;
+        }
+    }
+    if( fd >= 0 )
+        close( fd );
+#else
+    FILE* f = fopen( filename, "rb" );
+    if( f )
+    {
+        fseek( f, 0, SEEK_END );
+        long fsize = ftell( f );
+        fseek( f, 0, SEEK_SET );
+        if( fsize > 0 )
+        {
+            m->ptr = (uchar*)fastMalloc( fsize );
+            m->len = (size_t)fsize;
+            if( fread( m->ptr, 1, m->len, f ) != m->len )
+            {
+                fastFree( m->ptr );
+                m->ptr = 0;
+            }
+        }
+        fclose( f );
+    }
+#endif
+
+    if( !m->ptr )
+    {
+        m->release();
+        m = 0;
+    }
+    return m;
+}
+
+cv::FileMapping::~FileMapping()
+{
+#if defined HAVE_WIN32_FILE_MAPPING
+    if( ptr )
+        UnmapViewOfFile( ptr );
+    if( mapping )
+        CloseHandle( mapping );
+    if( file != INVALID_HANDLE_VALUE )
+        CloseHandle( file );
+#elif defined HAVE_MMAP
+    if( ptr )
+        munmap( ptr, len );
+#else
+    fastFree( ptr );
+#endif
+}
+
+cv::Mat cv::FileMapping::view( int dims, const int* sizes, int type, const uchar* p )
+{
+    CV_Assert( ptr <= p && p < ptr + len );
+    Mat m( dims, sizes, type, (void*)p );
+    m.refcount = new int(1);
+    m.allocator = this;
+    addref();
+    return m;
+}
+
+// a view that is reallocated by Mat::create() gets a regular buffer
+void cv::FileMapping::allocate( int dims, const int* sizes, int type, int*& _refcount,
+                                uchar*& datastart, uchar*& data, size_t* step )
+{
+    size_t total = CV_ELEM_SIZE(type);
+    for( int i = dims-1; i >= 0; i-- )
+    {
+        step[i] = total;
+        total *= sizes[i];
+    }
+    total = alignSize( total, (int)sizeof(*_refcount) );
+    data = datastart = (uchar*)fastMalloc( total + sizeof(*_refcount) );
+    _refcount = (int*)(data + total);
+    *_refcount = 1;
+    addref();
+}
+
+void cv::FileMapping::deallocate( int* _refcount, uchar* datastart, uchar* )
+{
+    if( ptr <= datastart && datastart < ptr + len )
+        delete _refcount;
+    else
+        fastFree( datastart );
+    release();
+}
+
+static void icvWriteBinaryData( CvFileStorage* fs, const void* data, size_t size )
+{
+    if( size > 0 && fwrite( data, 1, size, fs->file ) != size )
+        CV_Error( CV_StsError, "Could not write the binary file storage" );
+    fs->blob_pos += size;
+}
+
+// pads the file to the next data block and returns its offset
+static uint64 icvStartBinaryBlob( CvFileStorage* fs )
+{
+    static const char zeros[CV_FS_BLOB_ALIGN] = {0};
+    icvWriteBinaryData( fs, zeros, (size_t)((CV_FS_BLOB_ALIGN - fs->blob_pos % CV_FS_BLOB_ALIGN) % CV_FS_BLOB_ALIGN) );
+    return fs->blob_pos;
+}
+
+// appends the file node tree, which was written to fs->outbuf, and fills the header
+static void icvFinishBinaryStorage( CvFileStorage* fs )
+{
+    CvBinaryStorageHeader header;
+    memset( &header, 0, sizeof(header) );
+    strcpy( header.signature, CV_FS_BINARY_SIGNATURE );
+    header.byte_order = CV_FS_BYTE_ORDER_MARK;
+    header.header_size = (unsigned)sizeof(header);
+    header.tree_offset = fs->blob_pos;
+    header.tree_size = fs->outbuf->size();
+
+    std::vector<char> tree( fs->outbuf->begin(), fs->outbuf->end() );
+    icvWriteBinaryData( fs, tree.empty() ? 0 : &tree[0], tree.size() );
+
+    if( fseek( fs->file, 0, SEEK_SET ) != 0 || fwrite( &header, sizeof(header), 1, fs->file ) != 1 )
+        CV_Error( CV_StsError, "Could not write the binary file storage" );
+}
+
+// maps the file and makes the file node tree the input of the YAML parser
+static void icvOpenBinaryStorage( CvFileStorage* fs )
+{
+    fs->mapping = cv::FileMapping::open( fs->filename );
+    if( !fs->mapping )
+        CV_Error_( CV_StsError, ("Could not map the file storage %s", fs->filename) );
+
+    const CvBinaryStorageHeader* header = (const CvBinaryStorageHeader*)fs->mapping->data();
+    size_t size = fs->mapping->size();
+
+    if( size < sizeof(*header) || header->header_size != sizeof(*header) ||
+        header->tree_offset > size || header->tree_size > size - header->tree_offset )
+    {
+        if( size >= sizeof(*header) && header->byte_order != CV_FS_BYTE_ORDER_MARK )
+            CV_Error( CV_StsNotImplemented, "The binary file storage was written on a machine with a different byte order" );
+        CV_Error_( CV_StsParseError, ("The binary file storage %s is corrupted", fs->filename) );
+    }
+
+    fs->strbuf = (const char*)fs->mapping->data() + header->tree_offset;
+    fs->strbufsize = (size_t)header->tree_size;
+    fs->strbufpos = 0;
+}
+
+// returns the data of a matrix node of a binary file storage, or 0 if the node has no binary data
+static const uchar* icvGetBinaryBlob( const CvFileStorage* fs, const CvFileNode* node, size_t size )
+{
+    const CvFileNode* offset_node = fs->mapping ? cvGetFileNodeByName( fs, node, "blob_offset" ) : 0;
+    if( !offset_node )
+        return 0;
+
+    double offset = cvReadReal( offset_node, -1 );
+    size_t mapped = fs->mapping->size();
+    if( offset < (double)sizeof(CvBinaryStorageHeader) || offset >= (double)mapped ||
+        size > mapped - (size_t)offset )
+        CV_Error( CV_StsParseError, "The matrix data is out of the binary file storage" );
+
+    return fs->mapping->data() + (size_t)offset;
+}
+
 #define CV_YML_INDENT  3
 #define CV_XML_INDENT  2
 #define CV_YML_INDENT_FLOW  1
@@ -536,12 +807,14 @@ icvClose( CvFileStorage* fs, std::string* out )
             icvFSFlush(fs);
             if( fs->fmt == CV_STORAGE_FORMAT_XML )
                 icvPuts( fs, "</opencv_storage>\n" );
+            else if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+                icvFinishBinaryStorage(fs);
         }
 
         icvCloseFile(fs);
     }
 
-    if( fs->outbuf && out )
+    if( fs->outbuf && out && fs->fmt != CV_STORAGE_FORMAT_BINARY )
     {
         out->resize(fs->outbuf->size());
         std::copy(fs->outbuf->begin(), fs->outbuf->end(), out->begin());
@@ -569,6 +842,8 @@ cvReleaseFileStorage( CvFileStorage** p_fs )
 
         if( fs->outbuf )
             delete fs->outbuf;
+        if( fs->mapping )
+            fs->mapping->release();
 
         memset( fs, 0, sizeof(*fs) );
         cvFree( &fs );
@@ -643,7 +918,7 @@ cvGetFileNode( CvFileStorage* fs, CvFileNode* _map_node,
     if( !key )
         CV_Error( CV_StsNullPtr, "Null key element" );
 
-    if( _map_node )
+    if( !_map_node )
     {
         if( !fs->roots )
             return 0;
@@ -927,8 +1202,158 @@ icvProcessSpecialDouble( CvFileStorage* fs, char* buf, double* value, char** end
 }
 
 
+// the fast path of icv_strtod() relies on the correctly rounded double precision arithmetic,
+// which the x87 extended precision registers do not give
+#if (defined _M_IX86 || defined __i386__) && \
+    !(defined __SSE2_MATH__ || (defined _M_IX86_FP && _M_IX86_FP >= 2))
+#  define CV_FS_FAST_STRTOD 0
+#else
+#  define CV_FS_FAST_STRTOD 1
+#endif
+
+#if ( defined( WORDS_BIGENDIAN ) && !defined( OPENCV_UNIVERSAL_BUILD ) ) || defined( __BIG_ENDIAN__ )
+#  define CV_FS_SWAR_DIGITS 0
+#else
+#  define CV_FS_SWAR_DIGITS 1
+#endif
+
+// appends the decimal digits at ptr to the mantissa, 8 digits at once where possible;
+// returns the end of the digits. The parser buffer is zero-padded, so reading
+// the 8 bytes past the end of the line is safe.
+static inline const char* icvParseDigits( const char* ptr, uint64& mantissa, int& ndigits )
+{
+    // the leading zeros are not significant
+    if( mantissa == 0 )
+    {
+        while( *ptr == '0' )
+            ptr++;
+        if( !cv_isdigit(*ptr) )
+            return ptr;
+        mantissa = *ptr++ - '0';
+        ndigits = 1;
+    }
+#if CV_FS_SWAR_DIGITS
+    for( ; ndigits <= 11; ptr += 8, ndigits += 8 )
+    {
+        uint64 v;
+        memcpy( &v, ptr, sizeof(v) );
+        // all the 8 bytes are in '0'..'9'
+        if( ((v & CV_BIG_UINT(0xF0F0F0F0F0F0F0F0)) |
+             (((v + CV_BIG_UINT(0x0606060606060606)) & CV_BIG_UINT(0xF0F0F0F0F0F0F0F0)) >> 4)) !=
+            CV_BIG_UINT(0x3333333333333333) )
+            break;
+        v -= CV_BIG_UINT(0x3030303030303030);
+        v = v*10 + (v >> 8);
+        v = (((v & CV_BIG_UINT(0x000000FF000000FF))*(100 + (CV_BIG_UINT(1000000) << 32))) +
+             (((v >> 16) & CV_BIG_UINT(0x000000FF000000FF))*(1 + (CV_BIG_UINT(10000) << 32)))) >> 32;
+        mantissa = mantissa*100000000 + (unsigned)v;
+    }
+#endif
+    for( ; cv_isdigit(*ptr) && ndigits <= 19; ptr++ )
+    {
+        if( ++ndigits <= 19 )
+            mantissa = mantissa*10 + (*ptr - '0');
+    }
+    return ptr;
+}
+
+// parses the plain decimal numbers with at most 19 significant digits and a small exponent.
+// If the mantissa is exact in double and so is the power of 10, a single multiplication
+// or division gives the correctly rounded result, the same as strtod() does (Clinger's algorithm).
+// Returns false for all the other numbers.
+static bool icvFastStrtod( const char* ptr, double* value, char** endptr )
+{
+    static const double pow10[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const char* start = ptr + (*ptr == '-' || *ptr == '+');
+    uint64 mantissa = 0;
+    int ndigits = 0, exp10 = 0;
+
+    const char* p = icvParseDigits( start, mantissa, ndigits );
+    bool have_digits = p > start;
+    if( *p == '.' )
+    {
+        const char* frac = ++p;
+        p = icvParseDigits( frac, mantissa, ndigits );
+        exp10 = -(int)(p - frac);
+        have_digits |= p > frac;
+    }
+    if( !have_digits || ndigits > 19 )
+        return false;
+
+    if( *p == 'e' || *p == 'E' )
+    {
+        const char* q = p + 1;
+        bool neg_exp = *q == '-';
+        q += *q == '-' || *q == '+';
+        if( !cv_isdigit(*q) )
+            return false;
+        int e = 0;
+        for( ; cv_isdigit(*q); q++ )
+            e = std::min(e*10 + (*q - '0'), 10000);
+        exp10 += neg_exp ? -e : e;
+        p = q;
+    }
+    // let the general path handle the locale-dependent decimal point and the special values;
+    // a comma not followed by a digit is the separator of the flow sequence, e.g. "[1.5, 2]"
+    if( *p == '.' || (*p == ',' && cv_isdigit(p[1])) || cv_isalpha(*p) )
+        return false;
+
+    // the writer pads the short decimals with zeros, e.g. 0.25 is stored as 2.5000000000000000e-01
+    for( ; mantissa > (CV_BIG_UINT(1) << 53) && mantissa % 10 == 0; exp10++ )
+        mantissa /= 10;
+
+    double v;
+    if( mantissa == 0 )
+        v = 0;
+    else if( mantissa > (CV_BIG_UINT(1) << 53) || exp10 < -22 || exp10 > 22 )
+        return false;
+    else
+        v = exp10 < 0 ? (double)(int64)mantissa / pow10[-exp10] : (double)(int64)mantissa * pow10[exp10];
+
+    *value = *ptr == '-' ? -v : v;
+    *endptr = (char*)p;
+    return true;
+}
+
+// parses the decimal integers of at most 9 digits, which can not overflow int,
+// and leaves the octal, hexadecimal and longer numbers to strtol()
+static int icv_strtoi( char* ptr, char** endptr )
+{
+    char* p = ptr + (*ptr == '-' || *ptr == '+');
+    int len = 0;
+    while( len < 10 && cv_isdigit(p[len]) )
+        len++;
+    if( len == 0 || len > 9 || (p[0] == '0' && (len > 1 || p[1] == 'x' || p[1] == 'X')) )
+        return (int)strtol( ptr, endptr, 0 );
+
+    int val = 0;
+    for( int i = 0; i < len; i++ )
+        val = val*10 + (p[i] - '0');
+    *endptr = p + len;
+    return *ptr == '-' ? -val : val;
+}
+
+bool cv::fastStrtod( const char* ptr, double* value, char** endptr )
+{
+#if CV_FS_FAST_STRTOD
+    return icvFastStrtod( ptr, value, endptr );
+#else
+    (void)ptr; (void)value; (void)endptr;
+    return false;
+#endif
+}
+
 static double icv_strtod( CvFileStorage* fs, char* ptr, char** endptr )
 {
+#if CV_FS_FAST_STRTOD
+    double fastval;
+    if( icvFastStrtod( ptr, &fastval, endptr ) )
+        return fastval;
+#endif
     double fval = strtod( ptr, endptr );
     if( **endptr == '.' )
     {
@@ -1126,7 +1551,7 @@ force_real:
         else
         {
 force_int:
-            ival = (int)strtol( ptr, &endptr, 0 );
+            ival = icv_strtoi( ptr, &endptr );
             node->tag = CV_NODE_INT;
             node->data.i = ival;
         }
@@ -1946,7 +2371,7 @@ icvXMLParseValue( CvFileStorage* fs, char* ptr, CvFileNode* node,
                 }
                 else
                 {
-                    ival = (int)strtol( ptr, &endptr, 0 );
+                    ival = icv_strtoi( ptr, &endptr );
                     elem->tag = CV_NODE_INT;
                     elem->data.i = ival;
                 }
@@ -2655,8 +3080,10 @@ icvXMLWriteComment( CvFileStorage* fs, const char* comment, int eol_comment )
 *                              Common High-Level Functions                               *
 \****************************************************************************************/
 
-CV_IMPL CvFileStorage*
-cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, const char* encoding )
+// opens the storage; the storage opened for reading without parsing is read by cv::FileStorageReader
+static CvFileStorage*
+icvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags,
+                    const char* encoding, bool parse )
 {
     CvFileStorage* fs = 0;
     char* xml_buf = 0;
@@ -2665,6 +3092,7 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
     bool mem = (flags & CV_STORAGE_MEMORY) != 0;
     bool write_mode = (flags & 3) != 0;
     bool isGZ = false;
+    bool binary = false;
     size_t fnamelen = 0;
 
     if( !filename || filename[0] == '\0' )
@@ -2707,9 +3135,18 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
                 dot_pos[3] = '\0', fnamelen--;
         }
 
+        if( write_mode )
+        {
+            int fmt = flags & CV_STORAGE_FORMAT_MASK;
+            binary = fmt == CV_STORAGE_FORMAT_BINARY || (fmt == CV_STORAGE_FORMAT_AUTO && !isGZ &&
+                     dot_pos && (strcmp(dot_pos, ".bin") == 0 || strcmp(dot_pos, ".BIN") == 0));
+            if( binary && (append || isGZ) )
+                CV_Error( CV_StsNotImplemented, "The binary file storage can not be compressed or appended" );
+        }
+
         if( !isGZ )
         {
-            fs->file = fopen(fs->filename, !fs->write_mode ? "rt" : !append ? "wt" : "a+t" );
+            fs->file = fopen(fs->filename, !fs->write_mode ? "rt" : binary ? "wb" : !append ? "wt" : "a+t" );
             if( !fs->file )
                 goto _exit_;
         }
@@ -2735,10 +3172,21 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
     {
         int fmt = flags & CV_STORAGE_FORMAT_MASK;
 
-        if( mem )
+        if( mem && fmt == CV_STORAGE_FORMAT_BINARY )
+            CV_Error( CV_StsNotImplemented, "The binary file storage can not be written to memory" );
+
+        // the file node tree of the binary storage is written after the matrix data, on closing
+        if( mem || binary )
             fs->outbuf = new std::deque<char>;
 
-        if( fmt == CV_STORAGE_FORMAT_AUTO && filename )
+        if( binary )
+        {
+            CvBinaryStorageHeader header;
+            memset( &header, 0, sizeof(header) );
+            icvWriteBinaryData( fs, &header, sizeof(header) );
+            fs->fmt = CV_STORAGE_FORMAT_BINARY;
+        }
+        else if( fmt == CV_STORAGE_FORMAT_AUTO && filename )
         {
             const char* dot_pos = filename + fnamelen - (isGZ ? 7 : 4);
             fs->fmt = (dot_pos >= filename && (memcmp( dot_pos, ".xml", 4) == 0 ||
@@ -2857,6 +3305,15 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
         fs->fmt = strncmp( buf, yaml_signature, strlen(yaml_signature) ) == 0 ?
             CV_STORAGE_FORMAT_YAML : CV_STORAGE_FORMAT_XML;
 
+        if( !mem && !isGZ && strcmp( buf, CV_FS_BINARY_SIGNATURE ) == 0 )
+        {
+            // the tree is parsed from the mapped file, like a storage in memory
+            icvCloseFile( fs );
+            icvOpenBinaryStorage( fs );
+            fs->fmt = CV_STORAGE_FORMAT_BINARY;
+            mem = true;
+        }
+
         if( !isGZ )
         {
             if( !mem )
@@ -2879,20 +3336,25 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
 
         fs->buffer = fs->buffer_start = (char*)cvAlloc( buf_size + 256 );
         fs->buffer_end = fs->buffer_start + buf_size;
+        // the numbers are parsed 8 digits at once, see icvParseDigits()
+        memset( fs->buffer_start, 0, buf_size + 256 );
         fs->buffer[0] = '\n';
         fs->buffer[1] = '\0';
 
-        //mode = cvGetErrMode();
-        //cvSetErrMode( CV_ErrModeSilent );
-        if( fs->fmt == CV_STORAGE_FORMAT_XML )
-            icvXMLParse( fs );
-        else
-            icvYMLParse( fs );
-        //cvSetErrMode( mode );
+        if( parse )
+        {
+            //mode = cvGetErrMode();
+            //cvSetErrMode( CV_ErrModeSilent );
+            if( fs->fmt == CV_STORAGE_FORMAT_XML )
+                icvXMLParse( fs );
+            else
+                icvYMLParse( fs );
+            //cvSetErrMode( mode );
 
-        // release resources that we do not need anymore
-        cvFree( &fs->buffer_start );
-        fs->buffer = fs->buffer_end = 0;
+            // release resources that we do not need anymore
+            cvFree( &fs->buffer_start );
+            fs->buffer = fs->buffer_end = 0;
+        }
     }
     fs->is_opened = true;
 
@@ -2903,7 +3365,7 @@ _exit_:
         {
             cvReleaseFileStorage( &fs );
         }
-        else if( !fs->write_mode )
+        else if( !fs->write_mode && parse )
         {
             icvCloseFile(fs);
             // we close the file since it's not needed anymore. But icvCloseFile() resets is_opened,
@@ -2917,6 +3379,13 @@ _exit_:
 }
 
 
+CV_IMPL CvFileStorage*
+cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, const char* encoding )
+{
+    return icvOpenFileStorage( filename, dststorage, flags, encoding, true );
+}
+
+
 CV_IMPL void
 cvStartWriteStruct( CvFileStorage* fs, const char* key, int struct_flags,
                     const char* type_name, CvAttrList /*attributes*/ )
@@ -3502,22 +3971,33 @@ icvWriteMat( CvFileStorage* fs, const char* name,
     cvWriteInt( fs, "rows", mat->rows );
     cvWriteInt( fs, "cols", mat->cols );
     cvWriteString( fs, "dt", icvEncodeFormat( CV_MAT_TYPE(mat->type), dt ), 0 );
-    cvStartWriteStruct( fs, "data", CV_NODE_SEQ + CV_NODE_FLOW );
 
     size = cvGetSize(mat);
-    if( size.height > 0 && size.width > 0 && mat->data.ptr )
+    if( CV_IS_MAT_CONT(mat->type) )
     {
-        if( CV_IS_MAT_CONT(mat->type) )
+        size.width *= size.height;
+        size.height = 1;
+    }
+
+    if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+    {
+        cvWriteReal( fs, "blob_offset", (double)icvStartBinaryBlob( fs ) );
+        if( mat->data.ptr )
+            for( y = 0; y < size.height; y++ )
+                icvWriteBinaryData( fs, mat->data.ptr + (size_t)y*mat->step,
+                                    (size_t)size.width*CV_ELEM_SIZE(mat->type) );
+    }
+    else
+    {
+        cvStartWriteStruct( fs, "data", CV_NODE_SEQ + CV_NODE_FLOW );
+        if( size.height > 0 && size.width > 0 && mat->data.ptr )
         {
-            size.width *= size.height;
-            size.height = 1;
+            for( y = 0; y < size.height; y++ )
+                cvWriteRawData( fs, mat->data.ptr + (size_t)y*mat->step, size.width, dt );
         }
-
-        for( y = 0; y < size.height; y++ )
-            cvWriteRawData( fs, mat->data.ptr + (size_t)y*mat->step, size.width, dt );
+        cvEndWriteStruct( fs );
     }
     cvEndWriteStruct( fs );
-    cvEndWriteStruct( fs );
 }
 
 
@@ -3548,10 +4028,11 @@ icvReadMat( CvFileStorage* fs, CvFileNode* node )
     elem_type = icvDecodeSimpleFormat( dt );
 
     data = cvGetFileNodeByName( fs, node, "data" );
-    if( !data )
+    const uchar* blob = !data ? icvGetBinaryBlob( fs, node, (size_t)rows*cols*CV_ELEM_SIZE(elem_type) ) : 0;
+    if( !data && !blob )
         CV_Error( CV_StsError, "The matrix data is not found in file storage" );
 
-    int nelems = icvFileNodeSeqLen( data );
+    int nelems = data ? icvFileNodeSeqLen( data ) : rows*cols*CV_MAT_CN(elem_type);
     if( nelems > 0 && nelems != rows*cols*CV_MAT_CN(elem_type) )
         CV_Error( CV_StsUnmatchedSizes,
                  "The matrix size does not match to the number of stored elements" );
@@ -3559,7 +4040,10 @@ icvReadMat( CvFileStorage* fs, CvFileNode* node )
     if( nelems > 0 )
     {
         mat = cvCreateMat( rows, cols, elem_type );
-        cvReadRawData( fs, data, mat->data.ptr, dt );
+        if( data )
+            cvReadRawData( fs, data, mat->data.ptr, dt );
+        else
+            memcpy( mat->data.ptr, blob, (size_t)rows*cols*CV_ELEM_SIZE(elem_type) );
     }
     else if( rows == 0 && cols == 0 )
         mat = cvCreateMatHeader( 0, 1, elem_type );
@@ -3598,17 +4082,29 @@ icvWriteMatND( CvFileStorage* fs, const char* name,
     cvWriteRawData( fs, sizes, dims, "i" );
     cvEndWriteStruct( fs );
     cvWriteString( fs, "dt", icvEncodeFormat( cvGetElemType(mat), dt ), 0 );
-    cvStartWriteStruct( fs, "data", CV_NODE_SEQ + CV_NODE_FLOW );
+
+    bool binary = fs->fmt == CV_STORAGE_FORMAT_BINARY;
+    if( binary )
+        cvWriteReal( fs, "blob_offset", (double)icvStartBinaryBlob( fs ) );
+    else
+        cvStartWriteStruct( fs, "data", CV_NODE_SEQ + CV_NODE_FLOW );
 
     if( mat->dim[0].size > 0 && mat->data.ptr )
     {
         cvInitNArrayIterator( 1, (CvArr**)&mat, 0, &stub, &iterator );
 
         do
-            cvWriteRawData( fs, iterator.ptr[0], iterator.size.width, dt );
+        {
+            if( binary )
+                icvWriteBinaryData( fs, iterator.ptr[0],
+                                    (size_t)iterator.size.width*CV_ELEM_SIZE(mat->type) );
+            else
+                cvWriteRawData( fs, iterator.ptr[0], iterator.size.width, dt );
+        }
         while( cvNextNArraySlice( &iterator ));
     }
-    cvEndWriteStruct( fs );
+    if( !binary )
+        cvEndWriteStruct( fs );
     cvEndWriteStruct( fs );
 }
 
@@ -3639,16 +4135,16 @@ icvReadMatND( CvFileStorage* fs, CvFileNode* node )
     cvReadRawData( fs, sizes_node, sizes, "i" );
     elem_type = icvDecodeSimpleFormat( dt );
 
-    data = cvGetFileNodeByName( fs, node, "data" );
-    if( !data )
-        CV_Error( CV_StsError, "The matrix data is not found in file storage" );
-
-
-
     for( total_size = CV_MAT_CN(elem_type), i = 0; i < dims; i++ )
         total_size *= sizes[i];
 
-    int nelems = icvFileNodeSeqLen( data );
+    size_t blob_size = (size_t)total_size*CV_ELEM_SIZE1(elem_type);
+    data = cvGetFileNodeByName( fs, node, "data" );
+    const uchar* blob = !data ? icvGetBinaryBlob( fs, node, blob_size ) : 0;
+    if( !data && !blob )
+        CV_Error( CV_StsError, "The matrix data is not found in file storage" );
+
+    int nelems = data ? icvFileNodeSeqLen( data ) : total_size;
 
     if( nelems > 0 && nelems != total_size )
         CV_Error( CV_StsUnmatchedSizes,
@@ -3657,7 +4153,10 @@ icvReadMatND( CvFileStorage* fs, CvFileNode* node )
     if( nelems > 0 )
     {
         mat = cvCreateMatND( dims, sizes, elem_type );
-        cvReadRawData( fs, data, mat->data.ptr, dt );
+        if( data )
+            cvReadRawData( fs, data, mat->data.ptr, dt );
+        else
+            memcpy( mat->data.ptr, blob, blob_size );
     }
     else
         mat = cvCreateMatNDHeader( dims, sizes, elem_type );
@@ -5487,6 +5986,51 @@ WriteStructContext::WriteStructContext(FileStorage& _fs, const string& name,
 WriteStructContext::~WriteStructContext() { cvEndWriteStruct(**fs); }
 
 
+// makes m a view of the matrix data in the mapped binary file storage, if the node has such data
+static bool readBinaryMat( const CvFileStorage* fs, const CvFileNode* node, Mat& m )
+{
+    if( !fs->mapping || !CV_NODE_IS_MAP(node->tag) || !node->info )
+        return false;
+
+    int i, dims, sizes[CV_MAX_DIM];
+    if( strcmp( node->info->type_name, CV_TYPE_NAME_MAT ) == 0 )
+    {
+        dims = 2;
+        sizes[0] = cvReadIntByName( fs, node, "rows", -1 );
+        sizes[1] = cvReadIntByName( fs, node, "cols", -1 );
+    }
+    else if( strcmp( node->info->type_name, CV_TYPE_NAME_MATND ) == 0 )
+    {
+        const CvFileNode* sizes_node = cvGetFileNodeByName( fs, node, "sizes" );
+        dims = sizes_node && CV_NODE_IS_SEQ(sizes_node->tag) ? sizes_node->data.seq->total : -1;
+        if( dims < 2 || dims > CV_MAX_DIM )
+            return false;
+        cvReadRawData( fs, sizes_node, sizes, "i" );
+    }
+    else
+        return false;
+
+    const char* dt = cvReadStringByName( fs, node, "dt", 0 );
+    if( !dt )
+        return false;
+    int type = icvDecodeSimpleFormat( dt );
+
+    size_t total = CV_ELEM_SIZE(type);
+    for( i = 0; i < dims; i++ )
+    {
+        // the empty matrices are read as before
+        if( sizes[i] <= 0 )
+            return false;
+        total *= sizes[i];
+    }
+
+    const uchar* blob = icvGetBinaryBlob( fs, node, total );
+    if( !blob )
+        return false;
+    m = fs->mapping->view( dims, sizes, type, blob );
+    return true;
+}
+
 void read( const FileNode& node, Mat& mat, const Mat& default_mat )
 {
     if( node.empty() )
@@ -5494,6 +6038,8 @@ void read( const FileNode& node, Mat& mat, const Mat& default_mat )
         default_mat.copyTo(mat);
         return;
     }
+    if( readBinaryMat( node.fs, *node, mat ) )
+        return;
     void* obj = cvRead((CvFileStorage*)node.fs, (CvFileNode*)*node);
     if(CV_IS_MAT_HDR_Z(obj))
     {
@@ -5524,6 +6070,346 @@ void read( const FileNode& node, SparseMat& mat, const SparseMat& default_mat )
     SparseMat(m).copyTo(mat);
 }
 
+///////////////////////////////////// FileStorageReader /////////////////////////////////////
+
+/*
+   The storage is opened without parsing, and the top-level mapping is then read by the parser
+   functions one element at a time. The values are parsed into a child memory storage that is
+   cleared before each element, so only the keys (kept in the string hash) are accumulated.
+   A YAML value that is not requested is skipped by its indentation, line by line,
+   an XML value is parsed and dropped.
+*/
+class FileStorageReader::Impl
+{
+public:
+    Impl() : fs(0), storage(0), ptr(0), indent(0), started(false),
+             parsed(false), finished(true), key(0), rootKey(0), elemType(0), info(0)
+    {
+        memset( &value, 0, sizeof(value) );
+    }
+    ~Impl() { close(); }
+
+    bool open( const string& filename )
+    {
+        fs = icvOpenFileStorage( filename.c_str(), 0, CV_STORAGE_READ, 0, false );
+        if( !fs )
+            return false;
+        storage = cvCreateChildMemStorage( fs->memstorage );
+        std::swap( storage, fs->memstorage );
+        finished = false;
+
+        if( fs->fmt == CV_STORAGE_FORMAT_XML )
+            openXML();
+        else
+            openYML();
+        return true;
+    }
+
+    void close()
+    {
+        if( fs )
+        {
+            std::swap( storage, fs->memstorage );
+            cvReleaseMemStorage( &storage );
+            cvReleaseFileStorage( &fs );
+        }
+        ptr = 0;
+        started = parsed = false;
+        finished = true;
+    }
+
+    bool next()
+    {
+        if( finished )
+            return false;
+        if( started && !parsed )
+        {
+            if( fs->fmt == CV_STORAGE_FORMAT_XML )
+                parseValue();
+            else
+                skipYML();
+        }
+        cvClearMemStorage( fs->memstorage );
+        memset( &value, 0, sizeof(value) );
+        started = true;
+        parsed = false;
+
+        if( fs->fmt == CV_STORAGE_FORMAT_XML )
+            nextXML();
+        else
+            nextYML();
+        if( finished )
+            started = false;
+        return !finished;
+    }
+
+    FileNode node()
+    {
+        if( !started )
+            return FileNode();
+        if( !parsed )
+            parseValue();
+        return FileNode( fs, &value.value );
+    }
+
+    CvFileStorage* fs;
+    CvMemStorage* storage;
+    char* ptr;
+    int indent;
+    bool started, parsed, finished;
+    CvFileMapNode value;
+
+    // the XML element of the current node
+    CvStringHashNode *key, *rootKey;
+    int elemType;
+    CvTypeInfo* info;
+
+protected:
+    void openYML()
+    {
+        // skip the directives, like icvYMLParse()
+        ptr = fs->buffer_start;
+        for(;;)
+        {
+            ptr = icvYMLSkipSpaces( fs, ptr, 0, INT_MAX );
+            if( *ptr != '%' )
+                break;
+            if( memcmp( ptr, "%YAML:", 6 ) == 0 &&
+                memcmp( ptr, "%YAML:1.", 8 ) != 0 )
+                CV_PARSE_ERROR( "Unsupported YAML version (it must be 1.x)" );
+            *ptr = '\0';
+        }
+        if( memcmp( ptr, "---", 3 ) == 0 )
+            ptr = icvYMLSkipSpaces( fs, ptr + 3, 0, INT_MAX );
+
+        if( fs->dummy_eof || memcmp( ptr, "...", 3 ) == 0 )
+            finished = true;
+        else if( !cv_isalnum(*ptr) && *ptr != '_' && *ptr != '\'' && *ptr != '\"' )
+            CV_PARSE_ERROR( "FileStorageReader supports the block-style top-level mapping only" );
+        indent = (int)(ptr - fs->buffer_start);
+    }
+
+    void nextYML()
+    {
+        if( started )
+        {
+            ptr = icvYMLSkipSpaces( fs, ptr, 0, INT_MAX );
+            int col = (int)(ptr - fs->buffer_start);
+            if( col < indent || memcmp( ptr, "...", 3 ) == 0 || memcmp( ptr, "---", 3 ) == 0 )
+            {
+                finished = true;
+                return;
+            }
+            if( col > indent )
+                CV_PARSE_ERROR( "Incorrect indentation" );
+        }
+
+        // the key, like icvYMLParseKey()
+        char c, *endptr = ptr - 1, *saveptr;
+        if( *ptr == '-' )
+            CV_PARSE_ERROR( "Key may not start with \'-\'" );
+
+        do c = *++endptr;
+        while( cv_isprint(c) && c != ':' );
+
+        if( c != ':' )
+            CV_PARSE_ERROR( "Missing \':\'" );
+
+        saveptr = endptr + 1;
+        do c = *--endptr;
+        while( c == ' ' );
+
+        ++endptr;
+        if( endptr == ptr )
+            CV_PARSE_ERROR( "An empty key" );
+
+        value.key = cvGetHashedKey( fs, ptr, (int)(endptr - ptr), 1 );
+        ptr = saveptr;
+    }
+
+    // reads the lines until the one that starts at the top-level indentation or less
+    void skipYML()
+    {
+        char* buf = fs->buffer_start;
+        int max_size = (int)(fs->buffer_end - fs->buffer_start);
+        bool line_start = true;
+
+        for(;;)
+        {
+            char* line = icvGets( fs, buf, max_size );
+            if( !line )
+            {
+                // emulate end of stream, like icvYMLSkipSpaces()
+                buf[0] = buf[1] = buf[2] = '.';
+                buf[3] = '\0';
+                fs->dummy_eof = 1;
+                ptr = buf;
+                return;
+            }
+            fs->lineno += line_start;
+
+            int len = (int)strlen( line );
+            bool complete = len > 0 && line[len-1] == '\n';
+            if( line_start )
+            {
+                char* p = line;
+                while( *p == ' ' )
+                    p++;
+                if( *p != '#' && *p != '\n' && *p != '\r' && *p != '\0' && p - buf <= indent )
+                {
+                    if( !complete && !icvEof(fs) )
+                        CV_PARSE_ERROR( "Too long string or a last string w/o newline" );
+                    ptr = p;
+                    return;
+                }
+            }
+            line_start = complete;
+        }
+    }
+
+    void openXML()
+    {
+        CvAttrList* list = 0;
+        int tag_type = 0;
+
+        // like icvXMLParse()
+        ptr = icvXMLSkipSpaces( fs, fs->buffer_start, CV_XML_INSIDE_TAG );
+        if( memcmp( ptr, "<?xml", 5 ) != 0 )
+            CV_PARSE_ERROR( "Valid XML should start with \'<?xml ...?>\'" );
+        ptr = icvXMLParseTag( fs, ptr, &rootKey, &list, &tag_type );
+
+        ptr = icvXMLSkipSpaces( fs, ptr, 0 );
+        if( *ptr == '\0' )
+        {
+            finished = true;
+            return;
+        }
+        ptr = icvXMLParseTag( fs, ptr, &rootKey, &list, &tag_type );
+        if( tag_type != CV_XML_OPENING_TAG ||
+            strcmp(rootKey->str.ptr,"opencv_storage") != 0 )
+            CV_PARSE_ERROR( "<opencv_storage> tag is missing" );
+    }
+
+    void nextXML()
+    {
+        CvAttrList* list = 0;
+        int tag_type = 0;
+
+        ptr = icvXMLSkipSpaces( fs, ptr, 0 );
+        if( *ptr == '\0' )
+            CV_PARSE_ERROR( "</opencv_storage> tag is missing" );
+        if( *ptr != '<' )
+            CV_PARSE_ERROR( "FileStorageReader supports the top-level mapping only" );
+
+        ptr = icvXMLParseTag( fs, ptr, &key, &list, &tag_type );
+        if( tag_type == CV_XML_CLOSING_TAG )
+        {
+            if( key != rootKey )
+                CV_PARSE_ERROR( "</opencv_storage> tag is missing" );
+            finished = true;
+            return;
+        }
+        if( tag_type == CV_XML_DIRECTIVE_TAG )
+            CV_PARSE_ERROR( "Directive tags are not allowed here" );
+        if( tag_type == CV_XML_EMPTY_TAG )
+            CV_PARSE_ERROR( "Empty tags are not supported" );
+        if( key->str.len == 1 && key->str.ptr[0] == '_' )
+            CV_PARSE_ERROR( "FileStorageReader supports the top-level mapping only" );
+
+        // the element type, like icvXMLParseValue()
+        const char* type_name = list ? cvAttrValue( list, "type_id" ) : 0;
+        elemType = CV_NODE_NONE;
+        info = 0;
+        if( type_name )
+        {
+            if( strcmp( type_name, "str" ) == 0 )
+                elemType = CV_NODE_STRING;
+            else if( strcmp( type_name, "map" ) == 0 )
+                elemType = CV_NODE_MAP;
+            else if( strcmp( type_name, "seq" ) == 0 )
+                elemType = CV_NODE_SEQ;
+            else
+            {
+                info = cvFindType( type_name );
+                if( info )
+                    elemType = CV_NODE_USER;
+            }
+        }
+        value.key = key;
+    }
+
+    void parseValue()
+    {
+        if( fs->fmt == CV_STORAGE_FORMAT_XML )
+        {
+            CvStringHashNode* key2 = 0;
+            CvAttrList* list = 0;
+            int tag_type = 0;
+
+            ptr = icvXMLParseValue( fs, ptr, &value.value, elemType );
+            value.value.info = info;
+            ptr = icvXMLParseTag( fs, ptr, &key2, &list, &tag_type );
+            if( tag_type != CV_XML_CLOSING_TAG || key2 != key )
+                CV_PARSE_ERROR( "Mismatched closing tag" );
+        }
+        else
+        {
+            ptr = icvYMLSkipSpaces( fs, ptr, indent + 1, INT_MAX );
+            ptr = icvYMLParseValue( fs, ptr, &value.value, CV_NODE_MAP, indent + 1 );
+        }
+        value.value.tag |= CV_NODE_NAMED;
+        parsed = true;
+    }
+};
+
+template<> void Ptr<FileStorageReader::Impl>::delete_obj()
+{ delete obj; }
+
+FileStorageReader::FileStorageReader() {}
+
+FileStorageReader::FileStorageReader(const string& filename)
+{
+    open(filename);
+}
+
+FileStorageReader::~FileStorageReader() {}
+
+bool FileStorageReader::open(const string& filename)
+{
+    release();
+    impl = new Impl;
+    if( impl->open(filename) )
+        return true;
+    release();
+    return false;
+}
+
+bool FileStorageReader::isOpened() const
+{
+    return !impl.empty() && impl->fs != 0;
+}
+
+void FileStorageReader::release()
+{
+    impl.release();
+}
+
+bool FileStorageReader::next()
+{
+    return !impl.empty() && impl->next();
+}
+
+string FileStorageReader::name() const
+{
+    return !impl.empty() && impl->started && impl->value.key ?
+        string(impl->value.key->str.ptr, impl->value.key->str.len) : string();
+}
+
+FileNode FileStorageReader::node()
+{
+    return !impl.empty() ? impl->node() : FileNode();
+}
+
 }
 
 /* End of file. */
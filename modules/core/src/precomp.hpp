@@ -87,6 +87,7 @@ extern const uchar g_Saturate8u[];
 #if defined WIN32 || defined _WIN32
 void deleteThreadAllocData();
 void deleteThreadRNGData();
+void deleteThreadTraceData();
 #endif
 
 template<typename T1, typename T2=T1, typename T3=T1> struct OpAdd
@@ -172,6 +173,62 @@ struct NoVec
 extern volatile bool USE_SSE2;
 extern volatile bool USE_SSE4_2;
 extern volatile bool USE_AVX;
+extern volatile bool USE_AVX2;
+
+// set by the build when the kernels from *.avx2.cpp are compiled in
+#ifndef CV_TRY_AVX2
+#  define CV_TRY_AVX2 0
+#endif
+
+extern volatile bool useOptimizedFlag;
+
+/*
+   A kernel with implementations for several instruction sets.
+
+   The objects are static, so all the variants are registered at startup, and the best one
+   supported by the CPU (and not above the limit set by the OPENCV_CPU_DISPATCH environment
+   variable) is chosen once, in the constructor. The baseline variant is the generic code of
+   the caller: get() returns 0 when it is chosen or when the optimizations are turned off
+   with setUseOptimized(false). The choice is reported by cv::getDispatchedKernels().
+*/
+class DispatchedKernelBase
+{
+public:
+    enum { MAX_VARIANTS = 4 };
+
+    const char* name() const { return kname; }
+    // the instruction set of the variant in use, CV_CPU_NONE for the baseline
+    int feature() const { return useOptimizedFlag ? features[best] : CV_CPU_NONE; }
+
+protected:
+    DispatchedKernelBase(const char* name, int f1, int f2, int f3);
+
+    const char* kname;
+    int features[MAX_VARIANTS];
+    int best;
+};
+
+template<typename F> class DispatchedKernel : public DispatchedKernelBase
+{
+public:
+    // the variants with CV_CPU_NONE are skipped, see CV_AVX2_VARIANT
+    DispatchedKernel(const char* name, int f1=CV_CPU_NONE, F v1=0, int f2=CV_CPU_NONE, F v2=0,
+                     int f3=CV_CPU_NONE, F v3=0) : DispatchedKernelBase(name, f1, f2, f3)
+    {
+        funcs[0] = 0; funcs[1] = v1; funcs[2] = v2; funcs[3] = v3;
+    }
+
+    F get() const { return useOptimizedFlag ? funcs[best] : 0; }
+
+private:
+    F funcs[MAX_VARIANTS];
+};
+
+#if CV_TRY_AVX2
+#  define CV_AVX2_VARIANT(func) CV_CPU_AVX2, avx2::func
+#else
+#  define CV_AVX2_VARIANT(func) CV_CPU_NONE, 0
+#endif
 
 enum { BLOCK_SIZE = 1024 };
 
@@ -201,6 +258,14 @@ inline bool checkScalar(const Mat& sc, int atype, int sckind, int akind)
 
 void convertAndUnrollScalar( const Mat& sc, int buftype, uchar* scbuf, size_t blocksize );
 
+#if defined HAVE_PTHREADS_PF
+// the built-in thread pool, see parallel_pthreads.cpp
+void parallel_for_pthreads(const Range& stripeRange, const ParallelLoopBody& body);
+int parallel_pthreads_get_threads_num();
+void parallel_pthreads_set_threads_num(int num);
+int parallel_pthreads_get_thread_num();
+#endif
+
 }
 
 #endif /*_CXCORE_INTERNAL_H_*/
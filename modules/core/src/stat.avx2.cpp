@@ -0,0 +1,654 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+/*
+   AVX2 kernels for countNonZero(), norm() and minMaxIdx(); see avx2.hpp for the rules that
+   apply to this file. Integer results are exact; the floating-point sums are accumulated
+   in double precision like the generic code, only in a different order.
+*/
+
+#include "avx2.hpp"
+
+#if defined CV_TRY_AVX2 && CV_TRY_AVX2
+
+#include <float.h>
+#include <immintrin.h>
+
+namespace cv { namespace avx2 {
+
+namespace
+{
+
+typedef unsigned char uchar;
+typedef unsigned short ushort;
+
+inline __m256i load(const void* p) { return _mm256_loadu_si256((const __m256i*)p); }
+
+inline int hsum32(const __m256i& v)
+{
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+
+inline int hsum64(const __m256i& v)
+{
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi64(s, _mm_unpackhi_epi64(s, s));
+    return _mm_cvtsi128_si32(s);
+}
+
+inline double hsum(const __m256d& v)
+{
+    __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+
+template<typename T> inline T hmin(const T* buf, int n)
+{
+    T v = buf[0];
+    for( int i = 1; i < n; i++ )
+        v = buf[i] < v ? buf[i] : v;
+    return v;
+}
+
+template<typename T> inline T hmax(const T* buf, int n)
+{
+    T v = buf[0];
+    for( int i = 1; i < n; i++ )
+        v = buf[i] > v ? buf[i] : v;
+    return v;
+}
+
+inline int firstBit(unsigned mask)
+{
+    int k = 0;
+    for( ; !(mask & 1); mask >>= 1 )
+        k++;
+    return k;
+}
+
+inline float fabs32f(float v)
+{
+    union { float f; unsigned i; } u;
+    u.f = v; u.i &= 0x7fffffff;
+    return u.f;
+}
+
+inline __m256 vabs(const __m256& v) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), v); }
+
+// the sum of absolute values of 8 floats, in double precision
+inline __m256d absSum(const __m256d& s, const __m256& v)
+{
+    __m256 a = vabs(v);
+    return _mm256_add_pd(_mm256_add_pd(s, _mm256_cvtps_pd(_mm256_castps256_ps128(a))),
+                         _mm256_cvtps_pd(_mm256_extractf128_ps(a, 1)));
+}
+
+// the sum of squares of 8 floats, in double precision
+inline __m256d sqrSum(const __m256d& s, const __m256& v)
+{
+    __m256d v0 = _mm256_cvtps_pd(_mm256_castps256_ps128(v));
+    __m256d v1 = _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1));
+    return _mm256_fmadd_pd(v1, v1, _mm256_fmadd_pd(v0, v0, s));
+}
+
+}
+
+int countNonZero8u(const uchar* src, int len)
+{
+    int i = 0, nz = 0;
+    __m256i zero = _mm256_setzero_si256(), sum = zero;
+
+    while( i <= len - 32 )
+    {
+        // the zero counters are bytes, so they are flushed every 255 iterations
+        int blockEnd = i + 255*32 < len ? i + 255*32 : len;
+        __m256i cnt = zero;
+        for( ; i <= blockEnd - 32; i += 32 )
+            cnt = _mm256_sub_epi8(cnt, _mm256_cmpeq_epi8(load(src + i), zero));
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(cnt, zero));
+    }
+    nz = i - hsum64(sum);
+
+    for( ; i < len; i++ )
+        nz += src[i] != 0;
+    return nz;
+}
+
+int countNonZero16u(const ushort* src, int len)
+{
+    int i = 0, nz = 0;
+    __m256i zero = _mm256_setzero_si256(), ones = _mm256_set1_epi16(1), cnt = zero;
+
+    for( ; i <= len - 16; i += 16 )
+        cnt = _mm256_sub_epi32(cnt, _mm256_madd_epi16(_mm256_cmpeq_epi16(load(src + i), zero), ones));
+    nz = i - hsum32(cnt);
+
+    for( ; i < len; i++ )
+        nz += src[i] != 0;
+    return nz;
+}
+
+int countNonZero32s(const int* src, int len)
+{
+    int i = 0, nz = 0;
+    __m256i zero = _mm256_setzero_si256(), cnt = zero;
+
+    for( ; i <= len - 8; i += 8 )
+        cnt = _mm256_sub_epi32(cnt, _mm256_cmpeq_epi32(load(src + i), zero));
+    nz = i - hsum32(cnt);
+
+    for( ; i < len; i++ )
+        nz += src[i] != 0;
+    return nz;
+}
+
+int countNonZero32f(const float* src, int len)
+{
+    int i = 0, nz = 0;
+    __m256 zero = _mm256_setzero_ps();
+    __m256i cnt = _mm256_setzero_si256();
+
+    // NaNs are not equal to zero, so they are counted, as in the generic code
+    for( ; i <= len - 8; i += 8 )
+        cnt = _mm256_sub_epi32(cnt, _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(src + i), zero, _CMP_EQ_OQ)));
+    nz = i - hsum32(cnt);
+
+    for( ; i < len; i++ )
+        nz += src[i] != 0;
+    return nz;
+}
+
+int normInf8u(const uchar* src, int len)
+{
+    int i = 0, s = 0;
+    __m256i m = _mm256_setzero_si256();
+    for( ; i <= len - 32; i += 32 )
+        m = _mm256_max_epu8(m, load(src + i));
+    if( i > 0 )
+    {
+        uchar buf[32];
+        _mm256_storeu_si256((__m256i*)buf, m);
+        s = hmax(buf, 32);
+    }
+    for( ; i < len; i++ )
+        s = src[i] > s ? src[i] : s;
+    return s;
+}
+
+int normL1_8u(const uchar* src, int len)
+{
+    int i = 0, s = 0;
+    __m256i zero = _mm256_setzero_si256(), sum = zero;
+    for( ; i <= len - 32; i += 32 )
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(load(src + i), zero));
+    s = hsum64(sum);
+    for( ; i < len; i++ )
+        s += src[i];
+    return s;
+}
+
+int normL2Sqr8u(const uchar* src, int len)
+{
+    int i = 0, s = 0;
+    __m256i sum = _mm256_setzero_si256();
+    for( ; i <= len - 16; i += 16 )
+    {
+        __m256i v = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(src + i)));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(v, v));
+    }
+    s = hsum32(sum);
+    for( ; i < len; i++ )
+        s += src[i]*src[i];
+    return s;
+}
+
+int normInf16s(const short* src, int len)
+{
+    int i = 0, s = 0;
+    __m256i m = _mm256_setzero_si256();
+    // abs(-32768) wraps to 0x8000, which is right when read as unsigned
+    for( ; i <= len - 16; i += 16 )
+        m = _mm256_max_epu16(m, _mm256_abs_epi16(load(src + i)));
+    if( i > 0 )
+    {
+        ushort buf[16];
+        _mm256_storeu_si256((__m256i*)buf, m);
+        s = hmax(buf, 16);
+    }
+    for( ; i < len; i++ )
+    {
+        int v = src[i] < 0 ? -src[i] : src[i];
+        s = v > s ? v : s;
+    }
+    return s;
+}
+
+int normL1_16s(const short* src, int len)
+{
+    int i = 0, s = 0;
+    __m256i sum = _mm256_setzero_si256();
+    for( ; i <= len - 8; i += 8 )
+        sum = _mm256_add_epi32(sum, _mm256_abs_epi32(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src + i)))));
+    s = hsum32(sum);
+    for( ; i < len; i++ )
+        s += src[i] < 0 ? -src[i] : src[i];
+    return s;
+}
+
+float normInf32f(const float* src, int len)
+{
+    int i = 0;
+    float s = 0;
+    __m256 m = _mm256_setzero_ps();
+    // NaNs are skipped: _mm256_max_ps() returns the second operand when either one is NaN
+    for( ; i <= len - 8; i += 8 )
+        m = _mm256_max_ps(vabs(_mm256_loadu_ps(src + i)), m);
+    if( i > 0 )
+    {
+        float buf[8];
+        _mm256_storeu_ps(buf, m);
+        s = hmax(buf, 8);
+    }
+    for( ; i < len; i++ )
+    {
+        float v = fabs32f(src[i]);
+        s = s < v ? v : s;
+    }
+    return s;
+}
+
+double normL1_32f(const float* src, int len)
+{
+    int i = 0;
+    __m256d s0 = _mm256_setzero_pd(), s1 = s0;
+    for( ; i <= len - 16; i += 16 )
+    {
+        s0 = absSum(s0, _mm256_loadu_ps(src + i));
+        s1 = absSum(s1, _mm256_loadu_ps(src + i + 8));
+    }
+    double s = hsum(_mm256_add_pd(s0, s1));
+    for( ; i < len; i++ )
+        s += fabs32f(src[i]);
+    return s;
+}
+
+double normL2Sqr32f(const float* src, int len)
+{
+    int i = 0;
+    __m256d s0 = _mm256_setzero_pd(), s1 = s0;
+    for( ; i <= len - 16; i += 16 )
+    {
+        s0 = sqrSum(s0, _mm256_loadu_ps(src + i));
+        s1 = sqrSum(s1, _mm256_loadu_ps(src + i + 8));
+    }
+    double s = hsum(_mm256_add_pd(s0, s1));
+    for( ; i < len; i++ )
+    {
+        double v = src[i];
+        s += v*v;
+    }
+    return s;
+}
+
+int normDiffInf8u(const uchar* src1, const uchar* src2, int len)
+{
+    int i = 0, s = 0;
+    __m256i m = _mm256_setzero_si256();
+    for( ; i <= len - 32; i += 32 )
+    {
+        __m256i a = load(src1 + i), b = load(src2 + i);
+        m = _mm256_max_epu8(m, _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a)));
+    }
+    if( i > 0 )
+    {
+        uchar buf[32];
+        _mm256_storeu_si256((__m256i*)buf, m);
+        s = hmax(buf, 32);
+    }
+    for( ; i < len; i++ )
+    {
+        int v = src1[i] - src2[i];
+        v = v < 0 ? -v : v;
+        s = v > s ? v : s;
+    }
+    return s;
+}
+
+int normDiffL1_8u(const uchar* src1, const uchar* src2, int len)
+{
+    int i = 0, s = 0;
+    __m256i sum = _mm256_setzero_si256();
+    for( ; i <= len - 32; i += 32 )
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(load(src1 + i), load(src2 + i)));
+    s = hsum64(sum);
+    for( ; i < len; i++ )
+    {
+        int v = src1[i] - src2[i];
+        s += v < 0 ? -v : v;
+    }
+    return s;
+}
+
+int normDiffL2Sqr8u(const uchar* src1, const uchar* src2, int len)
+{
+    int i = 0, s = 0;
+    __m256i sum = _mm256_setzero_si256();
+    for( ; i <= len - 16; i += 16 )
+    {
+        __m256i v = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(src1 + i))),
+                                     _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(src2 + i))));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(v, v));
+    }
+    s = hsum32(sum);
+    for( ; i < len; i++ )
+    {
+        int v = src1[i] - src2[i];
+        s += v*v;
+    }
+    return s;
+}
+
+float normDiffInf32f(const float* src1, const float* src2, int len)
+{
+    int i = 0;
+    float s = 0;
+    __m256 m = _mm256_setzero_ps();
+    for( ; i <= len - 8; i += 8 )
+        m = _mm256_max_ps(vabs(_mm256_sub_ps(_mm256_loadu_ps(src1 + i), _mm256_loadu_ps(src2 + i))), m);
+    if( i > 0 )
+    {
+        float buf[8];
+        _mm256_storeu_ps(buf, m);
+        s = hmax(buf, 8);
+    }
+    for( ; i < len; i++ )
+    {
+        float v = fabs32f(src1[i] - src2[i]);
+        s = s < v ? v : s;
+    }
+    return s;
+}
+
+double normDiffL1_32f(const float* src1, const float* src2, int len)
+{
+    int i = 0;
+    __m256d s0 = _mm256_setzero_pd(), s1 = s0;
+    for( ; i <= len - 16; i += 16 )
+    {
+        s0 = absSum(s0, _mm256_sub_ps(_mm256_loadu_ps(src1 + i), _mm256_loadu_ps(src2 + i)));
+        s1 = absSum(s1, _mm256_sub_ps(_mm256_loadu_ps(src1 + i + 8), _mm256_loadu_ps(src2 + i + 8)));
+    }
+    double s = hsum(_mm256_add_pd(s0, s1));
+    for( ; i < len; i++ )
+        s += fabs32f(src1[i] - src2[i]);
+    return s;
+}
+
+double normDiffL2Sqr32f(const float* src1, const float* src2, int len)
+{
+    int i = 0;
+    __m256d s0 = _mm256_setzero_pd(), s1 = s0;
+    for( ; i <= len - 16; i += 16 )
+    {
+        s0 = sqrSum(s0, _mm256_sub_ps(_mm256_loadu_ps(src1 + i), _mm256_loadu_ps(src2 + i)));
+        s1 = sqrSum(s1, _mm256_sub_ps(_mm256_loadu_ps(src1 + i + 8), _mm256_loadu_ps(src2 + i + 8)));
+    }
+    double s = hsum(_mm256_add_pd(s0, s1));
+    for( ; i < len; i++ )
+    {
+        double v = src1[i] - src2[i];
+        s += v*v;
+    }
+    return s;
+}
+
+/*
+   minMaxIdx: the extremal values are found with vector min/max first, then the position
+   of the first occurrence is looked up, but only if the value beats the current one.
+   This gives the same indices as the sequential scan in minMaxIdx_().
+*/
+
+void minMaxIdx8u(const uchar* src, int* _minVal, int* _maxVal,
+                 size_t* _minIdx, size_t* _maxIdx, int len, size_t startIdx)
+{
+    int i = 0, minVal = 255, maxVal = 0;
+    __m256i vmin = _mm256_set1_epi8((char)255), vmax = _mm256_setzero_si256();
+    for( ; i <= len - 32; i += 32 )
+    {
+        __m256i v = load(src + i);
+        vmin = _mm256_min_epu8(vmin, v);
+        vmax = _mm256_max_epu8(vmax, v);
+    }
+    if( i > 0 )
+    {
+        uchar buf[32];
+        _mm256_storeu_si256((__m256i*)buf, vmin);
+        minVal = hmin(buf, 32);
+        _mm256_storeu_si256((__m256i*)buf, vmax);
+        maxVal = hmax(buf, 32);
+    }
+    for( int j = i; j < len; j++ )
+    {
+        minVal = src[j] < minVal ? src[j] : minVal;
+        maxVal = src[j] > maxVal ? src[j] : maxVal;
+    }
+
+    if( len > 0 && minVal < *_minVal )
+    {
+        __m256i v0 = _mm256_set1_epi8((char)minVal);
+        int j = 0;
+        for( ; j <= len - 32; j += 32 )
+        {
+            unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(load(src + j), v0));
+            if( mask )
+            {
+                j += firstBit(mask);
+                break;
+            }
+        }
+        for( ; src[j] != minVal; j++ )
+            ;
+        *_minVal = minVal;
+        *_minIdx = startIdx + j;
+    }
+    if( len > 0 && maxVal > *_maxVal )
+    {
+        __m256i v0 = _mm256_set1_epi8((char)maxVal);
+        int j = 0;
+        for( ; j <= len - 32; j += 32 )
+        {
+            unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(load(src + j), v0));
+            if( mask )
+            {
+                j += firstBit(mask);
+                break;
+            }
+        }
+        for( ; src[j] != maxVal; j++ )
+            ;
+        *_maxVal = maxVal;
+        *_maxIdx = startIdx + j;
+    }
+}
+
+void minMaxIdx16s(const short* src, int* _minVal, int* _maxVal,
+                  size_t* _minIdx, size_t* _maxIdx, int len, size_t startIdx)
+{
+    int i = 0, minVal = 32767, maxVal = -32768;
+    __m256i vmin = _mm256_set1_epi16(32767), vmax = _mm256_set1_epi16(-32768);
+    for( ; i <= len - 16; i += 16 )
+    {
+        __m256i v = load(src + i);
+        vmin = _mm256_min_epi16(vmin, v);
+        vmax = _mm256_max_epi16(vmax, v);
+    }
+    if( i > 0 )
+    {
+        short buf[16];
+        _mm256_storeu_si256((__m256i*)buf, vmin);
+        minVal = hmin(buf, 16);
+        _mm256_storeu_si256((__m256i*)buf, vmax);
+        maxVal = hmax(buf, 16);
+    }
+    for( int j = i; j < len; j++ )
+    {
+        minVal = src[j] < minVal ? src[j] : minVal;
+        maxVal = src[j] > maxVal ? src[j] : maxVal;
+    }
+
+    if( len > 0 && minVal < *_minVal )
+    {
+        __m256i v0 = _mm256_set1_epi16((short)minVal);
+        int j = 0;
+        for( ; j <= len - 16; j += 16 )
+        {
+            unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi16(load(src + j), v0));
+            if( mask )
+            {
+                j += firstBit(mask)/2;
+                break;
+            }
+        }
+        for( ; src[j] != minVal; j++ )
+            ;
+        *_minVal = minVal;
+        *_minIdx = startIdx + j;
+    }
+    if( len > 0 && maxVal > *_maxVal )
+    {
+        __m256i v0 = _mm256_set1_epi16((short)maxVal);
+        int j = 0;
+        for( ; j <= len - 16; j += 16 )
+        {
+            unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi16(load(src + j), v0));
+            if( mask )
+            {
+                j += firstBit(mask)/2;
+                break;
+            }
+        }
+        for( ; src[j] != maxVal; j++ )
+            ;
+        *_maxVal = maxVal;
+        *_maxIdx = startIdx + j;
+    }
+}
+
+void minMaxIdx32f(const float* src, float* _minVal, float* _maxVal,
+                  size_t* _minIdx, size_t* _maxIdx, int len, size_t startIdx)
+{
+    // NaNs never win a comparison in minMaxIdx_(); _mm256_min_ps(v, m) returns m for them
+    int i = 0;
+    float minVal = FLT_MAX, maxVal = -FLT_MAX;
+    __m256 vmin = _mm256_set1_ps(FLT_MAX), vmax = _mm256_set1_ps(-FLT_MAX);
+    for( ; i <= len - 8; i += 8 )
+    {
+        __m256 v = _mm256_loadu_ps(src + i);
+        vmin = _mm256_min_ps(v, vmin);
+        vmax = _mm256_max_ps(v, vmax);
+    }
+    if( i > 0 )
+    {
+        float buf[8];
+        _mm256_storeu_ps(buf, vmin);
+        minVal = hmin(buf, 8);
+        _mm256_storeu_ps(buf, vmax);
+        maxVal = hmax(buf, 8);
+    }
+    for( int j = i; j < len; j++ )
+    {
+        minVal = src[j] < minVal ? src[j] : minVal;
+        maxVal = src[j] > maxVal ? src[j] : maxVal;
+    }
+
+    // the initial FLT_MAX/-FLT_MAX may be absent from src, e.g. when it consists of NaNs only
+    if( minVal < *_minVal )
+    {
+        __m256 v0 = _mm256_set1_ps(minVal);
+        int j = 0;
+        for( ; j <= len - 8; j += 8 )
+        {
+            unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(src + j), v0, _CMP_EQ_OQ));
+            if( mask )
+            {
+                j += firstBit(mask);
+                break;
+            }
+        }
+        for( ; j < len && src[j] != minVal; j++ )
+            ;
+        if( j < len )
+        {
+            *_minVal = minVal;
+            *_minIdx = startIdx + j;
+        }
+    }
+    if( maxVal > *_maxVal )
+    {
+        __m256 v0 = _mm256_set1_ps(maxVal);
+        int j = 0;
+        for( ; j <= len - 8; j += 8 )
+        {
+            unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(src + j), v0, _CMP_EQ_OQ));
+            if( mask )
+            {
+                j += firstBit(mask);
+                break;
+            }
+        }
+        for( ; j < len && src[j] != maxVal; j++ )
+            ;
+        if( j < len )
+        {
+            *_maxVal = maxVal;
+            *_maxIdx = startIdx + j;
+        }
+    }
+}
+
+}}
+
+#endif
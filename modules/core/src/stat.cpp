@@ -41,6 +41,7 @@
 //M*/
 
 #include "precomp.hpp"
+#include "avx2.hpp"
 #include <climits>
 
 namespace cv
@@ -221,8 +222,15 @@ static int countNonZero_(const T* src, int len )
     return nz;
 }
 
+static DispatchedKernel<int (*)(const uchar*, int)> countNonZero8uKernel("countNonZero8u", CV_AVX2_VARIANT(countNonZero8u));
+static DispatchedKernel<int (*)(const ushort*, int)> countNonZero16uKernel("countNonZero16u", CV_AVX2_VARIANT(countNonZero16u));
+static DispatchedKernel<int (*)(const int*, int)> countNonZero32sKernel("countNonZero32s", CV_AVX2_VARIANT(countNonZero32s));
+static DispatchedKernel<int (*)(const float*, int)> countNonZero32fKernel("countNonZero32f", CV_AVX2_VARIANT(countNonZero32f));
+
 static int countNonZero8u( const uchar* src, int len )
 {
+    if( countNonZero8uKernel.get() )
+        return countNonZero8uKernel.get()(src, len);
     int i=0, nz = 0;
 #if CV_SSE2
     if(USE_SSE2)//5x-6x
@@ -258,13 +266,25 @@ static int countNonZero8u( const uchar* src, int len )
 }
 
 static int countNonZero16u( const ushort* src, int len )
-{ return countNonZero_(src, len); }
+{
+    if( countNonZero16uKernel.get() )
+        return countNonZero16uKernel.get()(src, len);
+    return countNonZero_(src, len);
+}
 
 static int countNonZero32s( const int* src, int len )
-{ return countNonZero_(src, len); }
+{
+    if( countNonZero32sKernel.get() )
+        return countNonZero32sKernel.get()(src, len);
+    return countNonZero_(src, len);
+}
 
 static int countNonZero32f( const float* src, int len )
-{ return countNonZero_(src, len); }
+{
+    if( countNonZero32fKernel.get() )
+        return countNonZero32fKernel.get()(src, len);
+    return countNonZero_(src, len);
+}
 
 static int countNonZero64f( const double* src, int len )
 { return countNonZero_(src, len); }
@@ -715,9 +735,26 @@ minMaxIdx_( const T* src, const uchar* mask, WT* _minVal, WT* _maxVal,
     *_maxVal = maxVal;
 }
 
+template<typename T, typename WT> struct MinMaxIdxKernel
+{
+    typedef void (*Func)(const T* src, WT* minVal, WT* maxVal, size_t* minIdx, size_t* maxIdx,
+                         int len, size_t startIdx);
+};
+
+static DispatchedKernel<MinMaxIdxKernel<uchar, int>::Func> minMaxIdx8uKernel("minMaxIdx8u", CV_AVX2_VARIANT(minMaxIdx8u));
+static DispatchedKernel<MinMaxIdxKernel<short, int>::Func> minMaxIdx16sKernel("minMaxIdx16s", CV_AVX2_VARIANT(minMaxIdx16s));
+static DispatchedKernel<MinMaxIdxKernel<float, float>::Func> minMaxIdx32fKernel("minMaxIdx32f", CV_AVX2_VARIANT(minMaxIdx32f));
+
 static void minMaxIdx_8u(const uchar* src, const uchar* mask, int* minval, int* maxval,
                          size_t* minidx, size_t* maxidx, int len, size_t startidx )
-{ minMaxIdx_(src, mask, minval, maxval, minidx, maxidx, len, startidx ); }
+{
+    if( !mask && minMaxIdx8uKernel.get() )
+    {
+        minMaxIdx8uKernel.get()(src, minval, maxval, minidx, maxidx, len, startidx);
+        return;
+    }
+    minMaxIdx_(src, mask, minval, maxval, minidx, maxidx, len, startidx );
+}
 
 static void minMaxIdx_8s(const schar* src, const uchar* mask, int* minval, int* maxval,
                          size_t* minidx, size_t* maxidx, int len, size_t startidx )
@@ -729,7 +766,14 @@ static void minMaxIdx_16u(const ushort* src, const uchar* mask, int* minval, int
 
 static void minMaxIdx_16s(const short* src, const uchar* mask, int* minval, int* maxval,
                           size_t* minidx, size_t* maxidx, int len, size_t startidx )
-{ minMaxIdx_(src, mask, minval, maxval, minidx, maxidx, len, startidx ); }
+{
+    if( !mask && minMaxIdx16sKernel.get() )
+    {
+        minMaxIdx16sKernel.get()(src, minval, maxval, minidx, maxidx, len, startidx);
+        return;
+    }
+    minMaxIdx_(src, mask, minval, maxval, minidx, maxidx, len, startidx );
+}
 
 static void minMaxIdx_32s(const int* src, const uchar* mask, int* minval, int* maxval,
                           size_t* minidx, size_t* maxidx, int len, size_t startidx )
@@ -737,7 +781,14 @@ static void minMaxIdx_32s(const int* src, const uchar* mask, int* minval, int* m
 
 static void minMaxIdx_32f(const float* src, const uchar* mask, float* minval, float* maxval,
                           size_t* minidx, size_t* maxidx, int len, size_t startidx )
-{ minMaxIdx_(src, mask, minval, maxval, minidx, maxidx, len, startidx ); }
+{
+    if( !mask && minMaxIdx32fKernel.get() )
+    {
+        minMaxIdx32fKernel.get()(src, minval, maxval, minidx, maxidx, len, startidx);
+        return;
+    }
+    minMaxIdx_(src, mask, minval, maxval, minidx, maxidx, len, startidx );
+}
 
 static void minMaxIdx_64f(const double* src, const uchar* mask, double* minval, double* maxval,
                           size_t* minidx, size_t* maxidx, int len, size_t startidx )
@@ -1097,13 +1148,72 @@ int normHamming(const uchar* a, const uchar* b, int n, int cellSize)
 }
 
 
+// the unmasked norms of a contiguous block; the dispatched kernels take over where they exist
+template<typename T, typename ST> static inline ST normInfBlock(const T* src, int n)
+{ return normInf<T, ST>(src, n); }
+template<typename T, typename ST> static inline ST normL1Block(const T* src, int n)
+{ return normL1<T, ST>(src, n); }
+template<typename T, typename ST> static inline ST normL2SqrBlock(const T* src, int n)
+{ return normL2Sqr<T, ST>(src, n); }
+template<typename T, typename ST> static inline ST normInfBlock(const T* src1, const T* src2, int n)
+{ return normInf<T, ST>(src1, src2, n); }
+template<typename T, typename ST> static inline ST normL1Block(const T* src1, const T* src2, int n)
+{ return normL1<T, ST>(src1, src2, n); }
+template<typename T, typename ST> static inline ST normL2SqrBlock(const T* src1, const T* src2, int n)
+{ return normL2Sqr<T, ST>(src1, src2, n); }
+
+static DispatchedKernel<int (*)(const uchar*, int)> normInf8uKernel("normInf8u", CV_AVX2_VARIANT(normInf8u));
+static DispatchedKernel<int (*)(const uchar*, int)> normL1_8uKernel("normL1_8u", CV_AVX2_VARIANT(normL1_8u));
+static DispatchedKernel<int (*)(const uchar*, int)> normL2Sqr8uKernel("normL2Sqr8u", CV_AVX2_VARIANT(normL2Sqr8u));
+static DispatchedKernel<int (*)(const short*, int)> normInf16sKernel("normInf16s", CV_AVX2_VARIANT(normInf16s));
+static DispatchedKernel<int (*)(const short*, int)> normL1_16sKernel("normL1_16s", CV_AVX2_VARIANT(normL1_16s));
+static DispatchedKernel<float (*)(const float*, int)> normInf32fKernel("normInf32f", CV_AVX2_VARIANT(normInf32f));
+static DispatchedKernel<double (*)(const float*, int)> normL1_32fKernel("normL1_32f", CV_AVX2_VARIANT(normL1_32f));
+static DispatchedKernel<double (*)(const float*, int)> normL2Sqr32fKernel("normL2Sqr32f", CV_AVX2_VARIANT(normL2Sqr32f));
+static DispatchedKernel<int (*)(const uchar*, const uchar*, int)> normDiffInf8uKernel("normDiffInf8u", CV_AVX2_VARIANT(normDiffInf8u));
+static DispatchedKernel<int (*)(const uchar*, const uchar*, int)> normDiffL1_8uKernel("normDiffL1_8u", CV_AVX2_VARIANT(normDiffL1_8u));
+static DispatchedKernel<int (*)(const uchar*, const uchar*, int)> normDiffL2Sqr8uKernel("normDiffL2Sqr8u", CV_AVX2_VARIANT(normDiffL2Sqr8u));
+static DispatchedKernel<float (*)(const float*, const float*, int)> normDiffInf32fKernel("normDiffInf32f", CV_AVX2_VARIANT(normDiffInf32f));
+static DispatchedKernel<double (*)(const float*, const float*, int)> normDiffL1_32fKernel("normDiffL1_32f", CV_AVX2_VARIANT(normDiffL1_32f));
+static DispatchedKernel<double (*)(const float*, const float*, int)> normDiffL2Sqr32fKernel("normDiffL2Sqr32f", CV_AVX2_VARIANT(normDiffL2Sqr32f));
+
+template<> inline int normInfBlock<uchar, int>(const uchar* src, int n)
+{ return normInf8uKernel.get() ? normInf8uKernel.get()(src, n) : normInf<uchar, int>(src, n); }
+template<> inline int normL1Block<uchar, int>(const uchar* src, int n)
+{ return normL1_8uKernel.get() ? normL1_8uKernel.get()(src, n) : normL1<uchar, int>(src, n); }
+template<> inline int normL2SqrBlock<uchar, int>(const uchar* src, int n)
+{ return normL2Sqr8uKernel.get() ? normL2Sqr8uKernel.get()(src, n) : normL2Sqr<uchar, int>(src, n); }
+template<> inline int normInfBlock<short, int>(const short* src, int n)
+{ return normInf16sKernel.get() ? normInf16sKernel.get()(src, n) : normInf<short, int>(src, n); }
+template<> inline int normL1Block<short, int>(const short* src, int n)
+{ return normL1_16sKernel.get() ? normL1_16sKernel.get()(src, n) : normL1<short, int>(src, n); }
+template<> inline float normInfBlock<float, float>(const float* src, int n)
+{ return normInf32fKernel.get() ? normInf32fKernel.get()(src, n) : normInf<float, float>(src, n); }
+template<> inline double normL1Block<float, double>(const float* src, int n)
+{ return normL1_32fKernel.get() ? normL1_32fKernel.get()(src, n) : normL1<float, double>(src, n); }
+template<> inline double normL2SqrBlock<float, double>(const float* src, int n)
+{ return normL2Sqr32fKernel.get() ? normL2Sqr32fKernel.get()(src, n) : normL2Sqr<float, double>(src, n); }
+
+template<> inline int normInfBlock<uchar, int>(const uchar* src1, const uchar* src2, int n)
+{ return normDiffInf8uKernel.get() ? normDiffInf8uKernel.get()(src1, src2, n) : normInf<uchar, int>(src1, src2, n); }
+template<> inline int normL1Block<uchar, int>(const uchar* src1, const uchar* src2, int n)
+{ return normDiffL1_8uKernel.get() ? normDiffL1_8uKernel.get()(src1, src2, n) : normL1<uchar, int>(src1, src2, n); }
+template<> inline int normL2SqrBlock<uchar, int>(const uchar* src1, const uchar* src2, int n)
+{ return normDiffL2Sqr8uKernel.get() ? normDiffL2Sqr8uKernel.get()(src1, src2, n) : normL2Sqr<uchar, int>(src1, src2, n); }
+template<> inline float normInfBlock<float, float>(const float* src1, const float* src2, int n)
+{ return normDiffInf32fKernel.get() ? normDiffInf32fKernel.get()(src1, src2, n) : normInf<float, float>(src1, src2, n); }
+template<> inline double normL1Block<float, double>(const float* src1, const float* src2, int n)
+{ return normDiffL1_32fKernel.get() ? normDiffL1_32fKernel.get()(src1, src2, n) : normL1<float, double>(src1, src2, n); }
+template<> inline double normL2SqrBlock<float, double>(const float* src1, const float* src2, int n)
+{ return normDiffL2Sqr32fKernel.get() ? normDiffL2Sqr32fKernel.get()(src1, src2, n) : normL2Sqr<float, double>(src1, src2, n); }
+
 template<typename T, typename ST> int
 normInf_(const T* src, const uchar* mask, ST* _result, int len, int cn)
 {
     ST result = *_result;
     if( !mask )
     {
-        result = std::max(result, normInf<T, ST>(src, len*cn));
+        result = std::max(result, normInfBlock<T, ST>(src, len*cn));
     }
     else
     {
@@ -1124,7 +1234,7 @@ normL1_(const T* src, const uchar* mask, ST* _result, int len, int cn)
     ST result = *_result;
     if( !mask )
     {
-        result += normL1<T, ST>(src, len*cn);
+        result += normL1Block<T, ST>(src, len*cn);
     }
     else
     {
@@ -1145,7 +1255,7 @@ normL2_(const T* src, const uchar* mask, ST* _result, int len, int cn)
     ST result = *_result;
     if( !mask )
     {
-        result += normL2Sqr<T, ST>(src, len*cn);
+        result += normL2SqrBlock<T, ST>(src, len*cn);
     }
     else
     {
@@ -1169,7 +1279,7 @@ normDiffInf_(const T* src1, const T* src2, const uchar* mask, ST* _result, int l
     ST result = *_result;
     if( !mask )
     {
-        result = std::max(result, normInf<T, ST>(src1, src2, len*cn));
+        result = std::max(result, normInfBlock<T, ST>(src1, src2, len*cn));
     }
     else
     {
@@ -1190,7 +1300,7 @@ normDiffL1_(const T* src1, const T* src2, const uchar* mask, ST* _result, int le
     ST result = *_result;
     if( !mask )
     {
-        result += normL1<T, ST>(src1, src2, len*cn);
+        result += normL1Block<T, ST>(src1, src2, len*cn);
     }
     else
     {
@@ -1211,7 +1321,7 @@ normDiffL2_(const T* src1, const T* src2, const uchar* mask, ST* _result, int le
     ST result = *_result;
     if( !mask )
     {
-        result += normL2Sqr<T, ST>(src1, src2, len*cn);
+        result += normL2SqrBlock<T, ST>(src1, src2, len*cn);
     }
     else
     {
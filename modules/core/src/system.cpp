@@ -55,6 +55,9 @@
 #if defined _MSC_VER
   #if _MSC_VER >= 1400
     #include <intrin.h>
+    #if _MSC_FULL_VER >= 160040219
+      #include <immintrin.h>
+    #endif
   #elif defined _M_IX86
     static void __cpuid(int* cpuid_data, int)
     {
@@ -187,18 +190,174 @@ struct HWFeatures
             f.have[CV_CPU_SSE4_2] = (cpuid_data[2] & (1<<20)) != 0;
             f.have[CV_CPU_POPCNT] = (cpuid_data[2] & (1<<23)) != 0;
             f.have[CV_CPU_AVX]    = (((cpuid_data[2] & (1<<28)) != 0)&&((cpuid_data[2] & (1<<27)) != 0));//OS uses XSAVE_XRSTORE and CPU support AVX
+
+            // AVX2 and FMA need the OS to preserve the upper halves of YMM registers as well
+            if( f.have[CV_CPU_AVX] && (getXCR0() & 6) == 6 )
+            {
+                int cpuid_data7[4] = { 0, 0, 0, 0 };
+                if( getMaxLeaf() >= 7 )
+                    cpuidex(cpuid_data7, 7, 0);
+                f.have[CV_CPU_AVX2] = (cpuid_data7[1] & (1<<5)) != 0;
+                f.have[CV_CPU_FMA3] = (cpuid_data[2] & (1<<12)) != 0;
+            }
         }
 
         return f;
     }
 
+    static void cpuidex(int* cpuid_data, int leaf, int subleaf)
+    {
+    #if defined _MSC_VER && (defined _M_IX86 || defined _M_X64) && _MSC_FULL_VER >= 150030729
+        __cpuidex(cpuid_data, leaf, subleaf);
+    #elif defined __GNUC__ && defined __x86_64__
+        asm __volatile__
+        (
+         "cpuid\n\t"
+         : "=a"(cpuid_data[0]), "=b"(cpuid_data[1]), "=c"(cpuid_data[2]), "=d"(cpuid_data[3])
+         : "a"(leaf), "c"(subleaf)
+         : "cc"
+        );
+    #elif defined __GNUC__ && defined __i386__
+        // ebx may hold the PIC register, so it is swapped with esi instead of being clobbered
+        asm volatile
+        (
+         "xchgl %%ebx, %%esi\n\t"
+         "cpuid\n\t"
+         "xchgl %%ebx, %%esi\n\t"
+         : "=a"(cpuid_data[0]), "=S"(cpuid_data[1]), "=c"(cpuid_data[2]), "=d"(cpuid_data[3])
+         : "a"(leaf), "c"(subleaf)
+         : "cc"
+        );
+    #else
+        (void)leaf; (void)subleaf;
+        cpuid_data[0] = cpuid_data[1] = cpuid_data[2] = cpuid_data[3] = 0;
+    #endif
+    }
+
+    static int getMaxLeaf()
+    {
+        int cpuid_data[4] = { 0, 0, 0, 0 };
+        cpuidex(cpuid_data, 0, 0);
+        return cpuid_data[0];
+    }
+
+    // the register states that the OS saves on context switches; call only when OSXSAVE is set
+    static int64 getXCR0()
+    {
+    #if defined _MSC_VER && (defined _M_IX86 || defined _M_X64) && _MSC_FULL_VER >= 160040219
+        return (int64)_xgetbv(0);
+    #elif defined __GNUC__ && (defined __i386__ || defined __x86_64__)
+        unsigned lo = 0, hi = 0;
+        asm volatile(".byte 0x0f, 0x01, 0xd0" : "=a"(lo), "=d"(hi) : "c"(0));
+        return ((int64)hi << 32) | lo;
+    #else
+        return 0;
+    #endif
+    }
+
     int x86_family;
     bool have[MAX_FEATURE+1];
 };
 
-static HWFeatures  featuresEnabled = HWFeatures::initialize(), featuresDisabled = HWFeatures();
+static const char* getFeatureName(int feature)
+{
+    switch( feature )
+    {
+    case CV_CPU_NONE: return "baseline";
+    case CV_CPU_MMX: return "MMX";
+    case CV_CPU_SSE: return "SSE";
+    case CV_CPU_SSE2: return "SSE2";
+    case CV_CPU_SSE3: return "SSE3";
+    case CV_CPU_SSSE3: return "SSSE3";
+    case CV_CPU_SSE4_1: return "SSE4.1";
+    case CV_CPU_SSE4_2: return "SSE4.2";
+    case CV_CPU_POPCNT: return "POPCNT";
+    case CV_CPU_AVX: return "AVX";
+    case CV_CPU_AVX2: return "AVX2";
+    case CV_CPU_FMA3: return "FMA3";
+    }
+    return "unknown";
+}
+
+// the highest instruction set allowed by the OPENCV_CPU_DISPATCH environment variable
+// (e.g. OPENCV_CPU_DISPATCH=SSE4_2), CV_HARDWARE_MAX_FEATURE when it is not set or not recognized
+static int getFeatureLimit()
+{
+    const char* env = getenv("OPENCV_CPU_DISPATCH");
+    if( !env )
+        return CV_HARDWARE_MAX_FEATURE;
+
+    static const struct { const char* name; int feature; } limits[] =
+    {
+        { "BASELINE", CV_CPU_NONE }, { "NONE", CV_CPU_NONE }, { "SSE", CV_CPU_SSE },
+        { "SSE2", CV_CPU_SSE2 }, { "SSE3", CV_CPU_SSE3 }, { "SSSE3", CV_CPU_SSSE3 },
+        { "SSE4_1", CV_CPU_SSE4_1 }, { "SSE4.1", CV_CPU_SSE4_1 }, { "SSE4_2", CV_CPU_SSE4_2 },
+        { "SSE4.2", CV_CPU_SSE4_2 }, { "AVX", CV_CPU_AVX }, { "AVX2", CV_CPU_AVX2 }
+    };
+    string val = env;
+    for( size_t i = 0; i < val.size(); i++ )
+        val[i] = (char)toupper(val[i]);
+    for( size_t i = 0; i < sizeof(limits)/sizeof(limits[0]); i++ )
+        if( val == limits[i].name )
+            return limits[i].feature;
+    return CV_HARDWARE_MAX_FEATURE;
+}
+
+static HWFeatures limitFeatures(HWFeatures f, int limit)
+{
+    // POPCNT comes with SSE 4.2 and FMA3 with AVX2
+    for( int i = 1; i <= CV_HARDWARE_MAX_FEATURE; i++ )
+    {
+        int level = i == CV_CPU_POPCNT ? CV_CPU_SSE4_2 : i == CV_CPU_FMA3 ? CV_CPU_AVX2 : i;
+        if( level > limit )
+            f.have[i] = false;
+    }
+    return f;
+}
+
+// The features are detected on the first use rather than in the static initialization of this file,
+// so that the dispatched kernels of the other files can be resolved by their static constructors.
+static const HWFeatures& getDetectedFeatures()
+{
+    static HWFeatures features = limitFeatures(HWFeatures::initialize(), getFeatureLimit());
+    return features;
+}
+
+static HWFeatures  featuresEnabled = getDetectedFeatures(), featuresDisabled = HWFeatures();
 static HWFeatures* currentFeatures = &featuresEnabled;
 
+static vector<DispatchedKernelBase*>& getDispatchedKernelList()
+{
+    static vector<DispatchedKernelBase*> kernels;
+    return kernels;
+}
+
+DispatchedKernelBase::DispatchedKernelBase(const char* name, int f1, int f2, int f3) : kname(name)
+{
+    const HWFeatures& hw = getDetectedFeatures();
+    features[0] = CV_CPU_NONE;
+    features[1] = f1;
+    features[2] = f2;
+    features[3] = f3;
+    best = 0;
+    for( int i = 1; i < MAX_VARIANTS; i++ )
+        if( features[i] != CV_CPU_NONE && hw.have[features[i]] && features[i] > features[best] )
+            best = i;
+    getDispatchedKernelList().push_back(this);
+}
+
+void getDispatchedKernels(vector<string>& kernels, vector<string>& variants)
+{
+    const vector<DispatchedKernelBase*>& list = getDispatchedKernelList();
+    kernels.resize(list.size());
+    variants.resize(list.size());
+    for( size_t i = 0; i < list.size(); i++ )
+    {
+        kernels[i] = list[i]->name();
+        variants[i] = getFeatureName(list[i]->feature());
+    }
+}
+
 bool checkHardwareSupport(int feature)
 {
     CV_DbgAssert( 0 <= feature && feature <= CV_HARDWARE_MAX_FEATURE );
@@ -219,12 +378,14 @@ IPPInitializer ippInitializer;
 volatile bool USE_SSE2 = featuresEnabled.have[CV_CPU_SSE2];
 volatile bool USE_SSE4_2 = featuresEnabled.have[CV_CPU_SSE4_2];
 volatile bool USE_AVX = featuresEnabled.have[CV_CPU_AVX];
+volatile bool USE_AVX2 = featuresEnabled.have[CV_CPU_AVX2];
 
 void setUseOptimized( bool flag )
 {
     useOptimizedFlag = flag;
     currentFeatures = flag ? &featuresEnabled : &featuresDisabled;
     USE_SSE2 = currentFeatures->have[CV_CPU_SSE2];
+    USE_AVX2 = currentFeatures->have[CV_CPU_AVX2];
 }
 
 bool useOptimized(void)
@@ -788,6 +949,7 @@ BOOL WINAPI DllMain( HINSTANCE, DWORD  fdwReason, LPVOID )
     {
         cv::deleteThreadAllocData();
         cv::deleteThreadRNGData();
+        cv::deleteThreadTraceData();
     }
     return TRUE;
 }
@@ -0,0 +1,429 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+    #include <windows.h>
+    #undef small
+    #undef min
+    #undef max
+    #undef abs
+#else
+    #include <pthread.h>
+#endif
+
+/*
+   Tracing of the hot paths.
+
+   Every thread that executes a traced region gets a ThreadTrace: the stack of its open regions,
+   a ring buffer of the finished ones (for the timeline) and the per-region counters. A region
+   touches only the data of its own thread, the lock of the thread trace is taken when a region
+   is finished and is contended only while the data is being read by getTraceStats() or writeTrace().
+   The traces of finished threads stay in the list until resetTrace(), so their data is not lost.
+*/
+
+namespace cv
+{
+
+enum { TRACE_BUFFER_SIZE = 1 << 14, TRACE_MAX_DEPTH = 64 };
+
+// OPENCV_TRACE=1 turns the tracing on at startup
+static bool getTraceEnabledByEnv()
+{
+    const char* env = getenv("OPENCV_TRACE");
+    return env != 0 && atoi(env) != 0;
+}
+
+static volatile bool traceEnabled = getTraceEnabledByEnv();
+
+struct TraceEvent
+{
+    int site;
+    int depth;
+    int64 start;
+    int64 end;
+    int64 bytes;
+};
+
+struct TraceCounter
+{
+    TraceCounter() : calls(0), ticks(0), maxTicks(0), bytes(0) {}
+
+    int64 calls;
+    int64 ticks;
+    int64 maxTicks;
+    int64 bytes;
+};
+
+struct ThreadTrace
+{
+    ThreadTrace() : tid(0), retired(false), nevents(0), depth(0) {}
+
+    static ThreadTrace* get();
+
+    Mutex mutex;
+    int tid;
+    bool retired;
+    vector<TraceEvent> events;
+    int64 nevents;
+    vector<TraceCounter> counters;
+
+    struct OpenRegion
+    {
+        int site;
+        int64 start;
+        int64 bytes;
+    };
+    OpenRegion stack[TRACE_MAX_DEPTH];
+    int depth;
+};
+
+// the site names and the thread traces; the registry is never destroyed, as the regions may run
+// in the static destructors of other modules
+struct TraceRegistry
+{
+    TraceRegistry() : nextTid(0), startTick(getTickCount()) {}
+
+    Mutex mutex;
+    vector<const char*> sites;
+    vector<ThreadTrace*> threads;
+    int nextTid;
+    int64 startTick;
+};
+
+static TraceRegistry& getTraceRegistry()
+{
+    static TraceRegistry* registry = new TraceRegistry;
+    return *registry;
+}
+
+static ThreadTrace* createThreadTrace()
+{
+    ThreadTrace* t = new ThreadTrace;
+    TraceRegistry& reg = getTraceRegistry();
+    AutoLock lock(reg.mutex);
+    t->tid = reg.nextTid++;
+    reg.threads.push_back(t);
+    return t;
+}
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+#ifdef WINCE
+#   define TLS_OUT_OF_INDEXES ((DWORD)0xFFFFFFFF)
+#endif
+
+static DWORD tlsTraceKey = TLS_OUT_OF_INDEXES;
+
+// there are no TLS destructors, so the trace of the thread is retired from DllMain (see system.cpp)
+void deleteThreadTraceData()
+{
+    if( tlsTraceKey != TLS_OUT_OF_INDEXES )
+    {
+        ThreadTrace* t = (ThreadTrace*)TlsGetValue( tlsTraceKey );
+        if( t )
+        {
+            AutoLock lock(t->mutex);
+            t->retired = true;
+        }
+        TlsSetValue( tlsTraceKey, 0 );
+    }
+}
+
+// the traces that are still in the list are released at shutdown (including the traces of the
+// threads that never detached); the regions that start after that are not recorded
+static struct ThreadTraceCleaner
+{
+    ~ThreadTraceCleaner()
+    {
+        traceEnabled = false;
+        TraceRegistry& reg = getTraceRegistry();
+        AutoLock lock(reg.mutex);
+        for( size_t i = 0; i < reg.threads.size(); i++ )
+            delete reg.threads[i];
+        reg.threads.clear();
+        if( tlsTraceKey != TLS_OUT_OF_INDEXES )
+            TlsSetValue( tlsTraceKey, 0 );
+    }
+} threadTraceCleaner;
+
+ThreadTrace* ThreadTrace::get()
+{
+    if( tlsTraceKey == TLS_OUT_OF_INDEXES )
+    {
+        AutoLock lock(getTraceRegistry().mutex);
+        if( tlsTraceKey == TLS_OUT_OF_INDEXES )
+            tlsTraceKey = TlsAlloc();
+        CV_Assert(tlsTraceKey != TLS_OUT_OF_INDEXES);
+    }
+    ThreadTrace* t = (ThreadTrace*)TlsGetValue( tlsTraceKey );
+    if( !t )
+    {
+        t = createThreadTrace();
+        TlsSetValue( tlsTraceKey, t );
+    }
+    return t;
+}
+#else
+static pthread_key_t tlsTraceKey = 0;
+static pthread_once_t tlsTraceKeyOnce = PTHREAD_ONCE_INIT;
+
+static void retireThreadTrace(void* data)
+{
+    ThreadTrace* t = (ThreadTrace*)data;
+    AutoLock lock(t->mutex);
+    t->retired = true;
+}
+
+static void makeTraceKey()
+{
+    int errcode = pthread_key_create(&tlsTraceKey, retireThreadTrace);
+    CV_Assert(errcode == 0);
+}
+
+ThreadTrace* ThreadTrace::get()
+{
+    pthread_once(&tlsTraceKeyOnce, makeTraceKey);
+    ThreadTrace* t = (ThreadTrace*)pthread_getspecific(tlsTraceKey);
+    if( !t )
+    {
+        t = createThreadTrace();
+        pthread_setspecific(tlsTraceKey, t);
+    }
+    return t;
+}
+#endif
+
+// the site may be entered by several threads at once, so the id is assigned under the lock
+static int registerTraceSite(TraceSite& site)
+{
+    TraceRegistry& reg = getTraceRegistry();
+    AutoLock lock(reg.mutex);
+    if( site.id < 0 )
+    {
+        reg.sites.push_back(site.name);
+        site.id = (int)reg.sites.size() - 1;
+    }
+    return site.id;
+}
+
+TraceRegion::TraceRegion(TraceSite& site) : active(traceEnabled)
+{
+    if( !active )
+        return;
+    int id = site.id;
+    if( id < 0 )
+        id = registerTraceSite(site);
+    ThreadTrace* t = ThreadTrace::get();
+    if( t->depth < TRACE_MAX_DEPTH )
+    {
+        ThreadTrace::OpenRegion& r = t->stack[t->depth];
+        r.site = id;
+        r.bytes = 0;
+        r.start = getTickCount();
+    }
+    t->depth++;
+}
+
+TraceRegion::~TraceRegion()
+{
+    if( !active )
+        return;
+    int64 end = getTickCount();
+    ThreadTrace* t = ThreadTrace::get();
+    int depth = --t->depth;
+    if( depth >= TRACE_MAX_DEPTH )
+        return;
+
+    const ThreadTrace::OpenRegion& r = t->stack[depth];
+    AutoLock lock(t->mutex);
+    if( (size_t)r.site >= t->counters.size() )
+        t->counters.resize(r.site + 1);
+    TraceCounter& c = t->counters[r.site];
+    c.calls++;
+    c.ticks += end - r.start;
+    c.maxTicks = std::max(c.maxTicks, end - r.start);
+    c.bytes += r.bytes;
+
+    if( t->events.empty() )
+        t->events.resize(TRACE_BUFFER_SIZE);
+    TraceEvent& e = t->events[(size_t)(t->nevents++ % TRACE_BUFFER_SIZE)];
+    e.site = r.site;
+    e.depth = depth;
+    e.start = r.start;
+    e.end = end;
+    e.bytes = r.bytes;
+}
+
+void TraceRegion::addBytes(size_t bytes)
+{
+    if( !traceEnabled )
+        return;
+    ThreadTrace* t = ThreadTrace::get();
+    if( 0 < t->depth && t->depth <= TRACE_MAX_DEPTH )
+        t->stack[t->depth - 1].bytes += (int64)bytes;
+}
+
+void setTraceEnabled(bool enabled)
+{
+    traceEnabled = enabled;
+}
+
+bool isTraceEnabled()
+{
+    return traceEnabled;
+}
+
+TraceStats::TraceStats() : calls(0), totalTime(0), maxTime(0), bytes(0)
+{
+}
+
+void getTraceStats(vector<TraceStats>& stats)
+{
+    TraceRegistry& reg = getTraceRegistry();
+    AutoLock lock(reg.mutex);
+    vector<TraceCounter> sum(reg.sites.size());
+    for( size_t i = 0; i < reg.threads.size(); i++ )
+    {
+        ThreadTrace* t = reg.threads[i];
+        AutoLock tlock(t->mutex);
+        for( size_t j = 0; j < t->counters.size(); j++ )
+        {
+            const TraceCounter& c = t->counters[j];
+            sum[j].calls += c.calls;
+            sum[j].ticks += c.ticks;
+            sum[j].maxTicks = std::max(sum[j].maxTicks, c.maxTicks);
+            sum[j].bytes += c.bytes;
+        }
+    }
+
+    double scale = 1./getTickFrequency();
+    stats.clear();
+    for( size_t j = 0; j < sum.size(); j++ )
+    {
+        if( sum[j].calls == 0 )
+            continue;
+        TraceStats s;
+        s.name = reg.sites[j];
+        s.calls = sum[j].calls;
+        s.totalTime = sum[j].ticks*scale;
+        s.maxTime = sum[j].maxTicks*scale;
+        s.bytes = sum[j].bytes;
+        stats.push_back(s);
+    }
+}
+
+static void writeJSONString(FILE* f, const char* str)
+{
+    fputc('\"', f);
+    for( ; *str; str++ )
+    {
+        if( *str == '\"' || *str == '\\' )
+            fputc('\\', f);
+        if( (uchar)*str >= ' ' )
+            fputc(*str, f);
+    }
+    fputc('\"', f);
+}
+
+void writeTrace(const string& filename)
+{
+    FILE* f = fopen(filename.c_str(), "wt");
+    if( !f )
+        CV_Error_( CV_StsError, ("Can not open the trace file %s", filename.c_str()) );
+
+    TraceRegistry& reg = getTraceRegistry();
+    AutoLock lock(reg.mutex);
+    double scale = 1e6/getTickFrequency();
+    bool first = true;
+
+    fputs("{\"traceEvents\":[\n", f);
+    for( size_t i = 0; i < reg.threads.size(); i++ )
+    {
+        ThreadTrace* t = reg.threads[i];
+        AutoLock tlock(t->mutex);
+        fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                "\"args\":{\"name\":\"thread %d\"}}", first ? "" : ",\n", t->tid, t->tid);
+        first = false;
+
+        int64 n = std::min(t->nevents, (int64)TRACE_BUFFER_SIZE);
+        for( int64 k = t->nevents - n; k < t->nevents; k++ )
+        {
+            const TraceEvent& e = t->events[(size_t)(k % TRACE_BUFFER_SIZE)];
+            fputs(",\n{\"name\":", f);
+            writeJSONString(f, reg.sites[e.site]);
+            fprintf(f, ",\"cat\":\"opencv\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+                    t->tid, (e.start - reg.startTick)*scale, (e.end - e.start)*scale);
+            if( e.bytes > 0 )
+                fprintf(f, ",\"args\":{\"bytes\":%lld}", (long long)e.bytes);
+            fputc('}', f);
+        }
+    }
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", f);
+    fclose(f);
+}
+
+void resetTrace()
+{
+    TraceRegistry& reg = getTraceRegistry();
+    AutoLock lock(reg.mutex);
+    size_t j = 0;
+    for( size_t i = 0; i < reg.threads.size(); i++ )
+    {
+        ThreadTrace* t = reg.threads[i];
+        {
+            AutoLock tlock(t->mutex);
+            t->counters.clear();
+            t->nevents = 0;
+            if( !t->retired )
+            {
+                reg.threads[j++] = t;
+                continue;
+            }
+        }
+        delete t;
+    }
+    reg.threads.resize(j);
+    reg.startTick = getTickCount();
+}
+
+}
@@ -863,3 +863,71 @@ protected:
 TEST(Core_DFT, complex_output) { Core_DFTComplexOutputTest test; test.safe_run(); }
 
 
+
+TEST(Core_DFT, plan)
+{
+    RNG& rng = theRNG();
+    const int flags[] = { 0, DFT_SCALE, DFT_INVERSE, DFT_INVERSE | DFT_SCALE, DFT_ROWS,
+                          DFT_ROWS | DFT_INVERSE, DFT_COMPLEX_OUTPUT, DFT_ROWS | DFT_COMPLEX_OUTPUT };
+    const int nflags = (int)(sizeof(flags)/sizeof(flags[0]));
+
+    for( int i = 0; i < nflags*6; i++ )
+    {
+        Size sz(rng.uniform(1, 70), rng.uniform(1, 50));
+        if( i % 5 == 0 )
+            sz.width = 1;
+        int f = flags[i % nflags], depth = (i / nflags) % 2 ? CV_32F : CV_64F;
+        int type = CV_MAKETYPE(depth, (f & DFT_COMPLEX_OUTPUT) ? 1 : 2);
+        DFTPlan plan(sz, type, f);
+        ASSERT_EQ(sz, plan.size());
+        ASSERT_EQ(type, plan.type());
+
+        // one plan transforms many different inputs; a DFT_ROWS plan any number of rows
+        for( int iter = 0; iter < 5; iter++ )
+        {
+            Mat src(sz.height*((f & DFT_ROWS) ? iter + 1 : 1), sz.width, type), srcz, dst, ref;
+            randu(src, Scalar::all(-1), Scalar::all(1));
+            plan.apply(src, dst);
+
+            srcz = src;
+            if( src.channels() == 1 )
+            {
+                Mat planes[] = { src, Mat::zeros(src.size(), depth) };
+                merge(planes, 2, srcz);
+            }
+            if( srcz.rows == 1 || (srcz.cols == 1 && !(f & DFT_ROWS)) )
+                cvtest::DFT_1D(srcz, ref, f);
+            else
+                cvtest::DFT_2D(srcz, ref, f);
+
+            ASSERT_EQ(ref.type(), dst.type());
+            ASSERT_EQ(ref.size(), dst.size());
+            double err = norm(ref, dst, NORM_INF), maxErr = (depth == CV_32F ? 1e-4 : 1e-10)*(1 + norm(ref, NORM_INF));
+            ASSERT_LE(err, maxErr) << "size " << src.size() << ", type " << type << ", flags " << f << ", iter " << iter;
+        }
+    }
+}
+
+TEST(Core_DFT, complex_output_1d)
+{
+    RNG& rng = theRNG();
+    for( int n = 1; n < 20; n++ )
+    {
+        Mat src(3, n, CV_32F), srcz, dst;
+        randu(src, Scalar::all(0), Scalar::all(10));
+        Mat mv[] = { src, Mat::zeros(3, n, CV_32F) };
+        merge(mv, 2, srcz);
+
+        // every row of a DFT_ROWS result and a single-row result are complete complex spectra
+        Mat dstz;
+        dft(srcz, dstz, DFT_ROWS);
+        dst.create(3, n, CV_32FC2);
+        dst = Scalar::all(rng.uniform(1, 100));
+        dft(src, dst, DFT_ROWS | DFT_COMPLEX_OUTPUT);
+        ASSERT_LE(norm(dst, dstz, NORM_INF), 1e-3) << "n = " << n;
+
+        dst = Scalar::all(rng.uniform(1, 100));
+        dft(src.row(0), dst.row(0), DFT_COMPLEX_OUTPUT);
+        ASSERT_LE(norm(dst.row(0), dstz.row(0), NORM_INF), 1e-3) << "n = " << n;
+    }
+}
@@ -409,3 +409,67 @@ TEST(Core_Eigen, scalar_32) {Core_EigenTest_Scalar_32 test; test.safe_run(); }
 TEST(Core_Eigen, scalar_64) {Core_EigenTest_Scalar_64 test; test.safe_run(); }
 TEST(Core_Eigen, vector_32) { Core_EigenTest_32 test; test.safe_run(); }
 TEST(Core_Eigen, vector_64) { Core_EigenTest_64 test; test.safe_run(); }
+
+TEST(Core_Eigen, large)
+{
+    // the sizes that go to the tridiagonal reduction
+    const int sizes[] = { 64, 150 };
+    RNG& rng = theRNG();
+
+    for( int depth = CV_32F; depth <= CV_64F; depth++ )
+        for( int si = 0; si < 2; si++ )
+        {
+            int n = sizes[si];
+            Mat a(n, n, depth), evals, evects;
+            rng.fill(a, RNG::UNIFORM, -1, 1);
+            Mat src = a + a.t();
+
+            ASSERT_TRUE(cv::eigen(src, true, evals, evects));
+            Mat evals64;
+            evals.convertTo(evals64, CV_64F);
+            for( int i = 0; i < n - 1; i++ )
+                ASSERT_GE(evals64.at<double>(i), evals64.at<double>(i+1)) << "i=" << i;
+            double eps = depth == CV_32F ? 1e-4 : 1e-10;
+            EXPECT_LE(cv::norm(evects*evects.t(), Mat::eye(n, n, depth), NORM_INF), eps);
+            EXPECT_LE(cv::norm(src*evects.t(), evects.t()*Mat::diag(evals), NORM_INF), eps*n);
+
+            Mat evals2;
+            ASSERT_TRUE(cv::eigen(src, evals2));
+            EXPECT_LE(cv::norm(evals, evals2, NORM_INF), eps);
+        }
+}
+
+TEST(Core_Eigen, batch)
+{
+    const int N = 50;
+    RNG& rng = theRNG();
+
+    for( int depth = CV_32F; depth <= CV_64F; depth++ )
+        for( int n = 2; n <= 9; n++ )
+        {
+            int sz[] = { N, n, n };
+            Mat src(3, sz, depth), evals, evects;
+            rng.fill(src, RNG::UNIFORM, -1, 1);
+
+            cv::eigenBatch(src, evals, evects);
+            ASSERT_EQ(N, evals.rows);
+            ASSERT_EQ(n, evals.cols);
+            double eps = depth == CV_32F ? 1e-5 : 1e-12;
+
+            for( int b = 0; b < N; b++ )
+            {
+                // only the upper triangle is used
+                Mat a(n, n, depth, src.ptr(b)), evals1;
+                Mat A = a.clone();
+                for( int i = 0; i < n; i++ )
+                    for( int j = 0; j < i; j++ )
+                        A.row(j).col(i).copyTo(A.row(i).col(j));
+                Mat V(n, n, depth, evects.ptr(b));
+
+                cv::eigen(A, evals1);
+                ASSERT_LE(cv::norm(evals.row(b).t(), evals1, NORM_INF), eps*n) << "n=" << n << " b=" << b;
+                ASSERT_LE(cv::norm(A*V.t(), V.t()*Mat::diag(evals.row(b).t()), NORM_INF), eps*n)
+                    << "n=" << n << " b=" << b;
+            }
+        }
+}
@@ -1,4 +1,5 @@
 #include "test_precomp.hpp"
+#include "opencv2/core/internal.hpp"
 
 using namespace cv;
 using namespace std;
@@ -83,7 +84,8 @@ static bool cvTsCheckSparse(const CvSparseMat* m1, const CvSparseMat* m2, double
 class Core_IOTest : public cvtest::BaseTest
 {
 public:
-    Core_IOTest() {};
+    // binary: the data is written in the binary format instead of XML and YAML
+    Core_IOTest(bool _binary=false) : binary(_binary) {};
 protected:
     void run(int)
     {
@@ -102,8 +104,9 @@ protected:
 
             cvClearMemStorage(storage);
 
-            bool mem = (idx % 4) >= 2;
-            string filename = tempfile(idx % 2 ? ".yml" : ".xml");
+            // the binary format has no memory mode
+            bool mem = (idx % 4) >= 2 && !binary;
+            string filename = tempfile(binary ? ".bin" : idx % 2 ? ".yml" : ".xml");
 
             FileStorage fs(filename, FileStorage::WRITE + (mem ? FileStorage::MEMORY : 0));
 
@@ -374,9 +377,12 @@ protected:
                 remove(filename.c_str());
         }
     }
+
+    bool binary;
 };
 
 TEST(Core_InputOutput, write_read_consistency) { Core_IOTest test; test.safe_run(); }
+TEST(Core_InputOutput, write_read_consistency_binary) { Core_IOTest test(true); test.safe_run(); }
 
 
 class CV_MiscIOTest : public cvtest::BaseTest
@@ -454,3 +460,233 @@ protected:
 TEST(Core_InputOutput, huge) { CV_BigMatrixIOTest test; test.safe_run(); }
 */
 
+
+TEST(Core_InputOutput, binary_storage)
+{
+    string fname = cv::tempfile(".bin");
+    RNG& rng = theRNG();
+
+    Mat big(100, 120, CV_8UC3), roi, m32f(17, 5, CV_32FC2), empty;
+    rng.fill(big, RNG::UNIFORM, 0, 256);
+    roi = big(Rect(3, 4, 50, 60));
+    rng.fill(m32f, RNG::UNIFORM, -1, 1);
+    int sz3[] = { 4, 5, 6 };
+    Mat m3(3, sz3, CV_64F);
+    rng.fill(m3, RNG::UNIFORM, -1, 1);
+    vector<Mat> mv(2, m32f);
+
+    FileStorage fs(fname, FileStorage::WRITE);
+    ASSERT_TRUE(fs.isOpened());
+    fs << "roi" << roi << "m32f" << m32f << "m3" << m3 << "empty" << empty;
+    fs << "mv" << mv << "i" << 5 << "s" << "text";
+    fs.release();
+
+    Mat roi2, m32f2, m32f3, m3_2, empty2;
+    vector<Mat> mv2;
+    fs.open(fname, FileStorage::READ);
+    ASSERT_TRUE(fs.isOpened());
+    fs["roi"] >> roi2;
+    fs["m32f"] >> m32f2;
+    fs["m32f"] >> m32f3;
+    fs["m3"] >> m3_2;
+    fs["empty"] >> empty2;
+    fs["mv"] >> mv2;
+    EXPECT_EQ(5, (int)fs["i"]);
+    EXPECT_EQ("text", (string)fs["s"]);
+    fs.release();
+
+    // the matrices refer to the mapped file and stay valid after the storage is released
+    EXPECT_EQ(m32f2.data, m32f3.data);
+    EXPECT_EQ(0, (int)((size_t)m32f2.data % 16));
+    EXPECT_EQ(0, norm(roi, roi2, NORM_INF));
+    EXPECT_EQ(0, norm(m32f, m32f2, NORM_INF));
+    EXPECT_EQ(0, norm(m3, m3_2, NORM_INF));
+    EXPECT_TRUE(empty2.empty());
+    ASSERT_EQ(2u, mv2.size());
+    EXPECT_EQ(0, norm(m32f, mv2[1], NORM_INF));
+
+    // the mapping is private, so modifying the matrices does not change the file
+    m32f2.setTo(Scalar::all(7));
+    roi2.create(3, 3, CV_8U);
+    roi2.setTo(Scalar::all(1));
+    m3_2.release();
+
+    // the C API copies the data
+    CvFileStorage* cfs = cvOpenFileStorage(fname.c_str(), 0, CV_STORAGE_READ);
+    ASSERT_TRUE(cfs != 0);
+    CvMat* cm = (CvMat*)cvReadByName(cfs, 0, "m32f");
+    ASSERT_TRUE(cm != 0);
+    EXPECT_EQ(0, norm(m32f, Mat(cm), NORM_INF));
+    cvReleaseMat(&cm);
+    cvReleaseFileStorage(&cfs);
+
+    remove(fname.c_str());
+}
+
+TEST(Core_InputOutput, streaming_reader)
+{
+    const char* exts[] = { ".yml", ".xml", ".yml.gz", ".xml.gz", ".bin" };
+    RNG& rng = theRNG();
+
+    Mat m(30, 40, CV_32FC3), small(3, 2, CV_64F);
+    rng.fill(m, RNG::UNIFORM, -100, 100);
+    rng.fill(small, RNG::UNIFORM, -1e10, 1e10);
+    vector<int> iv;
+    for( int i = 0; i < 100; i++ )
+        iv.push_back(rng.uniform(-2000000000, 2000000000));
+    // the numbers taking both the fast and the general path of the parser
+    double reals[] = { 0.1, -2.5e-7, 1e22, 1e23, 123456789012345678., 3.0e-310,
+                       1./3, -0., 4.9406564584124654e-324, 1.7976931348623157e308 };
+    vector<double> rv(reals, reals + sizeof(reals)/sizeof(reals[0]));
+    for( int i = 0; i < 100; i++ )
+        rv.push_back(rng.uniform(-1., 1.)*std::pow(10., rng.uniform(-30, 30)));
+
+    for( size_t k = 0; k < sizeof(exts)/sizeof(exts[0]); k++ )
+    {
+        SCOPED_TRACE(exts[k]);
+        string fname = cv::tempfile(exts[k]);
+        {
+            FileStorage fs(fname, FileStorage::WRITE);
+            ASSERT_TRUE(fs.isOpened());
+            fs << "m" << m << "skipped" << "{" << "a" << 1 << "b" << "[:" << 1 << 2 << 3 << "]" << "}";
+            fs << "iv" << iv << "rv" << rv << "small" << small;
+            fs << "s" << "text" << "i" << -17 << "octal" << "010";
+        }
+
+        FileStorage fs(fname, FileStorage::READ);
+        ASSERT_TRUE(fs.isOpened());
+        vector<string> names;
+        FileStorageReader reader(fname);
+        ASSERT_TRUE(reader.isOpened());
+        while( reader.next() )
+        {
+            string name = reader.name();
+            names.push_back(name);
+            if( name == "skipped" )
+                continue;
+            FileNode node = reader.node(), expected = fs[name];
+            ASSERT_FALSE(node.empty());
+            EXPECT_EQ(name, node.name());
+            if( name == "m" || name == "small" )
+            {
+                Mat a, b;
+                node >> a;
+                expected >> b;
+                EXPECT_EQ(0, norm(a, b, NORM_INF));
+                EXPECT_EQ(0, norm(a, name == "m" ? m : small, NORM_INF));
+            }
+            else if( name == "iv" )
+            {
+                vector<int> a;
+                node >> a;
+                EXPECT_TRUE(a == iv);
+            }
+            else if( name == "rv" )
+            {
+                vector<double> a, b;
+                node >> a;
+                expected >> b;
+                ASSERT_EQ(rv.size(), a.size());
+                EXPECT_TRUE(a == b);
+                for( size_t i = 0; i < rv.size(); i++ )
+                    EXPECT_EQ(rv[i], a[i]) << "i=" << i;
+            }
+            else if( name == "i" )
+                EXPECT_EQ(-17, (int)node);
+            else
+                EXPECT_EQ((string)expected, (string)node);
+        }
+        EXPECT_FALSE(reader.next());
+        EXPECT_TRUE(reader.node().empty());
+        ASSERT_EQ(8u, names.size());
+        EXPECT_EQ("m", names[0]);
+        EXPECT_EQ("skipped", names[1]);
+        EXPECT_EQ("small", names[4]);
+        EXPECT_EQ("octal", names[7]);
+        reader.release();
+        fs.release();
+        remove(fname.c_str());
+    }
+
+    FileStorageReader missing("/nonexistent/file.yml");
+    EXPECT_FALSE(missing.isOpened());
+    EXPECT_FALSE(missing.next());
+}
+
+// the fast path of the number parser is off on the x87 builds, see CV_FS_FAST_STRTOD
+#if !((defined _M_IX86 || defined __i386__) && \
+      !(defined __SSE2_MATH__ || (defined _M_IX86_FP && _M_IX86_FP >= 2)))
+TEST(Core_InputOutput, fast_strtod_flow_sequence)
+{
+    // the numbers as the writer formats them and as they appear in the flow sequences;
+    // the parser reads the digits by 8 bytes, so the strings are zero-padded, as the parser buffer is
+    char buf[64];
+    const char* accepted[] =
+    {
+        "0.25, -1.5", "-1.5, 3", "3]", "7.125e5 ]", "2.5000000000000000e-01,",
+        "-1.23456791e+02]", "1e-5,", "+0.0}", "9007199254740991, 1", "1.E3,"
+    };
+    for( size_t i = 0; i < sizeof(accepted)/sizeof(accepted[0]); i++ )
+    {
+        const char* str = strncpy(buf, accepted[i], sizeof(buf));
+        char *endptr = 0, *endptr0 = 0;
+        double v = 0, v0 = strtod(str, &endptr0);
+        ASSERT_TRUE(fastStrtod(str, &v, &endptr)) << str;
+        EXPECT_EQ(v0, v) << str;
+        EXPECT_EQ(endptr0 - str, endptr - str) << str;
+    }
+
+    // the locale-dependent decimal point, the special values and too many digits are left to strtod()
+    const char* rejected[] = { "1,5", ".inf", "nan", "1.5.2", "12345678901234567890123", "1e400", "-", "e5" };
+    for( size_t i = 0; i < sizeof(rejected)/sizeof(rejected[0]); i++ )
+    {
+        char* endptr = 0;
+        double v = 0;
+        EXPECT_FALSE(fastStrtod(strncpy(buf, rejected[i], sizeof(buf)), &v, &endptr)) << rejected[i];
+    }
+
+    // the values written by FileStorage, the accepted ones are correctly rounded
+    RNG& rng = theRNG();
+    int naccepted = 0;
+    for( int i = 0; i < 1000; i++ )
+    {
+        memset(buf, 0, sizeof(buf));
+        double x = rng.uniform(-1000., 1000.)*std::pow(10., rng.uniform(-10, 10));
+        if( i % 2 == 0 )
+            sprintf(buf, "%.8e, ", (float)x);
+        else
+            sprintf(buf, "%.16e]", x);
+        char *endptr = 0, *endptr0 = 0;
+        double v = 0, v0 = strtod(buf, &endptr0);
+        if( fastStrtod(buf, &v, &endptr) )
+        {
+            naccepted++;
+            EXPECT_EQ(v0, v) << buf;
+            EXPECT_EQ(endptr0 - buf, endptr - buf) << buf;
+        }
+    }
+    // all the floats are accepted
+    EXPECT_LE(500, naccepted);
+
+    Mat m(10, 10, CV_32F), m2;
+    rng.fill(m, RNG::UNIFORM, -1000, 1000);
+    vector<double> v;
+    string fname = cv::tempfile(".yml");
+    {
+        FileStorage fs(fname, FileStorage::WRITE);
+        ASSERT_TRUE(fs.isOpened());
+        fs << "m" << m << "v" << "[:" << 0.25 << -1.5 << 3 << 7.125e5 << "]";
+    }
+    {
+        FileStorage fs(fname, FileStorage::READ);
+        ASSERT_TRUE(fs.isOpened());
+        fs["m"] >> m2;
+        fs["v"] >> v;
+    }
+    remove(fname.c_str());
+
+    EXPECT_EQ(0, norm(m, m2, NORM_INF));
+    ASSERT_EQ(4u, v.size());
+    EXPECT_EQ(7.125e5, v[3]);
+}
+#endif
@@ -1111,3 +1111,82 @@ TEST(Core_Mat, reshape_1942)
     );
     ASSERT_EQ(1, cn);
 }
+
+TEST(Core_Mat, memory_pool)
+{
+    bool prevUsePool = useMemoryPool();
+    setUseMemoryPool(true);
+    MemoryPoolStats before = getMemoryPoolStats();
+
+    for( int i = 0; i < 100; i++ )
+    {
+        Mat m(480 + i % 3, 640, CV_8UC3);
+        EXPECT_EQ(0u, (size_t)m.data % 16);
+        m.setTo(Scalar::all(i));
+        EXPECT_EQ(i, (int)m.at<Vec3b>(m.rows - 1, m.cols - 1)[2]);
+    }
+
+    MemoryPoolStats after = getMemoryPoolStats();
+    EXPECT_EQ(100, after.allocCount - before.allocCount);
+    EXPECT_LE(97, after.hitCount - before.hitCount);
+    EXPECT_LT(0, after.bytesCached);
+
+    Mat pooled(10, 10, CV_8U);
+    setUseMemoryPool(false);
+    pooled.release(); // a pooled block must be freed correctly after the pool is off
+    EXPECT_EQ(0, getMemoryPoolStats().bytesCached);
+
+    setUseMemoryPool(prevUsePool);
+}
+
+TEST(Core_Mat, default_allocator)
+{
+    AccountingMatAllocator accounting;
+    setDefaultAllocator(&accounting);
+    {
+        AccountingMatAllocator::Site site("test");
+        Mat a(10, 10, CV_8UC1, Scalar::all(1)), b;
+        add(a, a, b); // the output of the library function is allocated by the default allocator
+        EXPECT_EQ(&accounting, b.allocator);
+        EXPECT_EQ(2, b.at<uchar>(9, 9));
+
+        AccountingMatAllocator::SiteStats total = accounting.getTotalStats();
+        EXPECT_EQ(2, total.allocCount);
+        EXPECT_EQ(200, total.liveBytes);
+    }
+    setDefaultAllocator(0);
+
+    vector<AccountingMatAllocator::SiteStats> sites;
+    accounting.getSiteStats(sites);
+    ASSERT_EQ(1u, sites.size());
+    EXPECT_EQ("test", sites[0].name);
+    EXPECT_EQ(0, sites[0].liveBytes);
+    EXPECT_EQ(200, sites[0].peakBytes);
+
+    Mat c(10, 10, CV_8UC1);
+    EXPECT_TRUE(c.allocator == 0);
+
+    NumaMatAllocator numa(NumaMatAllocator::INTERLEAVE);
+    setThreadDefaultAllocator(&numa);
+    Mat d(1000, 1000, CV_32FC1, Scalar::all(3));
+    setThreadDefaultAllocator(0);
+    EXPECT_EQ(&numa, d.allocator);
+    EXPECT_EQ(0u, (size_t)d.data % 16);
+    EXPECT_EQ(1000*1000, countNonZero(d == 3));
+
+    // the default allocator is not kept after release(), the explicitly set one is
+    Mat e = d;
+    d.release();
+    EXPECT_TRUE(d.allocator == 0);
+    EXPECT_EQ(&numa, e.allocator);
+    e.create(10, 10, CV_8UC1);
+    EXPECT_TRUE(e.allocator == 0);
+
+    Mat f;
+    f.allocator = &numa;
+    f.create(100, 100, CV_8UC1);
+    f.release();
+    EXPECT_EQ(&numa, f.allocator);
+    f.create(10, 10, CV_8UC1);
+    EXPECT_EQ(&numa, f.allocator);
+}
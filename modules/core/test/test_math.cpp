@@ -2641,6 +2641,245 @@ protected:
 
 TEST(Core_KMeans, singular) { CV_KMeansSingularTest test; test.safe_run(); }
 
+static void generateBlobs( Mat& data, Mat& gtLabels, int K, int N, int dims, RNG& rng )
+{
+    Mat blobCenters(K, dims, CV_32F);
+    rng.fill(blobCenters, RNG::UNIFORM, -100, 100);
+    data.create(N, dims, CV_32F);
+    gtLabels.create(N, 1, CV_32S);
+    rng.fill(data, RNG::NORMAL, 0, 1);
+    for( int i = 0; i < N; i++ )
+    {
+        int k = i % K;
+        gtLabels.at<int>(i) = k;
+        data.row(i) += blobCenters.row(k);
+    }
+}
+
+// every blob is labeled by one cluster, and every cluster labels one blob
+static bool sameClustering( const Mat& labels, const Mat& gtLabels, int K )
+{
+    vector<int> map(K, -1), inv(K, -1);
+    for( int i = 0; i < labels.rows; i++ )
+    {
+        int l = labels.at<int>(i), g = gtLabels.at<int>(i);
+        if( l < 0 || l >= K || (map[g] >= 0 && map[g] != l) || (inv[l] >= 0 && inv[l] != g) )
+            return false;
+        map[g] = l;
+        inv[l] = g;
+    }
+    return true;
+}
+
+TEST(Core_KMeans, threads)
+{
+    Mat data, gtLabels;
+    RNG rng(12345);
+    generateBlobs(data, gtLabels, 20, 30000, 8, rng);
+    TermCriteria criteria(TermCriteria::MAX_ITER+TermCriteria::EPS, 30, 0);
+    int nthreads = getNumThreads();
+
+    Mat labels1, labels4, centers1, centers4;
+    setNumThreads(1);
+    theRNG() = RNG(1);
+    double c1 = kmeans(data, 20, labels1, criteria, 2, KMEANS_PP_CENTERS, centers1);
+    setNumThreads(4);
+    theRNG() = RNG(1);
+    double c4 = kmeans(data, 20, labels4, criteria, 2, KMEANS_PP_CENTERS, centers4);
+    setNumThreads(nthreads);
+
+    EXPECT_EQ(c1, c4);
+    EXPECT_EQ(0, norm(labels1, labels4, NORM_INF));
+    EXPECT_EQ(0, norm(centers1, centers4, NORM_INF));
+}
+
+TEST(Core_KMeans, blobs)
+{
+    const int K = 6;
+    Mat data, gtLabels, labels, centers;
+    RNG rng(2);
+    generateBlobs(data, gtLabels, K, 6000, 16, rng);
+
+    theRNG() = RNG(3);
+    double compactness = kmeans(data, K, labels, TermCriteria(TermCriteria::MAX_ITER+TermCriteria::EPS, 30, 0),
+                                3, KMEANS_PP_CENTERS, centers);
+    EXPECT_TRUE(sameClustering(labels, gtLabels, K));
+    // the samples are N(0,1) around the blob centers
+    EXPECT_NEAR(data.rows*data.cols, compactness, data.rows*data.cols*0.05);
+
+    // starting from the found labels, the clustering does not change
+    Mat labels2 = labels.clone();
+    double compactness2 = kmeans(data, K, labels2, TermCriteria(TermCriteria::MAX_ITER, 10, 0),
+                                 1, KMEANS_USE_INITIAL_LABELS);
+    EXPECT_EQ(0, norm(labels, labels2, NORM_INF));
+    EXPECT_NEAR(compactness, compactness2, compactness*1e-5);
+}
+
+TEST(Core_KMeans, miniBatch)
+{
+    const int K = 6;
+    Mat data, gtLabels, labels, centers;
+    RNG rng(4);
+    generateBlobs(data, gtLabels, K, 20000, 16, rng);
+
+    theRNG() = RNG(5);
+    double compactness = kmeansMiniBatch(data, K, labels, TermCriteria(TermCriteria::MAX_ITER, 50, 0),
+                                         500, KMEANS_PP_CENTERS, centers);
+    ASSERT_EQ(K, centers.rows);
+    ASSERT_EQ(data.rows, labels.rows);
+    EXPECT_TRUE(sameClustering(labels, gtLabels, K));
+    EXPECT_NEAR(data.rows*data.cols, compactness, data.rows*data.cols*0.1);
+
+    // the centers are refined starting from the given labels
+    Mat labels2 = gtLabels.clone();
+    kmeansMiniBatch(data, K, labels2, TermCriteria(TermCriteria::MAX_ITER, 10, 0),
+                    1000, KMEANS_USE_INITIAL_LABELS);
+    EXPECT_EQ(0, norm(gtLabels, labels2, NORM_INF));
+}
+
+TEST(Core_GEMM, blocked)
+{
+    // sizes that go to the blocked implementation, including a tall-skinny product
+    // where the inner dimension gets split between the threads
+    const int sizes[][3] = { {200, 300, 530}, {97, 257, 129}, {20, 24, 5000} };
+    RNG& rng = theRNG();
+
+    for( int depth = CV_32F; depth <= CV_64F; depth++ )
+        for( size_t si = 0; si < sizeof(sizes)/sizeof(sizes[0]); si++ )
+            for( int flags = 0; flags < 16; flags++ )
+            {
+                if( depth == CV_64F && (flags & GEMM_FAST_32F) )
+                    continue;
+                int M = sizes[si][0], N = sizes[si][1], K = sizes[si][2];
+                Mat A = (flags & GEMM_1_T) ? Mat(K, M, depth) : Mat(M, K, depth);
+                Mat B = (flags & GEMM_2_T) ? Mat(N, K, depth) : Mat(K, N, depth);
+                Mat C = (flags & GEMM_3_T) ? Mat(N, M, depth) : Mat(M, N, depth);
+                rng.fill(A, RNG::UNIFORM, -1, 1);
+                rng.fill(B, RNG::UNIFORM, -1, 1);
+                rng.fill(C, RNG::UNIFORM, -1, 1);
+                double beta = (flags & 1) ? 0. : -0.5;
+
+                Mat D, Dref;
+                cv::gemm(A, B, 2., C, beta, D, flags);
+                cvtest::gemm(A, B, 2., C, beta, Dref, flags & ~GEMM_FAST_32F);
+
+                // only GEMM_FAST_32F accumulates the single-precision products in floats
+                double err = cvtest::norm(D, Dref, NORM_INF);
+                double maxErr = depth == CV_64F ? 1e-12*K : (flags & GEMM_FAST_32F) ? 1e-5*K : 1e-5*std::sqrt((double)K);
+                ASSERT_LE(err, maxErr) << "M=" << M << " N=" << N
+                    << " K=" << K << " flags=" << flags << " depth=" << depth;
+            }
+}
+
+TEST(Core_SVD, large)
+{
+    // the sizes that go to the round-robin Jacobi, both tall and wide
+    const Size sizes[] = { Size(120, 200), Size(300, 90) };
+    RNG& rng = theRNG();
+
+    for( int depth = CV_32F; depth <= CV_64F; depth++ )
+        for( size_t si = 0; si < sizeof(sizes)/sizeof(sizes[0]); si++ )
+        {
+            Mat A(sizes[si], depth), w, u, vt;
+            rng.fill(A, RNG::UNIFORM, -1, 1);
+            SVD::compute(A, w, u, vt);
+            int nm = std::min(A.rows, A.cols);
+            ASSERT_EQ(nm, w.rows);
+
+            Mat w64;
+            w.convertTo(w64, CV_64F);
+            for( int i = 0; i < nm - 1; i++ )
+                ASSERT_GE(w64.at<double>(i), w64.at<double>(i+1)) << "i=" << i;
+            double eps = depth == CV_32F ? 1e-4 : 1e-10;
+            Mat I = Mat::eye(nm, nm, depth);
+            EXPECT_LE(norm(u.t()*u, I, NORM_INF), eps);
+            EXPECT_LE(norm(vt*vt.t(), I, NORM_INF), eps);
+            EXPECT_LE(norm(u*Mat::diag(w)*vt, A, NORM_INF), eps);
+        }
+}
+
+TEST(Core_SolveLinearSystem, blockedLU)
+{
+    const int n = 200, nb = 70;
+    RNG& rng = theRNG();
+
+    for( int depth = CV_32F; depth <= CV_64F; depth++ )
+    {
+        Mat A(n, n, depth), b(n, nb, depth), x, Ainv;
+        rng.fill(A, RNG::UNIFORM, -1, 1);
+        rng.fill(b, RNG::UNIFORM, -1, 1);
+        // the eigenvalues of A stay far from zero
+        A += Mat::eye(n, n, depth)*50;
+        double eps = depth == CV_32F ? 1e-4 : 1e-10;
+
+        ASSERT_TRUE(solve(A, b, x, DECOMP_LU));
+        EXPECT_LE(norm(A*x, b, NORM_INF), eps);
+
+        ASSERT_NE(0, invert(A, Ainv, DECOMP_LU));
+        EXPECT_LE(norm(A*Ainv, Mat::eye(n, n, depth), NORM_INF), eps);
+
+        Mat w;
+        SVD::compute(A, w);
+        w.convertTo(w, CV_64F);
+        double logdet = 0;
+        for( int i = 0; i < n; i++ )
+            logdet += std::log(w.at<double>(i));
+        // |det(A/50)| = prod(w/50) does not overflow
+        EXPECT_NEAR(logdet - n*std::log(50.), std::log(std::abs(determinant(A*(1./50)))), 1e-3);
+    }
+}
+
+TEST(Core_SVD, batch)
+{
+    const int sizes[][2] = { {3, 3}, {9, 9}, {8, 3}, {2, 5} };
+    const int N = 37;
+    RNG& rng = theRNG();
+
+    for( int depth = CV_32F; depth <= CV_64F; depth++ )
+        for( size_t si = 0; si < sizeof(sizes)/sizeof(sizes[0]); si++ )
+        {
+            int m = sizes[si][0], n = sizes[si][1], nm = std::min(m, n);
+            int sz[] = { N, m, n };
+            Mat src(3, sz, depth), w, u, vt;
+            rng.fill(src, RNG::UNIFORM, -1, 1);
+
+            SVDecompBatch(src, w, u, vt);
+            ASSERT_EQ(N, w.rows);
+            ASSERT_EQ(nm, w.cols);
+            double eps = depth == CV_32F ? 1e-5 : 1e-12;
+
+            for( int b = 0; b < N; b++ )
+            {
+                Mat A(m, n, depth, src.ptr(b)), w1, u1, vt1;
+                Mat ub(m, nm, depth, u.ptr(b)), vtb(nm, n, depth, vt.ptr(b));
+                SVD::compute(A, w1, u1, vt1);
+                ASSERT_LE(norm(w.row(b).t(), w1, NORM_INF), eps) << "b=" << b;
+                ASSERT_LE(norm(ub*Mat::diag(w.row(b).t())*vtb, A, NORM_INF), eps) << "b=" << b;
+                ASSERT_LE(norm(vtb*vtb.t(), Mat::eye(nm, nm, depth), NORM_INF), eps) << "b=" << b;
+            }
+        }
+}
+
+TEST(Core_SVD, batchPartialOutputs)
+{
+    const int N = 13, sz[] = { N, 4, 3 };
+    RNG& rng = theRNG();
+    Mat src(3, sz, CV_64F), w0, u0, vt0;
+    rng.fill(src, RNG::UNIFORM, -1, 1);
+    SVDecompBatch(src, w0, u0, vt0);
+
+    // only U
+    Mat w, u, vt;
+    SVDecompBatch(src, w, u, noArray());
+    EXPECT_EQ(0, norm(w, w0, NORM_INF));
+    EXPECT_EQ(0, norm(u, u0, NORM_INF));
+
+    // only Vt
+    SVDecompBatch(src, w, noArray(), vt);
+    EXPECT_EQ(0, norm(w, w0, NORM_INF));
+    EXPECT_EQ(0, norm(vt, vt0, NORM_INF));
+}
+
 TEST(CovariationMatrixVectorOfMat, accuracy)
 {
     unsigned int col_problem_size = 8, row_problem_size = 8, vector_size = 16;
@@ -1,4 +1,5 @@
 #include "test_precomp.hpp"
+#include "opencv2/core/internal.hpp"
 
 using namespace cv;
 using namespace std;
@@ -39,4 +40,182 @@ TEST(Core_OutputArraySreate, _1997)
     Size submatSize = Size(256, 256);
 
     ASSERT_NO_THROW(local::create( mat(Rect(Point(), submatSize)), submatSize, mat.type() ));
-}
\ No newline at end of file
+}
+
+
+namespace
+{
+    class IncrementBody : public ParallelLoopBody
+    {
+    public:
+        IncrementBody(Mat& _counts, bool _nested) : counts(&_counts), nested(_nested) {}
+        void operator()(const Range& range) const
+        {
+            for( int i = range.start; i < range.end; i++ )
+            {
+                Mat row = counts->row(i).reshape(1, counts->cols);
+                if( nested )
+                    parallel_for_(Range(0, row.rows), IncrementBody(row, false));
+                else
+                    row += Scalar::all(1);
+            }
+        }
+    private:
+        Mat* counts;
+        bool nested;
+    };
+}
+
+TEST(Core_Parallel, each_stripe_is_processed_once)
+{
+    Mat counts(1000, 7, CV_32SC1, Scalar::all(0));
+    parallel_for_(Range(0, counts.rows), IncrementBody(counts, false));
+    EXPECT_EQ(0, countNonZero(counts != 1));
+
+    counts.setTo(Scalar::all(0));
+    parallel_for_(Range(0, counts.rows), IncrementBody(counts, false), 13);
+    EXPECT_EQ(0, countNonZero(counts != 1));
+}
+
+TEST(Core_Parallel, nested)
+{
+    Mat counts(100, 100, CV_32SC1, Scalar::all(0));
+    parallel_for_(Range(0, counts.rows), IncrementBody(counts, true));
+    EXPECT_EQ(0, countNonZero(counts != 1));
+}
+
+TEST(Core_Dispatch, variants)
+{
+    static const struct { const char* name; int feature; } features[] =
+    {
+        { "SSE2", CV_CPU_SSE2 }, { "SSE4.2", CV_CPU_SSE4_2 }, { "AVX2", CV_CPU_AVX2 }
+    };
+    vector<string> kernels, variants;
+    getDispatchedKernels(kernels, variants);
+
+    ASSERT_EQ(kernels.size(), variants.size());
+    EXPECT_NE(find(kernels.begin(), kernels.end(), string("add8u")), kernels.end());
+    EXPECT_NE(find(kernels.begin(), kernels.end(), string("gemm32f")), kernels.end());
+    for( size_t i = 0; i < variants.size(); i++ )
+    {
+        if( variants[i] == "baseline" )
+            continue;
+        size_t j = 0;
+        for( ; j < sizeof(features)/sizeof(features[0]); j++ )
+            if( variants[i] == features[j].name )
+                break;
+        ASSERT_LT(j, sizeof(features)/sizeof(features[0])) << kernels[i] << ": " << variants[i];
+        EXPECT_TRUE(checkHardwareSupport(features[j].feature)) << kernels[i] << ": " << variants[i];
+    }
+
+    Mat a(100, 100, CV_8U), b(100, 100, CV_8U), sum0, sum1;
+    randu(a, 0, 256);
+    randu(b, 0, 256);
+    add(a, b, sum0);
+
+    setUseOptimized(false);
+    getDispatchedKernels(kernels, variants);
+    add(a, b, sum1);
+    setUseOptimized(true);
+
+    for( size_t i = 0; i < variants.size(); i++ )
+        EXPECT_EQ(string("baseline"), variants[i]) << kernels[i];
+    EXPECT_EQ(0, norm(sum0, sum1, NORM_INF));
+}
+
+// the regions are not recorded when the tracing is compiled out
+#if CV_ENABLE_TRACE
+
+TEST(Core_Trace, regions)
+{
+    resetTrace();
+    setTraceEnabled(true);
+    {
+        Mat counts(1000, 1, CV_32SC1, Scalar::all(0));
+        for( int i = 0; i < 3; i++ )
+            parallel_for_(Range(0, counts.rows), IncrementBody(counts, false), 4);
+        CV_TRACE_REGION("Core_Trace.outer");
+        CV_TRACE_BYTES(100);
+        {
+            CV_TRACE_REGION("Core_Trace.inner");
+            CV_TRACE_BYTES(10);
+        }
+        CV_TRACE_BYTES(5);
+    }
+    setTraceEnabled(false);
+    {
+        CV_TRACE_REGION("Core_Trace.disabled");
+    }
+
+    vector<TraceStats> stats;
+    getTraceStats(stats);
+    map<string, TraceStats> byName;
+    for( size_t i = 0; i < stats.size(); i++ )
+        byName[stats[i].name] = stats[i];
+
+    ASSERT_EQ(1u, byName.count("cv::parallel_for_"));
+    EXPECT_EQ(3, byName["cv::parallel_for_"].calls);
+    EXPECT_LE(byName["cv::parallel_for_"].maxTime, byName["cv::parallel_for_"].totalTime);
+    ASSERT_EQ(1u, byName.count("Core_Trace.outer"));
+    EXPECT_EQ(1, byName["Core_Trace.outer"].calls);
+    EXPECT_EQ(105, byName["Core_Trace.outer"].bytes);
+    EXPECT_EQ(10, byName["Core_Trace.inner"].bytes);
+    EXPECT_EQ(0u, byName.count("Core_Trace.disabled"));
+
+    string filename = tempfile(".json");
+    writeTrace(filename);
+    FILE* f = fopen(filename.c_str(), "rt");
+    ASSERT_TRUE(f != 0);
+    char buf[1 << 10] = {0};
+    size_t len = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    remove(filename.c_str());
+    EXPECT_GT(len, 0u);
+    EXPECT_EQ(0, strncmp(buf, "{\"traceEvents\":[", 16));
+
+    resetTrace();
+    getTraceStats(stats);
+    EXPECT_TRUE(stats.empty());
+}
+
+namespace
+{
+    class TracedBody : public ParallelLoopBody
+    {
+    public:
+        void operator()(const Range& range) const
+        {
+            for( int i = range.start; i < range.end; i++ )
+            {
+                CV_TRACE_REGION("Core_Trace.concurrent");
+            }
+        }
+    };
+}
+
+TEST(Core_Trace, concurrentSites)
+{
+    int nthreads = getNumThreads();
+    setNumThreads(4);
+    resetTrace();
+    setTraceEnabled(true);
+    // the site is entered for the first time by several threads at once
+    parallel_for_(Range(0, 1000), TracedBody(), 100);
+    setTraceEnabled(false);
+    setNumThreads(nthreads);
+
+    vector<TraceStats> stats;
+    getTraceStats(stats);
+    int nsites = 0;
+    for( size_t i = 0; i < stats.size(); i++ )
+    {
+        if( stats[i].name != "Core_Trace.concurrent" )
+            continue;
+        nsites++;
+        EXPECT_EQ(1000, stats[i].calls);
+    }
+    EXPECT_EQ(1, nsites);
+    resetTrace();
+}
+
+#endif
@@ -1214,3 +1214,75 @@ protected:
 };
 
 TEST(Core_SparseMat, iterations) { CV_SparseMatTest test; test.safe_run(); }
+
+// The element-wise expressions are fused and evaluated in a single pass;
+// the result must match the step-by-step evaluation with the standalone functions.
+TEST(Core_MatExpr, fused_elementwise)
+{
+    RNG& rng = theRNG();
+    const int depths[] = { CV_8U, CV_16S, CV_32F, CV_64F };
+    const Size sizes[] = { Size(7, 5), Size(640, 480) };
+
+    for( int di = 0; di < 4; di++ )
+    for( int si = 0; si < 2; si++ )
+    for( int cn = 1; cn <= 3; cn += 2 )
+    {
+        int depth = depths[di], type = CV_MAKETYPE(depth, cn);
+        double eps = depth <= CV_32S ? 0 : 1e-4;
+        Mat a(sizes[si], type), b(sizes[si], type), c(sizes[si], type);
+        rng.fill(a, RNG::UNIFORM, 0, 100);
+        rng.fill(b, RNG::UNIFORM, 0, 100);
+        rng.fill(c, RNG::UNIFORM, 0, 100);
+        Mat t, ref, res;
+
+        SCOPED_TRACE(cv::format("depth=%d, cn=%d, size=%dx%d", depth, cn, a.cols, a.rows));
+
+        addWeighted(a, 0.7, b, 1.3, 0, t);
+        subtract(t, c, ref);
+        res = a*0.7 + b*1.3 - c;
+        EXPECT_LE(norm(ref, res, NORM_INF), eps);
+
+        multiply(a, b, t, 0.5);
+        min(t, c, t);
+        subtract(Scalar::all(50), t, ref);
+        res = Scalar::all(50) - min(a.mul(b, 0.5), c);
+        EXPECT_LE(norm(ref, res, NORM_INF), eps);
+
+        subtract(a, b, t);
+        max(t, 10, t);
+        t.convertTo(ref, -1, 2);
+        res = max(a - b, 10)*2;
+        EXPECT_LE(norm(ref, res, NORM_INF), eps);
+
+        absdiff(a, b, t);
+        t.convertTo(ref, CV_32F, 0.5);
+        Mat_<float> resf = abs(a - b)*0.5;
+        EXPECT_LE(norm(ref, resf, NORM_INF), 1e-4);
+
+        multiply(a, b, t);
+        add(c, t, ref);
+        res = c.clone();
+        res += a.mul(b);
+        EXPECT_LE(norm(ref, res, NORM_INF), eps);
+
+        Rect roi(1, 2, a.cols/2, a.rows/2);
+        multiply(a, b, t);
+        subtract(t, c, ref);
+        res = (a.mul(b) - c)(roi);
+        EXPECT_LE(norm(ref(roi), res, NORM_INF), eps);
+
+        if( cn == 1 )
+        {
+            absdiff(a, b, t);
+            compare(t, 10.5, ref, CMP_GT);
+            res = abs(a - b) > 10.5;
+            EXPECT_EQ(0, norm(ref, res, NORM_INF));
+
+            multiply(a, b, t, 0.01);
+            add(t, Scalar(1), t);
+            compare(t, c, ref, CMP_LE);
+            res = (a.mul(b, 0.01) + Scalar(1)) <= c;
+            EXPECT_EQ(0, norm(ref, res, NORM_INF));
+        }
+    }
+}
@@ -54,6 +54,8 @@ namespace cv
 
 CV_EXPORTS bool initModule_features2d();
 
+class Pyramid; // see opencv2/imgproc/imgproc.hpp
+
 /*!
  The Keypoint Class
 
@@ -383,6 +385,11 @@ public:
     void operator()( InputArray image, InputArray mask, vector<KeyPoint>& keypoints,
                      OutputArray descriptors, bool useProvidedKeypoints=false ) const;
 
+    // Compute the ORB features and descriptors on a prebuilt pyramid of the image,
+    // e.g. the one shared with calcOpticalFlowPyrLK
+    void operator()( const Pyramid& pyramid, InputArray mask, vector<KeyPoint>& keypoints,
+                     OutputArray descriptors, bool useProvidedKeypoints=false ) const;
+
     AlgorithmInfo* info() const;
 
 protected:
@@ -390,6 +397,10 @@ protected:
     void computeImpl( const Mat& image, vector<KeyPoint>& keypoints, Mat& descriptors ) const;
     void detectImpl( const Mat& image, vector<KeyPoint>& keypoints, const Mat& mask=Mat() ) const;
 
+    void computeOnPyramid( vector<Mat>& imagePyramid, const vector<Mat>& maskPyramid, Size imageSize,
+                           vector<KeyPoint>& keypoints, OutputArray descriptors,
+                           bool do_keypoints, bool do_descriptors ) const;
+
     CV_PROP_RW int nfeatures;
     CV_PROP_RW double scaleFactor;
     CV_PROP_RW int nlevels;
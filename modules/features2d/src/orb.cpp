@@ -712,6 +712,66 @@ static void computeDescriptors(const Mat& image, vector<KeyPoint>& keypoints, Ma
 }
 
 
+/** Compute the scaled and padded masks for the levels of the image pyramid
+ * @param mask the mask of the source image
+ * @param imagePyramid the image pyramid, only the level sizes are used
+ * @param firstLevel the level of the source image
+ * @param border the border added to the mask levels
+ * @param maskPyramid the resulting masks
+ */
+static void buildMaskPyramid(const Mat& mask, const vector<Mat>& imagePyramid, int firstLevel,
+                             int border, vector<Mat>& maskPyramid)
+{
+    int levelsNum = (int)imagePyramid.size();
+    maskPyramid.resize(levelsNum);
+    for (int level = 0; level < levelsNum; ++level)
+    {
+        Size sz = imagePyramid[level].size();
+        Mat masktemp(sz.height + border*2, sz.width + border*2, mask.type());
+        maskPyramid[level] = masktemp(Rect(border, border, sz.width, sz.height));
+
+        if( level != firstLevel )
+        {
+            if( level < firstLevel )
+                resize(mask, maskPyramid[level], sz, 0, 0, INTER_LINEAR);
+            else
+            {
+                resize(maskPyramid[level-1], maskPyramid[level], sz, 0, 0, INTER_LINEAR);
+                threshold(maskPyramid[level], maskPyramid[level], 254, 0, THRESH_TOZERO);
+            }
+            copyMakeBorder(maskPyramid[level], masktemp, border, border, border, border,
+                           BORDER_CONSTANT+BORDER_ISOLATED);
+        }
+        else
+            copyMakeBorder(mask, masktemp, border, border, border, border,
+                           BORDER_CONSTANT+BORDER_ISOLATED);
+    }
+}
+
+static int getOrbBorder(int edgeThreshold, int patchSize)
+{
+    const int HARRIS_BLOCK_SIZE = 9;
+    int halfPatchSize = patchSize / 2;
+    return std::max(edgeThreshold, std::max(halfPatchSize, HARRIS_BLOCK_SIZE/2))+1;
+}
+
+// the number of the pyramid levels used by the provided keypoints
+static int getKeypointLevels(const vector<KeyPoint>& keypoints)
+{
+    // !!!TODO!!! implement more correct method, independent from the used keypoint detector.
+    // Namely, the detector should provide correct size of each keypoint. Based on the keypoint size
+    // and the algorithm used (i.e. BRIEF, running on 31x31 patches) we should compute the approximate
+    // scale-factor that we need to apply. Then we should cluster all the computed scale-factors and
+    // for each cluster compute the corresponding image.
+    //
+    // In short, ultimately the descriptor should
+    // ignore octave parameter and deal only with the keypoint size.
+    int levelsNum = 0;
+    for( size_t i = 0; i < keypoints.size(); i++ )
+        levelsNum = std::max(levelsNum, std::max(keypoints[i].octave, 0));
+    return levelsNum + 1;
+}
+
 /** Compute the ORB features and descriptors on an image
  * @param img the image to compute the features and descriptors on
  * @param mask the mask to apply
@@ -732,32 +792,14 @@ void ORB::operator()( InputArray _image, InputArray _mask, vector<KeyPoint>& _ke
         return;
 
     //ROI handling
-    const int HARRIS_BLOCK_SIZE = 9;
-    int halfPatchSize = patchSize / 2;
-    int border = std::max(edgeThreshold, std::max(halfPatchSize, HARRIS_BLOCK_SIZE/2))+1;
+    int border = getOrbBorder(edgeThreshold, patchSize);
 
     Mat image = _image.getMat(), mask = _mask.getMat();
     if( image.type() != CV_8UC1 )
         cvtColor(_image, image, CV_BGR2GRAY);
 
-    int levelsNum = this->nlevels;
-
-    if( !do_keypoints )
-    {
-        // if we have pre-computed keypoints, they may use more levels than it is set in parameters
-        // !!!TODO!!! implement more correct method, independent from the used keypoint detector.
-        // Namely, the detector should provide correct size of each keypoint. Based on the keypoint size
-        // and the algorithm used (i.e. BRIEF, running on 31x31 patches) we should compute the approximate
-        // scale-factor that we need to apply. Then we should cluster all the computed scale-factors and
-        // for each cluster compute the corresponding image.
-        //
-        // In short, ultimately the descriptor should
-        // ignore octave parameter and deal only with the keypoint size.
-        levelsNum = 0;
-        for( size_t i = 0; i < _keypoints.size(); i++ )
-            levelsNum = std::max(levelsNum, std::max(_keypoints[i].octave, 0));
-        levelsNum++;
-    }
+    // if we have pre-computed keypoints, they may use more levels than it is set in parameters
+    int levelsNum = do_keypoints ? this->nlevels : getKeypointLevels(_keypoints);
 
     // Pre-compute the scale pyramids
     vector<Mat> imagePyramid(levelsNum), maskPyramid(levelsNum);
@@ -766,50 +808,93 @@ void ORB::operator()( InputArray _image, InputArray _mask, vector<KeyPoint>& _ke
         float scale = 1/getScale(level, firstLevel, scaleFactor);
         Size sz(cvRound(image.cols*scale), cvRound(image.rows*scale));
         Size wholeSize(sz.width + border*2, sz.height + border*2);
-        Mat temp(wholeSize, image.type()), masktemp;
+        Mat temp(wholeSize, image.type());
         imagePyramid[level] = temp(Rect(border, border, sz.width, sz.height));
 
-        if( !mask.empty() )
-        {
-            masktemp = Mat(wholeSize, mask.type());
-            maskPyramid[level] = masktemp(Rect(border, border, sz.width, sz.height));
-        }
-
         // Compute the resized image
         if( level != firstLevel )
         {
             if( level < firstLevel )
-            {
                 resize(image, imagePyramid[level], sz, 0, 0, INTER_LINEAR);
-                if (!mask.empty())
-                    resize(mask, maskPyramid[level], sz, 0, 0, INTER_LINEAR);
-            }
             else
-            {
                 resize(imagePyramid[level-1], imagePyramid[level], sz, 0, 0, INTER_LINEAR);
-                if (!mask.empty())
-                {
-                    resize(maskPyramid[level-1], maskPyramid[level], sz, 0, 0, INTER_LINEAR);
-                    threshold(maskPyramid[level], maskPyramid[level], 254, 0, THRESH_TOZERO);
-                }
-            }
 
             copyMakeBorder(imagePyramid[level], temp, border, border, border, border,
                            BORDER_REFLECT_101+BORDER_ISOLATED);
-            if (!mask.empty())
-                copyMakeBorder(maskPyramid[level], masktemp, border, border, border, border,
-                               BORDER_CONSTANT+BORDER_ISOLATED);
         }
         else
         {
             copyMakeBorder(image, temp, border, border, border, border,
                            BORDER_REFLECT_101);
-            if( !mask.empty() )
-                copyMakeBorder(mask, masktemp, border, border, border, border,
-                               BORDER_CONSTANT+BORDER_ISOLATED);
         }
     }
 
+    if( !mask.empty() )
+        buildMaskPyramid(mask, imagePyramid, firstLevel, border, maskPyramid);
+
+    computeOnPyramid(imagePyramid, maskPyramid, image.size(), _keypoints, _descriptors,
+                     do_keypoints, do_descriptors);
+}
+
+/** Compute the ORB features and descriptors on a prebuilt image pyramid
+ * @param pyramid the pyramid of the image, built with the scale factor of the detector
+ * @param mask the mask of the level 0 to apply
+ * @param keypoints the resulting keypoints
+ * @param descriptors the resulting descriptors
+ * @param useProvidedKeypoints if true, the keypoints are used as an input
+ */
+void ORB::operator()( const Pyramid& pyramid, InputArray _mask, vector<KeyPoint>& _keypoints,
+                      OutputArray _descriptors, bool useProvidedKeypoints) const
+{
+    CV_Assert(patchSize >= 2);
+
+    bool do_keypoints = !useProvidedKeypoints;
+    bool do_descriptors = _descriptors.needed();
+
+    if( (!do_keypoints && !do_descriptors) || pyramid.empty() )
+        return;
+
+    int border = getOrbBorder(edgeThreshold, patchSize);
+    int levelsNum = do_keypoints ? this->nlevels : getKeypointLevels(_keypoints);
+
+    CV_Assert( firstLevel == 0 && pyramid[0].type() == CV_8UC1 &&
+               pyramid.border() >= border && pyramid.maxLevel() + 1 >= levelsNum &&
+               std::abs(pyramid.scaleFactor() - scaleFactor) <= scaleFactor*FLT_EPSILON );
+
+    vector<Mat> imagePyramid(levelsNum), maskPyramid(levelsNum);
+    for (int level = 0; level < levelsNum; ++level)
+    {
+        const Mat& layer = pyramid[level];
+        if( do_descriptors )
+        {
+            // the levels are blurred in-place before computing the descriptors,
+            // so the shared pyramid is copied together with the border
+            Mat temp, padded = layer;
+            padded.adjustROI(border, border, border, border);
+            padded.copyTo(temp);
+            imagePyramid[level] = temp(Rect(border, border, layer.cols, layer.rows));
+        }
+        else
+            imagePyramid[level] = layer;
+    }
+
+    Mat mask = _mask.getMat();
+    if( !mask.empty() )
+    {
+        CV_Assert( mask.size() == pyramid[0].size() );
+        buildMaskPyramid(mask, imagePyramid, firstLevel, border, maskPyramid);
+    }
+
+    computeOnPyramid(imagePyramid, maskPyramid, pyramid[0].size(), _keypoints, _descriptors,
+                     do_keypoints, do_descriptors);
+}
+
+void ORB::computeOnPyramid( vector<Mat>& imagePyramid, const vector<Mat>& maskPyramid, Size imageSize,
+                            vector<KeyPoint>& _keypoints, OutputArray _descriptors,
+                            bool do_keypoints, bool do_descriptors ) const
+{
+    int levelsNum = (int)imagePyramid.size();
+
     // Pre-compute the keypoints (we keep the best over all scales, so this has to be done beforehand
     vector < vector<KeyPoint> > allKeypoints;
     if( do_keypoints )
@@ -838,7 +923,7 @@ void ORB::operator()( InputArray _image, InputArray _mask, vector<KeyPoint>& _ke
     else
     {
         // Remove keypoints very close to the border
-        KeyPointsFilter::runByImageBorder(_keypoints, image.size(), edgeThreshold);
+        KeyPointsFilter::runByImageBorder(_keypoints, imageSize, edgeThreshold);
 
         // Cluster the input keypoints depending on the level they were computed at
         allKeypoints.resize(levelsNum);
@@ -90,3 +90,30 @@ TEST(Features2D_ORB, _1996)
 
     ASSERT_EQ(0, roiViolations);
 }
+
+TEST(Features2D_ORB, sharedPyramid)
+{
+    Mat image(480, 640, CV_8UC1);
+    theRNG().fill(image, RNG::UNIFORM, 0, 255);
+    GaussianBlur(image, image, Size(9, 9), 3);
+
+    ORB orb;
+    vector<KeyPoint> keypoints, keypoints2;
+    Mat descriptors, descriptors2;
+    orb(image, Mat(), keypoints, descriptors);
+
+    // the pyramid with the scale factor and the border of the detector gives the same features
+    Pyramid pyramid(image, 7, 1.2, 32);
+    Mat level0 = pyramid[0].clone();
+    orb(pyramid, Mat(), keypoints2, descriptors2);
+
+    ASSERT_EQ(keypoints.size(), keypoints2.size());
+    for( size_t i = 0; i < keypoints.size(); i++ )
+    {
+        EXPECT_EQ(keypoints[i].pt, keypoints2[i].pt);
+        EXPECT_EQ(keypoints[i].octave, keypoints2[i].octave);
+    }
+    EXPECT_EQ(0, norm(descriptors, descriptors2, NORM_HAMMING));
+    // and the shared pyramid is not modified
+    EXPECT_EQ(0, norm(level0, pyramid[0], NORM_INF));
+}
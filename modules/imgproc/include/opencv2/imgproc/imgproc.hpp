@@ -87,6 +87,9 @@ public:
     //! the filtering operator. Must be overrided in the derived classes. The horizontal border interpolation is done outside of the class.
     virtual void operator()(const uchar* src, uchar* dst,
                             int width, int cn) = 0;
+    //! returns an independent copy of the filter, or an empty pointer if it can not be copied.
+    //! FilterEngine::apply() processes the image by stripes in parallel only when all its filters can be copied.
+    virtual Ptr<BaseRowFilter> clone() const;
     int ksize, anchor;
 };
 
@@ -116,6 +119,9 @@ public:
                             int dstcount, int width) = 0;
     //! resets the internal buffers, if any
     virtual void reset();
+    //! returns an independent copy of the filter with its own buffers, or an empty pointer if it can not be copied
+    //! or if the stripes processed from different starting rows would give a different result.
+    virtual Ptr<BaseColumnFilter> clone() const;
     int ksize, anchor;
 };
 
@@ -142,6 +148,8 @@ public:
                             int dstcount, int width, int cn) = 0;
     //! resets the internal buffers, if any
     virtual void reset();
+    //! returns an independent copy of the filter with its own buffers, or an empty pointer if it can not be copied
+    virtual Ptr<BaseFilter> clone() const;
     Size ksize;
     Point anchor;
 };
@@ -250,6 +258,8 @@ public:
     virtual int proceed(const uchar* src, int srcStep, int srcCount,
                         uchar* dst, int dstStep);
     //! applies filter to the specified ROI of the image. if srcRoi=(0,0,-1,-1), the whole image is filtered.
+    //! large images are split into horizontal stripes that are filtered in parallel, unless src and dst overlap
+    //! or some of the filters can not be cloned; the result is the same as in the serial mode.
     virtual void apply( const Mat& src, Mat& dst,
                         const Rect& srcRoi=Rect(0,0,-1,-1),
                         Point dstOfs=Point(0,0),
@@ -561,6 +571,11 @@ CV_EXPORTS_W void resize( InputArray src, OutputArray dst,
                           Size dsize, double fx=0, double fy=0,
                           int interpolation=INTER_LINEAR );
 
+//! resizes the 8-bit image and converts it to the planar float blob 1 x channels x height x width in one pass
+CV_EXPORTS_W void blobFromImage( InputArray image, OutputArray blob, Size size=Size(),
+                                 double scalefactor=1, Scalar mean=Scalar(), Scalar stdDev=Scalar::all(1),
+                                 bool swapRB=false, int interpolation=INTER_LINEAR );
+
 //! warps the image using affine transformation
 CV_EXPORTS_W void warpAffine( InputArray src, OutputArray dst,
                               InputArray M, Size dsize,
@@ -593,6 +608,50 @@ CV_EXPORTS_W void convertMaps( InputArray map1, InputArray map2,
                                OutputArray dstmap1, OutputArray dstmap2,
                                int dstmap1type, bool nninterpolation=false );
 
+/*!
+ The remap() maps prepared once for the repeated remapping of the images of the same size and type,
+ e.g. for the undistortion or the stitching warps of every frame.
+
+ For the 8-bit images with 1, 3 or 4 channels and the bilinear or bicubic interpolation
+ the source offsets and the interpolation weight indices of the destination pixels are stored
+ tile by tile in the order they are used, with the border taps resolved in advance, so
+ the remapping is a parallel SIMD gather without any per-pixel coordinate math.
+ The result is the same as of remap(). The other cases use remap() with the fixed-point maps.
+*/
+class CV_EXPORTS RemapPlan
+{
+public:
+    //! the default constructor
+    RemapPlan();
+    //! prepares the maps for the source images of the given size and type
+    RemapPlan( InputArray map1, InputArray map2, Size srcSize, int srcType,
+               int interpolation=INTER_LINEAR, int borderMode=BORDER_CONSTANT,
+               const Scalar& borderValue=Scalar() );
+    //! prepares the maps, the parameters are the same as of remap()
+    void create( InputArray map1, InputArray map2, Size srcSize, int srcType,
+                 int interpolation=INTER_LINEAR, int borderMode=BORDER_CONSTANT,
+                 const Scalar& borderValue=Scalar() );
+    //! remaps the image of the size and type passed to create()
+    void operator()( InputArray src, OutputArray dst ) const;
+
+    Size srcSize() const;
+    Size dstSize() const;
+    bool empty() const;
+
+protected:
+    Size ssize, dsize;
+    int stype, interpolation, borderMode;
+    Scalar borderValue;
+    // the fixed-point maps, when remap() is used
+    Mat xy, fxy;
+    // the first offset, the first pixel and the border flag of each destination tile
+    vector<Vec3i> tiles;
+    // the source offsets of the pixels in the tile order, or their border taps
+    vector<int> ofs;
+    // the interpolation table indices of the pixels in the tile order
+    vector<ushort> tabIdx;
+};
+
 //! returns 2x3 affine transformation matrix for the planar rotation.
 CV_EXPORTS_W Mat getRotationMatrix2D( Point2f center, double angle, double scale );
 //! returns 3x3 perspective transformation for the corresponding 4 point pairs.
@@ -638,6 +697,9 @@ CV_EXPORTS_W double PSNR(InputArray src1, InputArray src2);
 
 CV_EXPORTS_W Point2d phaseCorrelate(InputArray src1, InputArray src2,
                                     InputArray window = noArray(), CV_OUT double* response=0);
+//! the same, with the DFT plans that are (re)created when needed and reused by the next calls
+CV_EXPORTS Point2d phaseCorrelate(InputArray src1, InputArray src2, DFTPlan& forward, DFTPlan& inverse,
+                                  InputArray window = noArray(), double* response=0);
 CV_EXPORTS_W void createHanningWindow(OutputArray dst, Size winSize, int type);
 
 //! type of the threshold operation
@@ -669,6 +731,46 @@ CV_EXPORTS_W void pyrUp( InputArray src, OutputArray dst,
 CV_EXPORTS void buildPyramid( InputArray src, OutputArrayOfArrays dst,
                               int maxlevel, int borderType=BORDER_DEFAULT );
 
+/*!
+ The image pyramid that keeps its buffers between the frames.
+
+ Each level is stored inside a buffer padded by the specified border, so the pyramid built once
+ per frame can be shared by the functions that read the pixels around the images:
+ levels() can be passed to cv::calcOpticalFlowPyrLK() when the border is not smaller than winSize,
+ and the pyramid can be passed to ORB when its scale factor and border match.
+
+ With the scale factor 2 the levels are built by cv::pyrDown(), otherwise the level i is
+ the bilinear cv::resize() of the level i-1 to the size cvRound(size/scaleFactor^i).
+ The next build() overwrites the levels, so keep two objects for the previous and the current frame.
+*/
+class CV_EXPORTS Pyramid
+{
+public:
+    //! the default constructor
+    Pyramid();
+    //! builds the pyramid of the image
+    Pyramid( InputArray img, int maxLevel, double scaleFactor=2, int border=0,
+             int borderType=BORDER_REFLECT_101 );
+    //! builds the pyramid of the new image, reusing the buffers of the same size and type
+    void build( InputArray img, int maxLevel, double scaleFactor=2, int border=0,
+                int borderType=BORDER_REFLECT_101 );
+    //! returns the level image, a submatrix of the padded buffer (the level 0 is img if it is not padded)
+    const Mat& operator[]( int level ) const;
+    //! returns all the levels
+    const vector<Mat>& levels() const;
+    //! returns the index of the last level; it is less than maxLevel passed to build() if the levels get empty
+    int maxLevel() const;
+    double scaleFactor() const;
+    int border() const;
+    bool empty() const;
+
+protected:
+    vector<Mat> layers;
+    vector<Mat> buffers;
+    double scale;
+    int borderSize;
+};
+
 //! corrects lens distortion for the given camera matrix and distortion coefficients
 CV_EXPORTS_W void undistort( InputArray src, OutputArray dst,
                              InputArray cameraMatrix,
@@ -821,6 +923,11 @@ CV_EXPORTS_W int floodFill( InputOutputArray image, InputOutputArray mask,
                             Scalar loDiff=Scalar(), Scalar upDiff=Scalar(),
                             int flags=4 );
 
+//! fills the semi-uniform image regions of many seed points at once, in one labeling pass over the image
+CV_EXPORTS int floodFillBatch( InputOutputArray image, const vector<Point>& seeds,
+                               const vector<Scalar>& newVals, CV_OUT vector<Rect>* rects=0,
+                               Scalar diff=Scalar(), int connectivity=4 );
+
 
 enum
 {
@@ -1102,6 +1209,11 @@ enum { TM_SQDIFF=0, TM_SQDIFF_NORMED=1, TM_CCORR=2, TM_CCORR_NORMED=3, TM_CCOEFF
 CV_EXPORTS_W void matchTemplate( InputArray image, InputArray templ,
                                  OutputArray result, int method );
 
+//! finds the positions where the TM_SQDIFF or TM_SQDIFF_NORMED response is not above the threshold
+CV_EXPORTS_W void matchTemplateThreshold( InputArray image, InputArray templ, OutputArray locations,
+                                          int method, double threshold,
+                                          OutputArray responses=noArray() );
+
 enum { CC_STAT_LEFT=0, CC_STAT_TOP=1, CC_STAT_WIDTH=2, CC_STAT_HEIGHT=3, CC_STAT_AREA=4, CC_STAT_MAX = 5};
 
 // computes the connected components labeled image of boolean image ``image``
@@ -1144,6 +1256,15 @@ CV_EXPORTS_W void findContours( InputOutputArray image, OutputArrayOfArrays cont
 CV_EXPORTS void findContours( InputOutputArray image, OutputArrayOfArrays contours,
                               int mode, int method, Point offset=Point());
 
+//! retrieves the same contours and hierarchy as findContours() in parallel, the image is not modified
+CV_EXPORTS void findContoursParallel( InputArray image, vector<vector<Point> >& contours,
+                                      OutputArray hierarchy, int mode,
+                                      int method, Point offset=Point());
+
+//! retrieves the same contours as findContours() in parallel, the image is not modified
+CV_EXPORTS void findContoursParallel( InputArray image, vector<vector<Point> >& contours,
+                                      int mode, int method, Point offset=Point());
+
 //! approximates contour or a curve using Douglas-Peucker algorithm
 CV_EXPORTS_W void approxPolyDP( InputArray curve,
                                 OutputArray approxCurve,
@@ -1280,6 +1401,104 @@ protected:
 // main function for all demosaicing procceses
 CV_EXPORTS_W void demosaicing(InputArray _src, OutputArray _dst, int code, int dcn = 0);
 
+/*!
+ Tiled processing of the images that do not fit in memory.
+
+ The image is pulled from TileSource by rectangles and the result is pushed to TileSink.
+ TilePipeline runs a chain of operations tile by tile: for each tile of the result the operations
+ compute the rectangles they need, widened by the halo of the filters, from the last one to the first one,
+ and then the tile is read and passed through the chain. The tiles are processed in parallel,
+ so only a few tiles of each intermediate image are in memory at any time. The result is the same
+ as of the operations applied to the whole image.
+*/
+class CV_EXPORTS TileSource
+{
+public:
+    virtual ~TileSource();
+    //! the size of the image
+    virtual Size size() const = 0;
+    //! the type of the image
+    virtual int type() const = 0;
+    //! copies the rectangle of the image (it is inside the image) to dst of the rectangle size and the image type
+    virtual void read( const Rect& r, Mat& dst ) = 0;
+};
+
+class CV_EXPORTS TileSink
+{
+public:
+    virtual ~TileSink();
+    //! prepares the sink for the image of the given size and type, called before the first tile
+    virtual void open( Size size, int type ) = 0;
+    //! stores the rectangle of the image
+    virtual void write( const Rect& r, const Mat& tile ) = 0;
+};
+
+//! the source and the sink of the image in memory; the sink image is (re)allocated by TileSink::open
+CV_EXPORTS Ptr<TileSource> createMatTileSource( const Mat& image );
+CV_EXPORTS Ptr<TileSink> createMatTileSink( Mat& image );
+
+//! the source of the raw image stored in the file row by row without gaps, starting at the offset.
+//! The file is memory-mapped where possible, otherwise it is read with the standard I/O.
+CV_EXPORTS Ptr<TileSource> createRawFileTileSource( const string& filename, Size size, int type,
+                                                    int64 offset=0 );
+//! the sink that writes the raw image to the file, starting at the offset.
+//! The file is created if it does not exist, the data before the offset is kept.
+CV_EXPORTS Ptr<TileSink> createRawFileTileSink( const string& filename, int64 offset=0 );
+
+//! an operation of TilePipeline
+class CV_EXPORTS TileOp
+{
+public:
+    virtual ~TileOp();
+    //! the size of the result for the source of the given size; the same size by default
+    virtual Size dstSize( Size srcSize ) const;
+    //! the type of the result for the source of the given type; the same type by default
+    virtual int dstType( int srcType ) const;
+    //! the rectangle of the source, clipped by the image, needed to compute the rectangle of the result;
+    //! the same rectangle by default
+    virtual Rect srcRect( const Rect& dstRect, Size srcSize ) const;
+    //! computes the rectangle dstRect of the result into dst from src, that holds the rectangle srcRect
+    //! of the source of srcSize. srcRect includes srcRect(dstRect, srcSize), dst is already allocated.
+    virtual void apply( const Mat& src, const Rect& srcRect, Size srcSize,
+                        Mat& dst, const Rect& dstRect ) const = 0;
+};
+
+//! the filter; the engine is copied for each tile when its filters can be cloned, otherwise the tiles are filtered one by one
+CV_EXPORTS Ptr<TileOp> createFilterTileOp( const Ptr<FilterEngine>& filter );
+//! resize(), the parameters are the same
+CV_EXPORTS Ptr<TileOp> createResizeTileOp( Size dsize, double fx=0, double fy=0,
+                                           int interpolation=INTER_LINEAR );
+//! cvtColor(), except for the demosaicing and the YUV 4:2:0 conversions
+CV_EXPORTS Ptr<TileOp> createCvtColorTileOp( int code, int dstCn=0 );
+//! threshold(), except for THRESH_OTSU
+CV_EXPORTS Ptr<TileOp> createThresholdTileOp( double thresh, double maxval, int type );
+//! morphologyEx(), erode() and dilate() (MORPH_ERODE and MORPH_DILATE), the parameters are the same
+CV_EXPORTS Ptr<TileOp> createMorphologyTileOp( int op, InputArray kernel, Point anchor=Point(-1,-1),
+                                               int iterations=1, int borderType=BORDER_CONSTANT,
+                                               const Scalar& borderValue=morphologyDefaultBorderValue() );
+
+//! the chain of operations applied to the image tile by tile
+class CV_EXPORTS TilePipeline
+{
+public:
+    TilePipeline();
+    //! appends the operation to the chain
+    TilePipeline& add( const Ptr<TileOp>& op );
+    //! the size and the type of the result for the source of the given size and type
+    Size dstSize( Size srcSize ) const;
+    int dstType( int srcType ) const;
+    //! processes the image tile by tile. tileSize is the size of the tiles of the result, its width is rounded up
+    //! to a multiple of 16. If maxMemory is not 0, fewer tiles are processed at once to keep their buffers within it.
+    void run( TileSource& src, TileSink& dst, Size tileSize=Size(512, 512), size_t maxMemory=0 ) const;
+    //! the same for the images in memory
+    void run( InputArray src, OutputArray dst, Size tileSize=Size(512, 512) ) const;
+    //! returns true if the chain is empty
+    bool empty() const;
+
+protected:
+    vector<Ptr<TileOp> > ops;
+};
+
 }
 
 #endif /* __cplusplus */
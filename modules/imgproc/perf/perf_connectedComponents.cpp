@@ -0,0 +1,76 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+CV_ENUM(MaskKind, 0, 1, 2)
+enum { MASK_NOISE = 0, MASK_BLOBS = 1, MASK_CIRCLES = 2 };
+
+typedef std::tr1::tuple<Size, MaskKind, int> Size_MaskKind_Connectivity_t;
+typedef perf::TestBaseWithParam<Size_MaskKind_Connectivity_t> Size_MaskKind_Connectivity;
+
+// the random noise gives the most labels and merges, the blobs and the circles are the typical masks
+static Mat makeMask(Size sz, int kind)
+{
+    RNG rng(12345);
+    Mat mask(sz, CV_8UC1);
+    if( kind == MASK_CIRCLES )
+    {
+        mask.setTo(Scalar::all(0));
+        for( int i = 0; i < (int)(sz.area()/2000); i++ )
+            circle(mask, Point(rng.uniform(0, sz.width), rng.uniform(0, sz.height)),
+                   rng.uniform(3, 40), Scalar::all(255), rng.uniform(0, 2) ? -1 : 2);
+        return mask;
+    }
+    rng.fill(mask, RNG::UNIFORM, 0, 256);
+    if( kind == MASK_BLOBS )
+        GaussianBlur(mask, mask, Size(0, 0), 4);
+    return mask > 127;
+}
+
+PERF_TEST_P(Size_MaskKind_Connectivity, connectedComponents,
+            testing::Combine(
+                testing::Values(sz1080p, sz2160p, Size(7680, 4320)),
+                testing::ValuesIn(MaskKind::all()),
+                testing::Values(4, 8)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int kind = get<1>(GetParam());
+    int connectivity = get<2>(GetParam());
+
+    Mat mask = makeMask(sz, kind), labels(sz, CV_32S);
+    int nlabels = 0;
+
+    declare.in(mask).out(labels);
+
+    TEST_CYCLE() nlabels = connectedComponents(mask, labels, connectivity, CV_32S);
+
+    SANITY_CHECK(nlabels);
+}
+
+PERF_TEST_P(Size_MaskKind_Connectivity, connectedComponentsWithStats,
+            testing::Combine(
+                testing::Values(sz1080p, sz2160p, Size(7680, 4320)),
+                testing::ValuesIn(MaskKind::all()),
+                testing::Values(4, 8)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int kind = get<1>(GetParam());
+    int connectivity = get<2>(GetParam());
+
+    Mat mask = makeMask(sz, kind), labels(sz, CV_32S), stats, centroids;
+
+    declare.in(mask).out(labels);
+
+    TEST_CYCLE() connectedComponentsWithStats(mask, labels, stats, centroids, connectivity, CV_32S);
+
+    Mat area = stats.col(CC_STAT_AREA).clone();
+    SANITY_CHECK(area);
+}
@@ -1,5 +1,4 @@
-/*#include "perf_precomp.hpp"
-#include "distransform.cpp"
+#include "perf_precomp.hpp"
 
 using namespace std;
 using namespace cv;
@@ -7,17 +6,19 @@ using namespace perf;
 
 typedef perf::TestBaseWithParam<Size> Size_DistanceTransform;
 
-PERF_TEST_P(Size_DistanceTransform, icvTrueDistTrans, testing::Values(TYPICAL_MAT_SIZES))
+PERF_TEST_P(Size_DistanceTransform, precise, testing::Values(TYPICAL_MAT_SIZES))
 {
     Size size = GetParam();
     Mat src(size, CV_8UC1);
     Mat dst(size, CV_32FC1);
-    CvMat srcStub = src;
-    CvMat dstStub = dst;
 
-    declare.in(src, WARMUP_RNG).out(dst);
+    // sparse zero pixels, so the distances are large
+    randu(src, 0, 1000);
+    src = src > 0;
 
-    TEST_CYCLE() icvTrueDistTrans(&srcStub, &dstStub);
+    declare.in(src).out(dst);
+
+    TEST_CYCLE() distanceTransform(src, dst, CV_DIST_L2, CV_DIST_MASK_PRECISE);
 
     SANITY_CHECK(dst, 1);
-}*/
+}
@@ -0,0 +1,70 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+CV_ENUM(RetrMode, CV_RETR_EXTERNAL, CV_RETR_LIST, CV_RETR_CCOMP, CV_RETR_TREE)
+
+typedef std::tr1::tuple<Size, RetrMode> Size_RetrMode_t;
+typedef perf::TestBaseWithParam<Size_RetrMode_t> Size_RetrMode;
+
+// the blobs of a thresholded smooth noise, like a scanned page
+static Mat makeBlobs(Size sz)
+{
+    RNG rng(12345);
+    Mat img(sz, CV_8UC1);
+    rng.fill(img, RNG::UNIFORM, 0, 256);
+    GaussianBlur(img, img, Size(0, 0), 2);
+    return img > 128;
+}
+
+PERF_TEST_P(Size_RetrMode, findContours,
+            testing::Combine(
+                testing::Values(sz1080p, sz2160p),
+                testing::ValuesIn(RetrMode::all())
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int mode = get<1>(GetParam());
+
+    Mat src = makeBlobs(sz), img;
+    vector<vector<Point> > contours;
+    vector<Vec4i> hierarchy;
+
+    declare.in(src);
+
+    TEST_CYCLE()
+    {
+        src.copyTo(img);
+        findContours(img, contours, hierarchy, mode, CV_CHAIN_APPROX_SIMPLE);
+    }
+
+    int count = (int)contours.size();
+    SANITY_CHECK(count);
+}
+
+PERF_TEST_P(Size_RetrMode, findContoursParallel,
+            testing::Combine(
+                testing::Values(sz1080p, sz2160p),
+                testing::ValuesIn(RetrMode::all())
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int mode = get<1>(GetParam());
+
+    Mat src = makeBlobs(sz);
+    vector<vector<Point> > contours;
+    vector<Vec4i> hierarchy;
+
+    declare.in(src);
+
+    TEST_CYCLE() findContoursParallel(src, contours, hierarchy, mode, CV_CHAIN_APPROX_SIMPLE);
+
+    int count = (int)contours.size();
+    SANITY_CHECK(count);
+}
@@ -0,0 +1,44 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+typedef std::tr1::tuple<Size, int> Size_Seeds_t;
+typedef perf::TestBaseWithParam<Size_Seeds_t> Size_Seeds;
+
+PERF_TEST_P(Size_Seeds, floodFillBatch,
+            testing::Combine(
+                testing::Values(szVGA, sz1080p),
+                testing::Values(10, 1000)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int nseeds = get<1>(GetParam());
+
+    // the blobs of a thresholded smooth noise
+    RNG rng(12345);
+    Mat src(sz, CV_8UC1), dst;
+    rng.fill(src, RNG::UNIFORM, 0, 256);
+    GaussianBlur(src, src, Size(0, 0), 2);
+    src = src > 128;
+
+    vector<Point> seeds;
+    for( int k = 0; k < nseeds; k++ )
+        seeds.push_back(Point(rng.uniform(0, sz.width), rng.uniform(0, sz.height)));
+    vector<Scalar> newVals(1, Scalar(100));
+    int area = 0;
+
+    declare.in(src);
+
+    TEST_CYCLE()
+    {
+        src.copyTo(dst);
+        area = floodFillBatch(dst, seeds, newVals);
+    }
+
+    SANITY_CHECK(area);
+}
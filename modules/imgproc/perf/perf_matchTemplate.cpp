@@ -0,0 +1,67 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+CV_ENUM(MethodType, TM_SQDIFF, TM_SQDIFF_NORMED, TM_CCORR, TM_CCORR_NORMED, TM_CCOEFF, TM_CCOEFF_NORMED)
+
+typedef std::tr1::tuple<Size, Size, MatType, MethodType> ImgSize_TmplSize_MatType_Method_t;
+typedef perf::TestBaseWithParam<ImgSize_TmplSize_MatType_Method_t> ImgSize_TmplSize_MatType_Method;
+
+// the small templates are correlated directly, the large ones by the DFT
+PERF_TEST_P(ImgSize_TmplSize_MatType_Method, matchTemplate,
+            testing::Combine(
+                testing::Values(szVGA, sz1080p),
+                testing::Values(Size(8, 8), Size(16, 16), Size(64, 64)),
+                testing::Values(CV_8UC1, CV_32FC1, CV_8UC3),
+                testing::ValuesIn(MethodType::all())
+                )
+            )
+{
+    Size imgSz = get<0>(GetParam());
+    Size tmplSz = get<1>(GetParam());
+    int type = get<2>(GetParam());
+    int method = get<3>(GetParam());
+
+    Mat img(imgSz, type), tmpl(tmplSz, type);
+    Mat result(imgSz - tmplSz + Size(1, 1), CV_32F);
+
+    declare.in(img, tmpl, WARMUP_RNG).out(result);
+
+    TEST_CYCLE() matchTemplate(img, tmpl, result, method);
+
+    SANITY_CHECK(result, 1e-3, ERROR_RELATIVE);
+}
+
+typedef std::tr1::tuple<Size, Size, MatType> ImgSize_TmplSize_MatType_t;
+typedef perf::TestBaseWithParam<ImgSize_TmplSize_MatType_t> ImgSize_TmplSize_MatType;
+
+PERF_TEST_P(ImgSize_TmplSize_MatType, matchTemplateThreshold,
+            testing::Combine(
+                testing::Values(szVGA, sz1080p),
+                testing::Values(Size(16, 16), Size(64, 64)),
+                testing::Values(CV_8UC1, CV_32FC1)
+                )
+            )
+{
+    Size imgSz = get<0>(GetParam());
+    Size tmplSz = get<1>(GetParam());
+    int type = get<2>(GetParam());
+
+    Mat img(imgSz, type);
+    RNG rng(12345);
+    rng.fill(img, RNG::UNIFORM, Scalar::all(0), Scalar::all(255));
+    GaussianBlur(img, img, Size(5, 5), 2);
+    Mat tmpl = img(Rect(Point(imgSz.width/3, imgSz.height/2), tmplSz)).clone();
+    vector<Point> locations;
+
+    declare.in(img, tmpl);
+
+    TEST_CYCLE() matchTemplateThreshold(img, tmpl, locations, TM_SQDIFF_NORMED, 1e-4);
+
+    int count = (int)locations.size();
+    SANITY_CHECK(count);
+}
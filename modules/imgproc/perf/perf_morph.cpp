@@ -38,3 +38,59 @@ PERF_TEST_P(Size_MatType, dilate, TYPICAL_MATS_MORPH)
 
     SANITY_CHECK(dst);
 }
+
+CV_ENUM(MorphShape, MORPH_RECT, MORPH_CROSS, MORPH_ELLIPSE)
+
+typedef std::tr1::tuple<MatType, MorphShape, int> Type_Shape_KSize_t;
+typedef perf::TestBaseWithParam<Type_Shape_KSize_t> Type_Shape_KSize;
+
+PERF_TEST_P(Type_Shape_KSize, erode_large,
+            testing::Combine(
+                testing::Values(CV_8UC1, CV_32FC1),
+                testing::ValuesIn(MorphShape::all()),
+                testing::Values(15, 51, 101)
+            )
+)
+{
+    int type = get<0>(GetParam());
+    int shape = get<1>(GetParam());
+    int ksize = get<2>(GetParam());
+
+    Mat src(sz1080p, type);
+    Mat dst(sz1080p, type);
+    Mat kernel = getStructuringElement(shape, Size(ksize, ksize));
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() erode(src, dst, kernel);
+
+    SANITY_CHECK(dst);
+}
+
+typedef std::tr1::tuple<MatType, int> Type_KSize_t;
+typedef perf::TestBaseWithParam<Type_KSize_t> Type_KSize;
+
+// the horizontal and the vertical lines, as used to remove the document rulings
+PERF_TEST_P(Type_KSize, dilate_lines,
+            testing::Combine(
+                testing::Values(CV_8UC1, CV_32FC1),
+                testing::Values(51, 101, 201)
+            )
+)
+{
+    int type = get<0>(GetParam());
+    int ksize = get<1>(GetParam());
+
+    Mat src(sz1080p, type);
+    Mat dst(sz1080p, type);
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE()
+    {
+        dilate(src, dst, getStructuringElement(MORPH_RECT, Size(ksize, 1)));
+        dilate(dst, dst, getStructuringElement(MORPH_RECT, Size(1, ksize)));
+    }
+
+    SANITY_CHECK(dst);
+}
@@ -67,3 +67,38 @@ PERF_TEST_P( TestRemap, Remap,
 
     SANITY_CHECK(dst);
 }
+
+typedef TestBaseWithParam< tr1::tuple<Size, MatType, InterType> > TestRemapPlan;
+
+PERF_TEST_P( TestRemapPlan, RemapPlan,
+             Combine(
+                Values( szVGA, sz1080p ),
+                Values( CV_8UC1, CV_8UC3, CV_8UC4 ),
+                Values( (int)INTER_LINEAR, (int)INTER_CUBIC )
+             )
+)
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    int inter_type = get<2>(GetParam());
+
+    Mat src(sz, type), dst(sz, type), mapx(sz, CV_32FC1), mapy(sz, CV_32FC1);
+
+    // radial distortion around the center, like the undistortion maps
+    float cx = sz.width*0.5f, cy = sz.height*0.5f, k = 0.1f/(cx*cx + cy*cy);
+    for (int j = 0; j < sz.height; ++j)
+        for (int i = 0; i < sz.width; ++i)
+        {
+            float dx = i - cx, dy = j - cy, r = 1 + k*(dx*dx + dy*dy);
+            mapx.at<float>(j, i) = cx + dx*r;
+            mapy.at<float>(j, i) = cy + dy*r;
+        }
+
+    RemapPlan plan(mapx, mapy, sz, type, inter_type);
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() plan(src, dst);
+
+    SANITY_CHECK(dst);
+}
@@ -119,3 +119,25 @@ PERF_TEST_P(MatInfo_Size_Scale_Area, ResizeArea,
     //difference equal to 1 is allowed because of different possible rounding modes: round-to-nearest vs bankers' rounding
     SANITY_CHECK(dst, 1);
 }
+
+typedef TestBaseWithParam<tr1::tuple<Size, Size> > Size_Size;
+
+PERF_TEST_P(Size_Size, blobFromImage,
+            testing::Combine(
+                testing::Values(sz720p, sz1080p),
+                testing::Values(Size(224, 224), Size(640, 640))
+                )
+            )
+{
+    Size from = get<0>(GetParam());
+    Size to = get<1>(GetParam());
+
+    cv::Mat src(from, CV_8UC3), blob;
+
+    declare.in(src, WARMUP_RNG);
+
+    TEST_CYCLE() blobFromImage(src, blob, to, 1./255, Scalar(0.485, 0.456, 0.406), Scalar(0.229, 0.224, 0.225), true);
+
+    Mat planes(to.height*3, to.width, CV_32F, blob.data);
+    SANITY_CHECK(planes, 1e-5);
+}
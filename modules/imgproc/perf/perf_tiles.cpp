@@ -0,0 +1,60 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+typedef std::tr1::tuple<Size, Size> Size_TileSize_t;
+typedef perf::TestBaseWithParam<Size_TileSize_t> Size_TileSize;
+typedef perf::TestBaseWithParam<Size> Size_Only;
+
+static TilePipeline makeChain()
+{
+    TilePipeline pipeline;
+    pipeline.add(createResizeTileOp(Size(), 0.5, 0.5, INTER_AREA))
+            .add(createCvtColorTileOp(COLOR_BGR2GRAY))
+            .add(createFilterTileOp(createGaussianFilter(CV_8U, Size(5, 5), 1.2)))
+            .add(createThresholdTileOp(100, 255, THRESH_BINARY));
+    return pipeline;
+}
+
+PERF_TEST_P(Size_TileSize, TilePipeline_chain,
+            testing::Combine(
+                testing::Values(sz1080p, Size(4096, 4096)),
+                testing::Values(Size(256, 256), Size(1024, 128))
+            )
+)
+{
+    Size sz = get<0>(GetParam());
+    Size tileSize = get<1>(GetParam());
+
+    Mat src(sz, CV_8UC3), dst;
+    declare.in(src, WARMUP_RNG);
+
+    TilePipeline pipeline = makeChain();
+
+    TEST_CYCLE() pipeline.run(src, dst, tileSize);
+
+    SANITY_CHECK(dst);
+}
+
+// the same chain with the full-size intermediate images, for the comparison
+PERF_TEST_P(Size_Only, TilePipeline_chain_reference, testing::Values(sz1080p, Size(4096, 4096)))
+{
+    Size sz = GetParam();
+
+    Mat src(sz, CV_8UC3), dst, t1, t2, t3;
+    declare.in(src, WARMUP_RNG);
+
+    TEST_CYCLE()
+    {
+        resize(src, t1, Size(), 0.5, 0.5, INTER_AREA);
+        cvtColor(t1, t2, COLOR_BGR2GRAY);
+        GaussianBlur(t2, t3, Size(5, 5), 1.2);
+        threshold(t3, dst, 100, 255, THRESH_BINARY);
+    }
+
+    SANITY_CHECK(dst);
+}
@@ -41,6 +41,347 @@
 
 #include "precomp.hpp"
 
+namespace cv
+{
+
+/* sector numbers
+   (Top-Left Origin)
+
+    1   2   3
+     *  *  *
+      * * *
+    0*******0
+      * * *
+     *  *  *
+    3   2   1
+*/
+
+#define CANNY_PUSH(d)    *(d) = uchar(2), *stack_top++ = (d)
+#define CANNY_POP(d)     (d) = *--stack_top
+#define CANNY_SHIFT 15
+
+static void cannyGrowStack( std::vector<uchar*>& stack, uchar**& stack_bottom, uchar**& stack_top,
+                            int& maxsize, int n )
+{
+    if ((stack_top - stack_bottom) + n > maxsize)
+    {
+        int sz = (int)(stack_top - stack_bottom);
+        maxsize = std::max(maxsize * 3/2, sz + n);
+        stack.resize(maxsize);
+        stack_bottom = &stack[0];
+        stack_top = stack_bottom + sz;
+    }
+}
+
+// the gradient magnitudes of a row, |dx| + |dy| or dx^2 + dy^2
+static void cannyNorm( const short* _dx, const short* _dy, int* _norm, int len, bool L2gradient )
+{
+    int j = 0;
+#if CV_SSE2
+    if (checkHardwareSupport(CV_CPU_SSE2))
+    {
+        if (!L2gradient)
+        {
+            for ( ; j <= len - 8; j += 8)
+            {
+                __m128i x = _mm_loadu_si128((const __m128i*)(_dx + j));
+                __m128i y = _mm_loadu_si128((const __m128i*)(_dy + j));
+                __m128i x0 = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+                __m128i x1 = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+                __m128i y0 = _mm_srai_epi32(_mm_unpacklo_epi16(y, y), 16);
+                __m128i y1 = _mm_srai_epi32(_mm_unpackhi_epi16(y, y), 16);
+                __m128i s;
+                s = _mm_srai_epi32(x0, 31); x0 = _mm_sub_epi32(_mm_xor_si128(x0, s), s);
+                s = _mm_srai_epi32(x1, 31); x1 = _mm_sub_epi32(_mm_xor_si128(x1, s), s);
+                s = _mm_srai_epi32(y0, 31); y0 = _mm_sub_epi32(_mm_xor_si128(y0, s), s);
+                s = _mm_srai_epi32(y1, 31); y1 = _mm_sub_epi32(_mm_xor_si128(y1, s), s);
+                _mm_storeu_si128((__m128i*)(_norm + j), _mm_add_epi32(x0, y0));
+                _mm_storeu_si128((__m128i*)(_norm + j + 4), _mm_add_epi32(x1, y1));
+            }
+        }
+        else
+        {
+            for ( ; j <= len - 8; j += 8)
+            {
+                __m128i x = _mm_loadu_si128((const __m128i*)(_dx + j));
+                __m128i y = _mm_loadu_si128((const __m128i*)(_dy + j));
+                __m128i xy0 = _mm_unpacklo_epi16(x, y), xy1 = _mm_unpackhi_epi16(x, y);
+                _mm_storeu_si128((__m128i*)(_norm + j), _mm_madd_epi16(xy0, xy0));
+                _mm_storeu_si128((__m128i*)(_norm + j + 4), _mm_madd_epi16(xy1, xy1));
+            }
+        }
+    }
+#endif
+    if (!L2gradient)
+    {
+        for ( ; j < len; j++)
+            _norm[j] = std::abs(int(_dx[j])) + std::abs(int(_dy[j]));
+    }
+    else
+    {
+        for ( ; j < len; j++)
+            _norm[j] = int(_dx[j])*_dx[j] + int(_dy[j])*_dy[j];
+    }
+}
+
+/*
+   Computes the magnitudes, performs the non-maxima suppression and tracks the edges within
+   a stripe of rows. The map is filled with one of the following values:
+     0 - the pixel might belong to an edge
+     1 - the pixel can not belong to an edge
+     2 - the pixel does belong to an edge
+   The tracking does not leave the stripe: the edge pixels on the first and the last row of
+   the stripe are collected into borderPeaks and tracked over the whole map afterwards.
+   The edges are the connected components of the pixels 0 and 2 that contain the pixels 2,
+   so the result does not depend on the stripes.
+*/
+class CannyInvoker : public ParallelLoopBody
+{
+public:
+    CannyInvoker( const Mat& _dx, const Mat& _dy, uchar* _map, ptrdiff_t _mapstep,
+                  int _low, int _high, bool _L2gradient, std::vector<uchar*>& _borderPeaks,
+                  Mutex& _mutex )
+        : dx(_dx), dy(_dy), map(_map), mapstep(_mapstep), low(_low), high(_high),
+          L2gradient(_L2gradient), borderPeaks(&_borderPeaks), mutex(&_mutex)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        const int rows = dx.rows, cols = dx.cols, cn = dx.channels();
+        const int TG22 = (int)(0.4142135623730950488016887242097*(1<<CANNY_SHIFT) + 0.5);
+
+        // the ring buffer of 3 magnitude rows for non-maxima suppression,
+        // and of the gradient of the strongest channel for the multi-channel images
+        AutoBuffer<int> _magbuf((cols+2)*cn*3);
+        int* mag_buf[3];
+        mag_buf[0] = _magbuf;
+        mag_buf[1] = mag_buf[0] + (cols+2)*cn;
+        mag_buf[2] = mag_buf[1] + (cols+2)*cn;
+
+        AutoBuffer<short> _dxybuf(cn > 1 ? cols*2*3 : 1);
+        short* dxy_buf[3];
+        dxy_buf[0] = _dxybuf;
+        dxy_buf[1] = dxy_buf[0] + cols*2;
+        dxy_buf[2] = dxy_buf[1] + cols*2;
+
+        int maxsize = std::max(1 << 10, cols * (range.end - range.start) / 10);
+        std::vector<uchar*> stack(maxsize);
+        uchar **stack_top = &stack[0];
+        uchar **stack_bottom = &stack[0];
+
+#if CV_SSE2
+        bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+        __m128i v_low = _mm_set1_epi32(low);
+#endif
+
+        for (int i = range.start - 1; i <= range.end; i++)
+        {
+            int* _norm = mag_buf[2] + 1;
+            if (i >= 0 && i < rows)
+            {
+                const short* _dx = dx.ptr<short>(i);
+                const short* _dy = dy.ptr<short>(i);
+                cannyNorm(_dx, _dy, _norm, cols*cn, L2gradient);
+
+                if (cn > 1)
+                {
+                    short* _sdx = dxy_buf[2];
+                    short* _sdy = _sdx + cols;
+                    for(int j = 0, jn = 0; j < cols; ++j, jn += cn)
+                    {
+                        int maxIdx = jn;
+                        for(int k = 1; k < cn; ++k)
+                            if(_norm[jn + k] > _norm[maxIdx]) maxIdx = jn + k;
+                        _norm[j] = _norm[maxIdx];
+                        _sdx[j] = _dx[maxIdx];
+                        _sdy[j] = _dy[maxIdx];
+                    }
+                }
+                _norm[-1] = _norm[cols] = 0;
+            }
+            else
+                memset(_norm-1, 0, (cols+2)*sizeof(int));
+
+            // the row i-1 has the both neighbours now
+            if (i > range.start)
+            {
+                int r = i - 1;
+                uchar* _map = map + mapstep*(r+1) + 1;
+                _map[-1] = _map[cols] = 1;
+
+                const int* _mag = mag_buf[1] + 1; // take the central row
+                ptrdiff_t magstep1 = mag_buf[2] - mag_buf[1];
+                ptrdiff_t magstep2 = mag_buf[0] - mag_buf[1];
+
+                const short* _x = cn > 1 ? dxy_buf[1] : dx.ptr<short>(r);
+                const short* _y = cn > 1 ? dxy_buf[1] + cols : dy.ptr<short>(r);
+
+                // the row above belongs to another stripe, which may be processed concurrently
+                bool checkAbove = r > range.start;
+
+                cannyGrowStack(stack, stack_bottom, stack_top, maxsize, cols);
+
+                int prev_flag = 0;
+                for (int j = 0; j < cols; j++)
+                {
+#if CV_SSE2
+                    // skip the pixels below the low threshold by 4
+                    if (haveSSE2 && j <= cols - 4 &&
+                        _mm_movemask_epi8(_mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(_mag + j)), v_low)) == 0)
+                    {
+                        _map[j] = _map[j+1] = _map[j+2] = _map[j+3] = uchar(1);
+                        prev_flag = 0;
+                        j += 3;
+                        continue;
+                    }
+#endif
+                    int m = _mag[j];
+
+                    if (m > low)
+                    {
+                        int xs = _x[j];
+                        int ys = _y[j];
+                        int x = std::abs(xs);
+                        int y = std::abs(ys) << CANNY_SHIFT;
+
+                        int tg22x = x * TG22;
+
+                        if (y < tg22x)
+                        {
+                            if (m > _mag[j-1] && m >= _mag[j+1]) goto __ocv_canny_push;
+                        }
+                        else
+                        {
+                            int tg67x = tg22x + (x << (CANNY_SHIFT+1));
+                            if (y > tg67x)
+                            {
+                                if (m > _mag[j+magstep2] && m >= _mag[j+magstep1]) goto __ocv_canny_push;
+                            }
+                            else
+                            {
+                                int s = (xs ^ ys) < 0 ? -1 : 1;
+                                if (m > _mag[j+magstep2-s] && m > _mag[j+magstep1+s]) goto __ocv_canny_push;
+                            }
+                        }
+                    }
+                    prev_flag = 0;
+                    _map[j] = uchar(1);
+                    continue;
+__ocv_canny_push:
+                    if (!prev_flag && m > high && (!checkAbove || _map[j-mapstep] != 2))
+                    {
+                        CANNY_PUSH(_map + j);
+                        prev_flag = 1;
+                    }
+                    else
+                        _map[j] = 0;
+                }
+            }
+
+            // scroll the ring buffers
+            int* _mag = mag_buf[0];
+            mag_buf[0] = mag_buf[1];
+            mag_buf[1] = mag_buf[2];
+            mag_buf[2] = _mag;
+
+            short* _dxy = dxy_buf[0];
+            dxy_buf[0] = dxy_buf[1];
+            dxy_buf[1] = dxy_buf[2];
+            dxy_buf[2] = _dxy;
+        }
+
+        // now track the edges (hysteresis thresholding) inside the stripe
+        const uchar* inner_start = map + mapstep*(range.start + 2);
+        const uchar* inner_end = map + mapstep*range.end;
+        std::vector<uchar*> peaks;
+
+        while (stack_top > stack_bottom)
+        {
+            uchar* m;
+            cannyGrowStack(stack, stack_bottom, stack_top, maxsize, 8);
+
+            CANNY_POP(m);
+
+            if (m < inner_start || m >= inner_end)
+            {
+                peaks.push_back(m);
+                continue;
+            }
+
+            if (!m[-1])         CANNY_PUSH(m - 1);
+            if (!m[1])          CANNY_PUSH(m + 1);
+            if (!m[-mapstep-1]) CANNY_PUSH(m - mapstep - 1);
+            if (!m[-mapstep])   CANNY_PUSH(m - mapstep);
+            if (!m[-mapstep+1]) CANNY_PUSH(m - mapstep + 1);
+            if (!m[mapstep-1])  CANNY_PUSH(m + mapstep - 1);
+            if (!m[mapstep])    CANNY_PUSH(m + mapstep);
+            if (!m[mapstep+1])  CANNY_PUSH(m + mapstep + 1);
+        }
+
+        if (!peaks.empty())
+        {
+            AutoLock lock(*mutex);
+            borderPeaks->insert(borderPeaks->end(), peaks.begin(), peaks.end());
+        }
+    }
+
+private:
+    CannyInvoker& operator=(const CannyInvoker&); // to quiet MSVC
+
+    Mat dx, dy;
+    uchar* map;
+    ptrdiff_t mapstep;
+    int low, high;
+    bool L2gradient;
+    std::vector<uchar*>* borderPeaks;
+    Mutex* mutex;
+};
+
+// the final pass, form the final image
+class CannyFinalizeInvoker : public ParallelLoopBody
+{
+public:
+    CannyFinalizeInvoker( const uchar* _map, ptrdiff_t _mapstep, Mat& _dst )
+        : map(_map), mapstep(_mapstep), dst(&_dst)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int cols = dst->cols;
+#if CV_SSE2
+        bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+        __m128i v_edge = _mm_set1_epi8(2);
+#endif
+        for (int i = range.start; i < range.end; i++)
+        {
+            const uchar* pmap = map + mapstep*(i+1) + 1;
+            uchar* pdst = dst->ptr(i);
+            int j = 0;
+#if CV_SSE2
+            if (haveSSE2)
+            {
+                for ( ; j <= cols - 16; j += 16)
+                    _mm_storeu_si128((__m128i*)(pdst + j),
+                        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(pmap + j)), v_edge));
+            }
+#endif
+            for ( ; j < cols; j++)
+                pdst[j] = (uchar)-(pmap[j] >> 1);
+        }
+    }
+
+private:
+    CannyFinalizeInvoker& operator=(const CannyFinalizeInvoker&); // to quiet MSVC
+
+    const uchar* map;
+    ptrdiff_t mapstep;
+    Mat* dst;
+};
+
+}
+
 void cv::Canny( InputArray _src, OutputArray _dst,
                 double low_thresh, double high_thresh,
                 int aperture_size, bool L2gradient )
@@ -88,170 +429,31 @@ void cv::Canny( InputArray _src, OutputArray _dst,
     int high = cvFloor(high_thresh);
 
     ptrdiff_t mapstep = src.cols + 2;
-    cv::AutoBuffer<uchar> buffer((src.cols+2)*(src.rows+2) + cn * mapstep * 3 * sizeof(int));
-
-    int* mag_buf[3];
-    mag_buf[0] = (int*)(uchar*)buffer;
-    mag_buf[1] = mag_buf[0] + mapstep*cn;
-    mag_buf[2] = mag_buf[1] + mapstep*cn;
-    memset(mag_buf[0], 0, /* cn* */mapstep*sizeof(int));
+    cv::AutoBuffer<uchar> buffer((src.cols+2)*(src.rows+2));
 
-    uchar* map = (uchar*)(mag_buf[2] + mapstep*cn);
+    uchar* map = (uchar*)buffer;
     memset(map, 1, mapstep);
     memset(map + mapstep*(src.rows + 1), 1, mapstep);
 
+    // the magnitudes, the non-maxima suppression and the tracking inside the stripes
+    std::vector<uchar*> stack;
+    Mutex mutex;
+    double nstripes = src.total()/(double)(1 << 16);
+    parallel_for_(Range(0, src.rows), CannyInvoker(dx, dy, map, mapstep, low, high, L2gradient, stack, mutex),
+                  nstripes);
+
+    // track the edges across the stripes, starting from the edge pixels on their borders
     int maxsize = std::max(1 << 10, src.cols * src.rows / 10);
-    std::vector<uchar*> stack(maxsize);
-    uchar **stack_top = &stack[0];
+    int sz = (int)stack.size();
+    maxsize = std::max(maxsize, sz + 8);
+    stack.resize(maxsize);
     uchar **stack_bottom = &stack[0];
+    uchar **stack_top = stack_bottom + sz;
 
-    /* sector numbers
-       (Top-Left Origin)
-
-        1   2   3
-         *  *  *
-          * * *
-        0*******0
-          * * *
-         *  *  *
-        3   2   1
-    */
-
-    #define CANNY_PUSH(d)    *(d) = uchar(2), *stack_top++ = (d)
-    #define CANNY_POP(d)     (d) = *--stack_top
-
-    // calculate magnitude and angle of gradient, perform non-maxima supression.
-    // fill the map with one of the following values:
-    //   0 - the pixel might belong to an edge
-    //   1 - the pixel can not belong to an edge
-    //   2 - the pixel does belong to an edge
-    for (int i = 0; i <= src.rows; i++)
-    {
-        int* _norm = mag_buf[(i > 0) + 1] + 1;
-        if (i < src.rows)
-        {
-            short* _dx = dx.ptr<short>(i);
-            short* _dy = dy.ptr<short>(i);
-
-            if (!L2gradient)
-            {
-                for (int j = 0; j < src.cols*cn; j++)
-                    _norm[j] = std::abs(int(_dx[j])) + std::abs(int(_dy[j]));
-            }
-            else
-            {
-                for (int j = 0; j < src.cols*cn; j++)
-                    _norm[j] = int(_dx[j])*_dx[j] + int(_dy[j])*_dy[j];
-            }
-
-            if (cn > 1)
-            {
-                for(int j = 0, jn = 0; j < src.cols; ++j, jn += cn)
-                {
-                    int maxIdx = jn;
-                    for(int k = 1; k < cn; ++k)
-                        if(_norm[jn + k] > _norm[maxIdx]) maxIdx = jn + k;
-                    _norm[j] = _norm[maxIdx];
-                    _dx[j] = _dx[maxIdx];
-                    _dy[j] = _dy[maxIdx];
-                }
-            }
-            _norm[-1] = _norm[src.cols] = 0;
-        }
-        else
-            memset(_norm-1, 0, /* cn* */mapstep*sizeof(int));
-
-        // at the very beginning we do not have a complete ring
-        // buffer of 3 magnitude rows for non-maxima suppression
-        if (i == 0)
-            continue;
-
-        uchar* _map = map + mapstep*i + 1;
-        _map[-1] = _map[src.cols] = 1;
-
-        int* _mag = mag_buf[1] + 1; // take the central row
-        ptrdiff_t magstep1 = mag_buf[2] - mag_buf[1];
-        ptrdiff_t magstep2 = mag_buf[0] - mag_buf[1];
-
-        const short* _x = dx.ptr<short>(i-1);
-        const short* _y = dy.ptr<short>(i-1);
-
-        if ((stack_top - stack_bottom) + src.cols > maxsize)
-        {
-            int sz = (int)(stack_top - stack_bottom);
-            maxsize = maxsize * 3/2;
-            stack.resize(maxsize);
-            stack_bottom = &stack[0];
-            stack_top = stack_bottom + sz;
-        }
-
-        int prev_flag = 0;
-        for (int j = 0; j < src.cols; j++)
-        {
-            #define CANNY_SHIFT 15
-            const int TG22 = (int)(0.4142135623730950488016887242097*(1<<CANNY_SHIFT) + 0.5);
-
-            int m = _mag[j];
-
-            if (m > low)
-            {
-                int xs = _x[j];
-                int ys = _y[j];
-                int x = std::abs(xs);
-                int y = std::abs(ys) << CANNY_SHIFT;
-
-                int tg22x = x * TG22;
-
-                if (y < tg22x)
-                {
-                    if (m > _mag[j-1] && m >= _mag[j+1]) goto __ocv_canny_push;
-                }
-                else
-                {
-                    int tg67x = tg22x + (x << (CANNY_SHIFT+1));
-                    if (y > tg67x)
-                    {
-                        if (m > _mag[j+magstep2] && m >= _mag[j+magstep1]) goto __ocv_canny_push;
-                    }
-                    else
-                    {
-                        int s = (xs ^ ys) < 0 ? -1 : 1;
-                        if (m > _mag[j+magstep2-s] && m > _mag[j+magstep1+s]) goto __ocv_canny_push;
-                    }
-                }
-            }
-            prev_flag = 0;
-            _map[j] = uchar(1);
-            continue;
-__ocv_canny_push:
-            if (!prev_flag && m > high && _map[j-mapstep] != 2)
-            {
-                CANNY_PUSH(_map + j);
-                prev_flag = 1;
-            }
-            else
-                _map[j] = 0;
-        }
-
-        // scroll the ring buffer
-        _mag = mag_buf[0];
-        mag_buf[0] = mag_buf[1];
-        mag_buf[1] = mag_buf[2];
-        mag_buf[2] = _mag;
-    }
-
-    // now track the edges (hysteresis thresholding)
     while (stack_top > stack_bottom)
     {
         uchar* m;
-        if ((stack_top - stack_bottom) + 8 > maxsize)
-        {
-            int sz = (int)(stack_top - stack_bottom);
-            maxsize = maxsize * 3/2;
-            stack.resize(maxsize);
-            stack_bottom = &stack[0];
-            stack_top = stack_bottom + sz;
-        }
+        cannyGrowStack(stack, stack_bottom, stack_top, maxsize, 8);
 
         CANNY_POP(m);
 
@@ -265,14 +467,7 @@ __ocv_canny_push:
         if (!m[mapstep+1])  CANNY_PUSH(m + mapstep + 1);
     }
 
-    // the final pass, form the final image
-    const uchar* pmap = map + mapstep + 1;
-    uchar* pdst = dst.ptr();
-    for (int i = 0; i < src.rows; i++, pmap += mapstep, pdst += dst.step)
-    {
-        for (int j = 0; j < src.cols; j++)
-            pdst[j] = (uchar)-(pmap[j] >> 1);
-    }
+    parallel_for_(Range(0, src.rows), CannyFinalizeInvoker(map, mapstep, dst), nstripes);
 }
 
 void cvCanny( const CvArr* image, CvArr* edges, double threshold1,
@@ -2315,8 +2315,10 @@ struct mRGBA2RGBA
 
 void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
 {
+    CV_TRACE_REGION("cv::cvtColor");
     Mat src = _src.getMat(), dst;
     Size sz = src.size();
+    CV_TRACE_BYTES(src.total()*src.elemSize());
     int scn = src.channels(), depth = src.depth(), bidx;
 
     CV_Assert( depth == CV_8U || depth == CV_16U || depth == CV_32F );
@@ -49,81 +49,128 @@ namespace cv{
     struct NoOp{
         NoOp(){
         }
-        void init(int /*labels*/){
+        void init(int /*labels*/, int /*nstripes*/){
+        }
+        void markBorder(int /*l*/, int /*stripe*/){
+        }
+        void initStripes(){
         }
         inline
-        void operator()(int r, int c, int l){
+        void operator()(int k, int r, int c, int l){
+            (void) k;
             (void) r;
             (void) c;
             (void) l;
         }
         void finish(){}
     };
-    struct Point2ui64{
+
+    //The statistics of a component accumulated over its pixels
+    struct CCStats{
         uint64 x, y;
-        Point2ui64(uint64 _x, uint64 _y):x(_x), y(_y){}
+        int left, top, right, bottom, area;
+        int slot; //see CCStatsOp
+
+        CCStats(): x(0), y(0), left(INT_MAX), top(INT_MAX), right(INT_MIN), bottom(INT_MIN), area(0), slot(-1){
+        }
+        //the rows come in the increasing order
+        inline
+        void add(int r, int c){
+            if(c < left){
+                left = c;
+            }
+            if(c > right){
+                right = c;
+            }
+            if(area == 0){
+                top = r;
+            }
+            bottom = r;
+            area++;
+            x += c;
+            y += r;
+        }
+        void merge(const CCStats &s){
+            left = std::min(left, s.left);
+            right = std::max(right, s.right);
+            top = std::min(top, s.top);
+            bottom = std::max(bottom, s.bottom);
+            area += s.area;
+            x += s.x;
+            y += s.y;
+        }
     };
 
+    //The stats are gathered while the labels are written, by stripes of rows in parallel.
+    //The components that have pixels next to the borders of the stripes may be in several stripes,
+    //so each of those stripes accumulates them in its own slot, and the slots are merged in finish().
     struct CCStatsOp{
         const _OutputArray* _mstatsv;
-        cv::Mat statsv;
         const _OutputArray* _mcentroidsv;
-        cv::Mat centroidsv;
-        std::vector<Point2ui64> integrals;
+        std::vector<CCStats> stats;
+        std::vector<CCStats> slots;
+        std::vector<int> firstStripe, lastStripe;
 
         CCStatsOp(OutputArray _statsv, OutputArray _centroidsv): _mstatsv(&_statsv), _mcentroidsv(&_centroidsv){
         }
-        inline
-        void init(int nlabels){
-            _mstatsv->create(cv::Size(CC_STAT_MAX, nlabels), cv::DataType<int>::type);
-            statsv = _mstatsv->getMat();
-            _mcentroidsv->create(cv::Size(2, nlabels), cv::DataType<double>::type);
-            centroidsv = _mcentroidsv->getMat();
-
-            for(int l = 0; l < (int) nlabels; ++l){
-                int *row = (int *) &statsv.at<int>(l, 0);
-                row[CC_STAT_LEFT] = INT_MAX;
-                row[CC_STAT_TOP] = INT_MAX;
-                row[CC_STAT_WIDTH] = INT_MIN;
-                row[CC_STAT_HEIGHT] = INT_MIN;
-                row[CC_STAT_AREA] = 0;
-            }
-            integrals.resize(nlabels, Point2ui64(0, 0));
+        void init(int nlabels, int nstripes){
+            stats.assign(nlabels, CCStats());
+            firstStripe.assign(nlabels, INT_MAX);
+            lastStripe.assign(nlabels, -1);
+            //the background is in every stripe
+            markBorder(0, 0);
+            markBorder(0, nstripes - 1);
         }
-        void operator()(int r, int c, int l){
-            int *row = &statsv.at<int>(l, 0);
-            if(c > row[CC_STAT_WIDTH]){
-                row[CC_STAT_WIDTH] = c;
-            }else{
-                if(c < row[CC_STAT_LEFT]){
-                    row[CC_STAT_LEFT] = c;
+        //the label l is in the stripe next to a border
+        void markBorder(int l, int stripe){
+            firstStripe[l] = std::min(firstStripe[l], stripe);
+            lastStripe[l] = std::max(lastStripe[l], stripe);
+        }
+        //the slot of a label is the index of its first one in slots, or -1 if it is only in one stripe
+        void initStripes(){
+            int nslots = 0;
+            for(size_t l = 0; l < stats.size(); ++l){
+                if(lastStripe[l] > firstStripe[l]){
+                    stats[l].slot = nslots;
+                    nslots += lastStripe[l] - firstStripe[l] + 1;
                 }
             }
-            if(r > row[CC_STAT_HEIGHT]){
-                row[CC_STAT_HEIGHT] = r;
+            slots.assign(nslots, CCStats());
+        }
+        inline
+        void operator()(int k, int r, int c, int l){
+            CCStats &st = stats[l];
+            if(st.slot < 0){
+                st.add(r, c);
             }else{
-                if(r < row[CC_STAT_TOP]){
-                    row[CC_STAT_TOP] = r;
-                }
+                slots[st.slot + k - firstStripe[l]].add(r, c);
             }
-            row[CC_STAT_AREA]++;
-            Point2ui64 &integral = integrals[l];
-            integral.x += c;
-            integral.y += r;
         }
         void finish(){
-            for(int l = 0; l < statsv.rows; ++l){
+            int nlabels = (int)stats.size();
+            _mstatsv->create(cv::Size(CC_STAT_MAX, nlabels), cv::DataType<int>::type);
+            cv::Mat statsv = _mstatsv->getMat();
+            _mcentroidsv->create(cv::Size(2, nlabels), cv::DataType<double>::type);
+            cv::Mat centroidsv = _mcentroidsv->getMat();
+
+            for(int l = 0; l < nlabels; ++l){
+                CCStats &st = stats[l];
+                if(st.slot >= 0){
+                    for(int k = firstStripe[l]; k <= lastStripe[l]; ++k){
+                        st.merge(slots[st.slot + k - firstStripe[l]]);
+                    }
+                }
                 int *row = &statsv.at<int>(l, 0);
-                row[CC_STAT_LEFT] = std::min(row[CC_STAT_LEFT], row[CC_STAT_WIDTH]);
-                row[CC_STAT_WIDTH] = row[CC_STAT_WIDTH] - row[CC_STAT_LEFT] + 1;
-                row[CC_STAT_TOP] = std::min(row[CC_STAT_TOP], row[CC_STAT_HEIGHT]);
-                row[CC_STAT_HEIGHT] = row[CC_STAT_HEIGHT] - row[CC_STAT_TOP] + 1;
+                row[CC_STAT_LEFT] = std::min(st.left, st.right);
+                row[CC_STAT_WIDTH] = st.right - row[CC_STAT_LEFT] + 1;
+                row[CC_STAT_TOP] = std::min(st.top, st.bottom);
+                row[CC_STAT_HEIGHT] = st.bottom - row[CC_STAT_TOP] + 1;
+                row[CC_STAT_AREA] = st.area;
 
-                Point2ui64 &integral = integrals[l];
                 double *centroid = &centroidsv.at<double>(l, 0);
                 double area = ((unsigned*)row)[CC_STAT_AREA];
-                centroid[0] = double(integral.x) / area;
-                centroid[1] = double(integral.y) / area;
+                centroid[0] = double(st.x) / area;
+                centroid[1] = double(st.y) / area;
             }
         }
     };
@@ -176,21 +223,6 @@ namespace cv{
         return root;
     }
 
-    //Flatten the Union Find tree and relabel the components
-    template<typename LabelT>
-    inline static
-    LabelT flattenL(LabelT *P, LabelT length){
-        LabelT k = 1;
-        for(LabelT i = 1; i < length; ++i){
-            if(P[i] < i){
-                P[i] = P[P[i]];
-            }else{
-                P[i] = k; k = k + 1;
-            }
-        }
-        return k;
-    }
-
     //Based on "Two Strategies to Speed up Connected Components Algorithms", the SAUF (Scan array union find) variant
     //using decision trees
     //Kesheng Wu, et al
@@ -199,24 +231,13 @@ namespace cv{
     const int G4[2][2] = {{1, 0}, {0, -1}};//b, d neighborhoods
     //reference for 8-way: {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}};//a, b, c, d neighborhoods
     const int G8[4][2] = {{1, -1}, {1, 0}, {1, 1}, {0, -1}};//a, b, c, d neighborhoods
-    template<typename LabelT, typename PixelT, typename StatsOp = NoOp >
-    struct LabelingImpl{
-    LabelT operator()(const cv::Mat &I, cv::Mat &L, int connectivity, StatsOp &sop){
-        CV_Assert(L.rows == I.rows);
-        CV_Assert(L.cols == I.cols);
-        CV_Assert(connectivity == 8 || connectivity == 4);
-        const int rows = L.rows;
+    //Labels the rows [r0, r1) as a separate image, the new labels start from lunique.
+    //Returns the next unused label
+    template<typename LabelT, typename PixelT>
+    static
+    LabelT firstScan(const cv::Mat &I, cv::Mat &L, LabelT *P, int connectivity, int r0, int r1, LabelT lunique){
         const int cols = L.cols;
-        size_t Plength = (size_t(rows + 3 - 1)/3) * (size_t(cols + 3 - 1)/3);
-        if(connectivity == 4){
-            Plength = 4 * Plength;//a quick and dirty upper bound, an exact answer exists if you want to find it
-            //the 4 comes from the fact that a 3x3 block can never have more than 4 unique labels
-        }
-        LabelT *P = (LabelT *) fastMalloc(sizeof(LabelT) * Plength);
-        P[0] = 0;
-        LabelT lunique = 1;
-        //scanning phase
-        for(int r_i = 0; r_i < rows; ++r_i){
+        for(int r_i = r0; r_i < r1; ++r_i){
             LabelT *Lrow = (LabelT *)(L.data + L.step.p[0] * r_i);
             LabelT *Lrow_prev = (LabelT *)(((char *)Lrow) - L.step.p[0]);
             const PixelT *Irow = (PixelT *)(I.data + I.step.p[0] * r_i);
@@ -234,9 +255,9 @@ namespace cv{
                 const int b = 1;
                 const int c = 2;
                 const int d = 3;
-                const bool T_a_r = (r_i - G8[a][0]) >= 0;
-                const bool T_b_r = (r_i - G8[b][0]) >= 0;
-                const bool T_c_r = (r_i - G8[c][0]) >= 0;
+                const bool T_a_r = (r_i - G8[a][0]) >= r0;
+                const bool T_b_r = (r_i - G8[b][0]) >= r0;
+                const bool T_c_r = (r_i - G8[c][0]) >= r0;
                 for(int c_i = 0; Irows[0] != Irow + cols; ++Irows[0], c_i++){
                     if(!*Irows[0]){
                         Lrow[c_i] = 0;
@@ -290,7 +311,7 @@ namespace cv{
                 //B & D only
                 const int b = 0;
                 const int d = 1;
-                const bool T_b_r = (r_i - G4[b][0]) >= 0;
+                const bool T_b_r = (r_i - G4[b][0]) >= r0;
                 for(int c_i = 0; Irows[0] != Irow + cols; ++Irows[0], c_i++){
                     if(!*Irows[0]){
                         Lrow[c_i] = 0;
@@ -323,22 +344,164 @@ namespace cv{
                 }
             }
         }
+        return lunique;
+    }
+
+    template<typename LabelT, typename PixelT>
+    class FirstScanInvoker : public ParallelLoopBody{
+    public:
+        FirstScanInvoker(const cv::Mat &_I, cv::Mat &_L, LabelT *_P, int _connectivity,
+                         const int *_stripeRows, const LabelT *_stripeBase, LabelT *_stripeEnd):
+            I(_I), L(_L), P(_P), connectivity(_connectivity),
+            stripeRows(_stripeRows), stripeBase(_stripeBase), stripeEnd(_stripeEnd){
+        }
+        void operator()(const Range &range) const{
+            for(int k = range.start; k < range.end; ++k){
+                cv::Mat Lk = L;
+                stripeEnd[k] = firstScan<LabelT, PixelT>(I, Lk, P, connectivity,
+                                                         stripeRows[k], stripeRows[k + 1], stripeBase[k]);
+            }
+        }
+    private:
+        FirstScanInvoker& operator=(const FirstScanInvoker&); // to quiet MSVC
+
+        cv::Mat I, L;
+        LabelT *P;
+        int connectivity;
+        const int *stripeRows;
+        const LabelT *stripeBase;
+        LabelT *stripeEnd;
+    };
+
+    //Writes the final labels and gathers the stats
+    template<typename LabelT, typename StatsOp>
+    class SecondScanInvoker : public ParallelLoopBody{
+    public:
+        SecondScanInvoker(cv::Mat &_L, const LabelT *_P, const int *_stripeRows, StatsOp &_sop):
+            L(_L), P(_P), stripeRows(_stripeRows), sop(&_sop){
+        }
+        void operator()(const Range &range) const{
+            const LabelT *P_ = P;
+            StatsOp &sop_ = *sop;
+            for(int k = range.start; k < range.end; ++k){
+                for(int r_i = stripeRows[k]; r_i < stripeRows[k + 1]; ++r_i){
+                    LabelT *Lrow_start = (LabelT *)(L.data + L.step.p[0] * r_i);
+                    LabelT *Lrow_end = Lrow_start + L.cols;
+                    LabelT *Lrow = Lrow_start;
+                    for(int c_i = 0; Lrow != Lrow_end; ++Lrow, ++c_i){
+                        const LabelT l = P_[*Lrow];
+                        *Lrow = l;
+                        sop_(k, r_i, c_i, l);
+                    }
+                }
+            }
+        }
+    private:
+        SecondScanInvoker& operator=(const SecondScanInvoker&); // to quiet MSVC
+
+        cv::Mat L;
+        const LabelT *P;
+        const int *stripeRows;
+        StatsOp *sop;
+    };
+
+    enum { CC_STRIPE_MIN_ROWS = 32 };
+
+    //The stripes of rows are labeled in parallel, each one with its own range of the labels.
+    //Then the labels on the borders of the stripes are united, and the labels are flattened in the order
+    //of their ranges, so the result is the same as with the labeling of the whole image at once.
+    template<typename LabelT, typename PixelT, typename StatsOp = NoOp >
+    struct LabelingImpl{
+    LabelT operator()(const cv::Mat &I, cv::Mat &L, int connectivity, StatsOp &sop){
+        CV_Assert(L.rows == I.rows);
+        CV_Assert(L.cols == I.cols);
+        CV_Assert(connectivity == 8 || connectivity == 4);
+        const int rows = L.rows;
+        const int cols = L.cols;
+        //the pixels that get the new labels are never adjacent (never 4-adjacent for 4-way connectivity),
+        //so a pair of rows gets at most (cols + 1)/2 (cols for 4-way connectivity) of them
+        const int npairs = (rows + 1)/2;
+        const size_t pairLabels = connectivity == 8 ? size_t(cols + 1)/2 : size_t(cols);
+        const size_t Plength = npairs * pairLabels + 1;
+
+        int nstripes = 1;
+        if(getNumThreads() > 1 && Plength - 1 <= (size_t)std::numeric_limits<LabelT>::max()){
+            nstripes = std::max(1, std::min(getNumThreads() * 2, rows / CC_STRIPE_MIN_ROWS));
+        }
+
+        AutoBuffer<int> _stripeRows(nstripes + 1);
+        AutoBuffer<LabelT> _stripeBase(nstripes * 2);
+        int *stripeRows = _stripeRows;
+        LabelT *stripeBase = _stripeBase, *stripeEnd = stripeBase + nstripes;
+        for(int k = 0; k <= nstripes; ++k){
+            int pair = (int)((int64)k * npairs / nstripes);
+            stripeRows[k] = std::min(pair * 2, rows);
+            if(k < nstripes){
+                stripeBase[k] = (LabelT)(pair * pairLabels + 1);
+            }
+        }
+
+        LabelT *P = (LabelT *) fastMalloc(sizeof(LabelT) * Plength);
+        P[0] = 0;
+        //scanning phase
+        parallel_for_(Range(0, nstripes), FirstScanInvoker<LabelT, PixelT>(I, L, P, connectivity, stripeRows,
+                                                                             stripeBase, stripeEnd), nstripes);
+
+        //unite the labels across the borders of the stripes
+        for(int k = 1; k < nstripes; ++k){
+            const int r_i = stripeRows[k];
+            const PixelT *Irow = (PixelT *)(I.data + I.step.p[0] * r_i);
+            const PixelT *Irow_prev = (const PixelT *)(((char *)Irow) - I.step.p[0]);
+            const LabelT *Lrow = (LabelT *)(L.data + L.step.p[0] * r_i);
+            const LabelT *Lrow_prev = (LabelT *)(((char *)Lrow) - L.step.p[0]);
+            for(int c_i = 0; c_i < cols; ++c_i){
+                if(!Irow[c_i]){
+                    continue;
+                }
+                if(Irow_prev[c_i]){
+                    set_union(P, Lrow[c_i], Lrow_prev[c_i]);
+                }else if(connectivity == 8){
+                    //the neighbors above on the left and on the right are not connected through b
+                    if(c_i > 0 && Irow_prev[c_i - 1]){
+                        set_union(P, Lrow[c_i], Lrow_prev[c_i - 1]);
+                    }
+                    if(c_i + 1 < cols && Irow_prev[c_i + 1]){
+                        set_union(P, Lrow[c_i], Lrow_prev[c_i + 1]);
+                    }
+                }
+            }
+        }
 
         //analysis
-        LabelT nLabels = flattenL(P, lunique);
-        sop.init(nLabels);
-
-        for(int r_i = 0; r_i < rows; ++r_i){
-            LabelT *Lrow_start = (LabelT *)(L.data + L.step.p[0] * r_i);
-            LabelT *Lrow_end = Lrow_start + cols;
-            LabelT *Lrow = Lrow_start;
-            for(int c_i = 0; Lrow != Lrow_end; ++Lrow, ++c_i){
-                const LabelT l = P[*Lrow];
-                *Lrow = l;
-                sop(r_i, c_i, l);
+        //flatten the Union Find tree and relabel the components, the ranges of the stripes go in order
+        LabelT nLabels = 1;
+        for(int k = 0; k < nstripes; ++k){
+            for(LabelT i = stripeBase[k]; i < stripeEnd[k]; ++i){
+                if(P[i] < i){
+                    P[i] = P[P[i]];
+                }else{
+                    P[i] = nLabels; nLabels = nLabels + 1;
+                }
             }
         }
 
+        sop.init(nLabels, nstripes);
+        for(int k = 1; k < nstripes; ++k){
+            for(int r_i = stripeRows[k] - 1; r_i <= stripeRows[k]; ++r_i){
+                const LabelT *Lrow = (LabelT *)(L.data + L.step.p[0] * r_i);
+                for(int c_i = 0; c_i < cols; ++c_i){
+                    if(Lrow[c_i]){
+                        const LabelT l = P[Lrow[c_i]];
+                        sop.markBorder(l, k - 1);
+                        sop.markBorder(l, k);
+                    }
+                }
+            }
+        }
+        sop.initStripes();
+
+        parallel_for_(Range(0, nstripes), SecondScanInvoker<LabelT, StatsOp>(L, P, stripeRows, sop), nstripes);
+
         sop.finish();
         fastFree(P);
 
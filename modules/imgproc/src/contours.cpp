@@ -1753,4 +1753,371 @@ void cv::findContours( InputOutputArray _image, OutputArrayOfArrays _contours,
     findContours(_image, _contours, noArray(), mode, method, offset);
 }
 
+namespace cv
+{
+
+/*
+   Follows a border the way icvFetchContour() does, but does not mark the pixels, so any number
+   of borders can be followed at once. The tracing only tells zero pixels from non-zero ones,
+   and the marks of findContours() are never zero, so the point sequences are the same.
+*/
+static void traceContour( const uchar* ptr, int step, Point pt, bool isHole, int method,
+                          std::vector<Point>& contour )
+{
+    int deltas[16];
+    const uchar *i0 = ptr, *i1, *i3, *i4;
+    int prev_s, s, s_end;
+
+    CV_INIT_3X3_DELTAS( deltas, step, 1 );
+    memcpy( deltas + 8, deltas, 8 * sizeof( deltas[0] ));
+
+    contour.clear();
+    s_end = s = isHole ? 0 : 4;
+
+    do
+    {
+        s = (s - 1) & 7;
+        i1 = i0 + deltas[s];
+        if( *i1 != 0 )
+            break;
+    }
+    while( s != s_end );
+
+    if( s == s_end )            /* single pixel domain */
+    {
+        contour.push_back(pt);
+        return;
+    }
+
+    i3 = i0;
+    prev_s = s ^ 4;
+
+    /* follow border */
+    for( ;; )
+    {
+        for( ;; )
+        {
+            i4 = i3 + deltas[++s];
+            if( *i4 != 0 )
+                break;
+        }
+        s &= 7;
+
+        if( s != prev_s || method == CV_CHAIN_APPROX_NONE )
+        {
+            contour.push_back(pt);
+            prev_s = s;
+        }
+
+        pt.x += icvCodeDeltas[s].x;
+        pt.y += icvCodeDeltas[s].y;
+
+        if( i4 == i0 && i3 == i1 )
+            break;
+
+        i3 = i4;
+        s = (s + 4) & 7;
+    }
+}
+
+/*
+   A border as the raster scan of findContours() meets it. An 8-connected component of the
+   non-zero pixels has one outer border, which starts at its first pixel in the raster order.
+   A 4-connected component of the zero pixels, apart from the one around the image, has one
+   hole border, which starts at the pixel to the left of its first pixel.
+*/
+struct ContourStart
+{
+    Point pt;
+    bool isHole;
+    // the label of the component and of the one of the other kind at the left of it
+    int label, parent;
+
+    // the order of the raster scan, that meets a hole at the zero pixel
+    bool operator < (const ContourStart& b) const
+    {
+        return pt.y < b.pt.y || (pt.y == b.pt.y && pt.x + (int)isHole < b.pt.x + (int)b.isHole);
+    }
+};
+
+/*
+   Collects the pixels of the mask that have no neighbours in the mask above them or at their
+   left: 8 of them for the non-zero pixels, 4 for the zero ones. The first pixel of a component
+   in the raster order is one of those, and there are few of them, so each stripe of rows keeps
+   its own list, and the lists are looked through in the order of the stripes afterwards.
+   The mask is 0 or 255, so the conditions are computed bitwise, 16 pixels at once.
+*/
+class ComponentTopsInvoker : public ParallelLoopBody
+{
+public:
+    ComponentTopsInvoker( const Mat& _mask, bool _inverse, int _nstripes,
+                          std::vector<std::vector<Point> >& _tops )
+        : mask(&_mask), inverse(_inverse), nstripes(_nstripes), tops(&_tops) {}
+
+    void operator()( const Range& range ) const
+    {
+        // the frame is zero: it is not scanned and no component of interest starts there
+        int rows = mask->rows - 2, width = mask->cols - 1;
+#if CV_SSE2
+        bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+#endif
+        for( int k = range.start; k < range.end; k++ )
+        {
+            std::vector<Point>& stripeTops = (*tops)[k];
+            int y0 = 1 + (int)((int64)rows*k/nstripes), y1 = 1 + (int)((int64)rows*(k + 1)/nstripes);
+            for( int y = y0; y < y1; y++ )
+            {
+                const uchar* prev = mask->ptr(y - 1);
+                const uchar* row = mask->ptr(y);
+                int x = 1;
+#if CV_SSE2
+                if( haveSSE2 )
+                {
+                    for( ; x <= width - 16; x += 16 )
+                    {
+                        __m128i r0 = _mm_loadu_si128((const __m128i*)(row + x - 1));
+                        __m128i r1 = _mm_loadu_si128((const __m128i*)(row + x));
+                        __m128i p1 = _mm_loadu_si128((const __m128i*)(prev + x));
+                        __m128i t;
+                        if( !inverse )
+                        {
+                            __m128i p0 = _mm_loadu_si128((const __m128i*)(prev + x - 1));
+                            __m128i p2 = _mm_loadu_si128((const __m128i*)(prev + x + 1));
+                            t = _mm_andnot_si128(_mm_or_si128(_mm_or_si128(r0, p0), _mm_or_si128(p1, p2)), r1);
+                        }
+                        else
+                            t = _mm_andnot_si128(r1, _mm_and_si128(r0, p1));
+                        for( int m = _mm_movemask_epi8(t); m != 0; m &= m - 1 )
+                        {
+                            int i = 0;
+                            while( !(m & (1 << i)) )
+                                i++;
+                            stripeTops.push_back(Point(x + i, y));
+                        }
+                    }
+                }
+#endif
+                if( !inverse )
+                {
+                    for( ; x < width; x++ )
+                        if( row[x] && !(row[x-1] | prev[x-1] | prev[x] | prev[x+1]) )
+                            stripeTops.push_back(Point(x, y));
+                }
+                else
+                {
+                    for( ; x < width; x++ )
+                        if( !row[x] && row[x-1] && prev[x] )
+                            stripeTops.push_back(Point(x, y));
+                }
+            }
+        }
+    }
+
+private:
+    ComponentTopsInvoker& operator=(const ComponentTopsInvoker&);
+
+    const Mat* mask;
+    bool inverse;
+    int nstripes;
+    std::vector<std::vector<Point> >* tops;
+};
+
+// the first pixel in the raster order of every component apart from the ones on the frame
+static void findComponentStarts( const Mat& mask, bool inverse, const Mat& labels, int n,
+                                 std::vector<Point>& starts )
+{
+    int nstripes = std::max(1, std::min(getNumThreads()*2, mask.rows/32));
+    std::vector<std::vector<Point> > tops(nstripes);
+    parallel_for_(Range(0, nstripes), ComponentTopsInvoker(mask, inverse, nstripes, tops), nstripes);
+
+    starts.assign(n, Point(-1, -1));
+    for( int k = 0; k < nstripes; k++ )
+    {
+        const std::vector<Point>& stripeTops = tops[k];
+        for( size_t i = 0; i < stripeTops.size(); i++ )
+        {
+            Point pt = stripeTops[i];
+            Point& start = starts[labels.at<int>(pt)];
+            if( start.x < 0 )
+                start = pt;
+        }
+    }
+}
+
+class ContourTraceInvoker : public ParallelLoopBody
+{
+public:
+    ContourTraceInvoker( const Mat& _mask, const std::vector<ContourStart>& _starts,
+                         const std::vector<int>& _order, int _method, Point _offset,
+                         std::vector<std::vector<Point> >& _contours )
+        : mask(&_mask), starts(&_starts), order(&_order), method(_method), offset(_offset),
+          contours(&_contours) {}
+
+    void operator()( const Range& range ) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            const ContourStart& cs = (*starts)[(*order)[i]];
+            traceContour( mask->ptr(cs.pt.y) + cs.pt.x, (int)mask->step, cs.pt + offset,
+                          cs.isHole, method, (*contours)[i] );
+        }
+    }
+
+private:
+    ContourTraceInvoker& operator=(const ContourTraceInvoker&);
+
+    const Mat* mask;
+    const std::vector<ContourStart>* starts;
+    const std::vector<int>* order;
+    int method;
+    Point offset;
+    std::vector<std::vector<Point> >* contours;
+};
+
+}
+
+/*
+   The borders are found from the connected components of the non-zero and the zero pixels,
+   which are labeled by parallel stripes of rows; the components that cross the stripes are
+   stitched there. The nesting of the borders follows from the components too: the parent of an
+   outer border is the hole border of the zero component at its left, and the parent of a hole
+   border is the outer border of the non-zero component at its left. Then every border is traced
+   on its own, in parallel, straight into the output vector. The contours, their order and the
+   hierarchy are the same as those of findContours(), apart from the rare cases where the search
+   for the parent there (by the bounding rectangles and the last met border) picks a wrong one.
+*/
+void cv::findContoursParallel( InputArray _image, std::vector<std::vector<Point> >& contours,
+                               OutputArray _hierarchy, int mode, int method, Point offset )
+{
+    Mat image = _image.getMat();
+    CV_Assert( image.type() == CV_8UC1 );
+    CV_Assert( CV_RETR_EXTERNAL <= mode && mode <= CV_RETR_TREE );
+    CV_Assert( method == CV_CHAIN_APPROX_NONE || method == CV_CHAIN_APPROX_SIMPLE );
+
+    contours.clear();
+    if( _hierarchy.needed() )
+        _hierarchy.clear();
+    if( image.rows < 3 || image.cols < 3 )
+        return;
+
+    // findContours() takes the 1-pixel frame of the image for zeros
+    Mat mask, inv, labels, invLabels;
+    compare( image, Scalar::all(0), mask, CMP_NE );
+    mask.row(0) = Scalar::all(0);
+    mask.row(mask.rows - 1) = Scalar::all(0);
+    mask.col(0) = Scalar::all(0);
+    mask.col(mask.cols - 1) = Scalar::all(0);
+    bitwise_not( mask, inv );
+
+    int n = connectedComponents( mask, labels, 8, CV_32S );
+    int ninv = connectedComponents( inv, invLabels, 4, CV_32S );
+    int outside = invLabels.at<int>(0, 0);
+
+    std::vector<Point> compStarts, invStarts;
+    findComponentStarts( mask, false, labels, n, compStarts );
+    findComponentStarts( mask, true, invLabels, ninv, invStarts );
+
+    std::vector<ContourStart> starts;
+    int i, total = 0, nholes = ninv - 2;
+    starts.reserve(n - 1 + nholes);
+    for( i = 1; i < n; i++ )
+    {
+        ContourStart cs;
+        cs.pt = compStarts[i];
+        cs.isHole = false;
+        cs.label = i;
+        cs.parent = invLabels.at<int>(cs.pt.y, cs.pt.x - 1);
+        if( cs.parent == outside )
+            cs.parent = -1;
+        if( mode != CV_RETR_EXTERNAL || cs.parent < 0 )
+            starts.push_back(cs);
+    }
+    if( mode != CV_RETR_EXTERNAL )
+    {
+        for( i = 1; i < ninv; i++ )
+        {
+            if( i == outside )
+                continue;
+            ContourStart cs;
+            cs.pt = invStarts[i] - Point(1, 0);
+            cs.isHole = true;
+            cs.label = i;
+            cs.parent = labels.at<int>(cs.pt);
+            starts.push_back(cs);
+        }
+    }
+
+    // the parents as the indices in starts, -1 for the frame
+    std::vector<int> compIdx(n, -1), invIdx(ninv, -1);
+    std::sort( starts.begin(), starts.end() );
+    total = (int)starts.size();
+    for( i = 0; i < total; i++ )
+        (starts[i].isHole ? invIdx : compIdx)[starts[i].label] = i;
+    for( i = 0; i < total; i++ )
+    {
+        ContourStart& cs = starts[i];
+        if( mode == CV_RETR_LIST || (mode == CV_RETR_CCOMP && !cs.isHole) || cs.parent < 0 )
+            cs.parent = -1;
+        else
+            cs.parent = cs.isHole ? compIdx[cs.parent] : invIdx[cs.parent];
+    }
+
+    // findContours() makes every new contour the first child of its parent and then lists the
+    // tree in the depth-first order
+    std::vector<int> firstChild(total + 1, -1), next(total, -1), prev(total, -1);
+    for( i = 0; i < total; i++ )
+    {
+        int p = starts[i].parent < 0 ? total : starts[i].parent;
+        next[i] = firstChild[p];
+        if( next[i] >= 0 )
+            prev[next[i]] = i;
+        firstChild[p] = i;
+    }
+
+    std::vector<int> order, index(total), stack;
+    order.reserve(total);
+    for( int c = firstChild[total]; c >= 0; )
+    {
+        index[c] = (int)order.size();
+        order.push_back(c);
+        if( firstChild[c] >= 0 )
+        {
+            stack.push_back(c);
+            c = firstChild[c];
+            continue;
+        }
+        while( next[c] < 0 && !stack.empty() )
+        {
+            c = stack.back();
+            stack.pop_back();
+        }
+        c = next[c];
+    }
+    CV_Assert( (int)order.size() == total );
+
+    contours.resize(total);
+    parallel_for_(Range(0, total), ContourTraceInvoker(mask, starts, order, method, offset, contours),
+                  std::min((double)total, mask.total()/(double)(1<<16)));
+
+    if( _hierarchy.needed() && total > 0 )
+    {
+        _hierarchy.create(1, total, CV_32SC4, -1, true);
+        Vec4i* hierarchy = _hierarchy.getMat().ptr<Vec4i>();
+        for( i = 0; i < total; i++ )
+        {
+            int c = order[i];
+            hierarchy[i] = Vec4i(next[c] >= 0 ? index[next[c]] : -1,
+                                 prev[c] >= 0 ? index[prev[c]] : -1,
+                                 firstChild[c] >= 0 ? index[firstChild[c]] : -1,
+                                 starts[c].parent >= 0 ? index[starts[c].parent] : -1);
+        }
+    }
+}
+
+void cv::findContoursParallel( InputArray _image, std::vector<std::vector<Point> >& contours,
+                               int mode, int method, Point offset )
+{
+    findContoursParallel(_image, contours, noArray(), mode, method, offset);
+}
+
 /* End of file. */
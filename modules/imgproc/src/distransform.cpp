@@ -443,162 +443,182 @@ icvGetDistanceTransformMask( int maskType, float *metrics )
 namespace cv
 {
 
-struct DTColumnInvoker
+// the 1d distance of the pixels to the nearest zero pixel in the same column;
+// both sweeps go along the rows of a block of columns, so the memory is accessed
+// sequentially, and the integer distances are kept in the (float) output image
+struct DTColumnInvoker : ParallelLoopBody
 {
-    DTColumnInvoker( const CvMat* _src, CvMat* _dst, const int* _sat_tab, const float* _sqr_tab)
+    DTColumnInvoker( const Mat& _src, Mat& _dst, int _blockWidth )
+        : src(&_src), dst(&_dst), blockWidth(_blockWidth)
     {
-        src = _src;
-        dst = _dst;
-        sat_tab = _sat_tab + src->rows*2 + 1;
-        sqr_tab = _sqr_tab;
+        haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
     }
 
-    void operator()( const BlockedRange& range ) const
+    void operator()( const Range& range ) const
     {
-        int i, i1 = range.begin(), i2 = range.end();
-        int m = src->rows;
-        size_t sstep = src->step, dstep = dst->step/sizeof(float);
-        AutoBuffer<int> _d(m);
-        int* d = _d;
+        int m = src->rows, n = src->cols;
+        int j0 = range.start*blockWidth, j1 = std::min(range.end*blockWidth, n);
+        int i, j;
 
-        for( i = i1; i < i2; i++ )
-        {
-            const uchar* sptr = src->data.ptr + i + (m-1)*sstep;
-            float* dptr = dst->data.fl + i;
-            int j, dist = m-1;
+        const uchar* sptr = src->ptr(0);
+        int* dptr = dst->ptr<int>(0);
+        for( j = j0; j < j1; j++ )
+            dptr[j] = sptr[j] == 0 ? 0 : DT_INF;
 
-            for( j = m-1; j >= 0; j--, sptr -= sstep )
+        for( i = 1; i < m; i++ )
+        {
+            const int* prev = dptr;
+            sptr = src->ptr(i);
+            dptr = dst->ptr<int>(i);
+            j = j0;
+        #if CV_SSE2
+            if( haveSSE2 )
             {
-                dist = (dist + 1) & (sptr[0] == 0 ? 0 : -1);
-                d[j] = dist;
+                __m128i z = _mm_setzero_si128(), one = _mm_set1_epi32(1);
+                for( ; j <= j1 - 16; j += 16 )
+                {
+                    __m128i mz = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(sptr + j)), z);
+                    __m128i mlo = _mm_unpacklo_epi8(mz, mz), mhi = _mm_unpackhi_epi8(mz, mz);
+                    _mm_storeu_si128((__m128i*)(dptr + j), _mm_andnot_si128(_mm_unpacklo_epi16(mlo, mlo),
+                        _mm_add_epi32(_mm_loadu_si128((const __m128i*)(prev + j)), one)));
+                    _mm_storeu_si128((__m128i*)(dptr + j + 4), _mm_andnot_si128(_mm_unpackhi_epi16(mlo, mlo),
+                        _mm_add_epi32(_mm_loadu_si128((const __m128i*)(prev + j + 4)), one)));
+                    _mm_storeu_si128((__m128i*)(dptr + j + 8), _mm_andnot_si128(_mm_unpacklo_epi16(mhi, mhi),
+                        _mm_add_epi32(_mm_loadu_si128((const __m128i*)(prev + j + 8)), one)));
+                    _mm_storeu_si128((__m128i*)(dptr + j + 12), _mm_andnot_si128(_mm_unpackhi_epi16(mhi, mhi),
+                        _mm_add_epi32(_mm_loadu_si128((const __m128i*)(prev + j + 12)), one)));
+                }
             }
+        #endif
+            for( ; j < j1; j++ )
+                dptr[j] = sptr[j] == 0 ? 0 : prev[j] + 1;
+        }
 
-            dist = m-1;
-            for( j = 0; j < m; j++, dptr += dstep )
+        for( i = m - 2; i >= 0; i-- )
+        {
+            const int* next = dst->ptr<int>(i+1);
+            dptr = dst->ptr<int>(i);
+            j = j0;
+        #if CV_SSE2
+            if( haveSSE2 )
             {
-                dist = dist + 1 - sat_tab[dist - d[j]];
-                d[j] = dist;
-                dptr[0] = sqr_tab[dist];
+                __m128i one = _mm_set1_epi32(1);
+                for( ; j <= j1 - 4; j += 4 )
+                {
+                    __m128i d = _mm_loadu_si128((const __m128i*)(dptr + j));
+                    __m128i d1 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(next + j)), one);
+                    __m128i mask = _mm_cmpgt_epi32(d, d1);
+                    _mm_storeu_si128((__m128i*)(dptr + j),
+                        _mm_or_si128(_mm_and_si128(mask, d1), _mm_andnot_si128(mask, d)));
+                }
             }
+        #endif
+            for( ; j < j1; j++ )
+                dptr[j] = std::min(dptr[j], next[j] + 1);
         }
     }
 
-    const CvMat* src;
-    CvMat* dst;
-    const int* sat_tab;
-    const float* sqr_tab;
+    enum { DT_INF = 1 << 30 };
+
+    const Mat* src;
+    Mat* dst;
+    int blockWidth;
+    bool haveSSE2;
 };
 
 
-struct DTRowInvoker
+// the lower envelope of the parabolas f(p) + (q - p)^2 of each row (Felzenszwalb & Huttenlocher).
+// The squared distances are integers and the intersections of the parabolas are compared
+// as fractions in 64-bit integers, so the result is exact for any image size
+struct DTRowInvoker : ParallelLoopBody
 {
-    DTRowInvoker( CvMat* _dst, const float* _sqr_tab, const float* _inv_tab )
+    DTRowInvoker( Mat& _dst ) : dst(&_dst)
     {
-        dst = _dst;
-        sqr_tab = _sqr_tab;
-        inv_tab = _inv_tab;
     }
 
-    void operator()( const BlockedRange& range ) const
+    void operator()( const Range& range ) const
     {
-        const float inf = 1e15f;
-        int i, i1 = range.begin(), i2 = range.end();
         int n = dst->cols;
-        AutoBuffer<uchar> _buf((n+2)*2*sizeof(float) + (n+2)*sizeof(int));
-        float* f = (float*)(uchar*)_buf;
-        float* z = f + n;
-        int* v = alignPtr((int*)(z + n + 1), sizeof(int));
+        AutoBuffer<int64> _buf(n*2);
+        int64* f = _buf;
+        int64* sq = f + n;
+        AutoBuffer<int> _v(n);
+        int* v = _v;
+        int p, q, k;
 
-        for( i = i1; i < i2; i++ )
-        {
-            float* d = (float*)(dst->data.ptr + i*dst->step);
-            int p, q, k;
+        for( q = 0; q < n; q++ )
+            sq[q] = (int64)q*q;
 
-            v[0] = 0;
-            z[0] = -inf;
-            z[1] = inf;
-            f[0] = d[0];
+        for( int i = range.start; i < range.end; i++ )
+        {
+            const int* g = dst->ptr<int>(i);
+            float* d = dst->ptr<float>(i);
 
-            for( q = 1, k = 0; q < n; q++ )
+            for( q = 0, k = -1; q < n; q++ )
             {
-                float fq = d[q];
-                f[q] = fq;
-
-                for(;;k--)
+                int gq = g[q];
+                if( gq >= DTColumnInvoker::DT_INF/2 )
+                    continue;
+                f[q] = (int64)gq*gq + sq[q];
+
+                // pop the parabolas hidden by the new one: the intersection (v[k], q) is
+                // not to the right of the intersection (v[k-1], v[k])
+                for( ; k > 0; k-- )
                 {
-                    p = v[k];
-                    float s = (fq + sqr_tab[q] - d[p] - sqr_tab[p])*inv_tab[q - p];
-                    if( s > z[k] )
-                    {
-                        k++;
-                        v[k] = q;
-                        z[k] = s;
-                        z[k+1] = inf;
+                    int a = v[k-1], b = v[k];
+                    if( (f[q] - f[b])*(b - a) > (f[b] - f[a])*(q - b) )
                         break;
-                    }
                 }
+                v[++k] = q;
             }
 
+            if( k < 0 )
+            {
+                // no zero pixels in the whole image; keep the output of the earlier float implementation
+                for( q = 0; q < n; q++ )
+                    d[q] = 31622776.f;
+                continue;
+            }
+
+            int last = k;
             for( q = 0, k = 0; q < n; q++ )
             {
-                while( z[k+1] < q )
+                // move to the next parabola while their intersection is to the left of q
+                while( k < last && f[v[k+1]] - f[v[k]] < (int64)(2*q)*(v[k+1] - v[k]) )
                     k++;
                 p = v[k];
-                d[q] = std::sqrt(sqr_tab[std::abs(q - p)] + f[p]);
+                d[q] = (float)std::sqrt((double)(f[p] - sq[p] + (int64)(q - p)*(q - p)));
             }
         }
     }
 
-    CvMat* dst;
-    const float* sqr_tab;
-    const float* inv_tab;
+    Mat* dst;
 };
 
 }
 
 static void
-icvTrueDistTrans( const CvMat* src, CvMat* dst )
+icvTrueDistTrans( const CvMat* _src, CvMat* _dst )
 {
-    const float inf = 1e15f;
-
-    if( !CV_ARE_SIZES_EQ( src, dst ))
+    if( !CV_ARE_SIZES_EQ( _src, _dst ))
         CV_Error( CV_StsUnmatchedSizes, "" );
 
-    if( CV_MAT_TYPE(src->type) != CV_8UC1 ||
-        CV_MAT_TYPE(dst->type) != CV_32FC1 )
+    if( CV_MAT_TYPE(_src->type) != CV_8UC1 ||
+        CV_MAT_TYPE(_dst->type) != CV_32FC1 )
         CV_Error( CV_StsUnsupportedFormat,
         "The input image must have 8uC1 type and the output one must have 32fC1 type" );
 
-    int i, m = src->rows, n = src->cols;
-
-    cv::AutoBuffer<uchar> _buf(std::max(m*2*sizeof(float) + (m*3+1)*sizeof(int), n*2*sizeof(float)));
-    // stage 1: compute 1d distance transform of each column
-    float* sqr_tab = (float*)(uchar*)_buf;
-    int* sat_tab = cv::alignPtr((int*)(sqr_tab + m*2), sizeof(int));
-    int shift = m*2;
+    cv::Mat src(_src), dst(_dst);
+    int m = src.rows, n = src.cols;
+    double nstripes = (double)m*n/(1 << 16);
 
-    for( i = 0; i < m; i++ )
-        sqr_tab[i] = (float)(i*i);
-    for( i = m; i < m*2; i++ )
-        sqr_tab[i] = inf;
-    for( i = 0; i < shift; i++ )
-        sat_tab[i] = 0;
-    for( ; i <= m*3; i++ )
-        sat_tab[i] = i - shift;
-
-    cv::parallel_for(cv::BlockedRange(0, n), cv::DTColumnInvoker(src, dst, sat_tab, sqr_tab));
+    // stage 1: compute 1d distance transform of each column, by blocks of 256 columns
+    int blockWidth = 256, nblocks = (n + blockWidth - 1)/blockWidth;
+    cv::parallel_for_(cv::Range(0, nblocks), cv::DTColumnInvoker(src, dst, blockWidth),
+                      std::min(nstripes, (double)nblocks));
 
     // stage 2: compute modified distance transform for each row
-    float* inv_tab = sqr_tab + n;
-
-    inv_tab[0] = sqr_tab[0] = 0.f;
-    for( i = 1; i < n; i++ )
-    {
-        inv_tab[i] = (float)(0.5/i);
-        sqr_tab[i] = (float)(i*i);
-    }
-
-    cv::parallel_for(cv::BlockedRange(0, m), cv::DTRowInvoker(dst, sqr_tab, inv_tab));
+    cv::parallel_for_(cv::Range(0, m), cv::DTRowInvoker(dst), nstripes);
 }
 
 
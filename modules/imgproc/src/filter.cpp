@@ -95,14 +95,17 @@ namespace cv
 
 BaseRowFilter::BaseRowFilter() { ksize = anchor = -1; }
 BaseRowFilter::~BaseRowFilter() {}
+Ptr<BaseRowFilter> BaseRowFilter::clone() const { return Ptr<BaseRowFilter>(); }
 
 BaseColumnFilter::BaseColumnFilter() { ksize = anchor = -1; }
 BaseColumnFilter::~BaseColumnFilter() {}
 void BaseColumnFilter::reset() {}
+Ptr<BaseColumnFilter> BaseColumnFilter::clone() const { return Ptr<BaseColumnFilter>(); }
 
 BaseFilter::BaseFilter() { ksize = Size(-1,-1); anchor = Point(-1,-1); }
 BaseFilter::~BaseFilter() {}
 void BaseFilter::reset() {}
+Ptr<BaseFilter> BaseFilter::clone() const { return Ptr<BaseFilter>(); }
 
 FilterEngine::FilterEngine()
 {
@@ -430,9 +433,63 @@ int FilterEngine::proceed( const uchar* src, int srcstep, int count,
 }
 
 
+/*
+   Filters the stripes of the destination rows, each with its own copy of the engine.
+   The copies are started on the whole image with the same border modes, so the rows
+   around a stripe are taken from the source image and the result matches the serial mode.
+*/
+class FilterStripeInvoker : public ParallelLoopBody
+{
+public:
+    FilterStripeInvoker( const FilterEngine& _engine, const Mat& _src, Mat& _dst,
+                         Size _wholeSize, Rect _roi, Point _ofs, Point _dstOfs )
+        : engine(&_engine), src(&_src), dst(&_dst), wholeSize(_wholeSize),
+          roi(_roi), ofs(_ofs), dstOfs(_dstOfs) {}
+
+    void operator()( const Range& range ) const
+    {
+        FilterEngine f(*engine);
+        if( f.isSeparable() )
+        {
+            f.rowFilter = engine->rowFilter->clone();
+            f.columnFilter = engine->columnFilter->clone();
+        }
+        else
+            f.filter2D = engine->filter2D->clone();
+
+        Rect stripe(roi.x, roi.y + range.start, roi.width, range.end - range.start);
+        int y = f.start(wholeSize, stripe) - ofs.y;
+        f.proceed( src->data + y*src->step + (roi.x - ofs.x)*src->elemSize(), (int)src->step, f.endY - f.startY,
+                   dst->data + (dstOfs.y + range.start)*dst->step + dstOfs.x*dst->elemSize(),
+                   (int)dst->step );
+    }
+
+private:
+    FilterStripeInvoker& operator=(const FilterStripeInvoker&); // to quiet MSVC
+
+    const FilterEngine* engine;
+    const Mat* src;
+    Mat* dst;
+    Size wholeSize;
+    Rect roi;
+    Point ofs, dstOfs;
+};
+
+// the stripes are at least this much taller than the kernel, so that
+// the rows filtered twice at the stripe boundaries do not take much time
+enum { FILTER_STRIPE_KERNELS = 8, FILTER_STRIPE_MIN_ROWS = 32 };
+
+static bool canCloneFilters( const FilterEngine& f )
+{
+    if( f.isSeparable() )
+        return !f.rowFilter->clone().empty() && !f.columnFilter->clone().empty();
+    return !f.filter2D->clone().empty();
+}
+
 void FilterEngine::apply(const Mat& src, Mat& dst,
     const Rect& _srcRoi, Point dstOfs, bool isolated)
 {
+    CV_TRACE_REGION("cv::FilterEngine::apply");
     CV_Assert( src.type() == srcType && dst.type() == dstType );
 
     Rect srcRoi = _srcRoi;
@@ -441,13 +498,29 @@ void FilterEngine::apply(const Mat& src, Mat& dst,
 
     if( srcRoi.area() == 0 )
         return;
+    CV_TRACE_BYTES((size_t)srcRoi.area()*src.elemSize());
 
     CV_Assert( dstOfs.x >= 0 && dstOfs.y >= 0 &&
         dstOfs.x + srcRoi.width <= dst.cols &&
         dstOfs.y + srcRoi.height <= dst.rows );
 
+    int minStripeRows = std::max(ksize.height*FILTER_STRIPE_KERNELS, (int)FILTER_STRIPE_MIN_ROWS);
+    double nstripes = std::min(srcRoi.area()/(double)(1 << 16), (double)srcRoi.height/minStripeRows);
+    bool overlap = src.datastart < dst.dataend && dst.datastart < src.dataend;
+
+    if( nstripes >= 2 && getNumThreads() > 1 && !overlap && canCloneFilters(*this) )
+    {
+        Point ofs;
+        Size wsz(src.cols, src.rows);
+        if( !isolated )
+            src.locateROI( wsz, ofs );
+        parallel_for_(Range(0, srcRoi.height),
+                      FilterStripeInvoker(*this, src, dst, wsz, srcRoi + ofs, ofs, dstOfs), nstripes);
+        return;
+    }
+
     int y = start(src, srcRoi, isolated);
-    proceed( src.data + y*src.step, (int)src.step, endY - startY,
+    proceed( src.data + y*src.step + srcRoi.x*src.elemSize(), (int)src.step, endY - startY,
              dst.data + dstOfs.y*dst.step + dstOfs.x*dst.elemSize(), (int)dst.step );
 }
 
@@ -2218,6 +2291,8 @@ template<typename ST, typename DT, class VecOp> struct RowFilter : public BaseRo
         vecOp = _vecOp;
     }
 
+    Ptr<BaseRowFilter> clone() const { return Ptr<BaseRowFilter>(new RowFilter(*this)); }
+
     void operator()(const uchar* src, uchar* dst, int width, int cn)
     {
         int _ksize = ksize;
@@ -2276,6 +2351,8 @@ template<typename ST, typename DT, class VecOp> struct SymmRowSmallFilter :
         CV_Assert( (symmetryType & (KERNEL_SYMMETRICAL | KERNEL_ASYMMETRICAL)) != 0 && this->ksize <= 5 );
     }
 
+    Ptr<BaseRowFilter> clone() const { return Ptr<BaseRowFilter>(new SymmRowSmallFilter(*this)); }
+
     void operator()(const uchar* src, uchar* dst, int width, int cn)
     {
         int ksize2 = this->ksize/2, ksize2n = ksize2*cn;
@@ -2415,6 +2492,8 @@ template<class CastOp, class VecOp> struct ColumnFilter : public BaseColumnFilte
                    (kernel.rows == 1 || kernel.cols == 1));
     }
 
+    Ptr<BaseColumnFilter> clone() const { return Ptr<BaseColumnFilter>(new ColumnFilter(*this)); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         const ST* ky = (const ST*)kernel.data;
@@ -2478,6 +2557,8 @@ template<class CastOp, class VecOp> struct SymmColumnFilter : public ColumnFilte
         CV_Assert( (symmetryType & (KERNEL_SYMMETRICAL | KERNEL_ASYMMETRICAL)) != 0 );
     }
 
+    Ptr<BaseColumnFilter> clone() const { return Ptr<BaseColumnFilter>(new SymmColumnFilter(*this)); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int ksize2 = this->ksize/2;
@@ -2584,6 +2665,8 @@ struct SymmColumnSmallFilter : public SymmColumnFilter<CastOp, VecOp>
         CV_Assert( this->ksize == 3 );
     }
 
+    Ptr<BaseColumnFilter> clone() const { return Ptr<BaseColumnFilter>(new SymmColumnSmallFilter(*this)); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int ksize2 = this->ksize/2;
@@ -3060,6 +3143,8 @@ template<typename ST, class CastOp, class VecOp> struct Filter2D : public BaseFi
         ptrs.resize( coords.size() );
     }
 
+    Ptr<BaseFilter> clone() const { return Ptr<BaseFilter>(new Filter2D(*this)); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width, int cn)
     {
         KT _delta = delta;
@@ -3237,13 +3322,6 @@ void cv::filter2D( InputArray _src, OutputArray _dst, int ddepth,
     if( ddepth < 0 )
         ddepth = src.depth();
 
-#if CV_SSE2
-    int dft_filter_size = ((src.depth() == CV_8U && (ddepth == CV_8U || ddepth == CV_16S)) ||
-        (src.depth() == CV_32F && ddepth == CV_32F)) && checkHardwareSupport(CV_CPU_SSE3)? 130 : 50;
-#else
-    int dft_filter_size = 50;
-#endif
-
     _dst.create( src.size(), CV_MAKETYPE(ddepth, src.channels()) );
     Mat dst = _dst.getMat();
     anchor = normalizeAnchor(anchor, kernel.size());
@@ -3253,7 +3331,11 @@ void cv::filter2D( InputArray _src, OutputArray _dst, int ddepth,
         return;
 #endif
 
-    if( kernel.cols*kernel.rows >= dft_filter_size )
+    // the direct filter only processes the non-zero kernel elements
+    int nz = kernel.channels() == 1 ? countNonZero(kernel) : (int)kernel.total();
+    double directCost = (double)src.total()*src.channels()*std::max(nz, 1);
+
+    if( directCost > crossCorrCost(src.size(), kernel.size(), src.depth(), src.channels()) )
     {
         Mat temp;
         if( src.data != dst.data )
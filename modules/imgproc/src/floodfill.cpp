@@ -646,4 +646,370 @@ int cv::floodFill( InputOutputArray _image, InputOutputArray _mask,
     return cvRound(ccomp.area);
 }
 
+/****************************************************************************************\
+*                                  Multi-seed Floodfill                                  *
+\****************************************************************************************/
+
+/*
+   All the seeds are filled at once: the image is split into the horizontal stripes that are
+   labeled in parallel with union-find over the pixel indices (the neighbours within diff of
+   each other are connected, as in the floating range mode of floodFill with loDiff == upDiff),
+   the trees are united across the borders of the stripes, and the pixels of the trees with
+   a seed get the new value in a parallel pass. The cost does not depend on the number of seeds.
+*/
+
+namespace cv
+{
+
+enum { FF_STRIPE_MIN_ROWS = 32 };
+
+// the roots have P[i] == i, the other nodes point to a node with a smaller index
+static inline int ffFindRoot( const int* P, int i )
+{
+    while( P[i] < i )
+        i = P[i];
+    return i;
+}
+
+static inline void ffSetRoot( int* P, int i, int root )
+{
+    while( P[i] < i )
+    {
+        int j = P[i];
+        P[i] = root;
+        i = j;
+    }
+    P[i] = root;
+}
+
+static inline int ffUnion( int* P, int i, int j )
+{
+    int root = ffFindRoot(P, i);
+    if( i != j )
+    {
+        int rootj = ffFindRoot(P, j);
+        if( root > rootj )
+            root = rootj;
+        ffSetRoot(P, j, root);
+    }
+    ffSetRoot(P, i, root);
+    return root;
+}
+
+// joins the pixel i, which is in the tree of root or not joined yet (root == i), with the pixel j
+static inline int ffJoin( int* P, int i, int root, int j )
+{
+    if( root == i )
+        return ffFindRoot(P, j);
+    return P[j] == root ? root : ffUnion(P, root, j);
+}
+
+// the index of the seed of the pixel i, or -1; the roots of the filled trees are marked with -(seed+1)
+static inline int ffSeedOf( const int* P, int i )
+{
+    for(;;)
+    {
+        int v = P[i];
+        if( v < 0 )
+            return -v - 1;
+        if( v == i )
+            return -1;
+        i = v;
+    }
+}
+
+template<typename _Tp, class Diff>
+struct FloodFillLabelInvoker : ParallelLoopBody
+{
+    FloodFillLabelInvoker( const Mat& _img, int* _P, const int* _stripeRows,
+                           const Diff& _diff, int _connectivity )
+        : img(&_img), P(_P), stripeRows(_stripeRows), diff(_diff), connectivity(_connectivity)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int cols = img->cols;
+
+        for( int k = range.start; k < range.end; k++ )
+        {
+            int r0 = stripeRows[k], r1 = stripeRows[k+1];
+
+            for( int y = r0; y < r1; y++ )
+            {
+                const _Tp* row = img->ptr<_Tp>(y);
+                const _Tp* prow = y > r0 ? img->ptr<_Tp>(y-1) : 0;
+
+                for( int x = 0, i = y*cols; x < cols; x++, i++ )
+                {
+                    int root = i;
+                    if( x > 0 && diff(row + x, row + x - 1) )
+                        root = ffFindRoot(P, i - 1);
+                    if( prow )
+                    {
+                        if( diff(row + x, prow + x) )
+                            root = ffJoin(P, i, root, i - cols);
+                        if( connectivity == 8 )
+                        {
+                            if( x > 0 && diff(row + x, prow + x - 1) )
+                                root = ffJoin(P, i, root, i - cols - 1);
+                            if( x < cols - 1 && diff(row + x, prow + x + 1) )
+                                root = ffJoin(P, i, root, i - cols + 1);
+                        }
+                    }
+                    P[i] = root;
+                }
+            }
+
+            // make every pixel point to the root of its tree in the stripe
+            for( int i = r0*cols; i < r1*cols; i++ )
+                P[i] = P[P[i]];
+        }
+    }
+
+    const Mat* img;
+    int* P;
+    const int* stripeRows;
+    Diff diff;
+    int connectivity;
+};
+
+template<typename _Tp>
+struct FloodFillPaintInvoker : ParallelLoopBody
+{
+    FloodFillPaintInvoker( Mat& _img, const int* _P, const int* _stripeRows, const _Tp* _vals,
+                           bool _singleVal, int _nseeds, int* _areas, Vec4i* _bounds, Mutex& _mutex )
+        : img(&_img), P(_P), stripeRows(_stripeRows), vals(_vals), singleVal(_singleVal),
+          nseeds(_nseeds), areas(_areas), bounds(_bounds), mutex(&_mutex)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int cols = img->cols;
+        AutoBuffer<int> _area(nseeds);
+        AutoBuffer<Vec4i> _box(bounds ? nseeds : 1);
+        int* area = _area;
+        Vec4i* box = _box;
+
+        for( int k = range.start; k < range.end; k++ )
+        {
+            int r0 = stripeRows[k], r1 = stripeRows[k+1], s;
+
+            for( s = 0; s < nseeds; s++ )
+                area[s] = 0;
+            if( bounds )
+                for( s = 0; s < nseeds; s++ )
+                    box[s] = Vec4i(INT_MAX, INT_MAX, -1, -1);
+
+            for( int y = r0; y < r1; y++ )
+            {
+                _Tp* row = img->ptr<_Tp>(y);
+                int prevRoot = INT_MAX, prevSeed = -1;
+
+                for( int x = 0, i = y*cols; x < cols; x++, i++ )
+                {
+                    // the pixels of a run mostly point to the same root
+                    if( P[i] != prevRoot )
+                    {
+                        prevRoot = P[i];
+                        prevSeed = ffSeedOf(P, i);
+                    }
+                    if( (s = prevSeed) < 0 )
+                        continue;
+
+                    row[x] = vals[singleVal ? 0 : s];
+                    area[s]++;
+                    if( bounds )
+                    {
+                        Vec4i& b = box[s];
+                        b[0] = std::min(b[0], x); b[1] = std::min(b[1], y);
+                        b[2] = std::max(b[2], x); b[3] = std::max(b[3], y);
+                    }
+                }
+            }
+
+            AutoLock lock(*mutex);
+            for( s = 0; s < nseeds; s++ )
+            {
+                if( area[s] == 0 )
+                    continue;
+                areas[s] += area[s];
+                if( bounds )
+                {
+                    Vec4i& b = bounds[s];
+                    b[0] = std::min(b[0], box[s][0]); b[1] = std::min(b[1], box[s][1]);
+                    b[2] = std::max(b[2], box[s][2]); b[3] = std::max(b[3], box[s][3]);
+                }
+            }
+        }
+    }
+
+    Mat* img;
+    const int* P;
+    const int* stripeRows;
+    const _Tp* vals;
+    bool singleVal;
+    int nseeds;
+    int* areas;
+    Vec4i* bounds;
+    Mutex* mutex;
+};
+
+template<typename _Tp, class Diff> static int
+floodFillBatch_( Mat& img, const vector<Point>& seeds, const vector<Scalar>& newVals,
+                 vector<Rect>* rects, const Diff& diff, int connectivity )
+{
+    int rows = img.rows, cols = img.cols, nseeds = (int)seeds.size(), nvals = (int)newVals.size();
+    int i, k;
+
+    AutoBuffer<_Tp> _vals(nvals);
+    _Tp* vals = _vals;
+    for( k = 0; k < nvals; k++ )
+        scalarToRawData(newVals[k], &vals[k], img.type(), 0);
+
+    int nstripes = 1;
+    if( getNumThreads() > 1 )
+        nstripes = std::max(1, std::min(getNumThreads()*2, rows/FF_STRIPE_MIN_ROWS));
+    AutoBuffer<int> _stripeRows(nstripes + 1);
+    int* stripeRows = _stripeRows;
+    for( k = 0; k <= nstripes; k++ )
+        stripeRows[k] = (int)((int64)k*rows/nstripes);
+
+    Mat parent(img.size(), CV_32S);
+    int* P = parent.ptr<int>();
+
+    parallel_for_(Range(0, nstripes), FloodFillLabelInvoker<_Tp, Diff>(img, P, stripeRows, diff, connectivity),
+                  nstripes);
+
+    // unite the trees across the borders of the stripes; only the roots of the trees
+    // in the stripes are modified, so every pixel keeps pointing to the root of its stripe tree
+    for( k = 1; k < nstripes; k++ )
+    {
+        int y = stripeRows[k];
+        const _Tp* row = img.ptr<_Tp>(y);
+        const _Tp* prow = img.ptr<_Tp>(y-1);
+
+        for( int x = 0; x < cols; x++ )
+        {
+            i = y*cols + x;
+            if( diff(row + x, prow + x) )
+                ffUnion(P, P[i], P[i - cols]);
+            if( connectivity == 8 )
+            {
+                if( x > 0 && diff(row + x, prow + x - 1) )
+                    ffUnion(P, P[i], P[i - cols - 1]);
+                if( x < cols - 1 && diff(row + x, prow + x + 1) )
+                    ffUnion(P, P[i], P[i - cols + 1]);
+            }
+        }
+    }
+
+    // every united stripe root is the stripe root of some pixel next to a border,
+    // so after this every pixel is at most two steps away from the root of its component
+    for( k = 1; k < nstripes; k++ )
+        for( i = (stripeRows[k] - 1)*cols; i < (stripeRows[k] + 1)*cols; i++ )
+            ffSetRoot(P, i, ffFindRoot(P, i));
+
+    // mark the roots of the seed components, the first seed of a component takes it
+    for( k = 0; k < nseeds; k++ )
+    {
+        i = seeds[k].y*cols + seeds[k].x;
+        while( P[i] >= 0 && P[i] != i )
+            i = P[i];
+        if( P[i] >= 0 )
+            P[i] = -(k + 1);
+    }
+
+    AutoBuffer<int> _areas(nseeds);
+    int* areas = _areas;
+    for( k = 0; k < nseeds; k++ )
+        areas[k] = 0;
+    vector<Vec4i> bounds;
+    if( rects )
+        bounds.resize(nseeds, Vec4i(INT_MAX, INT_MAX, -1, -1));
+
+    Mutex mutex;
+    parallel_for_(Range(0, nstripes), FloodFillPaintInvoker<_Tp>(img, P, stripeRows, vals, nvals == 1, nseeds,
+                  areas, rects ? &bounds[0] : 0, mutex), nstripes);
+
+    int total = 0;
+    for( k = 0; k < nseeds; k++ )
+        total += areas[k];
+
+    if( rects )
+    {
+        rects->resize(nseeds);
+        for( k = 0; k < nseeds; k++ )
+        {
+            const Vec4i& b = bounds[k];
+            (*rects)[k] = areas[k] > 0 ? Rect(b[0], b[1], b[2] - b[0] + 1, b[3] - b[1] + 1) : Rect();
+        }
+    }
+    return total;
+}
+
+}
+
+int cv::floodFillBatch( InputOutputArray _image, const vector<Point>& seeds,
+                        const vector<Scalar>& newVals, vector<Rect>* rects,
+                        Scalar diff, int connectivity )
+{
+    Mat img = _image.getMat();
+    int type = img.type(), depth = img.depth(), cn = img.channels(), nseeds = (int)seeds.size();
+
+    if( connectivity == 0 )
+        connectivity = 4;
+    else if( connectivity != 4 && connectivity != 8 )
+        CV_Error( CV_StsBadFlag, "Connectivity must be 4, 0(=4) or 8" );
+
+    if( newVals.size() != 1 && (int)newVals.size() != nseeds )
+        CV_Error( CV_StsBadArg, "There must be one new value or a new value per seed" );
+
+    CV_Assert( (size_t)img.rows*img.cols <= (size_t)INT_MAX );
+
+    for( int i = 0; i < cn; i++ )
+        if( diff.val[i] < 0 )
+            CV_Error( CV_StsBadArg, "diff must be non-negative" );
+
+    for( int k = 0; k < nseeds; k++ )
+        if( (unsigned)seeds[k].x >= (unsigned)img.cols || (unsigned)seeds[k].y >= (unsigned)img.rows )
+            CV_Error( CV_StsOutOfRange, "Seed point is outside of image" );
+
+    if( rects )
+        rects->clear();
+    if( nseeds == 0 )
+        return 0;
+
+    Vec3b d8;
+    Vec3i d32s;
+    Vec3f d32f;
+    for( int i = 0; i < 3; i++ )
+    {
+        int t = cvFloor(diff.val[i]);
+        d8[i] = saturate_cast<uchar>(t);
+        d32s[i] = t;
+        d32f[i] = (float)diff.val[i];
+    }
+
+    if( depth != CV_8U && depth != CV_32S && depth != CV_32F )
+        CV_Error( CV_StsUnsupportedFormat, "" );
+
+    if( type == CV_8UC1 )
+        return floodFillBatch_<uchar>(img, seeds, newVals, rects, Diff8uC1(d8[0], d8[0]), connectivity);
+    if( type == CV_8UC3 )
+        return floodFillBatch_<Vec3b>(img, seeds, newVals, rects, Diff8uC3(d8, d8), connectivity);
+    if( type == CV_32SC1 )
+        return floodFillBatch_<int>(img, seeds, newVals, rects, Diff32sC1(d32s[0], d32s[0]), connectivity);
+    if( type == CV_32SC3 )
+        return floodFillBatch_<Vec3i>(img, seeds, newVals, rects, Diff32sC3(d32s, d32s), connectivity);
+    if( type == CV_32FC1 )
+        return floodFillBatch_<float>(img, seeds, newVals, rects, Diff32fC1(d32f[0], d32f[0]), connectivity);
+    if( type == CV_32FC3 )
+        return floodFillBatch_<Vec3f>(img, seeds, newVals, rects, Diff32fC3(d32f, d32f), connectivity);
+
+    CV_Error( CV_StsUnsupportedFormat, "" );
+    return 0;
+}
+
 /* End of file. */
@@ -259,21 +259,22 @@ class resizeNNInvoker :
     public ParallelLoopBody
 {
 public:
-    resizeNNInvoker(const Mat& _src, Mat &_dst, int *_x_ofs, int _pix_size4, double _ify) :
+    resizeNNInvoker(const Mat& _src, Mat &_dst, int *_x_ofs, int _pix_size4, double _ify,
+                    int _sy0, int _dy0, int _sheight) :
         ParallelLoopBody(), src(_src), dst(_dst), x_ofs(_x_ofs), pix_size4(_pix_size4),
-        ify(_ify)
+        ify(_ify), sy0(_sy0), dy0(_dy0), sheight(_sheight)
     {
     }
 
     virtual void operator() (const Range& range) const
     {
-        Size ssize = src.size(), dsize = dst.size();
+        Size dsize = dst.size();
         int y, x, pix_size = (int)src.elemSize();
 
         for( y = range.start; y < range.end; y++ )
         {
             uchar* D = dst.data + dst.step*y;
-            int sy = std::min(cvFloor(y*ify), ssize.height-1);
+            int sy = std::min(cvFloor((y + dy0)*ify), sheight-1) - sy0;
             const uchar* S = src.data + src.step*sy;
 
             switch( pix_size )
@@ -346,15 +347,17 @@ private:
     Mat dst;
     int* x_ofs, pix_size4;
     double ify;
+    int sy0, dy0, sheight;
 
     resizeNNInvoker(const resizeNNInvoker&);
     resizeNNInvoker& operator=(const resizeNNInvoker&);
 };
 
+// src and dst are at srcOfs and dstOfs of the whole images, the source is of ssize
 static void
-resizeNN( const Mat& src, Mat& dst, double fx, double fy )
+resizeNN( const Mat& src, Mat& dst, Point srcOfs, Size ssize, Point dstOfs, double fx, double fy )
 {
-    Size ssize = src.size(), dsize = dst.size();
+    Size dsize = dst.size();
     AutoBuffer<int> _x_ofs(dsize.width);
     int* x_ofs = _x_ofs;
     int pix_size = (int)src.elemSize();
@@ -364,12 +367,12 @@ resizeNN( const Mat& src, Mat& dst, double fx, double fy )
 
     for( x = 0; x < dsize.width; x++ )
     {
-        int sx = cvFloor(x*ifx);
-        x_ofs[x] = std::min(sx, ssize.width-1)*pix_size;
+        int sx = cvFloor((x + dstOfs.x)*ifx);
+        x_ofs[x] = (std::min(sx, ssize.width-1) - srcOfs.x)*pix_size;
     }
 
     Range range(0, dsize.height);
-    resizeNNInvoker invoker(src, dst, x_ofs, pix_size4, ify);
+    resizeNNInvoker invoker(src, dst, x_ofs, pix_size4, ify, srcOfs.y, dstOfs.y, ssize.height);
     parallel_for_(range, invoker, dst.total()/(double)(1<<16));
 }
 
@@ -1756,10 +1759,11 @@ typedef void (*ResizeAreaFunc)( const Mat& src, Mat& dst,
                                 const int* yofs);
 
 
-static int computeResizeAreaTab( int ssize, int dsize, int cn, double scale, DecimateAlpha* tab )
+// the coefficients of the destination pixels [dstart, dend)
+static int computeResizeAreaTab( int ssize, int dstart, int dend, int cn, double scale, DecimateAlpha* tab )
 {
     int k = 0;
-    for(int dx = 0; dx < dsize; dx++ )
+    for(int dx = dstart; dx < dend; dx++ )
     {
         double fsx1 = dx * scale;
         double fsx2 = fsx1 + scale;
@@ -1803,8 +1807,9 @@ static int computeResizeAreaTab( int ssize, int dsize, int cn, double scale, Dec
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
-                 double inv_scale_x, double inv_scale_y, int interpolation )
+void cv::resizeRegion( const Mat& src, const Rect& srcRect, Size ssize,
+                       Mat& dst, const Rect& dstRect,
+                       double inv_scale_x, double inv_scale_y, int interpolation )
 {
     static ResizeFunc linear_tab[] =
     {
@@ -1910,30 +1915,7 @@ void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
         resizeArea_<double, double>, 0
     };
 
-    Mat src = _src.getMat();
-    Size ssize = src.size();
-
-    CV_Assert( ssize.area() > 0 );
-    CV_Assert( dsize.area() || (inv_scale_x > 0 && inv_scale_y > 0) );
-    if( !dsize.area() )
-    {
-        dsize = Size(saturate_cast<int>(src.cols*inv_scale_x),
-            saturate_cast<int>(src.rows*inv_scale_y));
-        CV_Assert( dsize.area() );
-    }
-    else
-    {
-        inv_scale_x = (double)dsize.width/src.cols;
-        inv_scale_y = (double)dsize.height/src.rows;
-    }
-    _dst.create(dsize, src.type());
-    Mat dst = _dst.getMat();
-
-
-#ifdef HAVE_TEGRA_OPTIMIZATION
-    if (tegra::resize(src, dst, inv_scale_x, inv_scale_y, interpolation))
-        return;
-#endif
+    CV_Assert( src.size() == srcRect.size() && dst.size() == dstRect.size() );
 
     int depth = src.depth(), cn = src.channels();
     double scale_x = 1./inv_scale_x, scale_y = 1./inv_scale_y;
@@ -1941,7 +1923,7 @@ void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
 
     if( interpolation == INTER_NEAREST )
     {
-        resizeNN( src, dst, inv_scale_x, inv_scale_y );
+        resizeNN( src, dst, srcRect.tl(), ssize, dstRect.tl(), inv_scale_x, inv_scale_y );
         return;
     }
 
@@ -1963,9 +1945,14 @@ void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
         {
             if( is_area_fast )
             {
+                // the source blocks of the destination pixels, up to the image border
+                Rect r(dstRect.x*iscale_x, dstRect.y*iscale_y, 0, 0);
+                r.width = std::min((dstRect.x + dstRect.width)*iscale_x, ssize.width) - r.x;
+                r.height = std::min((dstRect.y + dstRect.height)*iscale_y, ssize.height) - r.y;
+                Mat src1 = src(r - srcRect.tl());
                 int area = iscale_x*iscale_y;
-                size_t srcstep = src.step / src.elemSize1();
-                AutoBuffer<int> _ofs(area + dsize.width*cn);
+                size_t srcstep = src1.step / src1.elemSize1();
+                AutoBuffer<int> _ofs(area + dst.cols*cn);
                 int* ofs = _ofs;
                 int* xofs = ofs + area;
                 ResizeAreaFastFunc func = areafast_tab[depth];
@@ -1975,7 +1962,7 @@ void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
                     for( sx = 0; sx < iscale_x; sx++ )
                         ofs[k++] = (int)(sy*srcstep + sx*cn);
 
-                for( dx = 0; dx < dsize.width; dx++ )
+                for( dx = 0; dx < dst.cols; dx++ )
                 {
                     int j = dx * cn;
                     sx = iscale_x * j;
@@ -1983,20 +1970,33 @@ void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
                         xofs[j + k] = sx + k;
                 }
 
-                func( src, dst, ofs, xofs, iscale_x, iscale_y );
+                func( src1, dst, ofs, xofs, iscale_x, iscale_y );
                 return;
             }
 
             ResizeAreaFunc func = area_tab[depth];
             CV_Assert( func != 0 && cn <= 4 );
 
-            AutoBuffer<DecimateAlpha> _xytab((ssize.width + ssize.height)*2);
-            DecimateAlpha* xtab = _xytab, *ytab = xtab + ssize.width*2;
+            int xtab_max = (srcRect.width + dstRect.width)*2, ytab_max = (srcRect.height + dstRect.height)*2;
+            AutoBuffer<DecimateAlpha> _xytab(xtab_max + ytab_max);
+            DecimateAlpha* xtab = _xytab, *ytab = xtab + xtab_max;
 
-            int xtab_size = computeResizeAreaTab(ssize.width, dsize.width, cn, scale_x, xtab);
-            int ytab_size = computeResizeAreaTab(ssize.height, dsize.height, 1, scale_y, ytab);
+            int xtab_size = computeResizeAreaTab(ssize.width, dstRect.x, dstRect.x + dstRect.width, cn, scale_x, xtab);
+            int ytab_size = computeResizeAreaTab(ssize.height, dstRect.y, dstRect.y + dstRect.height, 1, scale_y, ytab);
+
+            // the indices relative to src and dst
+            for( k = 0; k < xtab_size; k++ )
+            {
+                xtab[k].si -= srcRect.x*cn;
+                xtab[k].di -= dstRect.x*cn;
+            }
+            for( k = 0; k < ytab_size; k++ )
+            {
+                ytab[k].si -= srcRect.y;
+                ytab[k].di -= dstRect.y;
+            }
 
-            AutoBuffer<int> _tabofs(dsize.height + 1);
+            AutoBuffer<int> _tabofs(dstRect.height + 1);
             int* tabofs = _tabofs;
             for( k = 0, dy = 0; k < ytab_size; k++ )
             {
@@ -2013,7 +2013,7 @@ void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
         }
     }
 
-    int xmin = 0, xmax = dsize.width, width = dsize.width*cn;
+    int xmin = 0, xmax = dstRect.width, width = dstRect.width*cn;
     bool area_mode = interpolation == INTER_AREA;
     bool fixpt = depth == CV_8U;
     float fx, fy;
@@ -2031,27 +2031,28 @@ void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
 
     CV_Assert( func != 0 );
 
-    AutoBuffer<uchar> _buffer((width + dsize.height)*(sizeof(int) + sizeof(float)*ksize));
+    AutoBuffer<uchar> _buffer((width + dstRect.height)*(sizeof(int) + sizeof(float)*ksize));
     int* xofs = (int*)(uchar*)_buffer;
     int* yofs = xofs + width;
-    float* alpha = (float*)(yofs + dsize.height);
+    float* alpha = (float*)(yofs + dstRect.height);
     short* ialpha = (short*)alpha;
     float* beta = alpha + width*ksize;
     short* ibeta = ialpha + width*ksize;
     float cbuf[MAX_ESIZE];
 
-    for( dx = 0; dx < dsize.width; dx++ )
+    for( dx = 0; dx < dstRect.width; dx++ )
     {
+        int gx = dx + dstRect.x;
         if( !area_mode )
         {
-            fx = (float)((dx+0.5)*scale_x - 0.5);
+            fx = (float)((gx+0.5)*scale_x - 0.5);
             sx = cvFloor(fx);
             fx -= sx;
         }
         else
         {
-            sx = cvFloor(dx*scale_x);
-            fx = (float)((dx+1) - (sx+1)*inv_scale_x);
+            sx = cvFloor(gx*scale_x);
+            fx = (float)((gx+1) - (sx+1)*inv_scale_x);
             fx = fx <= 0 ? 0.f : fx - cvFloor(fx);
         }
 
@@ -2069,7 +2070,7 @@ void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
                 fx = 0, sx = ssize.width-1;
         }
 
-        for( k = 0, sx *= cn; k < cn; k++ )
+        for( k = 0, sx = (sx - srcRect.x)*cn; k < cn; k++ )
             xofs[dx*cn + k] = sx + k;
 
         if( interpolation == INTER_CUBIC )
@@ -2097,22 +2098,23 @@ void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
         }
     }
 
-    for( dy = 0; dy < dsize.height; dy++ )
+    for( dy = 0; dy < dstRect.height; dy++ )
     {
+        int gy = dy + dstRect.y;
         if( !area_mode )
         {
-            fy = (float)((dy+0.5)*scale_y - 0.5);
+            fy = (float)((gy+0.5)*scale_y - 0.5);
             sy = cvFloor(fy);
             fy -= sy;
         }
         else
         {
-            sy = cvFloor(dy*scale_y);
-            fy = (float)((dy+1) - (sy+1)*inv_scale_y);
+            sy = cvFloor(gy*scale_y);
+            fy = (float)((gy+1) - (sy+1)*inv_scale_y);
             fy = fy <= 0 ? 0.f : fy - cvFloor(fy);
         }
 
-        yofs[dy] = sy;
+        yofs[dy] = sy - srcRect.y;
         if( interpolation == INTER_CUBIC )
             interpolateCubic( fy, cbuf );
         else if( interpolation == INTER_LANCZOS4 )
@@ -2139,6 +2141,289 @@ void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
           fixpt ? (void*)ibeta : (void*)beta, xmin, xmax, ksize );
 }
 
+cv::Rect cv::resizeSrcRegion( const Rect& dstRect, Size ssize,
+                              double inv_scale_x, double inv_scale_y, int interpolation )
+{
+    double scale_x = 1./inv_scale_x, scale_y = 1./inv_scale_y;
+    int iscale_x = saturate_cast<int>(scale_x), iscale_y = saturate_cast<int>(scale_y);
+    bool is_area_fast = std::abs(scale_x - iscale_x) < DBL_EPSILON &&
+            std::abs(scale_y - iscale_y) < DBL_EPSILON;
+    int x1 = dstRect.x + dstRect.width, y1 = dstRect.y + dstRect.height;
+    Rect r;
+
+    if( interpolation == INTER_LINEAR && is_area_fast && iscale_x == 2 && iscale_y == 2 )
+        interpolation = INTER_AREA;
+
+    if( interpolation == INTER_NEAREST )
+        r = Rect(Point(cvFloor(dstRect.x*scale_x), cvFloor(dstRect.y*scale_y)),
+                 Point(cvFloor((x1 - 1)*scale_x) + 1, cvFloor((y1 - 1)*scale_y) + 1));
+    else if( interpolation == INTER_AREA && scale_x >= 1 && scale_y >= 1 )
+        r = Rect(Point(cvFloor(dstRect.x*scale_x) - 1, cvFloor(dstRect.y*scale_y) - 1),
+                 Point(cvCeil(x1*scale_x) + 1, cvCeil(y1*scale_y) + 1));
+    else
+    {
+        // the taps of the first and the last pixels, with a pixel more for the rounding errors
+        int ksize2 = interpolation == INTER_CUBIC ? 2 : interpolation == INTER_LANCZOS4 ? 4 : 1;
+        bool area_mode = interpolation == INTER_AREA;
+        double ax = area_mode ? 0 : 0.5*scale_x - 0.5, ay = area_mode ? 0 : 0.5*scale_y - 0.5;
+        r = Rect(Point(cvFloor(dstRect.x*scale_x + ax) - ksize2, cvFloor(dstRect.y*scale_y + ay) - ksize2),
+                 Point(cvFloor((x1 - 1)*scale_x + ax) + ksize2 + 2, cvFloor((y1 - 1)*scale_y + ay) + ksize2 + 2));
+    }
+    return r & Rect(Point(), ssize);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
+                 double inv_scale_x, double inv_scale_y, int interpolation )
+{
+    CV_TRACE_REGION("cv::resize");
+    Mat src = _src.getMat();
+    Size ssize = src.size();
+    CV_TRACE_BYTES(src.total()*src.elemSize());
+
+    CV_Assert( ssize.area() > 0 );
+    CV_Assert( dsize.area() || (inv_scale_x > 0 && inv_scale_y > 0) );
+    if( !dsize.area() )
+    {
+        dsize = Size(saturate_cast<int>(src.cols*inv_scale_x),
+            saturate_cast<int>(src.rows*inv_scale_y));
+        CV_Assert( dsize.area() );
+    }
+    else
+    {
+        inv_scale_x = (double)dsize.width/src.cols;
+        inv_scale_y = (double)dsize.height/src.rows;
+    }
+    _dst.create(dsize, src.type());
+    Mat dst = _dst.getMat();
+
+
+#ifdef HAVE_TEGRA_OPTIMIZATION
+    if (tegra::resize(src, dst, inv_scale_x, inv_scale_y, interpolation))
+        return;
+#endif
+
+    resizeRegion( src, Rect(Point(), ssize), ssize, dst, Rect(Point(), dsize),
+                  inv_scale_x, inv_scale_y, interpolation );
+}
+
+
+/****************************************************************************************\
+*                  Resize + channel swap + normalization to the planar float                *
+\****************************************************************************************/
+
+namespace cv
+{
+
+class BlobFromImageInvoker : public ParallelLoopBody
+{
+public:
+    BlobFromImageInvoker( const Mat& _src, Mat& _dst, const int* _xofs, const float* _xalpha,
+                          const int* _yofs, const float* _yalpha, const int* _chidx,
+                          const float* _scale, const float* _shift ) :
+        ParallelLoopBody(), src(_src), dst(_dst), xofs(_xofs), xalpha(_xalpha), yofs(_yofs),
+        yalpha(_yalpha), chidx(_chidx), scale(_scale), shift(_shift)
+    {
+        haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+    }
+
+    // resamples the source row horizontally into the planes of buf
+    void hresize( const uchar* S, float* buf ) const
+    {
+        int cn = src.channels(), dwidth = dst.size[3];
+
+        for( int c = 0; c < cn; c++, buf += dwidth )
+        {
+            const uchar* s = S + chidx[c];
+            for( int dx = 0; dx < dwidth; dx++ )
+            {
+                float t0 = s[xofs[dx*2]], t1 = s[xofs[dx*2+1]];
+                buf[dx] = t0 + (t1 - t0)*xalpha[dx];
+            }
+        }
+    }
+
+    virtual void operator() (const Range& range) const
+    {
+        int cn = src.channels(), dwidth = dst.size[3];
+        AutoBuffer<float> _buf(dwidth*cn*2);
+        float* rows[2] = { _buf, _buf + dwidth*cn };
+        int prevy[2] = { -1, -1 };
+
+        for( int dy = range.start; dy < range.end; dy++ )
+        {
+            int sy0 = yofs[dy*2], sy1 = yofs[dy*2+1];
+            float fy = yalpha[dy];
+
+            // the rows of the previous output row are reused when upscaling
+            if( prevy[0] != sy0 )
+            {
+                if( prevy[1] == sy0 )
+                {
+                    std::swap(rows[0], rows[1]);
+                    std::swap(prevy[0], prevy[1]);
+                }
+                else
+                {
+                    hresize(src.ptr(sy0), rows[0]);
+                    prevy[0] = sy0;
+                }
+            }
+            const float* R1 = rows[0];
+            if( sy1 != sy0 )
+            {
+                if( prevy[1] != sy1 )
+                {
+                    hresize(src.ptr(sy1), rows[1]);
+                    prevy[1] = sy1;
+                }
+                R1 = rows[1];
+            }
+
+            for( int c = 0; c < cn; c++ )
+            {
+                const float* r0 = rows[0] + c*dwidth;
+                const float* r1 = R1 + c*dwidth;
+                float* D = (float*)dst.ptr(0, c, dy);
+                float w0 = (1.f - fy)*scale[c], w1 = fy*scale[c], b = shift[c];
+                int dx = 0;
+
+            #if CV_SSE2
+                if( haveSSE2 )
+                {
+                    __m128 v_w0 = _mm_set1_ps(w0), v_w1 = _mm_set1_ps(w1), v_b = _mm_set1_ps(b);
+                    for( ; dx <= dwidth - 8; dx += 8 )
+                    {
+                        __m128 t0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(r0 + dx), v_w0),
+                                                          _mm_mul_ps(_mm_loadu_ps(r1 + dx), v_w1)), v_b);
+                        __m128 t1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(r0 + dx + 4), v_w0),
+                                                          _mm_mul_ps(_mm_loadu_ps(r1 + dx + 4), v_w1)), v_b);
+                        _mm_storeu_ps(D + dx, t0);
+                        _mm_storeu_ps(D + dx + 4, t1);
+                    }
+                }
+            #endif
+                for( ; dx < dwidth; dx++ )
+                    D[dx] = r0[dx]*w0 + r1[dx]*w1 + b;
+            }
+        }
+    }
+
+private:
+    const Mat& src;
+    Mat& dst;
+    const int* xofs;
+    const float* xalpha;
+    const int* yofs;
+    const float* yalpha;
+    const int* chidx;
+    const float* scale;
+    const float* shift;
+    bool haveSSE2;
+
+    BlobFromImageInvoker(const BlobFromImageInvoker&);
+    BlobFromImageInvoker& operator=(const BlobFromImageInvoker&);
+};
+
+}
+
+void cv::blobFromImage( InputArray _src, OutputArray _dst, Size dsize, double scalefactor,
+                        Scalar mean, Scalar stdDev, bool swapRB, int interpolation )
+{
+    Mat src = _src.getMat();
+    int cn = src.channels();
+
+    CV_Assert( !src.empty() && src.depth() == CV_8U && (cn == 1 || cn == 3 || cn == 4) );
+    if( dsize.area() == 0 )
+        dsize = src.size();
+
+    // the other methods resample in a separate pass
+    if( dsize != src.size() && interpolation != INTER_LINEAR && interpolation != INTER_NEAREST )
+    {
+        Mat temp;
+        resize(src, temp, dsize, 0, 0, interpolation);
+        src = temp;
+    }
+
+    int sz[] = { 1, cn, dsize.height, dsize.width };
+    _dst.create(4, sz, CV_32F);
+    Mat dst = _dst.getMat();
+
+    Size ssize = src.size();
+    double scale_x = 1./((double)dsize.width/ssize.width), scale_y = 1./((double)dsize.height/ssize.height);
+    AutoBuffer<int> _ofs(dsize.width*2 + dsize.height*2);
+    AutoBuffer<float> _alpha(dsize.width + dsize.height);
+    int* xofs = _ofs;
+    int* yofs = xofs + dsize.width*2;
+    float* xalpha = _alpha;
+    float* yalpha = xalpha + dsize.width;
+    int chidx[4];
+    float scale[4], shift[4];
+    int k;
+
+    // the same coordinates as in resize()
+    for( k = 0; k < dsize.width; k++ )
+    {
+        int sx;
+        float fx;
+        if( interpolation == INTER_NEAREST )
+        {
+            sx = std::min(cvFloor(k*scale_x), ssize.width - 1);
+            fx = 0.f;
+        }
+        else
+        {
+            fx = (float)((k + 0.5)*scale_x - 0.5);
+            sx = cvFloor(fx);
+            fx -= sx;
+            if( sx < 0 )
+                fx = 0, sx = 0;
+            if( sx >= ssize.width - 1 )
+                fx = 0, sx = ssize.width - 1;
+        }
+        xofs[k*2] = sx*cn;
+        xofs[k*2+1] = (fx > 0 ? sx + 1 : sx)*cn;
+        xalpha[k] = fx;
+    }
+
+    for( k = 0; k < dsize.height; k++ )
+    {
+        int sy;
+        float fy;
+        if( interpolation == INTER_NEAREST )
+        {
+            sy = std::min(cvFloor(k*scale_y), ssize.height - 1);
+            fy = 0.f;
+        }
+        else
+        {
+            fy = (float)((k + 0.5)*scale_y - 0.5);
+            sy = cvFloor(fy);
+            fy -= sy;
+            if( sy < 0 )
+                fy = 0, sy = 0;
+            if( sy >= ssize.height - 1 )
+                fy = 0, sy = ssize.height - 1;
+        }
+        yofs[k*2] = sy;
+        yofs[k*2+1] = fy > 0 ? sy + 1 : sy;
+        yalpha[k] = fy;
+    }
+
+    for( k = 0; k < cn; k++ )
+    {
+        CV_Assert( stdDev[k] != 0 );
+        chidx[k] = swapRB && cn >= 3 && k < 3 ? 2 - k : k;
+        scale[k] = (float)(scalefactor/stdDev[k]);
+        shift[k] = (float)(-mean[k]/stdDev[k]);
+    }
+
+    parallel_for_(Range(0, dsize.height), BlobFromImageInvoker(src, dst, xofs, xalpha, yofs, yalpha,
+                  chidx, scale, shift), dst.total()/(double)(1<<16));
+}
+
 
 /****************************************************************************************\
 *                       General warping (affine, perspective, remap)                     *
@@ -3323,6 +3608,464 @@ void cv::convertMaps( InputArray _map1, InputArray _map2,
     }
 }
 
+/****************************************************************************************\
+*                                      RemapPlan                                         *
+\****************************************************************************************/
+
+namespace cv
+{
+
+enum { REMAP_TILE_W = 64, REMAP_TILE_H = 16 };
+
+// the source offsets of the inner pixels point to the top-left tap,
+// the border pixels keep all the taps (-1 for the border value)
+static void remapPlanBilinear( const uchar* S0, int sstep, const int* O, const ushort* A,
+                               uchar* D, int n, int cn, const short* wtab, bool useSIMD )
+{
+    const int delta = INTER_REMAP_COEF_SCALE/2;
+    int x = 0;
+
+#if CV_SSE2
+    if( useSIMD )
+    {
+        __m128i z = _mm_setzero_si128(), v_delta = _mm_set1_epi32(delta);
+        if( cn == 1 )
+        {
+            for( ; x <= n - 4; x += 4 )
+            {
+                const uchar *S_0 = S0 + O[x], *S_1 = S0 + O[x+1], *S_2 = S0 + O[x+2], *S_3 = S0 + O[x+3];
+                const int *w0 = (const int*)(wtab + A[x]*4), *w1 = (const int*)(wtab + A[x+1]*4);
+                const int *w2 = (const int*)(wtab + A[x+2]*4), *w3 = (const int*)(wtab + A[x+3]*4);
+                __m128i t = _mm_setr_epi32((int)(*(const ushort*)S_0 | ((unsigned)*(const ushort*)S_1 << 16)),
+                                           (int)(*(const ushort*)S_2 | ((unsigned)*(const ushort*)S_3 << 16)), 0, 0);
+                __m128i b = _mm_setr_epi32((int)(*(const ushort*)(S_0 + sstep) | ((unsigned)*(const ushort*)(S_1 + sstep) << 16)),
+                                           (int)(*(const ushort*)(S_2 + sstep) | ((unsigned)*(const ushort*)(S_3 + sstep) << 16)), 0, 0);
+                t = _mm_unpacklo_epi8(t, z);
+                b = _mm_unpacklo_epi8(b, z);
+                __m128i s = _mm_add_epi32(_mm_madd_epi16(t, _mm_setr_epi32(w0[0], w1[0], w2[0], w3[0])),
+                                          _mm_madd_epi16(b, _mm_setr_epi32(w0[1], w1[1], w2[1], w3[1])));
+                s = _mm_srai_epi32(_mm_add_epi32(s, v_delta), INTER_REMAP_COEF_BITS);
+                s = _mm_packus_epi16(_mm_packs_epi32(s, z), z);
+                *(int*)(D + x) = _mm_cvtsi128_si32(s);
+            }
+        }
+        else if( cn == 3 )
+        {
+            for( ; x < n; x++ )
+            {
+                const uchar* S = S0 + O[x];
+                const int* w = (const int*)(wtab + A[x]*4);
+                // the left and the right pixels interleaved, without reading past them
+                __m128i t = _mm_unpacklo_epi8(_mm_cvtsi32_si128(*(const int*)S),
+                                              _mm_cvtsi32_si128(*(const ushort*)(S + 3) | (S[5] << 16)));
+                S += sstep;
+                __m128i b = _mm_unpacklo_epi8(_mm_cvtsi32_si128(*(const int*)S),
+                                              _mm_cvtsi32_si128(*(const ushort*)(S + 3) | (S[5] << 16)));
+                t = _mm_unpacklo_epi8(t, z);
+                b = _mm_unpacklo_epi8(b, z);
+                __m128i s = _mm_add_epi32(_mm_madd_epi16(t, _mm_set1_epi32(w[0])),
+                                          _mm_madd_epi16(b, _mm_set1_epi32(w[1])));
+                s = _mm_srai_epi32(_mm_add_epi32(s, v_delta), INTER_REMAP_COEF_BITS);
+                int v = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(s, z), z));
+                D[x*3] = (uchar)v; D[x*3+1] = (uchar)(v >> 8); D[x*3+2] = (uchar)(v >> 16);
+            }
+        }
+        else if( cn == 4 )
+        {
+            for( ; x < n; x++ )
+            {
+                const uchar* S = S0 + O[x];
+                const int* w = (const int*)(wtab + A[x]*4);
+                __m128i t = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)S), z);
+                __m128i b = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(S + sstep)), z);
+                t = _mm_unpacklo_epi16(t, _mm_srli_si128(t, 8));
+                b = _mm_unpacklo_epi16(b, _mm_srli_si128(b, 8));
+                __m128i s = _mm_add_epi32(_mm_madd_epi16(t, _mm_set1_epi32(w[0])),
+                                          _mm_madd_epi16(b, _mm_set1_epi32(w[1])));
+                s = _mm_srai_epi32(_mm_add_epi32(s, v_delta), INTER_REMAP_COEF_BITS);
+                *(int*)(D + x*4) = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(s, z), z));
+            }
+        }
+    }
+#else
+    (void)useSIMD;
+#endif
+
+    for( ; x < n; x++ )
+    {
+        const uchar* S = S0 + O[x];
+        const short* w = wtab + A[x]*4;
+        for( int k = 0; k < cn; k++ )
+        {
+            int v = S[k]*w[0] + S[k+cn]*w[1] + S[k+sstep]*w[2] + S[k+sstep+cn]*w[3];
+            D[x*cn + k] = saturate_cast<uchar>((v + delta) >> INTER_REMAP_COEF_BITS);
+        }
+    }
+}
+
+static void remapPlanBilinearBorder( const uchar* S0, const int* O, const ushort* A,
+                                     uchar* D, int n, int cn, const short* wtab, const uchar* cval )
+{
+    const int delta = INTER_REMAP_COEF_SCALE/2;
+    for( int x = 0; x < n; x++, O += 4, D += cn )
+    {
+        const short* w = wtab + A[x]*4;
+        for( int k = 0; k < cn; k++ )
+        {
+            int v0 = O[0] >= 0 ? S0[O[0] + k] : cval[k];
+            int v1 = O[1] >= 0 ? S0[O[1] + k] : cval[k];
+            int v2 = O[2] >= 0 ? S0[O[2] + k] : cval[k];
+            int v3 = O[3] >= 0 ? S0[O[3] + k] : cval[k];
+            D[k] = saturate_cast<uchar>((v0*w[0] + v1*w[1] + v2*w[2] + v3*w[3] + delta) >> INTER_REMAP_COEF_BITS);
+        }
+    }
+}
+
+static void remapPlanBicubic( const uchar* S0, int sstep, const int* O, const ushort* A,
+                              uchar* D, int n, int cn, const short* wtab, bool useSIMD )
+{
+    const int delta = INTER_REMAP_COEF_SCALE/2;
+    int x = 0;
+
+#if CV_SSE2
+    if( useSIMD )
+    {
+        __m128i z = _mm_setzero_si128(), v_delta = _mm_set1_epi32(delta);
+        if( cn == 1 )
+        {
+            for( ; x <= n - 4; x += 4 )
+            {
+                __m128i s[4];
+                for( int j = 0; j < 4; j++ )
+                {
+                    const uchar* S = S0 + O[x+j];
+                    const short* w = wtab + A[x+j]*16;
+                    __m128i r01 = _mm_setr_epi32(*(const int*)S, *(const int*)(S + sstep), 0, 0);
+                    __m128i r23 = _mm_setr_epi32(*(const int*)(S + sstep*2), *(const int*)(S + sstep*3), 0, 0);
+                    s[j] = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi8(r01, z), _mm_loadu_si128((const __m128i*)w)),
+                                         _mm_madd_epi16(_mm_unpacklo_epi8(r23, z), _mm_loadu_si128((const __m128i*)(w + 8))));
+                }
+                // horizontal sums of the 4 pixels
+                __m128i t0 = _mm_add_epi32(_mm_unpacklo_epi32(s[0], s[1]), _mm_unpackhi_epi32(s[0], s[1]));
+                __m128i t1 = _mm_add_epi32(_mm_unpacklo_epi32(s[2], s[3]), _mm_unpackhi_epi32(s[2], s[3]));
+                __m128i v = _mm_add_epi32(_mm_unpacklo_epi64(t0, t1), _mm_unpackhi_epi64(t0, t1));
+                v = _mm_srai_epi32(_mm_add_epi32(v, v_delta), INTER_REMAP_COEF_BITS);
+                *(int*)(D + x) = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(v, z), z));
+            }
+        }
+        else if( cn == 3 )
+        {
+            for( ; x < n; x++ )
+            {
+                const uchar* S = S0 + O[x];
+                const int* w = (const int*)(wtab + A[x]*16);
+                __m128i s = v_delta;
+                for( int i = 0; i < 4; i++, S += sstep, w += 2 )
+                {
+                    // the pixels 0,1 and 2,3 interleaved, without reading past them
+                    __m128i lo = _mm_unpacklo_epi8(_mm_cvtsi32_si128(*(const int*)S),
+                                                   _mm_cvtsi32_si128(*(const ushort*)(S + 3) | (S[5] << 16)));
+                    __m128i hi = _mm_unpacklo_epi8(_mm_cvtsi32_si128(*(const int*)(S + 6)),
+                                                   _mm_cvtsi32_si128(*(const ushort*)(S + 9) | (S[11] << 16)));
+                    s = _mm_add_epi32(s, _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi8(lo, z), _mm_set1_epi32(w[0])),
+                                                       _mm_madd_epi16(_mm_unpacklo_epi8(hi, z), _mm_set1_epi32(w[1]))));
+                }
+                s = _mm_srai_epi32(s, INTER_REMAP_COEF_BITS);
+                int v = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(s, z), z));
+                D[x*3] = (uchar)v; D[x*3+1] = (uchar)(v >> 8); D[x*3+2] = (uchar)(v >> 16);
+            }
+        }
+        else if( cn == 4 )
+        {
+            for( ; x < n; x++ )
+            {
+                const uchar* S = S0 + O[x];
+                const int* w = (const int*)(wtab + A[x]*16);
+                __m128i s = v_delta;
+                for( int i = 0; i < 4; i++, S += sstep, w += 2 )
+                {
+                    __m128i r = _mm_loadu_si128((const __m128i*)S);
+                    __m128i lo = _mm_unpacklo_epi8(r, z), hi = _mm_unpackhi_epi8(r, z);
+                    lo = _mm_unpacklo_epi16(lo, _mm_srli_si128(lo, 8));
+                    hi = _mm_unpacklo_epi16(hi, _mm_srli_si128(hi, 8));
+                    s = _mm_add_epi32(s, _mm_add_epi32(_mm_madd_epi16(lo, _mm_set1_epi32(w[0])),
+                                                       _mm_madd_epi16(hi, _mm_set1_epi32(w[1]))));
+                }
+                s = _mm_srai_epi32(s, INTER_REMAP_COEF_BITS);
+                *(int*)(D + x*4) = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(s, z), z));
+            }
+        }
+    }
+#else
+    (void)useSIMD;
+#endif
+
+    for( ; x < n; x++ )
+    {
+        const uchar* S = S0 + O[x];
+        const short* w = wtab + A[x]*16;
+        for( int k = 0; k < cn; k++ )
+        {
+            int v = 0;
+            for( int i = 0; i < 4; i++ )
+            {
+                const uchar* R = S + sstep*i + k;
+                v += R[0]*w[i*4] + R[cn]*w[i*4+1] + R[cn*2]*w[i*4+2] + R[cn*3]*w[i*4+3];
+            }
+            D[x*cn + k] = saturate_cast<uchar>((v + delta) >> INTER_REMAP_COEF_BITS);
+        }
+    }
+}
+
+static void remapPlanBicubicBorder( const uchar* S0, const int* O, const ushort* A,
+                                    uchar* D, int n, int cn, const short* wtab, const uchar* cval )
+{
+    const int delta = INTER_REMAP_COEF_SCALE/2;
+    for( int x = 0; x < n; x++, O += 8, D += cn )
+    {
+        const short* w = wtab + A[x]*16;
+        for( int k = 0; k < cn; k++ )
+        {
+            int cv = cval[k], sum = cv*INTER_REMAP_COEF_SCALE;
+            for( int i = 0; i < 4; i++ )
+            {
+                if( O[4+i] < 0 )
+                    continue;
+                const uchar* S = S0 + O[4+i] + k;
+                for( int j = 0; j < 4; j++ )
+                    if( O[j] >= 0 )
+                        sum += (S[O[j]] - cv)*w[i*4+j];
+            }
+            D[k] = saturate_cast<uchar>((sum + delta) >> INTER_REMAP_COEF_BITS);
+        }
+    }
+}
+
+class RemapPlanInvoker : public ParallelLoopBody
+{
+public:
+    RemapPlanInvoker(const Mat& _src, Mat& _dst, const Vec3i* _tiles, const int* _ofs,
+                     const ushort* _tabIdx, int _interpolation, const Scalar& _borderValue) :
+        ParallelLoopBody(), src(&_src), dst(&_dst), tiles(_tiles), ofs(_ofs), tabIdx(_tabIdx),
+        interpolation(_interpolation), borderValue(_borderValue)
+    {
+        haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+    }
+
+    virtual void operator() (const Range& range) const
+    {
+        int cn = src->channels(), sstep = (int)src->step;
+        int ntx = (dst->cols + REMAP_TILE_W - 1)/REMAP_TILE_W;
+        bool linear = interpolation == INTER_LINEAR;
+        const short* wtab = (const short*)initInterTab2D(interpolation, true);
+        uchar cval[4];
+        for( int k = 0; k < 4; k++ )
+            cval[k] = saturate_cast<uchar>(borderValue[k]);
+
+        for( int t = range.start; t < range.end; t++ )
+        {
+            int x0 = (t % ntx)*REMAP_TILE_W, y0 = (t / ntx)*REMAP_TILE_H;
+            int tw = std::min((int)REMAP_TILE_W, dst->cols - x0);
+            int th = std::min((int)REMAP_TILE_H, dst->rows - y0);
+            const int* O = ofs + tiles[t][0];
+            const ushort* A = tabIdx + tiles[t][1];
+            bool border = tiles[t][2] != 0;
+            int ostep = tw*(!border ? 1 : linear ? 4 : 8);
+
+            for( int y = 0; y < th; y++, O += ostep, A += tw )
+            {
+                uchar* D = dst->ptr(y0 + y) + x0*cn;
+                if( !border )
+                {
+                    if( linear )
+                        remapPlanBilinear(src->data, sstep, O, A, D, tw, cn, wtab, haveSSE2);
+                    else
+                        remapPlanBicubic(src->data, sstep, O, A, D, tw, cn, wtab, haveSSE2);
+                }
+                else if( linear )
+                    remapPlanBilinearBorder(src->data, O, A, D, tw, cn, wtab, cval);
+                else
+                    remapPlanBicubicBorder(src->data, O, A, D, tw, cn, wtab, cval);
+            }
+        }
+    }
+
+private:
+    const Mat* src;
+    Mat* dst;
+    const Vec3i* tiles;
+    const int* ofs;
+    const ushort* tabIdx;
+    int interpolation;
+    Scalar borderValue;
+    bool haveSSE2;
+};
+
+}
+
+cv::RemapPlan::RemapPlan() : stype(-1), interpolation(INTER_LINEAR), borderMode(BORDER_CONSTANT)
+{
+}
+
+cv::RemapPlan::RemapPlan( InputArray map1, InputArray map2, Size srcSize, int srcType,
+                          int _interpolation, int _borderMode, const Scalar& _borderValue )
+{
+    create(map1, map2, srcSize, srcType, _interpolation, _borderMode, _borderValue);
+}
+
+void cv::RemapPlan::create( InputArray _map1, InputArray _map2, Size srcSize, int srcType,
+                            int _interpolation, int _borderMode, const Scalar& _borderValue )
+{
+    Mat map1 = _map1.getMat(), map2 = _map2.getMat();
+    CV_Assert( map1.size().area() > 0 && srcSize.width > 0 && srcSize.height > 0 );
+    CV_Assert( !map2.data || map2.size() == map1.size() );
+
+    if( _interpolation == INTER_AREA )
+        _interpolation = INTER_LINEAR;
+
+    ssize = srcSize;
+    dsize = map1.size();
+    stype = srcType;
+    interpolation = _interpolation;
+    borderMode = _borderMode;
+    borderValue = _borderValue;
+    tiles.clear();
+    ofs.clear();
+    tabIdx.clear();
+
+    bool nn = interpolation == INTER_NEAREST;
+    if( map1.type() == CV_16SC2 && !map2.data )
+    {
+        xy = map1.clone();
+        fxy = nn ? Mat() : Mat::zeros(dsize, CV_16UC1);
+    }
+    else
+        convertMaps(map1, map2, xy, fxy, CV_16SC2, nn);
+
+    int depth = CV_MAT_DEPTH(stype), cn = CV_MAT_CN(stype);
+    if( depth != CV_8U || (cn != 1 && cn != 3 && cn != 4) ||
+        (interpolation != INTER_LINEAR && interpolation != INTER_CUBIC) ||
+        borderMode == BORDER_TRANSPARENT || (double)ssize.area()*cn >= INT_MAX/2 )
+        return;
+
+    initInterTab2D(interpolation, true);
+
+    bool linear = interpolation == INTER_LINEAR;
+    int width = ssize.width, height = ssize.height, sstep = width*cn;
+    int ksize = linear ? 2 : 4, anchor = linear ? 0 : 1;
+    int ntx = (dsize.width + REMAP_TILE_W - 1)/REMAP_TILE_W;
+    int nty = (dsize.height + REMAP_TILE_H - 1)/REMAP_TILE_H;
+
+    tiles.resize(ntx*nty);
+    tabIdx.resize(dsize.area());
+    ofs.reserve(dsize.area());
+    int npix = 0;
+
+    for( int t = 0; t < ntx*nty; t++ )
+    {
+        int x0 = (t % ntx)*REMAP_TILE_W, y0 = (t / ntx)*REMAP_TILE_H;
+        int x1 = std::min(x0 + REMAP_TILE_W, dsize.width), y1 = std::min(y0 + REMAP_TILE_H, dsize.height);
+        bool inside = true;
+
+        for( int y = y0; y < y1 && inside; y++ )
+        {
+            const short* XY = xy.ptr<short>(y);
+            for( int x = x0; x < x1; x++ )
+            {
+                int sx = XY[x*2] - anchor, sy = XY[x*2+1] - anchor;
+                if( sx < 0 || sx + ksize > width || sy < 0 || sy + ksize > height )
+                {
+                    inside = false;
+                    break;
+                }
+            }
+        }
+
+        tiles[t] = Vec3i((int)ofs.size(), npix, !inside);
+
+        for( int y = y0; y < y1; y++ )
+        {
+            const short* XY = xy.ptr<short>(y);
+            const ushort* FXY = fxy.ptr<ushort>(y);
+            for( int x = x0; x < x1; x++ )
+            {
+                int sx = XY[x*2] - anchor, sy = XY[x*2+1] - anchor;
+                tabIdx[npix++] = (ushort)(FXY[x] & (INTER_TAB_SIZE2-1));
+
+                if( inside )
+                {
+                    ofs.push_back(sy*sstep + sx*cn);
+                    continue;
+                }
+
+                int xofs[4], yofs[4];
+                if( borderMode == BORDER_CONSTANT &&
+                    (sx >= width || sx + ksize <= 0 || sy >= height || sy + ksize <= 0) )
+                {
+                    for( int k = 0; k < ksize; k++ )
+                        xofs[k] = yofs[k] = -1;
+                }
+                else
+                {
+                    for( int k = 0; k < ksize; k++ )
+                    {
+                        int xk = borderInterpolate(sx + k, width, borderMode);
+                        int yk = borderInterpolate(sy + k, height, borderMode);
+                        xofs[k] = xk >= 0 ? xk*cn : -1;
+                        yofs[k] = yk >= 0 ? yk*sstep : -1;
+                    }
+                }
+
+                if( linear )
+                {
+                    for( int i = 0; i < 2; i++ )
+                        for( int j = 0; j < 2; j++ )
+                            ofs.push_back(xofs[j] >= 0 && yofs[i] >= 0 ? yofs[i] + xofs[j] : -1);
+                }
+                else
+                {
+                    ofs.insert(ofs.end(), xofs, xofs + 4);
+                    ofs.insert(ofs.end(), yofs, yofs + 4);
+                }
+            }
+        }
+    }
+
+    // the maps are not needed anymore
+    xy.release();
+    fxy.release();
+}
+
+void cv::RemapPlan::operator()( InputArray _src, OutputArray _dst ) const
+{
+    Mat src = _src.getMat();
+    CV_Assert( !empty() && src.size() == ssize && src.type() == stype );
+
+    _dst.create( dsize, stype );
+    Mat dst = _dst.getMat();
+    if( dst.data == src.data )
+        src = src.clone();
+
+    if( tiles.empty() )
+    {
+        remap( src, dst, xy, fxy, interpolation, borderMode, borderValue );
+        return;
+    }
+
+    if( !src.isContinuous() )
+        src = src.clone();
+
+    RemapPlanInvoker invoker(src, dst, &tiles[0], ofs.empty() ? 0 : &ofs[0], &tabIdx[0],
+                             interpolation, borderValue);
+    parallel_for_(Range(0, (int)tiles.size()), invoker, dst.total()/(double)(1<<16));
+}
+
+cv::Size cv::RemapPlan::srcSize() const { return ssize; }
+
+cv::Size cv::RemapPlan::dstSize() const { return dsize; }
+
+bool cv::RemapPlan::empty() const { return dsize.area() == 0; }
+
 
 namespace cv
 {
@@ -67,14 +67,6 @@ template<typename T> struct MaxOp
     T operator ()(T a, T b) const { return std::max(a, b); }
 };
 
-#undef CV_MIN_8U
-#undef CV_MAX_8U
-#define CV_MIN_8U(a,b)       ((a) - CV_FAST_CAST_8U((a) - (b)))
-#define CV_MAX_8U(a,b)       ((a) + CV_FAST_CAST_8U((b) - (a)))
-
-template<> inline uchar MinOp<uchar>::operator ()(uchar a, uchar b) const { return CV_MIN_8U(a, b); }
-template<> inline uchar MaxOp<uchar>::operator ()(uchar a, uchar b) const { return CV_MAX_8U(a, b); }
-
 struct MorphRowNoVec
 {
     MorphRowNoVec(int, int) {}
@@ -92,6 +84,11 @@ struct MorphNoVec
     int operator()(uchar**, int, uchar*, int) const { return 0; }
 };
 
+struct MorphPairNoVec
+{
+    int operator()(const uchar*, const uchar*, uchar*, int) const { return 0; }
+};
+
 #if CV_SSE2
 
 template<class VecUpdate> struct MorphRowIVec
@@ -518,6 +515,71 @@ template<class VecUpdate> struct MorphFVec
     }
 };
 
+
+// dst[i] = op(a[i], b[i]), used by the van Herk/Gil-Werman filters
+template<class VecUpdate> struct MorphPairIVec
+{
+    enum { ESZ = VecUpdate::ESZ };
+
+    int operator()(const uchar* a, const uchar* b, uchar* dst, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        int i;
+        width *= ESZ;
+        VecUpdate updateOp;
+
+        for( i = 0; i <= width - 32; i += 32 )
+        {
+            __m128i s0 = _mm_loadu_si128((const __m128i*)(a + i));
+            __m128i s1 = _mm_loadu_si128((const __m128i*)(a + i + 16));
+            __m128i x0 = _mm_loadu_si128((const __m128i*)(b + i));
+            __m128i x1 = _mm_loadu_si128((const __m128i*)(b + i + 16));
+            _mm_storeu_si128((__m128i*)(dst + i), updateOp(s0, x0));
+            _mm_storeu_si128((__m128i*)(dst + i + 16), updateOp(s1, x1));
+        }
+
+        for( ; i <= width - 16; i += 16 )
+        {
+            __m128i s0 = _mm_loadu_si128((const __m128i*)(a + i));
+            __m128i x0 = _mm_loadu_si128((const __m128i*)(b + i));
+            _mm_storeu_si128((__m128i*)(dst + i), updateOp(s0, x0));
+        }
+
+        return i/ESZ;
+    }
+};
+
+
+template<class VecUpdate> struct MorphPairFVec
+{
+    int operator()(const uchar* _a, const uchar* _b, uchar* _dst, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE) )
+            return 0;
+
+        const float* a = (const float*)_a;
+        const float* b = (const float*)_b;
+        float* dst = (float*)_dst;
+        int i;
+        VecUpdate updateOp;
+
+        for( i = 0; i <= width - 8; i += 8 )
+        {
+            __m128 s0 = _mm_loadu_ps(a + i), s1 = _mm_loadu_ps(a + i + 4);
+            __m128 x0 = _mm_loadu_ps(b + i), x1 = _mm_loadu_ps(b + i + 4);
+            _mm_storeu_ps(dst + i, updateOp(s0, x0));
+            _mm_storeu_ps(dst + i + 4, updateOp(s1, x1));
+        }
+
+        for( ; i <= width - 4; i += 4 )
+            _mm_storeu_ps(dst + i, updateOp(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+
+        return i;
+    }
+};
+
 struct VMin8u
 {
     enum { ESZ = 1 };
@@ -582,6 +644,15 @@ typedef MorphIVec<VMax16s> DilateVec16s;
 typedef MorphFVec<VMin32f> ErodeVec32f;
 typedef MorphFVec<VMax32f> DilateVec32f;
 
+typedef MorphPairIVec<VMin8u> ErodePairVec8u;
+typedef MorphPairIVec<VMax8u> DilatePairVec8u;
+typedef MorphPairIVec<VMin16u> ErodePairVec16u;
+typedef MorphPairIVec<VMax16u> DilatePairVec16u;
+typedef MorphPairIVec<VMin16s> ErodePairVec16s;
+typedef MorphPairIVec<VMax16s> DilatePairVec16s;
+typedef MorphPairFVec<VMin32f> ErodePairVec32f;
+typedef MorphPairFVec<VMax32f> DilatePairVec32f;
+
 #else
 
 #ifdef HAVE_TEGRA_OPTIMIZATION
@@ -621,6 +692,15 @@ typedef MorphNoVec DilateVec16s;
 typedef MorphNoVec ErodeVec32f;
 typedef MorphNoVec DilateVec32f;
 
+typedef MorphPairNoVec ErodePairVec8u;
+typedef MorphPairNoVec DilatePairVec8u;
+typedef MorphPairNoVec ErodePairVec16u;
+typedef MorphPairNoVec DilatePairVec16u;
+typedef MorphPairNoVec ErodePairVec16s;
+typedef MorphPairNoVec DilatePairVec16s;
+typedef MorphPairNoVec ErodePairVec32f;
+typedef MorphPairNoVec DilatePairVec32f;
+
 #endif
 
 typedef MorphRowNoVec ErodeRowVec64f;
@@ -629,6 +709,8 @@ typedef MorphColumnNoVec ErodeColumnVec64f;
 typedef MorphColumnNoVec DilateColumnVec64f;
 typedef MorphNoVec ErodeVec64f;
 typedef MorphNoVec DilateVec64f;
+typedef MorphPairNoVec ErodePairVec64f;
+typedef MorphPairNoVec DilatePairVec64f;
 
 
 template<class Op, class VecOp> struct MorphRowFilter : public BaseRowFilter
@@ -641,6 +723,8 @@ template<class Op, class VecOp> struct MorphRowFilter : public BaseRowFilter
         anchor = _anchor;
     }
 
+    Ptr<BaseRowFilter> clone() const { return Ptr<BaseRowFilter>(new MorphRowFilter(*this)); }
+
     void operator()(const uchar* src, uchar* dst, int width, int cn)
     {
         int i, j, k, _ksize = ksize*cn;
@@ -695,6 +779,8 @@ template<class Op, class VecOp> struct MorphColumnFilter : public BaseColumnFilt
         anchor = _anchor;
     }
 
+    Ptr<BaseColumnFilter> clone() const { return Ptr<BaseColumnFilter>(new MorphColumnFilter(*this)); }
+
     void operator()(const uchar** _src, uchar* dst, int dststep, int count, int width)
     {
         int i, k, _ksize = ksize;
@@ -796,6 +882,8 @@ template<class Op, class VecOp> struct MorphFilter : BaseFilter
         ptrs.resize( coords.size() );
     }
 
+    Ptr<BaseFilter> clone() const { return Ptr<BaseFilter>(new MorphFilter(*this)); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width, int cn)
     {
         const Point* pt = &coords[0];
@@ -844,6 +932,317 @@ template<class Op, class VecOp> struct MorphFilter : BaseFilter
     VecOp vecOp;
 };
 
+
+/*
+   van Herk/Gil-Werman algorithm. The row is split into the blocks of ksize pixels and the running
+   minimums (maximums) are computed within each block from its start (g) and from its end (h).
+   A window of ksize pixels starting at x covers the end of one block and the start of the next one,
+   so the result is op(h[x], g[x + ksize - 1]): 3 operations per pixel regardless of ksize.
+*/
+template<class Op, class VecOp> struct MorphRowVHGWFilter : public BaseRowFilter
+{
+    typedef typename Op::rtype T;
+
+    MorphRowVHGWFilter( int _ksize, int _anchor )
+    {
+        ksize = _ksize;
+        anchor = _anchor;
+    }
+
+    Ptr<BaseRowFilter> clone() const { return Ptr<BaseRowFilter>(new MorphRowVHGWFilter(*this)); }
+
+    void operator()(const uchar* src, uchar* dst, int width, int cn)
+    {
+        int i, j, c, k = ksize*cn, n = (width + ksize - 1)*cn;
+        const T* S = (const T*)src;
+        T* D = (T*)dst;
+        Op op;
+
+        buf.resize(n*2);
+        T* g = &buf[0];
+        T* h = g + n;
+        width *= cn;
+
+        // g and h are computed together, so that the two dependency chains overlap
+        for( i = 0; i < width; i += k )
+        {
+            for( c = 0; c < cn; c++ )
+            {
+                const T *S0 = S + i + c, *S1 = S + i + k - cn + c;
+                T *g1 = g + i + c, *h1 = h + i + k - cn + c;
+                T gval = S0[0], hval = S1[0];
+                g1[0] = gval;
+                h1[0] = hval;
+                for( j = cn; j < k; j += cn )
+                {
+                    gval = op(gval, S0[j]);
+                    hval = op(hval, S1[-j]);
+                    g1[j] = gval;
+                    h1[-j] = hval;
+                }
+            }
+        }
+
+        // the last block is only needed from its start
+        for( ; i < n; i += k )
+        {
+            int i1 = std::min(i + k, n);
+            for( c = 0; c < cn; c++ )
+            {
+                T gval = S[i + c];
+                g[i + c] = gval;
+                for( j = i + cn + c; j < i1; j += cn )
+                {
+                    gval = op(gval, S[j]);
+                    g[j] = gval;
+                }
+            }
+        }
+
+        g += k - cn;
+        i = vecOp((const uchar*)h, (const uchar*)g, dst, width);
+        for( ; i < width; i++ )
+            D[i] = op(h[i], g[i]);
+    }
+
+    vector<T> buf;
+    VecOp vecOp;
+};
+
+
+/*
+   van Herk/Gil-Werman algorithm for the columns. The filter is called for a few rows at a time,
+   so it counts the output rows since reset() and keeps the running minimums (maximums) from the end
+   of the current block of ksize source rows (h) and from the start of the next one (g) between the calls.
+*/
+template<class Op, class VecOp> struct MorphColumnVHGWFilter : public BaseColumnFilter
+{
+    typedef typename Op::rtype T;
+
+    MorphColumnVHGWFilter( int _ksize, int _anchor ) : y(0)
+    {
+        ksize = _ksize;
+        anchor = _anchor;
+    }
+
+    Ptr<BaseColumnFilter> clone() const { return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter(*this)); }
+
+    void reset() { y = 0; }
+
+    void update( const T* a, const T* b, T* dst, int width ) const
+    {
+        Op op;
+        int i = vecOp((const uchar*)a, (const uchar*)b, (uchar*)dst, width);
+        for( ; i < width; i++ )
+            dst[i] = op(a[i], b[i]);
+    }
+
+    void operator()(const uchar** _src, uchar* dst, int dststep, int count, int width)
+    {
+        const T** src = (const T**)_src;
+        int k, _ksize = ksize;
+
+        if( buf.size() < (size_t)(_ksize + 1)*width )
+            buf.resize((size_t)(_ksize + 1)*width);
+        T* h = &buf[0];
+        T* g = h + (size_t)_ksize*width;
+
+        for( ; count > 0; count--, dst += dststep, src++, y++ )
+        {
+            int j = y % _ksize;
+            T* D = (T*)dst;
+
+            if( j == 0 )
+            {
+                // the source rows src[0] ... src[ksize-1] are the next block
+                T* hk = h + (size_t)(_ksize - 1)*width;
+                memcpy( hk, src[_ksize-1], width*sizeof(T) );
+                for( k = _ksize - 2; k >= 0; k--, hk -= width )
+                    update( src[k], hk, hk - width, width );
+                memcpy( D, h, width*sizeof(T) );
+            }
+            else
+            {
+                if( j == 1 )
+                    memcpy( g, src[_ksize-1], width*sizeof(T) );
+                else
+                    update( g, src[_ksize-1], g, width );
+                update( h + (size_t)j*width, g, D, width );
+            }
+        }
+    }
+
+    int y;
+    vector<T> buf;
+    VecOp vecOp;
+};
+
+
+/*
+   The structuring element, each row of which is a single run of non-zero elements (e.g. any convex
+   shape), is decomposed into the horizontal lines. When a source row enters the kernel window,
+   the minimums (maximums) of all its windows of 2, 4, 8 ... pixels are computed, each level from
+   the previous one, and kept until the row leaves the window. A line of len pixels,
+   2^k <= len < 2^(k+1), is the combination of two overlapping windows of 2^k pixels, so every
+   kernel row costs two vector operations per pixel whatever its length, and the source rows are
+   filtered once rather than once per kernel row.
+*/
+template<class Op, class VecOp> struct MorphLinesFilter : BaseFilter
+{
+    typedef typename Op::rtype T;
+
+    MorphLinesFilter( const Mat& _kernel, Point _anchor, const vector<Vec3i>& _lines )
+        : y(0), rowsReady(0), rowLen(0)
+    {
+        anchor = _anchor;
+        ksize = _kernel.size();
+        lines = _lines;
+        nlevels = 0;
+        for( size_t i = 0; i < lines.size(); i++ )
+            nlevels = std::max(nlevels, getLevel(lines[i][2]));
+    }
+
+    Ptr<BaseFilter> clone() const { return Ptr<BaseFilter>(new MorphLinesFilter(*this)); }
+
+    void reset() { y = rowsReady = 0; }
+
+    // the largest k such that 2^k <= len
+    static int getLevel( int len )
+    {
+        int k = 0;
+        while( (2 << k) <= len )
+            k++;
+        return k;
+    }
+
+    // the windows of 2^k pixels of the source row r, k = 1 ... nlevels
+    T* levelPtr( int r, int k )
+    {
+        return &buf[((size_t)(r % ksize.height)*nlevels + k - 1)*rowLen];
+    }
+
+    void apply( const T* a, const T* b, T* dst, int n )
+    {
+        Op op;
+        int i = vecOp((const uchar*)a, (const uchar*)b, (uchar*)dst, n);
+        for( ; i < n; i++ )
+            dst[i] = op(a[i], b[i]);
+    }
+
+    void operator()(const uchar** src, uchar* dst, int dststep, int count, int width, int cn)
+    {
+        int k, nlines = (int)lines.size(), _rowLen = (width + ksize.width - 1)*cn;
+        width *= cn;
+
+        if( rowLen != _rowLen )
+        {
+            rowLen = _rowLen;
+            buf.resize((size_t)ksize.height*nlevels*rowLen + width);
+            rowsReady = y;
+        }
+        T* B = &buf[(size_t)ksize.height*nlevels*rowLen];
+
+        for( ; count > 0; count--, dst += dststep, src++, y++ )
+        {
+            // the rows src[0] ... src[ksize.height-1] are the source rows y ... y + ksize.height - 1
+            for( ; rowsReady < y + ksize.height; rowsReady++ )
+            {
+                const T* prev = (const T*)src[rowsReady - y];
+                for( k = 1; k <= nlevels; k++ )
+                {
+                    T* cur = levelPtr(rowsReady, k);
+                    int half = (1 << (k - 1))*cn;
+                    apply(prev, prev + half, cur, rowLen - (half*2 - cn));
+                    prev = cur;
+                }
+            }
+
+            T* D = (T*)dst;
+            for( k = 0; k < nlines; k++ )
+            {
+                int len = lines[k][2], level = getLevel(len);
+                const T* S = level == 0 ? (const T*)src[lines[k][0]] : levelPtr(y + lines[k][0], level);
+                const T* a = S + lines[k][1]*cn;
+                const T* b = a + (len - (1 << level))*cn;
+
+                if( k == 0 )
+                {
+                    if( a == b )
+                        memcpy(D, a, width*sizeof(T));
+                    else
+                        apply(a, b, D, width);
+                }
+                else if( a == b )
+                    apply(D, a, D, width);
+                else
+                {
+                    apply(a, b, B, width);
+                    apply(D, B, D, width);
+                }
+            }
+        }
+    }
+
+    // (kernel row, the first non-zero element, the number of non-zero elements)
+    vector<Vec3i> lines;
+    int nlevels;
+    // the output rows since reset() and the number of source rows with the computed windows
+    int y, rowsReady;
+    int rowLen;
+    vector<T> buf;
+    VecOp vecOp;
+};
+
+// the kernel size from which the van Herk/Gil-Werman filters are used. The row filter computes
+// the running minimums without SIMD, so it pays off later for the types with more SIMD lanes.
+enum { MORPH_VHGW_MIN_COLUMN_KSIZE = 16 };
+
+static int getMorphologyVHGWMinRowKsize( int depth )
+{
+    return depth == CV_8U ? 48 : depth == CV_16U || depth == CV_16S ? 24 : depth == CV_32F ? 12 : 8;
+}
+
+// the kernel is decomposed into the lines when it is estimated to be at least this much cheaper
+static const double MORPH_LINES_MAX_COST = 0.6;
+
+/*
+   Finds the horizontal lines of the structuring element. Returns the estimated cost of the
+   decomposition relative to the direct filter, or a negative value if some row has several runs.
+*/
+static double getMorphologyLines( const Mat& kernel, vector<Vec3i>& lines )
+{
+    CV_Assert( kernel.type() == CV_8U );
+    int nz = 0, maxlen = 0;
+    double cost = 0;
+    lines.clear();
+
+    for( int i = 0; i < kernel.rows; i++ )
+    {
+        const uchar* krow = kernel.ptr(i);
+        int j = 0, j1;
+        while( j < kernel.cols && !krow[j] )
+            j++;
+        for( j1 = j; j1 < kernel.cols && krow[j1]; j1++ )
+            ;
+        if( j1 == j )
+            continue;
+        for( int j2 = j1; j2 < kernel.cols; j2++ )
+            if( krow[j2] )
+                return -1;
+        lines.push_back(Vec3i(i, j, j1 - j));
+        nz += j1 - j;
+        maxlen = std::max(maxlen, j1 - j);
+        // two windows per line, then the line is merged with the other lines
+        cost += 3;
+    }
+
+    // the windows of 2, 4, ... maxlen pixels of every source row
+    for( int len = 2; len <= maxlen; len *= 2 )
+        cost++;
+
+    return nz > 0 ? cost/nz : -1;
+}
+
 }
 
 /////////////////////////////////// External Interface /////////////////////////////////////
@@ -854,7 +1253,46 @@ cv::Ptr<cv::BaseRowFilter> cv::getMorphologyRowFilter(int op, int type, int ksiz
     if( anchor < 0 )
         anchor = ksize/2;
     CV_Assert( op == MORPH_ERODE || op == MORPH_DILATE );
-    if( op == MORPH_ERODE )
+    if( ksize >= getMorphologyVHGWMinRowKsize(depth) )
+    {
+        if( op == MORPH_ERODE )
+        {
+            if( depth == CV_8U )
+                return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MinOp<uchar>,
+                                          ErodePairVec8u>(ksize, anchor));
+            if( depth == CV_16U )
+                return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MinOp<ushort>,
+                                          ErodePairVec16u>(ksize, anchor));
+            if( depth == CV_16S )
+                return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MinOp<short>,
+                                          ErodePairVec16s>(ksize, anchor));
+            if( depth == CV_32F )
+                return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MinOp<float>,
+                                          ErodePairVec32f>(ksize, anchor));
+            if( depth == CV_64F )
+                return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MinOp<double>,
+                                          ErodePairVec64f>(ksize, anchor));
+        }
+        else
+        {
+            if( depth == CV_8U )
+                return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MaxOp<uchar>,
+                                          DilatePairVec8u>(ksize, anchor));
+            if( depth == CV_16U )
+                return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MaxOp<ushort>,
+                                          DilatePairVec16u>(ksize, anchor));
+            if( depth == CV_16S )
+                return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MaxOp<short>,
+                                          DilatePairVec16s>(ksize, anchor));
+            if( depth == CV_32F )
+                return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MaxOp<float>,
+                                          DilatePairVec32f>(ksize, anchor));
+            if( depth == CV_64F )
+                return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MaxOp<double>,
+                                          DilatePairVec64f>(ksize, anchor));
+        }
+    }
+    else if( op == MORPH_ERODE )
     {
         if( depth == CV_8U )
             return Ptr<BaseRowFilter>(new MorphRowFilter<MinOp<uchar>,
@@ -901,7 +1339,46 @@ cv::Ptr<cv::BaseColumnFilter> cv::getMorphologyColumnFilter(int op, int type, in
     if( anchor < 0 )
         anchor = ksize/2;
     CV_Assert( op == MORPH_ERODE || op == MORPH_DILATE );
-    if( op == MORPH_ERODE )
+    if( ksize >= (int)MORPH_VHGW_MIN_COLUMN_KSIZE )
+    {
+        if( op == MORPH_ERODE )
+        {
+            if( depth == CV_8U )
+                return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MinOp<uchar>,
+                                             ErodePairVec8u>(ksize, anchor));
+            if( depth == CV_16U )
+                return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MinOp<ushort>,
+                                             ErodePairVec16u>(ksize, anchor));
+            if( depth == CV_16S )
+                return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MinOp<short>,
+                                             ErodePairVec16s>(ksize, anchor));
+            if( depth == CV_32F )
+                return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MinOp<float>,
+                                             ErodePairVec32f>(ksize, anchor));
+            if( depth == CV_64F )
+                return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MinOp<double>,
+                                             ErodePairVec64f>(ksize, anchor));
+        }
+        else
+        {
+            if( depth == CV_8U )
+                return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MaxOp<uchar>,
+                                             DilatePairVec8u>(ksize, anchor));
+            if( depth == CV_16U )
+                return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MaxOp<ushort>,
+                                             DilatePairVec16u>(ksize, anchor));
+            if( depth == CV_16S )
+                return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MaxOp<short>,
+                                             DilatePairVec16s>(ksize, anchor));
+            if( depth == CV_32F )
+                return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MaxOp<float>,
+                                             DilatePairVec32f>(ksize, anchor));
+            if( depth == CV_64F )
+                return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MaxOp<double>,
+                                             DilatePairVec64f>(ksize, anchor));
+        }
+    }
+    else if( op == MORPH_ERODE )
     {
         if( depth == CV_8U )
             return Ptr<BaseColumnFilter>(new MorphColumnFilter<MinOp<uchar>,
@@ -949,7 +1426,39 @@ cv::Ptr<cv::BaseFilter> cv::getMorphologyFilter(int op, int type, InputArray _ke
     int depth = CV_MAT_DEPTH(type);
     anchor = normalizeAnchor(anchor, kernel.size());
     CV_Assert( op == MORPH_ERODE || op == MORPH_DILATE );
-    if( op == MORPH_ERODE )
+
+    vector<Vec3i> lines;
+    double cost = getMorphologyLines(kernel, lines);
+    if( cost >= 0 && cost < MORPH_LINES_MAX_COST )
+    {
+        if( op == MORPH_ERODE )
+        {
+            if( depth == CV_8U )
+                return Ptr<BaseFilter>(new MorphLinesFilter<MinOp<uchar>, ErodePairVec8u>(kernel, anchor, lines));
+            if( depth == CV_16U )
+                return Ptr<BaseFilter>(new MorphLinesFilter<MinOp<ushort>, ErodePairVec16u>(kernel, anchor, lines));
+            if( depth == CV_16S )
+                return Ptr<BaseFilter>(new MorphLinesFilter<MinOp<short>, ErodePairVec16s>(kernel, anchor, lines));
+            if( depth == CV_32F )
+                return Ptr<BaseFilter>(new MorphLinesFilter<MinOp<float>, ErodePairVec32f>(kernel, anchor, lines));
+            if( depth == CV_64F )
+                return Ptr<BaseFilter>(new MorphLinesFilter<MinOp<double>, ErodePairVec64f>(kernel, anchor, lines));
+        }
+        else
+        {
+            if( depth == CV_8U )
+                return Ptr<BaseFilter>(new MorphLinesFilter<MaxOp<uchar>, DilatePairVec8u>(kernel, anchor, lines));
+            if( depth == CV_16U )
+                return Ptr<BaseFilter>(new MorphLinesFilter<MaxOp<ushort>, DilatePairVec16u>(kernel, anchor, lines));
+            if( depth == CV_16S )
+                return Ptr<BaseFilter>(new MorphLinesFilter<MaxOp<short>, DilatePairVec16s>(kernel, anchor, lines));
+            if( depth == CV_32F )
+                return Ptr<BaseFilter>(new MorphLinesFilter<MaxOp<float>, DilatePairVec32f>(kernel, anchor, lines));
+            if( depth == CV_64F )
+                return Ptr<BaseFilter>(new MorphLinesFilter<MaxOp<double>, DilatePairVec64f>(kernel, anchor, lines));
+        }
+    }
+    else if( op == MORPH_ERODE )
     {
         if( depth == CV_8U )
             return Ptr<BaseFilter>(new MorphFilter<MinOp<uchar>, ErodeVec8u>(kernel, anchor));
@@ -1119,12 +1628,23 @@ public:
 
         f->apply( srcStripe, dstStripe );
         for( int i = 1; i < iterations; i++ )
-            f->apply( dstStripe, dstStripe );
+        {
+            // see morphOp() on the in-place processing
+            if( nStripes == 1 && !dstStripe.isSubmatrix() && getNumThreads() > 1 &&
+                dstStripe.total() >= (size_t)(1 << 17) )
+            {
+                dstStripe.copyTo(buf);
+                f->apply( buf, dstStripe );
+            }
+            else
+                f->apply( dstStripe, dstStripe );
+        }
     }
 
 private:
     Mat src;
     Mat dst;
+    mutable Mat buf;
     int nStripes;
     int iterations;
 
@@ -1172,6 +1692,13 @@ static void morphOp( int op, InputArray _src, OutputArray _dst,
         iterations = 1;
     }
 
+    // FilterEngine::apply filters the stripes in parallel only when the source and the destination
+    // do not overlap, so the source is copied for the in-place processing of a large image
+    // (unless it is an ROI, the pixels around which are used as the border)
+    if( src.data == dst.data && !src.isSubmatrix() && getNumThreads() > 1 &&
+        src.total() >= (size_t)(1 << 17) )
+        src = src.clone();
+
     int nStripes = 1;
 #if defined HAVE_TBB && defined HAVE_TEGRA_OPTIMIZATION
     if (src.data != dst.data && iterations == 1 &&  //NOTE: threads are not used for inplace processing
@@ -489,6 +489,13 @@ static Point2d weightedCentroid(InputArray _src, cv::Point peakLocation, cv::Siz
 }
 
 cv::Point2d cv::phaseCorrelate(InputArray _src1, InputArray _src2, InputArray _window, double* response)
+{
+    DFTPlan forward, inverse;
+    return phaseCorrelate(_src1, _src2, forward, inverse, _window, response);
+}
+
+cv::Point2d cv::phaseCorrelate(InputArray _src1, InputArray _src2, DFTPlan& forward, DFTPlan& inverse,
+                               InputArray _window, double* response)
 {
     Mat src1 = _src1.getMat();
     Mat src2 = _src2.getMat();
@@ -538,15 +545,21 @@ cv::Point2d cv::phaseCorrelate(InputArray _src1, InputArray _src2, InputArray _w
 
     // execute phase correlation equation
     // Reference: http://en.wikipedia.org/wiki/Phase_correlation
-    dft(padded1, FFT1, DFT_REAL_OUTPUT);
-    dft(padded2, FFT2, DFT_REAL_OUTPUT);
+    // both images are transformed with the same plan; the plans are kept between the calls
+    // as long as the padded size and the type stay the same
+    if( forward.size() != padded1.size() || forward.type() != padded1.type() || forward.flags() != DFT_REAL_OUTPUT )
+        forward.create(padded1.size(), padded1.type(), DFT_REAL_OUTPUT);
+    if( inverse.size() != padded1.size() || inverse.type() != padded1.type() || inverse.flags() != DFT_INVERSE )
+        inverse.create(padded1.size(), padded1.type(), DFT_INVERSE);
+    forward.apply(padded1, FFT1);
+    forward.apply(padded2, FFT2);
 
     mulSpectrums(FFT1, FFT2, P, 0, true);
 
     magSpectrums(P, Pm);
     divSpectrums(P, Pm, C, 0, false); // FF* / |FF*| (phase correlation equation completed here...)
 
-    idft(C, C); // gives us the nice peak shift location...
+    inverse.apply(C, C); // gives us the nice peak shift location...
 
     fftShift(C); // shift the energy to the center of the frame.
 
@@ -96,6 +96,18 @@ void crossCorr( const Mat& src, const Mat& templ, Mat& dst,
                 Size corrsize, int ctype,
                 Point anchor=Point(0,0), double delta=0,
                 int borderType=BORDER_REFLECT_101 );
+// the approximate cost of crossCorr(), in the multiply-adds of the direct filtering
+double crossCorrCost( Size corrsize, Size templsize, int depth, int cn );
+
+// resizes a part of the image: src holds the rectangle srcRect of the source of the size ssize,
+// which must include resizeSrcRegion(dstRect, ...), dst receives the rectangle dstRect of the result.
+// The result is the same as of the part of resize() with the same scales.
+void resizeRegion( const Mat& src, const Rect& srcRect, Size ssize,
+                   Mat& dst, const Rect& dstRect,
+                   double inv_scale_x, double inv_scale_y, int interpolation );
+// the part of the source, clipped by the image, needed to compute the rectangle of the result
+Rect resizeSrcRegion( const Rect& dstRect, Size ssize,
+                      double inv_scale_x, double inv_scale_y, int interpolation );
 
 }
 
@@ -177,15 +177,218 @@ struct PyrDownVec_32f
     }
 };
 
+// the sum of 5 rows with the weights 1 4 6 4 1 in 32 bits, for the 16-bit images
+static inline __m128i pyrDownSum_32s( const int** src, int x )
+{
+    __m128i r0 = _mm_load_si128((const __m128i*)(src[0] + x));
+    __m128i r1 = _mm_load_si128((const __m128i*)(src[1] + x));
+    __m128i r2 = _mm_load_si128((const __m128i*)(src[2] + x));
+    __m128i r3 = _mm_load_si128((const __m128i*)(src[3] + x));
+    __m128i r4 = _mm_load_si128((const __m128i*)(src[4] + x));
+    r0 = _mm_add_epi32(_mm_add_epi32(r0, r4), _mm_add_epi32(_mm_slli_epi32(r2, 2), _mm_slli_epi32(r2, 1)));
+    return _mm_add_epi32(r0, _mm_slli_epi32(_mm_add_epi32(r1, r3), 2));
+}
+
+struct PyrDownVec_32s16s
+{
+    int operator()(int** src, short* dst, int, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        int x = 0;
+        const int** rows = (const int**)src;
+        __m128i delta = _mm_set1_epi32(128);
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m128i t0 = _mm_srai_epi32(_mm_add_epi32(pyrDownSum_32s(rows, x), delta), 8);
+            __m128i t1 = _mm_srai_epi32(_mm_add_epi32(pyrDownSum_32s(rows, x + 4), delta), 8);
+            _mm_storeu_si128((__m128i*)(dst + x), _mm_packs_epi32(t0, t1));
+        }
+
+        return x;
+    }
+};
+
+struct PyrDownVec_32s16u
+{
+    int operator()(int** src, ushort* dst, int, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        int x = 0;
+        const int** rows = (const int**)src;
+        // the results are shifted to the signed range for _mm_packs_epi32 and back
+        __m128i delta = _mm_set1_epi32(128 - (32768 << 8)), sign = _mm_set1_epi16((short)0x8000);
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m128i t0 = _mm_srai_epi32(_mm_add_epi32(pyrDownSum_32s(rows, x), delta), 8);
+            __m128i t1 = _mm_srai_epi32(_mm_add_epi32(pyrDownSum_32s(rows, x + 4), delta), 8);
+            _mm_storeu_si128((__m128i*)(dst + x), _mm_xor_si128(_mm_packs_epi32(t0, t1), sign));
+        }
+
+        return x;
+    }
+};
+
+/*
+   The vertical pass of pyrUp: dst gets row0 + row1*6 + row2 and dst + dststep gets (row1 + row2)*4.
+   dststep is 0 for the last row of the odd-height images, so the first row is stored last.
+*/
+struct PyrUpVec_32s8u
+{
+    int operator()(int** src, uchar* dst, int dststep, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        int x = 0;
+        const int *row0 = src[0], *row1 = src[1], *row2 = src[2];
+        __m128i delta = _mm_set1_epi16(32);
+
+        // the sums are at most 8*8*255, so they fit in 16 bits
+        for( ; x <= width - 16; x += 16 )
+        {
+            __m128i r0, r1, r2, t0, t1, t2, t3;
+            r0 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row0 + x)),
+                                 _mm_load_si128((const __m128i*)(row0 + x + 4)));
+            r1 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row1 + x)),
+                                 _mm_load_si128((const __m128i*)(row1 + x + 4)));
+            r2 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row2 + x)),
+                                 _mm_load_si128((const __m128i*)(row2 + x + 4)));
+            t0 = _mm_add_epi16(_mm_add_epi16(r0, r2), _mm_add_epi16(_mm_slli_epi16(r1, 2), _mm_slli_epi16(r1, 1)));
+            t1 = _mm_slli_epi16(_mm_add_epi16(r1, r2), 2);
+            r0 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row0 + x + 8)),
+                                 _mm_load_si128((const __m128i*)(row0 + x + 12)));
+            r1 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row1 + x + 8)),
+                                 _mm_load_si128((const __m128i*)(row1 + x + 12)));
+            r2 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row2 + x + 8)),
+                                 _mm_load_si128((const __m128i*)(row2 + x + 12)));
+            t2 = _mm_add_epi16(_mm_add_epi16(r0, r2), _mm_add_epi16(_mm_slli_epi16(r1, 2), _mm_slli_epi16(r1, 1)));
+            t3 = _mm_slli_epi16(_mm_add_epi16(r1, r2), 2);
+            t0 = _mm_srli_epi16(_mm_add_epi16(t0, delta), 6);
+            t1 = _mm_srli_epi16(_mm_add_epi16(t1, delta), 6);
+            t2 = _mm_srli_epi16(_mm_add_epi16(t2, delta), 6);
+            t3 = _mm_srli_epi16(_mm_add_epi16(t3, delta), 6);
+            _mm_storeu_si128((__m128i*)(dst + dststep + x), _mm_packus_epi16(t1, t3));
+            _mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(t0, t2));
+        }
+
+        return x;
+    }
+};
+
+static inline void pyrUpSum_32s( const int** src, int x, __m128i& t0, __m128i& t1 )
+{
+    __m128i r0 = _mm_load_si128((const __m128i*)(src[0] + x));
+    __m128i r1 = _mm_load_si128((const __m128i*)(src[1] + x));
+    __m128i r2 = _mm_load_si128((const __m128i*)(src[2] + x));
+    t0 = _mm_add_epi32(_mm_add_epi32(r0, r2), _mm_add_epi32(_mm_slli_epi32(r1, 2), _mm_slli_epi32(r1, 1)));
+    t1 = _mm_slli_epi32(_mm_add_epi32(r1, r2), 2);
+}
+
+struct PyrUpVec_32s16s
+{
+    int operator()(int** src, short* dst, int dststep, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        int x = 0;
+        const int** rows = (const int**)src;
+        short* dst1 = (short*)((uchar*)dst + dststep);
+        __m128i delta = _mm_set1_epi32(32);
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m128i t0, t1, t2, t3;
+            pyrUpSum_32s(rows, x, t0, t1);
+            pyrUpSum_32s(rows, x + 4, t2, t3);
+            t0 = _mm_srai_epi32(_mm_add_epi32(t0, delta), 6);
+            t1 = _mm_srai_epi32(_mm_add_epi32(t1, delta), 6);
+            t2 = _mm_srai_epi32(_mm_add_epi32(t2, delta), 6);
+            t3 = _mm_srai_epi32(_mm_add_epi32(t3, delta), 6);
+            _mm_storeu_si128((__m128i*)(dst1 + x), _mm_packs_epi32(t1, t3));
+            _mm_storeu_si128((__m128i*)(dst + x), _mm_packs_epi32(t0, t2));
+        }
+
+        return x;
+    }
+};
+
+struct PyrUpVec_32s16u
+{
+    int operator()(int** src, ushort* dst, int dststep, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        int x = 0;
+        const int** rows = (const int**)src;
+        ushort* dst1 = (ushort*)((uchar*)dst + dststep);
+        __m128i delta = _mm_set1_epi32(32 - (32768 << 6)), sign = _mm_set1_epi16((short)0x8000);
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m128i t0, t1, t2, t3;
+            pyrUpSum_32s(rows, x, t0, t1);
+            pyrUpSum_32s(rows, x + 4, t2, t3);
+            t0 = _mm_srai_epi32(_mm_add_epi32(t0, delta), 6);
+            t1 = _mm_srai_epi32(_mm_add_epi32(t1, delta), 6);
+            t2 = _mm_srai_epi32(_mm_add_epi32(t2, delta), 6);
+            t3 = _mm_srai_epi32(_mm_add_epi32(t3, delta), 6);
+            _mm_storeu_si128((__m128i*)(dst1 + x), _mm_xor_si128(_mm_packs_epi32(t1, t3), sign));
+            _mm_storeu_si128((__m128i*)(dst + x), _mm_xor_si128(_mm_packs_epi32(t0, t2), sign));
+        }
+
+        return x;
+    }
+};
+
+struct PyrUpVec_32f
+{
+    int operator()(float** src, float* dst, int dststep, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE) )
+            return 0;
+
+        int x = 0;
+        const float *row0 = src[0], *row1 = src[1], *row2 = src[2];
+        float* dst1 = (float*)((uchar*)dst + dststep);
+        __m128 _4 = _mm_set1_ps(4.f), _6 = _mm_set1_ps(6.f), _scale = _mm_set1_ps(1.f/64);
+
+        for( ; x <= width - 4; x += 4 )
+        {
+            __m128 r0 = _mm_load_ps(row0 + x), r1 = _mm_load_ps(row1 + x), r2 = _mm_load_ps(row2 + x);
+            __m128 t0 = _mm_add_ps(_mm_add_ps(r0, _mm_mul_ps(r1, _6)), r2);
+            __m128 t1 = _mm_mul_ps(_mm_add_ps(r1, r2), _4);
+            _mm_storeu_ps(dst1 + x, _mm_mul_ps(t1, _scale));
+            _mm_storeu_ps(dst + x, _mm_mul_ps(t0, _scale));
+        }
+
+        return x;
+    }
+};
+
 #else
 
 typedef NoVec<int, uchar> PyrDownVec_32s8u;
+typedef NoVec<int, short> PyrDownVec_32s16s;
+typedef NoVec<int, ushort> PyrDownVec_32s16u;
 typedef NoVec<float, float> PyrDownVec_32f;
+typedef NoVec<int, uchar> PyrUpVec_32s8u;
+typedef NoVec<int, short> PyrUpVec_32s16s;
+typedef NoVec<int, ushort> PyrUpVec_32s16u;
+typedef NoVec<float, float> PyrUpVec_32f;
 
 #endif
 
+// pyrDown for the destination rows in range; the rows of the stripes are computed independently
 template<class CastOp, class VecOp> void
-pyrDown_( const Mat& _src, Mat& _dst, int borderType )
+pyrDownRows_( const Mat& _src, Mat& _dst, int borderType, const Range& range )
 {
     const int PD_SZ = 5;
     typedef typename CastOp::type1 WT;
@@ -205,7 +408,7 @@ pyrDown_( const Mat& _src, Mat& _dst, int borderType )
 
     CV_Assert( std::abs(dsize.width*2 - ssize.width) <= 2 &&
                std::abs(dsize.height*2 - ssize.height) <= 2 );
-    int k, x, sy0 = -PD_SZ/2, sy = sy0, width0 = std::min((ssize.width-PD_SZ/2-1)/2 + 1, dsize.width);
+    int k, x, sy0 = range.start*2 - PD_SZ/2, sy = sy0, width0 = std::min((ssize.width-PD_SZ/2-1)/2 + 1, dsize.width);
 
     for( x = 0; x <= PD_SZ+1; x++ )
     {
@@ -225,7 +428,7 @@ pyrDown_( const Mat& _src, Mat& _dst, int borderType )
     for( x = 0; x < dsize.width; x++ )
         tabM[x] = (x/cn)*2*cn + x % cn;
 
-    for( int y = 0; y < dsize.height; y++ )
+    for( int y = range.start; y < range.end; y++ )
     {
         T* dst = (T*)(_dst.data + _dst.step*y);
         WT *row0, *row1, *row2, *row3, *row4;
@@ -307,8 +510,9 @@ pyrDown_( const Mat& _src, Mat& _dst, int borderType )
 }
 
 
+// pyrUp for the source rows in range, i.e. for the destination rows range.start*2 ... range.end*2-1
 template<class CastOp, class VecOp> void
-pyrUp_( const Mat& _src, Mat& _dst, int)
+pyrUpRows_( const Mat& _src, Mat& _dst, int, const Range& range )
 {
     const int PU_SZ = 3;
     typedef typename CastOp::type1 WT;
@@ -327,7 +531,7 @@ pyrUp_( const Mat& _src, Mat& _dst, int)
 
     CV_Assert( std::abs(dsize.width - ssize.width*2) == dsize.width % 2 &&
                std::abs(dsize.height - ssize.height*2) == dsize.height % 2);
-    int k, x, sy0 = -PU_SZ/2, sy = sy0, width0 = ssize.width - 1;
+    int k, x, sy0 = range.start - PU_SZ/2, sy = sy0, width0 = ssize.width - 1;
 
     ssize.width *= cn;
     dsize.width *= cn;
@@ -336,7 +540,7 @@ pyrUp_( const Mat& _src, Mat& _dst, int)
     for( x = 0; x < ssize.width; x++ )
         dtab[x] = (x/cn)*2*cn + x % cn;
 
-    for( int y = 0; y < ssize.height; y++ )
+    for( int y = range.start; y < range.end; y++ )
     {
         T* dst0 = (T*)(_dst.data + _dst.step*y*2);
         T* dst1 = (T*)(_dst.data + _dst.step*(y*2+1));
@@ -387,7 +591,7 @@ pyrUp_( const Mat& _src, Mat& _dst, int)
             rows[k] = buf + ((y - PU_SZ/2 + k - sy0) % PU_SZ)*bufstep;
         row0 = rows[0]; row1 = rows[1]; row2 = rows[2];
 
-        x = vecOp(rows, dst0, (int)_dst.step, dsize.width);
+        x = vecOp(rows, dst0, (int)((uchar*)dst1 - (uchar*)dst0), dsize.width);
         for( ; x < dsize.width; x++ )
         {
             T t1 = castOp((row1[x] + row2[x])*4);
@@ -397,6 +601,58 @@ pyrUp_( const Mat& _src, Mat& _dst, int)
     }
 }
 
+template<class CastOp, class VecOp> class PyrDownInvoker : public ParallelLoopBody
+{
+public:
+    PyrDownInvoker( const Mat& _src, Mat& _dst, int _borderType )
+        : src(&_src), dst(&_dst), borderType(_borderType) {}
+
+    void operator()( const Range& range ) const
+    {
+        pyrDownRows_<CastOp, VecOp>(*src, *dst, borderType, range);
+    }
+
+private:
+    PyrDownInvoker& operator=(const PyrDownInvoker&); // to quiet MSVC
+
+    const Mat* src;
+    Mat* dst;
+    int borderType;
+};
+
+template<class CastOp, class VecOp> void
+pyrDown_( const Mat& src, Mat& dst, int borderType )
+{
+    parallel_for_(Range(0, dst.rows), PyrDownInvoker<CastOp, VecOp>(src, dst, borderType),
+                  dst.total()/(double)(1<<16));
+}
+
+template<class CastOp, class VecOp> class PyrUpInvoker : public ParallelLoopBody
+{
+public:
+    PyrUpInvoker( const Mat& _src, Mat& _dst, int _borderType )
+        : src(&_src), dst(&_dst), borderType(_borderType) {}
+
+    void operator()( const Range& range ) const
+    {
+        pyrUpRows_<CastOp, VecOp>(*src, *dst, borderType, range);
+    }
+
+private:
+    PyrUpInvoker& operator=(const PyrUpInvoker&); // to quiet MSVC
+
+    const Mat* src;
+    Mat* dst;
+    int borderType;
+};
+
+template<class CastOp, class VecOp> void
+pyrUp_( const Mat& src, Mat& dst, int borderType )
+{
+    parallel_for_(Range(0, src.rows), PyrUpInvoker<CastOp, VecOp>(src, dst, borderType),
+                  dst.total()/(double)(1<<16));
+}
+
 typedef void (*PyrFunc)(const Mat&, Mat&, int);
 
 }
@@ -418,9 +674,9 @@ void cv::pyrDown( InputArray _src, OutputArray _dst, const Size& _dsz, int borde
     if( depth == CV_8U )
         func = pyrDown_<FixPtCast<uchar, 8>, PyrDownVec_32s8u>;
     else if( depth == CV_16S )
-        func = pyrDown_<FixPtCast<short, 8>, NoVec<int, short> >;
+        func = pyrDown_<FixPtCast<short, 8>, PyrDownVec_32s16s>;
     else if( depth == CV_16U )
-        func = pyrDown_<FixPtCast<ushort, 8>, NoVec<int, ushort> >;
+        func = pyrDown_<FixPtCast<ushort, 8>, PyrDownVec_32s16u>;
     else if( depth == CV_32F )
         func = pyrDown_<FltCast<float, 8>, PyrDownVec_32f>;
     else if( depth == CV_64F )
@@ -446,13 +702,13 @@ void cv::pyrUp( InputArray _src, OutputArray _dst, const Size& _dsz, int borderT
     int depth = src.depth();
     PyrFunc func = 0;
     if( depth == CV_8U )
-        func = pyrUp_<FixPtCast<uchar, 6>, NoVec<int, uchar> >;
+        func = pyrUp_<FixPtCast<uchar, 6>, PyrUpVec_32s8u>;
     else if( depth == CV_16S )
-        func = pyrUp_<FixPtCast<short, 6>, NoVec<int, short> >;
+        func = pyrUp_<FixPtCast<short, 6>, PyrUpVec_32s16s>;
     else if( depth == CV_16U )
-        func = pyrUp_<FixPtCast<ushort, 6>, NoVec<int, ushort> >;
+        func = pyrUp_<FixPtCast<ushort, 6>, PyrUpVec_32s16u>;
     else if( depth == CV_32F )
-        func = pyrUp_<FltCast<float, 6>, NoVec<float, float> >;
+        func = pyrUp_<FltCast<float, 6>, PyrUpVec_32f>;
     else if( depth == CV_64F )
         func = pyrUp_<FltCast<double, 6>, NoVec<double, double> >;
     else
@@ -470,6 +726,97 @@ void cv::buildPyramid( InputArray _src, OutputArrayOfArrays _dst, int maxlevel,
         pyrDown( _dst.getMatRef(i-1), _dst.getMatRef(i), Size(), borderType );
 }
 
+cv::Pyramid::Pyramid() : scale(2), borderSize(0)
+{
+}
+
+cv::Pyramid::Pyramid( InputArray img, int _maxLevel, double _scaleFactor, int _border, int borderType )
+{
+    build(img, _maxLevel, _scaleFactor, _border, borderType);
+}
+
+void cv::Pyramid::build( InputArray _img, int _maxLevel, double _scaleFactor, int _border, int borderType )
+{
+    Mat img = _img.getMat();
+    CV_Assert( !img.empty() && img.dims <= 2 && _maxLevel >= 0 && _scaleFactor > 1 && _border >= 0 );
+
+    scale = _scaleFactor;
+    borderSize = _border;
+    layers.resize(_maxLevel + 1);
+    buffers.resize(_maxLevel + 1);
+
+    for( int level = 0; level <= _maxLevel; level++ )
+    {
+        Size sz = img.size();
+        if( level > 0 )
+        {
+            if( scale == 2 )
+                sz = Size((layers[level-1].cols + 1)/2, (layers[level-1].rows + 1)/2);
+            else
+            {
+                float s = 1.f/(float)std::pow(scale, (double)level);
+                sz = Size(cvRound(img.cols*s), cvRound(img.rows*s));
+            }
+            if( sz.width <= 0 || sz.height <= 0 )
+            {
+                layers.resize(level);
+                buffers.resize(level);
+                break;
+            }
+        }
+
+        Mat& buf = buffers[level];
+        if( level == 0 && borderSize > 0 && (borderType & BORDER_ISOLATED) == 0 )
+        {
+            // use the image itself if it already has enough pixels around
+            Size wholeSize;
+            Point ofs;
+            img.locateROI(wholeSize, ofs);
+            if( ofs.x >= borderSize && ofs.y >= borderSize &&
+                ofs.x + img.cols + borderSize <= wholeSize.width &&
+                ofs.y + img.rows + borderSize <= wholeSize.height )
+            {
+                layers[0] = img;
+                continue;
+            }
+        }
+        else if( level == 0 && borderSize == 0 )
+        {
+            layers[0] = img;
+            continue;
+        }
+
+        buf.create(sz.height + borderSize*2, sz.width + borderSize*2, img.type());
+        Mat& layer = layers[level];
+        layer = buf(Rect(borderSize, borderSize, sz.width, sz.height));
+
+        if( level == 0 )
+            copyMakeBorder(img, buf, borderSize, borderSize, borderSize, borderSize, borderType);
+        else
+        {
+            if( scale == 2 )
+                pyrDown(layers[level-1], layer, sz, borderType & ~BORDER_ISOLATED);
+            else
+                resize(layers[level-1], layer, sz, 0, 0, INTER_LINEAR);
+            if( borderSize > 0 )
+                copyMakeBorder(layer, buf, borderSize, borderSize, borderSize, borderSize,
+                               borderType | BORDER_ISOLATED);
+        }
+    }
+}
+
+const cv::Mat& cv::Pyramid::operator[]( int level ) const
+{
+    CV_Assert( (unsigned)level < layers.size() );
+    return layers[level];
+}
+
+const std::vector<cv::Mat>& cv::Pyramid::levels() const { return layers; }
+int cv::Pyramid::maxLevel() const { return (int)layers.size() - 1; }
+double cv::Pyramid::scaleFactor() const { return scale; }
+int cv::Pyramid::border() const { return borderSize; }
+bool cv::Pyramid::empty() const { return layers.empty(); }
+
 CV_IMPL void cvPyrDown( const void* srcarr, void* dstarr, int _filter )
 {
     cv::Mat src = cv::cvarrToMat(srcarr), dst = cv::cvarrToMat(dstarr);
@@ -74,6 +74,8 @@ template<typename T, typename ST> struct RowSum : public BaseRowFilter
         anchor = _anchor;
     }
 
+    Ptr<BaseRowFilter> clone() const { return Ptr<BaseRowFilter>(new RowSum(*this)); }
+
     void operator()(const uchar* src, uchar* dst, int width, int cn)
     {
         const T* S = (const T*)src;
@@ -109,6 +111,13 @@ template<typename ST, typename T> struct ColumnSum : public BaseColumnFilter
 
     void reset() { sumCount = 0; }
 
+    // the floating-point running sums depend on the row the filtering starts from
+    Ptr<BaseColumnFilter> clone() const
+    {
+        return DataType<ST>::depth >= CV_32F ? Ptr<BaseColumnFilter>() :
+            Ptr<BaseColumnFilter>(new ColumnSum(*this));
+    }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
@@ -209,6 +218,8 @@ template<> struct ColumnSum<int, uchar> : public BaseColumnFilter
 
     void reset() { sumCount = 0; }
 
+    Ptr<BaseColumnFilter> clone() const { return Ptr<BaseColumnFilter>(new ColumnSum(*this)); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
@@ -350,6 +361,8 @@ template<> struct ColumnSum<int, short> : public BaseColumnFilter
 
     void reset() { sumCount = 0; }
 
+    Ptr<BaseColumnFilter> clone() const { return Ptr<BaseColumnFilter>(new ColumnSum(*this)); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
@@ -488,6 +501,8 @@ template<> struct ColumnSum<int, ushort> : public BaseColumnFilter
 
     void reset() { sumCount = 0; }
 
+    Ptr<BaseColumnFilter> clone() const { return Ptr<BaseColumnFilter>(new ColumnSum(*this)); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
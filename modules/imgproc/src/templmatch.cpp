@@ -44,16 +44,207 @@
 namespace cv
 {
 
+static void getCrossCorrBlockSize( Size corrsize, Size templsize, Size& blocksize, Size& dftsize )
+{
+    const double blockScale = 4.5;
+    const int minBlockSize = 256;
+
+    blocksize.width = cvRound(templsize.width*blockScale);
+    blocksize.width = std::max( blocksize.width, minBlockSize - templsize.width + 1 );
+    blocksize.width = std::min( blocksize.width, corrsize.width );
+    blocksize.height = cvRound(templsize.height*blockScale);
+    blocksize.height = std::max( blocksize.height, minBlockSize - templsize.height + 1 );
+    blocksize.height = std::min( blocksize.height, corrsize.height );
+
+    dftsize.width = std::max(getOptimalDFTSize(blocksize.width + templsize.width - 1), 2);
+    dftsize.height = getOptimalDFTSize(blocksize.height + templsize.height - 1);
+    if( dftsize.width <= 0 || dftsize.height <= 0 )
+        CV_Error( CV_StsOutOfRange, "the input arrays are too big" );
+
+    // recompute block size
+    blocksize.width = dftsize.width - templsize.width + 1;
+    blocksize.width = MIN( blocksize.width, corrsize.width );
+    blocksize.height = dftsize.height - templsize.height + 1;
+    blocksize.height = MIN( blocksize.height, corrsize.height );
+}
+
+double crossCorrCost( Size corrsize, Size templsize, int depth, int cn )
+{
+    Size blocksize, dftsize;
+    getCrossCorrBlockSize( corrsize, templsize, blocksize, dftsize );
+
+    int tileCount = ((corrsize.width + blocksize.width - 1)/blocksize.width)*
+                    ((corrsize.height + blocksize.height - 1)/blocksize.height);
+    double n = (double)dftsize.width*dftsize.height;
+    // the forward and the inverse transforms of every tile; one operation of a transform
+    // costs about 3 multiply-adds of the direct filter in single precision and 6 in double
+    double scale = depth > CV_8S ? 6 : 3;
+    return scale*tileCount*cn*2*n*std::log(n)/std::log(2.);
+}
+
+// the plans do not change after they are created and the copies share them, so the plans of the
+// recently used tile sizes are kept for the subsequent calls; the results do not depend on the cache
+enum { CROSS_CORR_PLAN_CACHE_SIZE = 4 };
+
+static DFTPlan crossCorrPlans[CROSS_CORR_PLAN_CACHE_SIZE][2];
+static int crossCorrPlanIdx = 0;
+static Mutex crossCorrPlanMutex;
+
+static void getCrossCorrPlans( Size dftsize, int depth, DFTPlan& fwdPlan, DFTPlan& invPlan )
+{
+    {
+        AutoLock lock(crossCorrPlanMutex);
+        for( int i = 0; i < CROSS_CORR_PLAN_CACHE_SIZE; i++ )
+        {
+            const DFTPlan* plans = crossCorrPlans[i];
+            if( plans[0].size() == dftsize && plans[0].type() == depth )
+            {
+                fwdPlan = plans[0];
+                invPlan = plans[1];
+                return;
+            }
+        }
+    }
+
+    fwdPlan.create( dftsize, depth );
+    invPlan.create( dftsize, depth, DFT_INVERSE + DFT_SCALE );
+
+    AutoLock lock(crossCorrPlanMutex);
+    DFTPlan* plans = crossCorrPlans[crossCorrPlanIdx];
+    plans[0] = fwdPlan;
+    plans[1] = invPlan;
+    crossCorrPlanIdx = (crossCorrPlanIdx + 1) % CROSS_CORR_PLAN_CACHE_SIZE;
+}
+
+// computes the correlation in the tiles of corr; every call uses its own buffers,
+// the forward and the inverse transform plans of the tile size are shared
+class CrossCorrInvoker : public ParallelLoopBody
+{
+public:
+    CrossCorrInvoker( const Mat& _img0, Point _roiofs, const Mat& _dftTempl, Size _templsize,
+                      Mat& _corr, Size _blocksize, const DFTPlan& _fwdPlan, const DFTPlan& _invPlan,
+                      int _tileCountX, Point _anchor, double _delta, int _borderType )
+        : img0(&_img0), roiofs(_roiofs), dftTempl(&_dftTempl), templsize(_templsize), corr(&_corr),
+          blocksize(_blocksize), dftsize(_fwdPlan.size()), fwdPlan(&_fwdPlan), invPlan(&_invPlan),
+          tileCountX(_tileCountX), anchor(_anchor), delta(_delta), borderType(_borderType) {}
+
+    void operator()( const Range& range ) const
+    {
+        int depth = img0->depth(), cn = img0->channels();
+        int maxDepth = dftTempl->depth(), tcn = dftTempl->rows/dftsize.height;
+        int cdepth = corr->depth(), ccn = corr->channels();
+        Mat dftImg( dftsize, maxDepth );
+        std::vector<uchar> buf;
+        int i, k, bufSize = 0;
+
+        if( cn > 1 && depth != maxDepth )
+            bufSize = (blocksize.width + templsize.width - 1)*
+                (blocksize.height + templsize.height - 1)*CV_ELEM_SIZE(depth);
+
+        if( (ccn > 1 || cn > 1) && cdepth != maxDepth )
+            bufSize = std::max( bufSize, blocksize.width*blocksize.height*CV_ELEM_SIZE(cdepth));
+
+        buf.resize(bufSize);
+
+        for( i = range.start; i < range.end; i++ )
+        {
+            int x = (i%tileCountX)*blocksize.width;
+            int y = (i/tileCountX)*blocksize.height;
+
+            Size bsz(std::min(blocksize.width, corr->cols - x),
+                     std::min(blocksize.height, corr->rows - y));
+            Size dsz(bsz.width + templsize.width - 1, bsz.height + templsize.height - 1);
+            int x0 = x - anchor.x + roiofs.x, y0 = y - anchor.y + roiofs.y;
+            int x1 = std::max(0, x0), y1 = std::max(0, y0);
+            int x2 = std::min(img0->cols, x0 + dsz.width);
+            int y2 = std::min(img0->rows, y0 + dsz.height);
+            Mat src0(*img0, Range(y1, y2), Range(x1, x2));
+            Mat dst(dftImg, Rect(0, 0, dsz.width, dsz.height));
+            Mat dst1(dftImg, Rect(x1-x0, y1-y0, x2-x1, y2-y1));
+            Mat cdst(*corr, Rect(x, y, bsz.width, bsz.height));
+
+            for( k = 0; k < cn; k++ )
+            {
+                Mat src = src0;
+                dftImg = Scalar::all(0);
+
+                if( cn > 1 )
+                {
+                    src = depth == maxDepth ? dst1 : Mat(y2-y1, x2-x1, depth, &buf[0]);
+                    int pairs[] = {k, 0};
+                    mixChannels(&src0, 1, &src, 1, pairs, 1);
+                }
+
+                if( dst1.data != src.data )
+                    src.convertTo(dst1, dst1.depth());
+
+                if( x2 - x1 < dsz.width || y2 - y1 < dsz.height )
+                    copyMakeBorder(dst1, dst, y1-y0, dst.rows-dst1.rows-(y1-y0),
+                                   x1-x0, dst.cols-dst1.cols-(x1-x0), borderType);
+
+                fwdPlan->apply( dftImg, dftImg, dsz.height );
+                Mat dftTempl1(*dftTempl, Rect(0, tcn > 1 ? k*dftsize.height : 0,
+                                              dftsize.width, dftsize.height));
+                mulSpectrums(dftImg, dftTempl1, dftImg, 0, true);
+                invPlan->apply( dftImg, dftImg, bsz.height );
+
+                src = dftImg(Rect(0, 0, bsz.width, bsz.height));
+
+                if( ccn > 1 )
+                {
+                    if( cdepth != maxDepth )
+                    {
+                        Mat plane(bsz, cdepth, &buf[0]);
+                        src.convertTo(plane, cdepth, 1, delta);
+                        src = plane;
+                    }
+                    int pairs[] = {0, k};
+                    mixChannels(&src, 1, &cdst, 1, pairs, 1);
+                }
+                else
+                {
+                    if( k == 0 )
+                        src.convertTo(cdst, cdepth, 1, delta);
+                    else
+                    {
+                        if( maxDepth != cdepth )
+                        {
+                            Mat plane(bsz, cdepth, &buf[0]);
+                            src.convertTo(plane, cdepth);
+                            src = plane;
+                        }
+                        add(src, cdst, cdst);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    CrossCorrInvoker& operator=(const CrossCorrInvoker&); // to quiet MSVC
+
+    const Mat* img0;
+    Point roiofs;
+    const Mat* dftTempl;
+    Size templsize;
+    Mat* corr;
+    Size blocksize, dftsize;
+    const DFTPlan* fwdPlan;
+    const DFTPlan* invPlan;
+    int tileCountX;
+    Point anchor;
+    double delta;
+    int borderType;
+};
+
 void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
                 Size corrsize, int ctype,
                 Point anchor, double delta, int borderType )
 {
-    const double blockScale = 4.5;
-    const int minBlockSize = 256;
     std::vector<uchar> buf;
 
     Mat templ = _templ;
-    int depth = img.depth(), cn = img.channels();
+    int depth = img.depth();
     int tdepth = templ.depth(), tcn = templ.channels();
     int cdepth = CV_MAT_DEPTH(ctype), ccn = CV_MAT_CN(ctype);
 
@@ -75,43 +266,16 @@ void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
 
     int maxDepth = depth > CV_8S ? CV_64F : std::max(std::max(CV_32F, tdepth), cdepth);
     Size blocksize, dftsize;
+    getCrossCorrBlockSize( corr.size(), templ.size(), blocksize, dftsize );
 
-    blocksize.width = cvRound(templ.cols*blockScale);
-    blocksize.width = std::max( blocksize.width, minBlockSize - templ.cols + 1 );
-    blocksize.width = std::min( blocksize.width, corr.cols );
-    blocksize.height = cvRound(templ.rows*blockScale);
-    blocksize.height = std::max( blocksize.height, minBlockSize - templ.rows + 1 );
-    blocksize.height = std::min( blocksize.height, corr.rows );
-
-    dftsize.width = std::max(getOptimalDFTSize(blocksize.width + templ.cols - 1), 2);
-    dftsize.height = getOptimalDFTSize(blocksize.height + templ.rows - 1);
-    if( dftsize.width <= 0 || dftsize.height <= 0 )
-        CV_Error( CV_StsOutOfRange, "the input arrays are too big" );
-
-    // recompute block size
-    blocksize.width = dftsize.width - templ.cols + 1;
-    blocksize.width = MIN( blocksize.width, corr.cols );
-    blocksize.height = dftsize.height - templ.rows + 1;
-    blocksize.height = MIN( blocksize.height, corr.rows );
-
+    DFTPlan fwdPlan, invPlan;
+    getCrossCorrPlans( dftsize, maxDepth, fwdPlan, invPlan );
     Mat dftTempl( dftsize.height*tcn, dftsize.width, maxDepth );
-    Mat dftImg( dftsize, maxDepth );
-
-    int i, k, bufSize = 0;
     if( tcn > 1 && tdepth != maxDepth )
-        bufSize = templ.cols*templ.rows*CV_ELEM_SIZE(tdepth);
-
-    if( cn > 1 && depth != maxDepth )
-        bufSize = std::max( bufSize, (blocksize.width + templ.cols - 1)*
-            (blocksize.height + templ.rows - 1)*CV_ELEM_SIZE(depth));
-
-    if( (ccn > 1 || cn > 1) && cdepth != maxDepth )
-        bufSize = std::max( bufSize, blocksize.width*blocksize.height*CV_ELEM_SIZE(cdepth));
-
-    buf.resize(bufSize);
+        buf.resize(templ.cols*templ.rows*CV_ELEM_SIZE(tdepth));
 
     // compute DFT of each template plane
-    for( k = 0; k < tcn; k++ )
+    for( int k = 0; k < tcn; k++ )
     {
         int yofs = k*dftsize.height;
         Mat src = templ;
@@ -133,7 +297,7 @@ void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
             Mat part(dst, Range(0, templ.rows), Range(templ.cols, dst.cols));
             part = Scalar::all(0);
         }
-        dft(dst, dst, 0, templ.rows);
+        fwdPlan.apply(dst, dst, templ.rows);
     }
 
     int tileCountX = (corr.cols + blocksize.width - 1)/blocksize.width;
@@ -153,80 +317,486 @@ void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
     borderType |= BORDER_ISOLATED;
 
     // calculate correlation by blocks
-    for( i = 0; i < tileCount; i++ )
+    parallel_for_(Range(0, tileCount),
+                  CrossCorrInvoker(img0, roiofs, dftTempl, templ.size(), corr, blocksize,
+                                   fwdPlan, invPlan, tileCountX, anchor, delta, borderType),
+                  tileCount);
+}
+
+/*
+   The direct correlation of a single-channel image with a small template, by the rows of
+   the result. The 8-bit data is accumulated exactly in integers, two template columns per
+   _mm_madd_epi16; the floating-point data is accumulated in double precision, as crossCorr()
+   does. The accumulators of a block of the result row stay in the registers while the whole
+   template is applied.
+*/
+class DirectCorrInvoker : public ParallelLoopBody
+{
+public:
+    DirectCorrInvoker( const Mat& _img, const Mat& _templ, Mat& _corr )
+        : img(&_img), templ(&_templ), corr(&_corr) {}
+
+    void operator()( const Range& range ) const
     {
-        int x = (i%tileCountX)*blocksize.width;
-        int y = (i/tileCountX)*blocksize.height;
-
-        Size bsz(std::min(blocksize.width, corr.cols - x),
-                 std::min(blocksize.height, corr.rows - y));
-        Size dsz(bsz.width + templ.cols - 1, bsz.height + templ.rows - 1);
-        int x0 = x - anchor.x + roiofs.x, y0 = y - anchor.y + roiofs.y;
-        int x1 = std::max(0, x0), y1 = std::max(0, y0);
-        int x2 = std::min(img0.cols, x0 + dsz.width);
-        int y2 = std::min(img0.rows, y0 + dsz.height);
-        Mat src0(img0, Range(y1, y2), Range(x1, x2));
-        Mat dst(dftImg, Rect(0, 0, dsz.width, dsz.height));
-        Mat dst1(dftImg, Rect(x1-x0, y1-y0, x2-x1, y2-y1));
-        Mat cdst(corr, Rect(x, y, bsz.width, bsz.height));
-
-        for( k = 0; k < cn; k++ )
+        if( img->depth() == CV_8U )
+            corr8u(range);
+        else
+            corr32f(range);
+    }
+
+private:
+    void corr8u( const Range& range ) const
+    {
+        int width = corr->cols, trows = templ->rows, tcols = templ->cols;
+        int pairs = (tcols + 1)/2;
+        // the template columns 2*k and 2*k+1 packed as the 16-bit halves of w[k]
+        AutoBuffer<int> _w(trows*pairs), _acc(width);
+        int* w = _w;
+        int* acc = _acc;
+        int tx, ty, x, y;
+
+        for( ty = 0; ty < trows; ty++ )
         {
-            Mat src = src0;
-            dftImg = Scalar::all(0);
+            const uchar* T = templ->ptr(ty);
+            for( tx = 0; tx < tcols; tx += 2 )
+                w[ty*pairs + tx/2] = T[tx] | ((tx + 1 < tcols ? T[tx+1] : 0) << 16);
+        }
 
-            if( cn > 1 )
+#if CV_SSE2
+        bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+#endif
+
+        for( y = range.start; y < range.end; y++ )
+        {
+            float* D = corr->ptr<float>(y);
+            x = 0;
+#if CV_SSE2
+            if( haveSSE2 )
+            {
+                __m128i z = _mm_setzero_si128();
+                for( ; x <= width - 8; x += 8 )
+                {
+                    __m128i s0 = z, s1 = z;
+                    for( ty = 0; ty < trows; ty++ )
+                    {
+                        const uchar* S = img->ptr(y + ty) + x;
+                        const int* wrow = w + ty*pairs;
+                        for( tx = 0; tx < tcols; tx += 2 )
+                        {
+                            // the odd last column has zero weight, its pixels are not read
+                            const uchar* S1 = tx + 1 < tcols ? S + tx + 1 : S + tx;
+                            __m128i wk = _mm_set1_epi32(wrow[tx/2]);
+                            __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(S + tx)), z);
+                            __m128i b = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)S1), z);
+                            s0 = _mm_add_epi32(s0, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), wk));
+                            s1 = _mm_add_epi32(s1, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), wk));
+                        }
+                    }
+                    _mm_storeu_ps(D + x, _mm_cvtepi32_ps(s0));
+                    _mm_storeu_ps(D + x + 4, _mm_cvtepi32_ps(s1));
+                }
+            }
+#endif
+            if( x < width )
             {
-                src = depth == maxDepth ? dst1 : Mat(y2-y1, x2-x1, depth, &buf[0]);
-                int pairs[] = {k, 0};
-                mixChannels(&src0, 1, &src, 1, pairs, 1);
+                for( int i = x; i < width; i++ )
+                    acc[i] = 0;
+                for( ty = 0; ty < trows; ty++ )
+                {
+                    const uchar* S = img->ptr(y + ty);
+                    const uchar* T = templ->ptr(ty);
+                    for( tx = 0; tx < tcols; tx++ )
+                    {
+                        int t = T[tx];
+                        for( int i = x; i < width; i++ )
+                            acc[i] += S[i + tx]*t;
+                    }
+                }
+                for( ; x < width; x++ )
+                    D[x] = (float)acc[x];
             }
+        }
+    }
 
-            if( dst1.data != src.data )
-                src.convertTo(dst1, dst1.depth());
-
-            if( x2 - x1 < dsz.width || y2 - y1 < dsz.height )
-                copyMakeBorder(dst1, dst, y1-y0, dst.rows-dst1.rows-(y1-y0),
-                               x1-x0, dst.cols-dst1.cols-(x1-x0), borderType);
+    void corr32f( const Range& range ) const
+    {
+        int width = corr->cols, trows = templ->rows, tcols = templ->cols;
+        AutoBuffer<double> _w(trows*tcols), _acc(width);
+        double* w = _w;
+        double* acc = _acc;
+        int tx, ty, x, y;
 
-            dft( dftImg, dftImg, 0, dsz.height );
-            Mat dftTempl1(dftTempl, Rect(0, tcn > 1 ? k*dftsize.height : 0,
-                                         dftsize.width, dftsize.height));
-            mulSpectrums(dftImg, dftTempl1, dftImg, 0, true);
-            dft( dftImg, dftImg, DFT_INVERSE + DFT_SCALE, bsz.height );
+        for( ty = 0; ty < trows; ty++ )
+        {
+            const float* T = templ->ptr<float>(ty);
+            for( tx = 0; tx < tcols; tx++ )
+                w[ty*tcols + tx] = T[tx];
+        }
 
-            src = dftImg(Rect(0, 0, bsz.width, bsz.height));
+#if CV_SSE2
+        bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+#endif
 
-            if( ccn > 1 )
+        for( y = range.start; y < range.end; y++ )
+        {
+            float* D = corr->ptr<float>(y);
+            x = 0;
+#if CV_SSE2
+            if( haveSSE2 )
             {
-                if( cdepth != maxDepth )
+                for( ; x <= width - 4; x += 4 )
                 {
-                    Mat plane(bsz, cdepth, &buf[0]);
-                    src.convertTo(plane, cdepth, 1, delta);
-                    src = plane;
+                    __m128d s0 = _mm_setzero_pd(), s1 = s0;
+                    for( ty = 0; ty < trows; ty++ )
+                    {
+                        const float* S = img->ptr<float>(y + ty) + x;
+                        const double* wrow = w + ty*tcols;
+                        for( tx = 0; tx < tcols; tx++ )
+                        {
+                            __m128 a = _mm_loadu_ps(S + tx);
+                            __m128d wk = _mm_set1_pd(wrow[tx]);
+                            s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_cvtps_pd(a), wk));
+                            s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(a, a)), wk));
+                        }
+                    }
+                    _mm_storeu_ps(D + x, _mm_movelh_ps(_mm_cvtpd_ps(s0), _mm_cvtpd_ps(s1)));
                 }
-                int pairs[] = {0, k};
-                mixChannels(&src, 1, &cdst, 1, pairs, 1);
             }
-            else
+#endif
+            if( x < width )
             {
-                if( k == 0 )
-                    src.convertTo(cdst, cdepth, 1, delta);
-                else
+                for( int i = x; i < width; i++ )
+                    acc[i] = 0;
+                for( ty = 0; ty < trows; ty++ )
                 {
-                    if( maxDepth != cdepth )
+                    const float* S = img->ptr<float>(y + ty);
+                    const double* wrow = w + ty*tcols;
+                    for( tx = 0; tx < tcols; tx++ )
                     {
-                        Mat plane(bsz, cdepth, &buf[0]);
-                        src.convertTo(plane, cdepth);
-                        src = plane;
+                        double t = wrow[tx];
+                        for( int i = x; i < width; i++ )
+                            acc[i] += S[i + tx]*t;
                     }
-                    add(src, cdst, cdst);
                 }
+                for( ; x < width; x++ )
+                    D[x] = (float)acc[x];
             }
         }
     }
+
+    DirectCorrInvoker& operator=(const DirectCorrInvoker&);
+
+    const Mat* img;
+    const Mat* templ;
+    Mat* corr;
+};
+
+/*
+   Decides whether matchTemplate() correlates directly. The direct code handles single-channel
+   images; with 8-bit data the sums must also fit the integer accumulators. The costs of
+   a direct multiply-add in the units of crossCorrCost() are measured ones: the 8-bit code
+   does twice as many per instruction and needs no conversions.
+*/
+static bool useDirectCorr( const Mat& img, const Mat& templ, Size corrsize )
+{
+    if( img.channels() != 1 || (img.depth() == CV_8U && templ.total() > (size_t)(INT_MAX/(255*255))) )
+        return false;
+    double scale = img.depth() == CV_8U ? 0.75 : 3;
+    double directCost = scale*corrsize.area()*(double)templ.total();
+    return directCost < crossCorrCost(corrsize, templ.size(), img.depth(), 1);
 }
 
+static void directCorr( const Mat& img, const Mat& templ, Mat& corr )
+{
+    CV_Assert( img.type() == templ.type() && img.channels() == 1 && corr.type() == CV_32F &&
+               corr.rows == img.rows - templ.rows + 1 && corr.cols == img.cols - templ.cols + 1 );
+    parallel_for_(Range(0, corr.rows), DirectCorrInvoker(img, templ, corr),
+                  corr.total()*(double)templ.total()/(1<<16));
+}
+
+/*
+   Turns the correlation into the response of the method, using the integrals of the image;
+   the result rows are independent.
+*/
+class MatchTemplateNormInvoker : public ParallelLoopBody
+{
+public:
+    MatchTemplateNormInvoker( Mat& _result, const Mat& _sum, const Mat& _sqsum, Size _templsize,
+                              int _cn, int _method, Scalar _templMean, double _templNorm,
+                              double _templSum2 )
+        : result(&_result), sum(&_sum), sqsum(&_sqsum), templsize(_templsize), cn(_cn),
+          method(_method), templMean(_templMean), templNorm(_templNorm), templSum2(_templSum2) {}
+
+    void operator()( const Range& range ) const
+    {
+        int numType = method == CV_TM_CCORR || method == CV_TM_CCORR_NORMED ? 0 :
+                      method == CV_TM_CCOEFF || method == CV_TM_CCOEFF_NORMED ? 1 : 2;
+        bool isNormed = method == CV_TM_CCORR_NORMED ||
+                        method == CV_TM_SQDIFF_NORMED ||
+                        method == CV_TM_CCOEFF_NORMED;
+        double invArea = 1./((double)templsize.height * templsize.width);
+
+        const double *q0 = 0, *q1 = 0, *q2 = 0, *q3 = 0;
+        if( sqsum->data )
+        {
+            q0 = (const double*)sqsum->data;
+            q1 = q0 + templsize.width*cn;
+            q2 = (const double*)(sqsum->data + templsize.height*sqsum->step);
+            q3 = q2 + templsize.width*cn;
+        }
+
+        const double* p0 = (const double*)sum->data;
+        const double* p1 = p0 + templsize.width*cn;
+        const double* p2 = (const double*)(sum->data + templsize.height*sum->step);
+        const double* p3 = p2 + templsize.width*cn;
+
+        int sumstep = sum->data ? (int)(sum->step / sizeof(double)) : 0;
+        int sqstep = sqsum->data ? (int)(sqsum->step / sizeof(double)) : 0;
+
+        int i, j, k;
+
+        for( i = range.start; i < range.end; i++ )
+        {
+            float* rrow = (float*)(result->data + i*result->step);
+            int idx = i * sumstep;
+            int idx2 = i * sqstep;
+
+            for( j = 0; j < result->cols; j++, idx += cn, idx2 += cn )
+            {
+                double num = rrow[j], t;
+                double wndMean2 = 0, wndSum2 = 0;
+
+                if( numType == 1 )
+                {
+                    for( k = 0; k < cn; k++ )
+                    {
+                        t = p0[idx+k] - p1[idx+k] - p2[idx+k] + p3[idx+k];
+                        wndMean2 += CV_SQR(t);
+                        num -= t*templMean[k];
+                    }
+
+                    wndMean2 *= invArea;
+                }
+
+                if( isNormed || numType == 2 )
+                {
+                    for( k = 0; k < cn; k++ )
+                    {
+                        t = q0[idx2+k] - q1[idx2+k] - q2[idx2+k] + q3[idx2+k];
+                        wndSum2 += t;
+                    }
+
+                    if( numType == 2 )
+                    {
+                        num = wndSum2 - 2*num + templSum2;
+                        num = MAX(num, 0.);
+                    }
+                }
+
+                if( isNormed )
+                {
+                    t = sqrt(MAX(wndSum2 - wndMean2,0))*templNorm;
+                    if( fabs(num) < t )
+                        num /= t;
+                    else if( fabs(num) < t*1.125 )
+                        num = num > 0 ? 1 : -1;
+                    else
+                        num = method != CV_TM_SQDIFF_NORMED ? 0 : 1;
+                }
+
+                rrow[j] = (float)num;
+            }
+        }
+    }
+
+private:
+    MatchTemplateNormInvoker& operator=(const MatchTemplateNormInvoker&);
+
+    Mat* result;
+    const Mat* sum;
+    const Mat* sqsum;
+    Size templsize;
+    int cn, method;
+    Scalar templMean;
+    double templNorm, templSum2;
+};
+
+// the sum of squared differences of two rows of n elements
+static double sqDiffRow( const uchar* a, const uchar* b, int n, bool haveSSE2 )
+{
+    int i = 0;
+    double s = 0;
+#if CV_SSE2
+    if( haveSSE2 )
+    {
+        __m128i z = _mm_setzero_si128(), s0 = z;
+        // every 32-bit lane gets at most 4*255^2 per iteration, so it is flushed now and then
+        for( ; i <= n - 16; i += 16 )
+        {
+            __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+            __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+            __m128i d0 = _mm_sub_epi16(_mm_unpacklo_epi8(x, z), _mm_unpacklo_epi8(y, z));
+            __m128i d1 = _mm_sub_epi16(_mm_unpackhi_epi8(x, z), _mm_unpackhi_epi8(y, z));
+            s0 = _mm_add_epi32(s0, _mm_add_epi32(_mm_madd_epi16(d0, d0), _mm_madd_epi16(d1, d1)));
+            if( (i & 8191) == 8176 )
+            {
+                int CV_DECL_ALIGNED(16) buf[4];
+                _mm_store_si128((__m128i*)buf, s0);
+                s += (double)buf[0] + buf[1] + buf[2] + buf[3];
+                s0 = z;
+            }
+        }
+        int CV_DECL_ALIGNED(16) buf[4];
+        _mm_store_si128((__m128i*)buf, s0);
+        s += (double)buf[0] + buf[1] + buf[2] + buf[3];
+    }
+#else
+    (void)haveSSE2;
+#endif
+    int si = 0;
+    for( ; i < n; i++ )
+    {
+        int d = a[i] - b[i];
+        si += d*d;
+    }
+    return s + si;
+}
+
+static double sqDiffRow( const float* a, const float* b, int n, bool haveSSE2 )
+{
+    int i = 0;
+    double s = 0;
+#if CV_SSE2
+    if( haveSSE2 )
+    {
+        __m128d s0 = _mm_setzero_pd(), s1 = s0;
+        for( ; i <= n - 4; i += 4 )
+        {
+            __m128 x = _mm_loadu_ps(a + i), y = _mm_loadu_ps(b + i);
+            __m128d d0 = _mm_sub_pd(_mm_cvtps_pd(x), _mm_cvtps_pd(y));
+            __m128d d1 = _mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(x, x)),
+                                    _mm_cvtps_pd(_mm_movehl_ps(y, y)));
+            s0 = _mm_add_pd(s0, _mm_mul_pd(d0, d0));
+            s1 = _mm_add_pd(s1, _mm_mul_pd(d1, d1));
+        }
+        double CV_DECL_ALIGNED(16) buf[2];
+        _mm_store_pd(buf, _mm_add_pd(s0, s1));
+        s = buf[0] + buf[1];
+    }
+#else
+    (void)haveSSE2;
+#endif
+    for( ; i < n; i++ )
+    {
+        double d = (double)a[i] - b[i];
+        s += d*d;
+    }
+    return s;
+}
+
+/*
+   Computes TM_SQDIFF or TM_SQDIFF_NORMED at every position of a stripe of result rows and
+   keeps the ones not above the threshold. Most positions are rejected before any pixel is
+   compared, by two lower bounds of the sum of squared differences that the integrals give:
+   (|w| - |t|)^2 by the triangle inequality and (sum(w) - sum(t))^2/N by Cauchy-Schwarz,
+   where w is the window, t is the template and N is the number of their elements. The others
+   are summed by the template rows; the partial sum never decreases, so a position is abandoned
+   as soon as it exceeds the limit that the threshold sets for the final response.
+*/
+template<typename T> class SqDiffThresholdInvoker : public ParallelLoopBody
+{
+public:
+    SqDiffThresholdInvoker( const Mat& _img, const Mat& _templ, const Mat& _sum, const Mat& _sqsum,
+                            Size _corrsize, int _method, double _threshold,
+                            std::vector<std::vector<Point> >& _locations,
+                            std::vector<std::vector<float> >& _responses )
+        : img(&_img), templ(&_templ), sum(&_sum), sqsum(&_sqsum), corrsize(_corrsize),
+          method(_method), threshold(_threshold), locations(&_locations),
+          responses(&_responses)
+    {
+        Scalar s = cv::sum(_templ);
+        templSum = s[0] + s[1] + s[2] + s[3];
+        templNorm = norm(_templ, NORM_L2);
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int cn = img->channels(), trows = templ->rows, n = templ->cols*cn;
+        bool isNormed = method == CV_TM_SQDIFF_NORMED;
+        // the normed response is never above 1
+        bool prune = !isNormed || threshold < 1;
+        bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+        double templSum2 = templNorm*templNorm;
+        double invN = 1./((double)trows*n);
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            std::vector<Point>& locs = (*locations)[y];
+            std::vector<float>& resps = (*responses)[y];
+            const double* p0 = sum->ptr<double>(y);
+            const double* p2 = sum->ptr<double>(y + trows);
+            const double* q0 = sqsum->ptr<double>(y);
+            const double* q2 = sqsum->ptr<double>(y + trows);
+
+            for( int x = 0; x < corrsize.width; x++ )
+            {
+                double wndSum = 0, wndSum2 = 0;
+                for( int k = 0; k < cn; k++ )
+                {
+                    int i0 = x*cn + k, i1 = i0 + n;
+                    wndSum += p0[i0] - p0[i1] - p2[i0] + p2[i1];
+                    wndSum2 += q0[i0] - q0[i1] - q2[i0] + q2[i1];
+                }
+                double wndNorm = sqrt(MAX(wndSum2, 0));
+                double t = wndNorm*templNorm, limit = isNormed ? threshold*t : threshold;
+
+                // the bounds are the differences of large sums, so they get a tolerance
+                double bound = std::max(CV_SQR(wndNorm - templNorm), CV_SQR(wndSum - templSum)*invN);
+                if( prune && bound - (wndSum2 + templSum2)*1e-10 > limit )
+                    continue;
+
+                double num = 0;
+                int ty = 0;
+                for( ; ty < trows; ty++ )
+                {
+                    num += sqDiffRow(img->ptr<T>(y + ty) + x*cn, templ->ptr<T>(ty), n, haveSSE2);
+                    if( prune && num > limit )
+                        break;
+                }
+                if( ty < trows )
+                    continue;
+
+                if( isNormed )
+                {
+                    if( num < t )
+                        num /= t;
+                    else
+                        num = 1;
+                }
+                if( num <= threshold )
+                {
+                    locs.push_back(Point(x, y));
+                    resps.push_back((float)num);
+                }
+            }
+        }
+    }
+
+private:
+    SqDiffThresholdInvoker& operator=(const SqDiffThresholdInvoker&);
+
+    const Mat* img;
+    const Mat* templ;
+    const Mat* sum;
+    const Mat* sqsum;
+    Size corrsize;
+    int method;
+    double threshold;
+    double templSum, templNorm;
+    std::vector<std::vector<Point> >* locations;
+    std::vector<std::vector<float> >* responses;
+};
+
 }
 
 /*****************************************************************************************/
@@ -237,9 +807,6 @@ void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result,
 
     int numType = method == CV_TM_CCORR || method == CV_TM_CCORR_NORMED ? 0 :
                   method == CV_TM_CCOEFF || method == CV_TM_CCOEFF_NORMED ? 1 : 2;
-    bool isNormed = method == CV_TM_CCORR_NORMED ||
-                    method == CV_TM_SQDIFF_NORMED ||
-                    method == CV_TM_CCOEFF_NORMED;
 
     Mat img = _img.getMat(), templ = _templ.getMat();
     if( img.rows < templ.rows || img.cols < templ.cols )
@@ -253,7 +820,10 @@ void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result,
     Mat result = _result.getMat();
 
     int cn = img.channels();
-    crossCorr( img, templ, result, result.size(), result.type(), Point(0,0), 0, 0);
+    if( useDirectCorr(img, templ, corrSize) )
+        directCorr( img, templ, result );
+    else
+        crossCorr( img, templ, result, result.size(), result.type(), Point(0,0), 0, 0);
 
     if( method == CV_TM_CCORR )
         return;
@@ -262,7 +832,6 @@ void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result,
 
     Mat sum, sqsum;
     Scalar templMean, templSdv;
-    double *q0 = 0, *q1 = 0, *q2 = 0, *q3 = 0;
     double templNorm = 0, templSum2 = 0;
 
     if( method == CV_TM_CCOEFF )
@@ -297,74 +866,80 @@ void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result,
         templSum2 /= invArea;
         templNorm = sqrt(templNorm);
         templNorm /= sqrt(invArea); // care of accuracy here
-
-        q0 = (double*)sqsum.data;
-        q1 = q0 + templ.cols*cn;
-        q2 = (double*)(sqsum.data + templ.rows*sqsum.step);
-        q3 = q2 + templ.cols*cn;
     }
 
-    double* p0 = (double*)sum.data;
-    double* p1 = p0 + templ.cols*cn;
-    double* p2 = (double*)(sum.data + templ.rows*sum.step);
-    double* p3 = p2 + templ.cols*cn;
-
-    int sumstep = sum.data ? (int)(sum.step / sizeof(double)) : 0;
-    int sqstep = sqsum.data ? (int)(sqsum.step / sizeof(double)) : 0;
+    parallel_for_(Range(0, result.rows),
+                  MatchTemplateNormInvoker(result, sum, sqsum, templ.size(), cn, method,
+                                           templMean, templNorm, templSum2),
+                  result.total()*cn/(double)(1<<16));
+}
 
-    int i, j, k;
 
-    for( i = 0; i < result.rows; i++ )
-    {
-        float* rrow = (float*)(result.data + i*result.step);
-        int idx = i * sumstep;
-        int idx2 = i * sqstep;
+void cv::matchTemplateThreshold( InputArray _img, InputArray _templ, OutputArray _locations,
+                                 int method, double threshold, OutputArray _responses )
+{
+    CV_Assert( method == CV_TM_SQDIFF || method == CV_TM_SQDIFF_NORMED );
 
-        for( j = 0; j < result.cols; j++, idx += cn, idx2 += cn )
-        {
-            double num = rrow[j], t;
-            double wndMean2 = 0, wndSum2 = 0;
+    Mat img = _img.getMat(), templ = _templ.getMat();
+    if( img.rows < templ.rows || img.cols < templ.cols )
+        std::swap(img, templ);
 
-            if( numType == 1 )
-            {
-                for( k = 0; k < cn; k++ )
-                {
-                    t = p0[idx+k] - p1[idx+k] - p2[idx+k] + p3[idx+k];
-                    wndMean2 += CV_SQR(t);
-                    num -= t*templMean[k];
-                }
+    CV_Assert( (img.depth() == CV_8U || img.depth() == CV_32F) &&
+               img.type() == templ.type() && img.dims <= 2 );
 
-                wndMean2 *= invArea;
-            }
+    Size corrSize(img.cols - templ.cols + 1, img.rows - templ.rows + 1);
+    Mat sum, sqsum;
+    integral(img, sum, sqsum, CV_64F);
 
-            if( isNormed || numType == 2 )
-            {
-                for( k = 0; k < cn; k++ )
-                {
-                    t = q0[idx2+k] - q1[idx2+k] - q2[idx2+k] + q3[idx2+k];
-                    wndSum2 += t;
-                }
+    std::vector<std::vector<Point> > rowLocations(corrSize.height);
+    std::vector<std::vector<float> > rowResponses(corrSize.height);
+    double nstripes = corrSize.area()*(double)templ.total()*img.channels()/(1<<18);
 
-                if( numType == 2 )
-                {
-                    num = wndSum2 - 2*num + templSum2;
-                    num = MAX(num, 0.);
-                }
-            }
+    if( img.depth() == CV_8U )
+        parallel_for_(Range(0, corrSize.height),
+                      SqDiffThresholdInvoker<uchar>(img, templ, sum, sqsum, corrSize, method,
+                                                    threshold, rowLocations, rowResponses), nstripes);
+    else
+        parallel_for_(Range(0, corrSize.height),
+                      SqDiffThresholdInvoker<float>(img, templ, sum, sqsum, corrSize, method,
+                                                    threshold, rowLocations, rowResponses), nstripes);
+
+    int i, n = 0;
+    for( i = 0; i < corrSize.height; i++ )
+        n += (int)rowLocations[i].size();
+
+    if( _locations.kind() == _InputArray::MAT && !_locations.getMatRef().isContinuous() )
+        _locations.release();
+    _locations.create(n, 1, CV_32SC2);
+    bool needResponses = _responses.needed();
+    if( needResponses )
+    {
+        if( _responses.kind() == _InputArray::MAT && !_responses.getMatRef().isContinuous() )
+            _responses.release();
+        _responses.create(n, 1, CV_32F);
+    }
+    if( n == 0 )
+        return;
 
-            if( isNormed )
-            {
-                t = sqrt(MAX(wndSum2 - wndMean2,0))*templNorm;
-                if( fabs(num) < t )
-                    num /= t;
-                else if( fabs(num) < t*1.125 )
-                    num = num > 0 ? 1 : -1;
-                else
-                    num = method != CV_TM_SQDIFF_NORMED ? 0 : 1;
-            }
+    Mat locations = _locations.getMat(), responses;
+    CV_Assert( locations.isContinuous() );
+    Point* locptr = (Point*)locations.data;
+    float* respptr = 0;
+    if( needResponses )
+    {
+        responses = _responses.getMat();
+        CV_Assert( responses.isContinuous() );
+        respptr = (float*)responses.data;
+    }
 
-            rrow[j] = (float)num;
-        }
+    for( i = 0; i < corrSize.height; i++ )
+    {
+        size_t k, count = rowLocations[i].size();
+        for( k = 0; k < count; k++ )
+            *locptr++ = rowLocations[i][k];
+        if( respptr )
+            for( k = 0; k < count; k++ )
+                *respptr++ = rowResponses[i][k];
     }
 }
 
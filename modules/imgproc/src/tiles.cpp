@@ -0,0 +1,720 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+
+#if (defined WIN32 || defined _WIN32) && !defined WINCE
+#  include <windows.h>
+#  undef small
+#  undef min
+#  undef max
+#  undef abs
+#  define HAVE_WIN32_FILE_MAPPING
+#elif defined __unix__ || defined __APPLE__
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  define HAVE_MMAP
+#endif
+
+/****************************************************************************************\
+*                                 Tile sources and sinks                                 *
+\****************************************************************************************/
+
+namespace cv
+{
+
+TileSource::~TileSource() {}
+TileSink::~TileSink() {}
+
+class MatTileSource : public TileSource
+{
+public:
+    MatTileSource( const Mat& _image ) : image(_image) { CV_Assert( image.dims <= 2 ); }
+    Size size() const { return image.size(); }
+    int type() const { return image.type(); }
+    void read( const Rect& r, Mat& dst ) { image(r).copyTo(dst); }
+
+protected:
+    Mat image;
+};
+
+class MatTileSink : public TileSink
+{
+public:
+    MatTileSink( Mat& _image ) : image(&_image) {}
+    void open( Size size, int type ) { image->create(size, type); }
+    void write( const Rect& r, const Mat& tile )
+    {
+        Mat part = (*image)(r);
+        tile.copyTo(part);
+    }
+
+protected:
+    Mat* image;
+};
+
+Ptr<TileSource> createMatTileSource( const Mat& image )
+{
+    return new MatTileSource(image);
+}
+
+Ptr<TileSink> createMatTileSink( Mat& image )
+{
+    return new MatTileSink(image);
+}
+
+/*
+   The file is mapped into memory when the platform allows it and the file fits in the address space,
+   otherwise it is read and written with the standard I/O.
+*/
+class RawImageFile
+{
+public:
+    RawImageFile() : ptr(0), len(0), f(0)
+    {
+#ifdef HAVE_WIN32_FILE_MAPPING
+        file = INVALID_HANDLE_VALUE;
+        mapping = 0;
+#endif
+    }
+
+    ~RawImageFile() { close(); }
+
+    // opens the file of at least fsize bytes; the writable file is created or extended if needed
+    bool open( const string& filename, int64 fsize, bool writable )
+    {
+        close();
+        bool ok = false, fits = (int64)(size_t)fsize == fsize;
+
+#if defined HAVE_WIN32_FILE_MAPPING
+        LARGE_INTEGER sz;
+        file = CreateFileA( filename.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+                            writable ? 0 : FILE_SHARE_READ, 0, writable ? OPEN_ALWAYS : OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, 0 );
+        ok = file != INVALID_HANDLE_VALUE && GetFileSizeEx( file, &sz ) &&
+             (writable || sz.QuadPart >= fsize);
+        if( ok && fits )
+        {
+            // the mapping of the writable file extends it to fsize
+            mapping = CreateFileMappingA( file, 0, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                          (DWORD)((uint64)fsize >> 32), (DWORD)fsize, 0 );
+            if( mapping )
+                ptr = (uchar*)MapViewOfFile( mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ,
+                                             0, 0, (SIZE_T)fsize );
+        }
+        if( !ptr )
+            close();
+#elif defined HAVE_MMAP
+        struct stat st;
+        int fd = ::open( filename.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0666 );
+        ok = fd >= 0 && fstat( fd, &st ) == 0;
+        if( ok && (int64)st.st_size < fsize )
+            ok = writable && ftruncate( fd, (off_t)fsize ) == 0;
+        if( ok && fits )
+        {
+            void* p = mmap( 0, (size_t)fsize, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                            MAP_SHARED, fd, 0 );
+            if( p != MAP_FAILED )
+                ptr = (uchar*)p;
+        }
+        if( fd >= 0 )
+            ::close( fd );
+#else
+        f = fopen( filename.c_str(), "rb" );
+        if( f )
+        {
+            ok = writable || (fseek( f, 0, SEEK_END ) == 0 && (int64)ftell( f ) >= fsize);
+            fclose( f );
+            f = 0;
+        }
+        else
+            ok = writable;
+#endif
+
+        if( ptr )
+            len = (size_t)fsize;
+        else if( ok )
+        {
+            f = fopen( filename.c_str(), writable ? "r+b" : "rb" );
+            if( !f && writable )
+                f = fopen( filename.c_str(), "w+b" );
+        }
+        return ptr != 0 || f != 0;
+    }
+
+    void close()
+    {
+#if defined HAVE_WIN32_FILE_MAPPING
+        if( ptr )
+            UnmapViewOfFile( ptr );
+        if( mapping )
+            CloseHandle( mapping );
+        if( file != INVALID_HANDLE_VALUE )
+            CloseHandle( file );
+        file = INVALID_HANDLE_VALUE;
+        mapping = 0;
+#elif defined HAVE_MMAP
+        if( ptr )
+            munmap( ptr, len );
+#endif
+        if( f )
+            fclose( f );
+        ptr = 0;
+        len = 0;
+        f = 0;
+    }
+
+    void read( int64 pos, uchar* buf, size_t n )
+    {
+        if( ptr )
+            memcpy( buf, ptr + pos, n );
+        else if( seek( pos ) != 0 || fread( buf, 1, n, f ) != n )
+            CV_Error( CV_StsError, "Can not read the image file" );
+    }
+
+    void write( int64 pos, const uchar* buf, size_t n )
+    {
+        if( ptr )
+            memcpy( ptr + pos, buf, n );
+        else if( seek( pos ) != 0 || fwrite( buf, 1, n, f ) != n )
+            CV_Error( CV_StsError, "Can not write the image file" );
+    }
+
+protected:
+    int seek( int64 pos )
+    {
+#if defined WIN32 || defined _WIN32
+        return _fseeki64( f, pos, SEEK_SET );
+#elif defined HAVE_MMAP
+        return fseeko( f, (off_t)pos, SEEK_SET );
+#else
+        return fseek( f, (long)pos, SEEK_SET );
+#endif
+    }
+
+    uchar* ptr;
+    size_t len;
+    FILE* f;
+#ifdef HAVE_WIN32_FILE_MAPPING
+    HANDLE file, mapping;
+#endif
+
+private:
+    RawImageFile( const RawImageFile& );
+    RawImageFile& operator = ( const RawImageFile& );
+};
+
+class RawFileTileSource : public TileSource
+{
+public:
+    RawFileTileSource( const string& filename, Size _size, int _type, int64 _offset )
+        : isize(_size), itype(_type), offset(_offset)
+    {
+        CV_Assert( isize.width > 0 && isize.height > 0 && offset >= 0 );
+        esz = CV_ELEM_SIZE(itype);
+        if( !file.open( filename, offset + (int64)isize.width*isize.height*esz, false ) )
+            CV_Error( CV_StsError, "Can not open the image file or it is too small: " + filename );
+    }
+
+    Size size() const { return isize; }
+    int type() const { return itype; }
+
+    void read( const Rect& r, Mat& dst )
+    {
+        for( int y = 0; y < r.height; y++ )
+            file.read( offset + ((int64)(r.y + y)*isize.width + r.x)*esz, dst.ptr(y), r.width*esz );
+    }
+
+protected:
+    RawImageFile file;
+    Size isize;
+    int itype;
+    int64 offset;
+    size_t esz;
+};
+
+class RawFileTileSink : public TileSink
+{
+public:
+    RawFileTileSink( const string& _filename, int64 _offset )
+        : filename(_filename), offset(_offset), width(0), esz(0)
+    {
+        CV_Assert( offset >= 0 );
+    }
+
+    void open( Size size, int type )
+    {
+        width = size.width;
+        esz = CV_ELEM_SIZE(type);
+        if( !file.open( filename, offset + (int64)size.width*size.height*esz, true ) )
+            CV_Error( CV_StsError, "Can not create the image file: " + filename );
+    }
+
+    void write( const Rect& r, const Mat& tile )
+    {
+        for( int y = 0; y < r.height; y++ )
+            file.write( offset + ((int64)(r.y + y)*width + r.x)*esz, tile.ptr(y), r.width*esz );
+    }
+
+protected:
+    RawImageFile file;
+    string filename;
+    int64 offset;
+    int width;
+    size_t esz;
+};
+
+Ptr<TileSource> createRawFileTileSource( const string& filename, Size size, int type, int64 offset )
+{
+    return new RawFileTileSource(filename, size, type, offset);
+}
+
+Ptr<TileSink> createRawFileTileSink( const string& filename, int64 offset )
+{
+    return new RawFileTileSink(filename, offset);
+}
+
+/****************************************************************************************\
+*                                    Tile operations                                     *
+\****************************************************************************************/
+
+TileOp::~TileOp() {}
+Size TileOp::dstSize( Size srcSize ) const { return srcSize; }
+int TileOp::dstType( int srcType ) const { return srcType; }
+Rect TileOp::srcRect( const Rect& dstRect, Size ) const { return dstRect; }
+
+class FilterTileOp : public TileOp
+{
+public:
+    FilterTileOp( const Ptr<FilterEngine>& _filter ) : filter(_filter)
+    {
+        CV_Assert( !filter.empty() );
+        CV_Assert( filter->rowBorderType != BORDER_WRAP && filter->columnBorderType != BORDER_WRAP );
+        if( filter->isSeparable() )
+            cloneable = !filter->rowFilter->clone().empty() && !filter->columnFilter->clone().empty();
+        else
+            cloneable = !filter->filter2D->clone().empty();
+    }
+
+    int dstType( int srcType ) const
+    {
+        CV_Assert( srcType == filter->srcType );
+        return filter->dstType;
+    }
+
+    Rect srcRect( const Rect& r, Size srcSize ) const
+    {
+        Size ksize = filter->ksize;
+        Point anchor = filter->anchor;
+        return Rect(r.x - anchor.x, r.y - anchor.y, r.width + ksize.width - 1,
+                    r.height + ksize.height - 1) & Rect(Point(), srcSize);
+    }
+
+    // the pixels of src around the rectangle are used by the filter, the borders
+    // of src are extrapolated; they are the image borders or are far enough
+    void apply( const Mat& src, const Rect& _srcRect, Size, Mat& dst, const Rect& dstRect ) const
+    {
+        Rect roi = dstRect - _srcRect.tl();
+        if( cloneable )
+        {
+            FilterEngine f(*filter);
+            if( f.isSeparable() )
+            {
+                f.rowFilter = filter->rowFilter->clone();
+                f.columnFilter = filter->columnFilter->clone();
+            }
+            else
+                f.filter2D = filter->filter2D->clone();
+            f.apply(src, dst, roi, Point(), true);
+        }
+        else
+        {
+            AutoLock lock(mutex);
+            filter->apply(src, dst, roi, Point(), true);
+        }
+    }
+
+protected:
+    // the engine itself is used under the lock when the filters can not be cloned
+    mutable Ptr<FilterEngine> filter;
+    bool cloneable;
+    mutable Mutex mutex;
+};
+
+class ResizeTileOp : public TileOp
+{
+public:
+    ResizeTileOp( Size _dsize, double _fx, double _fy, int _interpolation )
+        : dsize(_dsize), fx(_fx), fy(_fy), interpolation(_interpolation)
+    {
+        CV_Assert( dsize.area() > 0 || (fx > 0 && fy > 0) );
+    }
+
+    Size dstSize( Size srcSize ) const
+    {
+        if( dsize.area() > 0 )
+            return dsize;
+        Size sz(saturate_cast<int>(srcSize.width*fx), saturate_cast<int>(srcSize.height*fy));
+        CV_Assert( sz.area() > 0 );
+        return sz;
+    }
+
+    Rect srcRect( const Rect& r, Size srcSize ) const
+    {
+        double ifx, ify;
+        getScales( srcSize, ifx, ify );
+        return resizeSrcRegion( r, srcSize, ifx, ify, interpolation );
+    }
+
+    void apply( const Mat& src, const Rect& _srcRect, Size srcSize, Mat& dst, const Rect& dstRect ) const
+    {
+        double ifx, ify;
+        getScales( srcSize, ifx, ify );
+        resizeRegion( src, _srcRect, srcSize, dst, dstRect, ifx, ify, interpolation );
+    }
+
+protected:
+    // the same scales as of resize()
+    void getScales( Size srcSize, double& ifx, double& ify ) const
+    {
+        if( dsize.area() > 0 )
+        {
+            ifx = (double)dsize.width/srcSize.width;
+            ify = (double)dsize.height/srcSize.height;
+        }
+        else
+            ifx = fx, ify = fy;
+    }
+
+    Size dsize;
+    double fx, fy;
+    int interpolation;
+};
+
+class CvtColorTileOp : public TileOp
+{
+public:
+    CvtColorTileOp( int _code, int _dcn ) : code(_code), dcn(_dcn)
+    {
+        // the conversions that need the neighbor pixels or change the size
+        bool demosaicing = (CV_BayerBG2BGR <= code && code <= CV_BayerGR2BGR) ||
+                           (CV_BayerBG2BGR_VNG <= code && code <= CV_BayerGR2BGR_VNG) ||
+                           (CV_BayerBG2GRAY <= code && code <= CV_BayerGR2GRAY) ||
+                           (CV_BayerBG2BGR_EA <= code && code <= CV_BayerGR2BGR_EA);
+        bool yuv420 = CV_YUV2RGB_NV12 <= code && code <= CV_YUV2GRAY_420;
+        if( demosaicing || yuv420 )
+            CV_Error( CV_StsBadArg, "The demosaicing and the YUV 4:2:0 conversions can not be done by tiles" );
+    }
+
+    int dstType( int srcType ) const
+    {
+        Mat probe(2, 2, srcType, Scalar::all(0)), result;
+        cvtColor( probe, result, code, dcn );
+        return result.type();
+    }
+
+    void apply( const Mat& src, const Rect& _srcRect, Size, Mat& dst, const Rect& dstRect ) const
+    {
+        cvtColor( src(dstRect - _srcRect.tl()), dst, code, dcn );
+    }
+
+protected:
+    int code, dcn;
+};
+
+class ThresholdTileOp : public TileOp
+{
+public:
+    ThresholdTileOp( double _thresh, double _maxval, int _type )
+        : thresh(_thresh), maxval(_maxval), type(_type)
+    {
+        if( type & THRESH_OTSU )
+            CV_Error( CV_StsBadArg, "The Otsu's threshold can not be computed by tiles" );
+    }
+
+    void apply( const Mat& src, const Rect& _srcRect, Size, Mat& dst, const Rect& dstRect ) const
+    {
+        threshold( src(dstRect - _srcRect.tl()), dst, thresh, maxval, type );
+    }
+
+protected:
+    double thresh, maxval;
+    int type;
+};
+
+class MorphologyTileOp : public TileOp
+{
+public:
+    MorphologyTileOp( int _op, const Mat& _kernel, Point _anchor, int _iterations,
+                      int _borderType, const Scalar& _borderValue )
+        : op(_op), iterations(_iterations), borderType(_borderType), borderValue(_borderValue)
+    {
+        CV_Assert( borderType != BORDER_WRAP );
+        kernel = _kernel.data ? _kernel.clone() : getStructuringElement(MORPH_RECT, Size(3,3));
+        anchor = normalizeAnchor(_anchor, kernel.size());
+
+        // the number of the erosions and dilations done one after another
+        int passes = op == MORPH_ERODE || op == MORPH_DILATE || op == MORPH_GRADIENT ? 1 :
+                     op == MORPH_OPEN || op == MORPH_CLOSE || op == MORPH_TOPHAT || op == MORPH_BLACKHAT ? 2 : 0;
+        CV_Assert( passes > 0 );
+        passes *= std::max(iterations, 1);
+        margin = Size(std::max(anchor.x, kernel.cols - 1 - anchor.x)*passes,
+                      std::max(anchor.y, kernel.rows - 1 - anchor.y)*passes);
+    }
+
+    Rect srcRect( const Rect& r, Size srcSize ) const
+    {
+        return Rect(r.x - margin.width, r.y - margin.height, r.width + margin.width*2,
+                    r.height + margin.height*2) & Rect(Point(), srcSize);
+    }
+
+    // the whole src is processed, its borders are extrapolated at each pass, so the pixels
+    // near the borders that are not the image borders are wrong; they are cut off by the margin
+    void apply( const Mat& src, const Rect& _srcRect, Size, Mat& dst, const Rect& dstRect ) const
+    {
+        Mat result;
+        morphologyEx( src, result, op, kernel, anchor, iterations, borderType, borderValue );
+        result(dstRect - _srcRect.tl()).copyTo(dst);
+    }
+
+protected:
+    int op;
+    Mat kernel;
+    Point anchor;
+    int iterations, borderType;
+    Scalar borderValue;
+    Size margin;
+};
+
+Ptr<TileOp> createFilterTileOp( const Ptr<FilterEngine>& filter )
+{
+    return new FilterTileOp(filter);
+}
+
+Ptr<TileOp> createResizeTileOp( Size dsize, double fx, double fy, int interpolation )
+{
+    return new ResizeTileOp(dsize, fx, fy, interpolation);
+}
+
+Ptr<TileOp> createCvtColorTileOp( int code, int dstCn )
+{
+    return new CvtColorTileOp(code, dstCn);
+}
+
+Ptr<TileOp> createThresholdTileOp( double thresh, double maxval, int type )
+{
+    return new ThresholdTileOp(thresh, maxval, type);
+}
+
+Ptr<TileOp> createMorphologyTileOp( int op, InputArray kernel, Point anchor, int iterations,
+                                    int borderType, const Scalar& borderValue )
+{
+    return new MorphologyTileOp(op, kernel.getMat(), anchor, iterations, borderType, borderValue);
+}
+
+/****************************************************************************************\
+*                                     Tile pipeline                                      *
+\****************************************************************************************/
+
+// the horizontal bounds of the rectangles are aligned, so that the vectorized loops
+// of the operations process the same pixels as on the whole image
+enum { TILE_ALIGN = 16 };
+
+static Rect alignTileRect( const Rect& r, Size size )
+{
+    int x0 = r.x & -TILE_ALIGN, x1 = std::min((int)alignSize(r.x + r.width, TILE_ALIGN), size.width);
+    return Rect(x0, r.y, x1 - x0, r.height);
+}
+
+// the rectangles of the tile in the source and in the results of all the operations
+static void getTileRects( const vector<Ptr<TileOp> >& ops, const vector<Size>& sizes,
+                          Size tileSize, int ntx, int t, vector<Rect>& rects )
+{
+    int n = (int)ops.size();
+    Point tl((t % ntx)*tileSize.width, (t / ntx)*tileSize.height);
+    rects.resize(n + 1);
+    rects[n] = Rect(tl, tileSize) & Rect(Point(), sizes[n]);
+    for( int k = n - 1; k >= 0; k-- )
+        rects[k] = alignTileRect(ops[k]->srcRect(rects[k+1], sizes[k]), sizes[k]);
+}
+
+class TilePipelineInvoker : public ParallelLoopBody
+{
+public:
+    TilePipelineInvoker( const vector<Ptr<TileOp> >& _ops, const vector<Size>& _sizes,
+                         const vector<int>& _types, TileSource& _src, TileSink& _dst,
+                         Size _tileSize, int _ntx, Mutex& _ioMutex )
+        : ops(&_ops), sizes(&_sizes), types(&_types), src(&_src), dst(&_dst),
+          tileSize(_tileSize), ntx(_ntx), ioMutex(&_ioMutex) {}
+
+    void operator()( const Range& range ) const
+    {
+        int n = (int)ops->size();
+        vector<Rect> rects;
+
+        for( int t = range.start; t < range.end; t++ )
+        {
+            getTileRects( *ops, *sizes, tileSize, ntx, t, rects );
+
+            Mat buf(rects[0].size(), (*types)[0]);
+            {
+                AutoLock lock(*ioMutex);
+                src->read(rects[0], buf);
+            }
+
+            for( int k = 0; k < n; k++ )
+            {
+                Mat result(rects[k+1].size(), (*types)[k+1]);
+                (*ops)[k]->apply(buf, rects[k], (*sizes)[k], result, rects[k+1]);
+                buf = result;
+            }
+
+            {
+                AutoLock lock(*ioMutex);
+                dst->write(rects[n], buf);
+            }
+        }
+    }
+
+private:
+    TilePipelineInvoker& operator=(const TilePipelineInvoker&);
+
+    const vector<Ptr<TileOp> >* ops;
+    const vector<Size>* sizes;
+    const vector<int>* types;
+    TileSource* src;
+    TileSink* dst;
+    Size tileSize;
+    int ntx;
+    Mutex* ioMutex;
+};
+
+TilePipeline::TilePipeline() {}
+
+TilePipeline& TilePipeline::add( const Ptr<TileOp>& op )
+{
+    CV_Assert( !op.empty() );
+    ops.push_back(op);
+    return *this;
+}
+
+Size TilePipeline::dstSize( Size srcSize ) const
+{
+    for( size_t k = 0; k < ops.size(); k++ )
+        srcSize = ops[k]->dstSize(srcSize);
+    return srcSize;
+}
+
+int TilePipeline::dstType( int srcType ) const
+{
+    for( size_t k = 0; k < ops.size(); k++ )
+        srcType = ops[k]->dstType(srcType);
+    return srcType;
+}
+
+bool TilePipeline::empty() const
+{
+    return ops.empty();
+}
+
+void TilePipeline::run( TileSource& src, TileSink& dst, Size tileSize, size_t maxMemory ) const
+{
+    int k, n = (int)ops.size();
+    vector<Size> sizes(n + 1);
+    vector<int> types(n + 1);
+
+    sizes[0] = src.size();
+    types[0] = src.type();
+    CV_Assert( sizes[0].width > 0 && sizes[0].height > 0 );
+    for( k = 0; k < n; k++ )
+    {
+        sizes[k+1] = ops[k]->dstSize(sizes[k]);
+        types[k+1] = ops[k]->dstType(types[k]);
+    }
+
+    CV_Assert( tileSize.width > 0 && tileSize.height > 0 );
+    tileSize.width = (int)alignSize(tileSize.width, TILE_ALIGN);
+    int ntx = (sizes[n].width + tileSize.width - 1)/tileSize.width;
+    int nty = (sizes[n].height + tileSize.height - 1)/tileSize.height;
+    int ntiles = ntx*nty;
+
+    dst.open(sizes[n], types[n]);
+
+    // the buffers of a tile in the middle, which has the halo on all the sides
+    vector<Rect> rects;
+    getTileRects( ops, sizes, tileSize, ntx, (nty/2)*ntx + ntx/2, rects );
+    size_t tileMemory = 0;
+    for( k = 0; k <= n; k++ )
+        tileMemory += rects[k].area()*CV_ELEM_SIZE(types[k]);
+
+    Mutex ioMutex;
+    TilePipelineInvoker invoker(ops, sizes, types, src, dst, tileSize, ntx, ioMutex);
+    int nthreads = std::max(getNumThreads(), 1);
+    int batch = maxMemory > 0 ? (int)std::min(maxMemory/std::max(tileMemory, (size_t)1), (size_t)nthreads) : nthreads;
+
+    if( batch >= nthreads )
+        parallel_for_(Range(0, ntiles), invoker, ntiles);
+    else
+    {
+        // a batch of tiles at a time, their buffers are released before the next batch
+        batch = std::max(batch, 1);
+        for( int t = 0; t < ntiles; t += batch )
+            parallel_for_(Range(t, std::min(t + batch, ntiles)), invoker, batch);
+    }
+}
+
+void TilePipeline::run( InputArray _src, OutputArray _dst, Size tileSize ) const
+{
+    Mat src = _src.getMat();
+    _dst.create( dstSize(src.size()), dstType(src.type()) );
+    Mat dst = _dst.getMat();
+    if( src.datastart < dst.dataend && dst.datastart < src.dataend )
+        src = src.clone();
+
+    MatTileSource source(src);
+    MatTileSink sink(dst);
+    run( source, sink, tileSize );
+}
+
+}
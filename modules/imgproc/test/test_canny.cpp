@@ -284,4 +284,29 @@ int CV_CannyTest::validate_test_results( int test_case_idx )
 
 TEST(Imgproc_Canny, accuracy) { CV_CannyTest test; test.safe_run(); }
 
+TEST(Imgproc_Canny, parallel)
+{
+    int nthreads = cv::getNumThreads();
+    cv::RNG& rng = cv::theRNG();
+
+    for( int cn = 1; cn <= 3; cn += 2 )
+        for( int L2gradient = 0; L2gradient < 2; L2gradient++ )
+        {
+            // the edges cross the stripes in all directions
+            cv::Mat src(1080, 1280, CV_8UC(cn)), dst[2];
+            rng.fill(src, cv::RNG::UNIFORM, 0, 256);
+            cv::GaussianBlur(src, src, cv::Size(0, 0), 2);
+
+            for( int k = 0; k < 2; k++ )
+            {
+                cv::setNumThreads(k == 0 ? 1 : 4);
+                cv::Canny(src, dst[k], 5, 15, 3, L2gradient != 0);
+            }
+            cv::setNumThreads(nthreads);
+
+            EXPECT_LT(0, cv::countNonZero(dst[0]));
+            EXPECT_EQ(0, cv::norm(dst[0], dst[1], cv::NORM_INF)) << "cn " << cn << ", L2gradient " << L2gradient;
+        }
+}
+
 /* End of file. */
@@ -106,3 +106,61 @@ void CV_ConnectedComponentsTest::run( int /* start_from */)
 
 TEST(Imgproc_ConnectedComponents, regression) { CV_ConnectedComponentsTest test; test.safe_run(); }
 
+TEST(Imgproc_ConnectedComponents, stats)
+{
+    Mat img = (Mat_<uchar>(3, 4) << 0, 1, 0, 0,
+                                    1, 1, 1, 0,
+                                    0, 0, 0, 1);
+    Mat labels, stats, centroids;
+    ASSERT_EQ(3, connectedComponentsWithStats(img, labels, stats, centroids, 4, CV_32S));
+
+    // the bounding box of the background and of the T shape start before their first pixels
+    int expected[3][CC_STAT_MAX] = { { 0, 0, 4, 3, 7 }, { 0, 0, 3, 2, 4 }, { 3, 2, 1, 1, 1 } };
+    for( int l = 0; l < 3; l++ )
+        for( int i = 0; i < CC_STAT_MAX; i++ )
+            EXPECT_EQ(expected[l][i], stats.at<int>(l, i)) << "label " << l << ", stat " << i;
+    EXPECT_DOUBLE_EQ(1., centroids.at<double>(1, 0));
+    EXPECT_DOUBLE_EQ(0.75, centroids.at<double>(1, 1));
+}
+
+TEST(Imgproc_ConnectedComponents, parallel)
+{
+    int nthreads = getNumThreads();
+    RNG& rng = theRNG();
+
+    for( int connectivity = 4; connectivity <= 8; connectivity += 4 )
+    {
+        // the blobs of all sizes cross the stripes
+        Mat img(1080, 1920, CV_8U);
+        rng.fill(img, RNG::UNIFORM, 0, 256);
+        GaussianBlur(img, img, Size(0, 0), 3);
+        img = img > 127;
+
+        Mat labels[2], stats[2], centroids[2];
+        int n[2];
+        for( int k = 0; k < 2; k++ )
+        {
+            setNumThreads(k == 0 ? 1 : 4);
+            n[k] = connectedComponentsWithStats(img, labels[k], stats[k], centroids[k], connectivity, CV_32S);
+        }
+        setNumThreads(nthreads);
+
+        ASSERT_EQ(n[0], n[1]);
+        EXPECT_LT(100, n[0]);
+        EXPECT_EQ(0, norm(labels[0], labels[1], NORM_INF)) << "connectivity " << connectivity;
+        EXPECT_EQ(0, norm(stats[0], stats[1], NORM_INF)) << "connectivity " << connectivity;
+        EXPECT_EQ(0, norm(centroids[0], centroids[1], NORM_INF)) << "connectivity " << connectivity;
+        EXPECT_EQ(img.total(), (size_t)sum(stats[1].col(CC_STAT_AREA))[0]);
+    }
+
+    // every pixel is a component
+    Mat dots(301, 403, CV_8U);
+    for( int r = 0; r < dots.rows; r++ )
+        for( int c = 0; c < dots.cols; c++ )
+            dots.at<uchar>(r, c) = (r % 2 == 0 && c % 2 == 0) ? 255 : 0;
+    Mat labels;
+    setNumThreads(4);
+    int n = connectedComponents(dots, labels, 8, CV_32S);
+    setNumThreads(nthreads);
+    EXPECT_EQ(countNonZero(dots) + 1, n);
+}
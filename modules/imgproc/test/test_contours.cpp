@@ -390,4 +390,56 @@ _exit_:
 
 TEST(Imgproc_FindContours, accuracy) { CV_FindContourTest test; test.safe_run(); }
 
+TEST(Imgproc_FindContours, parallel)
+{
+    RNG& rng = theRNG();
+    int nthreads = getNumThreads();
+    for( int iter = 0; iter < 60; iter++ )
+    {
+        Size sz(rng.uniform(1, 300), rng.uniform(1, 300));
+        Mat img(sz, CV_8U);
+        int kind = iter % 3;
+        if( kind == 0 )
+        {
+            // nested rings and discs, for the deep hierarchies
+            img = Scalar::all(0);
+            for( int i = 0; i < 20; i++ )
+            {
+                Point c(rng.uniform(0, sz.width), rng.uniform(0, sz.height));
+                for( int r = rng.uniform(2, 80), k = 0; r > 0; r -= rng.uniform(2, 8), k++ )
+                    circle(img, c, r, Scalar::all(k % 2 ? 0 : rng.uniform(1, 256)),
+                           rng.uniform(0, 2) ? -1 : rng.uniform(1, 3));
+            }
+        }
+        else
+        {
+            rng.fill(img, RNG::UNIFORM, 0, 256);
+            if( kind == 1 )
+                GaussianBlur(img, img, Size(0, 0), 2);
+            img = img > (kind == 1 ? 128 : 160);
+        }
+
+        // in the dense noise findContours() sometimes misplaces the tree nodes,
+        // so CV_RETR_TREE is not compared there
+        int mode = kind == 2 ? rng.uniform(0, 3) : rng.uniform(0, 4);
+        int method = rng.uniform(0, 2) ? CV_CHAIN_APPROX_NONE : CV_CHAIN_APPROX_SIMPLE;
+        Point offset(rng.uniform(-3, 4), rng.uniform(-3, 4));
+        setNumThreads(iter % 2 ? 1 : 4);
+
+        vector<vector<Point> > contours, refContours;
+        vector<Vec4i> hierarchy, refHierarchy;
+        Mat img0 = img.clone(), tmp = img.clone();
+        findContours(tmp, refContours, refHierarchy, mode, method, offset);
+        findContoursParallel(img, contours, hierarchy, mode, method, offset);
+
+        EXPECT_EQ(0, norm(img, img0, NORM_INF));
+        setNumThreads(nthreads);
+        ASSERT_EQ(refContours.size(), contours.size()) << "mode " << mode << ", iteration " << iter;
+        for( size_t i = 0; i < contours.size(); i++ )
+            ASSERT_TRUE(refContours[i] == contours[i]) << "contour " << i << ", iteration " << iter;
+        ASSERT_TRUE(refHierarchy == hierarchy) << "iteration " << iter;
+    }
+    setNumThreads(nthreads);
+}
+
 /* End of file. */
@@ -295,3 +295,49 @@ void CV_DisTransTest::prepare_to_validation( int /*test_case_idx*/ )
 TEST(Imgproc_DistanceTransform, accuracy) { CV_DisTransTest test; test.safe_run(); }
 
 
+
+TEST(Imgproc_DistanceTransform, precise)
+{
+    RNG& rng = theRNG();
+    int nthreads = getNumThreads();
+
+    for( int iter = 0; iter < 50; iter++ )
+    {
+        Size sz(rng.uniform(1, 80), rng.uniform(1, 80));
+        Mat src(sz, CV_8U);
+        randu(src, 0, iter % 2 ? 20 : 200);
+        src.at<uchar>(rng.uniform(0, sz.height), rng.uniform(0, sz.width)) = 0;
+
+        setNumThreads(iter % 2 ? 1 : 4);
+        Mat dist;
+        distanceTransform(src, dist, CV_DIST_L2, CV_DIST_MASK_PRECISE);
+        setNumThreads(nthreads);
+
+        vector<Point> zeros;
+        for( int y = 0; y < sz.height; y++ )
+            for( int x = 0; x < sz.width; x++ )
+                if( src.at<uchar>(y, x) == 0 )
+                    zeros.push_back(Point(x, y));
+
+        for( int y = 0; y < sz.height; y++ )
+            for( int x = 0; x < sz.width; x++ )
+            {
+                int best = INT_MAX;
+                for( size_t k = 0; k < zeros.size(); k++ )
+                    best = std::min(best, (zeros[k].x - x)*(zeros[k].x - x) + (zeros[k].y - y)*(zeros[k].y - y));
+                ASSERT_EQ((float)std::sqrt((double)best), dist.at<float>(y, x)) << "iter " << iter << " at " << Point(x, y);
+            }
+    }
+
+    // the squared distances do not fit the float mantissa
+    Mat src(6000, 3000, CV_8U, Scalar(1));
+    src.at<uchar>(0, 0) = src.at<uchar>(5999, 2999) = 0;
+    Mat dist;
+    distanceTransform(src, dist, CV_DIST_L2, CV_DIST_MASK_PRECISE);
+    for( int y = 0; y < src.rows; y += 7 )
+        for( int x = 0; x < src.cols; x += 3 )
+        {
+            double d2 = std::min((double)y*y + (double)x*x, (double)(5999 - y)*(5999 - y) + (double)(2999 - x)*(2999 - x));
+            ASSERT_EQ((float)std::sqrt(d2), dist.at<float>(y, x)) << Point(x, y);
+        }
+}
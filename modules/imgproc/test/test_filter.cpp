@@ -1887,3 +1887,137 @@ protected:
 
 TEST(Imgproc_Filtering, supportedFormats) { CV_FilterSupportedFormatsTest test; test.safe_run(); }
 
+
+TEST(Imgproc_Filtering, parallelStripes)
+{
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16SC1, CV_32FC1, CV_32FC3 };
+    const int borders[] = { BORDER_REFLECT_101, BORDER_REPLICATE, BORDER_CONSTANT };
+    int nthreads = getNumThreads();
+    RNG& rng = theRNG();
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+        for( int b = 0; b < (int)(sizeof(borders)/sizeof(borders[0])); b++ )
+        {
+            int type = types[t], border = borders[b];
+            // filter a ROI, so that the rows around it are taken from the parent image
+            Mat whole(520, 700, type), kernel(7, 7, CV_32F), kx(1, 9, CV_32F), ky(9, 1, CV_32F);
+            rng.fill(whole, RNG::UNIFORM, 0, 100);
+            rng.fill(kernel, RNG::UNIFORM, -1, 1);
+            rng.fill(kx, RNG::UNIFORM, -1, 1);
+            rng.fill(ky, RNG::UNIFORM, -1, 1);
+            Mat src = whole(Rect(30, 20, 640, 480));
+            Mat elem = getStructuringElement(MORPH_ELLIPSE, Size(5, 5));
+
+            Mat dst[2][8];
+            for( int k = 0; k < 2; k++ )
+            {
+                setNumThreads(k == 0 ? 1 : 4);
+                filter2D(src, dst[k][0], -1, kernel, Point(-1,-1), 1, border);
+                sepFilter2D(src, dst[k][1], CV_32F, kx, ky, Point(-1,-1), 0, border);
+                GaussianBlur(src, dst[k][2], Size(5, 5), 1.5, 1.5, border);
+                Sobel(src, dst[k][3], CV_32F, 1, 1, 3, 1, 0, border);
+                Laplacian(src, dst[k][4], CV_32F, 3, 1, 0, border);
+                blur(src, dst[k][5], Size(15, 15), Point(-1,-1), border);
+                erode(src, dst[k][6], elem, Point(-1,-1), 2, border);
+                dilate(src, dst[k][7], Mat(), Point(-1,-1), 1, border);
+            }
+            setNumThreads(nthreads);
+
+            for( int i = 0; i < 8; i++ )
+                EXPECT_EQ(0, norm(dst[0][i], dst[1][i], NORM_INF))
+                    << "filter " << i << ", type " << type << ", border " << border;
+        }
+}
+
+TEST(Imgproc_Filtering, filter2D_dft)
+{
+    const int types[] = { CV_8UC1, CV_8UC3, CV_32FC1 };
+    const int ksizes[] = { 31, 63 };
+    RNG& rng = theRNG();
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+        for( int k = 0; k < (int)(sizeof(ksizes)/sizeof(ksizes[0])); k++ )
+        {
+            int type = types[t], ksize = ksizes[k];
+            Mat whole(420, 560, type), kernel(ksize, ksize, CV_32F);
+            rng.fill(whole, RNG::UNIFORM, 0, 256);
+            rng.fill(kernel, RNG::UNIFORM, -1, 2);
+            kernel *= 1./sum(kernel)[0];
+            Mat src = whole(Rect(40, 10, 480, 400));
+
+            for( int b = 0; b < 2; b++ )
+            {
+                int border = b == 0 ? BORDER_REFLECT_101 : BORDER_CONSTANT;
+                Mat dst, ref(src.size(), type);
+                // the large kernels are applied by DFT; compare with the direct filtering
+                filter2D(src, dst, -1, kernel, Point(-1,-1), 0, border);
+                Ptr<FilterEngine> f = createLinearFilter(type, type, kernel, Point(-1,-1), 0, border);
+                f->apply(src, ref);
+
+                double err = norm(dst, ref, NORM_INF);
+                double maxErr = CV_MAT_DEPTH(type) == CV_8U ? 1 : 1e-3*norm(ref, NORM_INF);
+                EXPECT_LE(err, maxErr) << "type " << type << ", ksize " << ksize << ", border " << border;
+            }
+        }
+}
+
+TEST(Imgproc_Morphology, largeKernels)
+{
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16UC1, CV_16SC1, CV_32FC1, CV_64FC1 };
+    const Size ksizes[] = { Size(51, 51), Size(101, 1), Size(1, 77), Size(33, 65), Size(9, 11) };
+    int nthreads = getNumThreads();
+    RNG& rng = theRNG();
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+        for( int k = 0; k < (int)(sizeof(ksizes)/sizeof(ksizes[0])); k++ )
+            for( int shape = MORPH_RECT; shape <= MORPH_ELLIPSE; shape++ )
+            {
+                int type = types[t], border = shape == MORPH_CROSS ? BORDER_REPLICATE : BORDER_REFLECT_101;
+                Mat src(rng.uniform(100, 200), rng.uniform(100, 200), type);
+                rng.fill(src, RNG::UNIFORM, 0, 256);
+                Mat elem = getStructuringElement(shape, ksizes[k]);
+                Point anchor(rng.uniform(0, elem.cols), rng.uniform(0, elem.rows));
+
+                Mat ref, dst;
+                cvtest::erode(src, ref, elem, anchor, border);
+                setNumThreads(k % 2 ? 4 : 1);
+                erode(src, dst, elem, anchor, 1, border);
+                EXPECT_EQ(0, norm(dst, ref, NORM_INF)) << "erode, type " << type << ", kernel " << ksizes[k] << ", shape " << shape;
+
+                cvtest::dilate(src, ref, elem, anchor, border);
+                dst = src.clone();
+                dilate(dst, dst, elem, anchor, 1, border);
+                setNumThreads(nthreads);
+                EXPECT_EQ(0, norm(dst, ref, NORM_INF)) << "dilate, type " << type << ", kernel " << ksizes[k] << ", shape " << shape;
+            }
+
+    // the images large enough to be processed in parallel: the in-place operation and
+    // the subsequent iterations work on a copy of the source
+    for( int shape = MORPH_RECT; shape <= MORPH_ELLIPSE; shape++ )
+    {
+        Mat src(400, 360, CV_8UC1), ref, tmp;
+        rng.fill(src, RNG::UNIFORM, 0, 256);
+        Mat elem = getStructuringElement(shape, Size(41, 41));
+        Point anchor(-1, -1);
+        setNumThreads(4);
+
+        Mat dst = src.clone();
+        erode(dst, dst, elem, anchor, 1, BORDER_REPLICATE);
+        cvtest::erode(src, ref, elem, anchor, BORDER_REPLICATE);
+        EXPECT_EQ(0, norm(dst, ref, NORM_INF)) << "in-place erode, shape " << shape;
+
+        dst = src.clone();
+        dilate(dst, dst, elem, anchor, 2, BORDER_REPLICATE);
+        cvtest::dilate(src, tmp, elem, anchor, BORDER_REPLICATE);
+        cvtest::dilate(tmp, ref, elem, anchor, BORDER_REPLICATE);
+        EXPECT_EQ(0, norm(dst, ref, NORM_INF)) << "in-place dilate, 2 iterations, shape " << shape;
+
+        morphologyEx(src, dst, MORPH_OPEN, elem, anchor, 2, BORDER_REPLICATE);
+        cvtest::erode(src, tmp, elem, anchor, BORDER_REPLICATE);
+        cvtest::erode(tmp, ref, elem, anchor, BORDER_REPLICATE);
+        cvtest::dilate(ref, tmp, elem, anchor, BORDER_REPLICATE);
+        cvtest::dilate(tmp, ref, elem, anchor, BORDER_REPLICATE);
+        EXPECT_EQ(0, norm(dst, ref, NORM_INF)) << "opening, 2 iterations, shape " << shape;
+        setNumThreads(nthreads);
+    }
+}
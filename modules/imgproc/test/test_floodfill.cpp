@@ -519,4 +519,56 @@ void CV_FloodFillTest::prepare_to_validation( int /*test_case_idx*/ )
 
 TEST(Imgproc_FloodFill, accuracy) { CV_FloodFillTest test; test.safe_run(); }
 
+TEST(Imgproc_FloodFill, batch)
+{
+    RNG& rng = theRNG();
+    int types[] = { CV_8UC1, CV_8UC3, CV_32SC1, CV_32FC3 };
+    int nthreads = getNumThreads();
+
+    for( int iter = 0; iter < 100; iter++ )
+    {
+        int type = types[iter % 4], connectivity = iter % 2 ? 8 : 4;
+        Size sz(rng.uniform(1, 150), rng.uniform(1, 300));
+        double diff = iter % 5 == 0 ? 1 : 0;
+        Mat img(sz, type);
+        randu(img, 0, iter % 3 == 0 ? 2 : 4);
+
+        int nseeds = rng.uniform(1, 30);
+        vector<Point> seeds;
+        vector<Scalar> newVals;
+        for( int k = 0; k < nseeds; k++ )
+        {
+            seeds.push_back(Point(rng.uniform(0, sz.width), rng.uniform(0, sz.height)));
+            newVals.push_back(Scalar::all(10 + k));
+        }
+
+        // the reference: the components of the seeds in the original image, the first seed takes a component
+        Mat ref = img.clone(), filled(sz.height + 2, sz.width + 2, CV_8U, Scalar(0));
+        vector<Rect> refRects(nseeds);
+        int refArea = 0;
+        for( int k = 0; k < nseeds; k++ )
+        {
+            if( filled.at<uchar>(seeds[k].y + 1, seeds[k].x + 1) )
+                continue;
+            Mat mask(filled.size(), CV_8U, Scalar(0));
+            refArea += floodFill(img, mask, seeds[k], Scalar(), &refRects[k], Scalar::all(diff), Scalar::all(diff),
+                                 connectivity | FLOODFILL_MASK_ONLY | (1 << 8));
+            filled |= mask;
+            ref.setTo(newVals[k], mask(Rect(1, 1, sz.width, sz.height)));
+        }
+
+        setNumThreads(iter % 3 == 0 ? 1 : 4);
+        Mat dst = img.clone();
+        vector<Rect> rects;
+        int area = floodFillBatch(dst, seeds, newVals, &rects, Scalar::all(diff), connectivity);
+        setNumThreads(nthreads);
+
+        EXPECT_EQ(0, norm(dst, ref, NORM_INF)) << "iter " << iter;
+        EXPECT_EQ(refArea, area) << "iter " << iter;
+        ASSERT_EQ(nseeds, (int)rects.size());
+        for( int k = 0; k < nseeds; k++ )
+            EXPECT_EQ(refRects[k], rects[k]) << "iter " << iter << ", seed " << k;
+    }
+}
+
 /* End of file. */
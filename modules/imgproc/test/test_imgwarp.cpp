@@ -1545,4 +1545,93 @@ TEST(Imgproc_InitUndistortMap, accuracy) { CV_UndistortMapTest test; test.safe_r
 TEST(Imgproc_GetRectSubPix, accuracy) { CV_GetRectSubPixTest test; test.safe_run(); }
 TEST(Imgproc_GetQuadSubPix, accuracy) { CV_GetQuadSubPixTest test; test.safe_run(); }
 
+TEST(Imgproc_BlobFromImage, accuracy)
+{
+    RNG& rng = theRNG();
+    int nthreads = getNumThreads();
+
+    for( int iter = 0; iter < 60; iter++ )
+    {
+        int cn = iter % 3 == 0 ? 1 : iter % 3 == 1 ? 3 : 4;
+        int interpolation = iter % 4 == 0 ? INTER_NEAREST : INTER_LINEAR;
+        bool swapRB = iter % 2 != 0;
+        Mat src(rng.uniform(1, 200), rng.uniform(1, 200), CV_8UC(cn));
+        randu(src, 0, 256);
+        Size dsize(rng.uniform(1, 200), rng.uniform(1, 200));
+        if( iter % 7 == 0 )
+            dsize = src.size();
+        Scalar mean(10, 20, 30, 40), stdDev(0.5, 2, 3, 4);
+        double scale = 1./255;
+
+        setNumThreads(iter % 2 ? 4 : 1);
+        Mat blob;
+        blobFromImage(src, blob, dsize, scale, mean, stdDev, swapRB, interpolation);
+        setNumThreads(nthreads);
+
+        ASSERT_EQ(4, blob.dims);
+        ASSERT_EQ(cn, blob.size[1]);
+        ASSERT_EQ(dsize.height, blob.size[2]);
+        ASSERT_EQ(dsize.width, blob.size[3]);
+
+        // resize in floating point, then swap the channels and normalize the planes
+        Mat fsrc, resized;
+        vector<Mat> planes;
+        src.convertTo(fsrc, CV_32F);
+        resize(fsrc, resized, dsize, 0, 0, interpolation);
+        split(resized, planes);
+        if( swapRB && cn >= 3 )
+            std::swap(planes[0], planes[2]);
+
+        for( int c = 0; c < cn; c++ )
+        {
+            Mat expected, plane(dsize, CV_32F, blob.ptr(0, c));
+            planes[c].convertTo(expected, CV_32F, scale/stdDev[c], -mean[c]/stdDev[c]);
+            EXPECT_LE(norm(plane, expected, NORM_INF), 1e-3) << "iter " << iter << ", channel " << c;
+        }
+    }
+}
+
+TEST(Imgproc_RemapPlan, accuracy)
+{
+    static const int borders[] = { BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT_101, BORDER_WRAP, BORDER_TRANSPARENT };
+    static const int types[] = { CV_8UC1, CV_8UC3, CV_8UC4, CV_16UC1, CV_32FC3 };
+    RNG& rng = theRNG();
+    int nthreads = getNumThreads();
+
+    for( int iter = 0; iter < 100; iter++ )
+    {
+        int type = types[iter % 5 == 4 ? rng.uniform(3, 5) : rng.uniform(0, 3)];
+        int interpolation = iter % 6 == 5 ? INTER_NEAREST : iter % 2 ? INTER_CUBIC : INTER_LINEAR;
+        int borderMode = borders[rng.uniform(0, 5)];
+        Scalar borderValue(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+
+        Mat src(rng.uniform(1, 100), rng.uniform(1, 100), type);
+        randu(src, 0, 256);
+        Size dsize(rng.uniform(1, 200), rng.uniform(1, 100));
+        Mat mapx(dsize, CV_32F), mapy(dsize, CV_32F);
+        // mostly inside the source, with some pixels outside of it
+        randu(mapx, -5, src.cols + 4);
+        randu(mapy, -5, src.rows + 4);
+        if( iter % 3 == 0 )
+            for( int y = 0; y < dsize.height; y++ )
+                for( int x = 0; x < dsize.width; x++ )
+                {
+                    mapx.at<float>(y, x) = (x*0.37f + y*0.05f) + 0.5f;
+                    mapy.at<float>(y, x) = (y*0.41f - x*0.03f) + 1.5f;
+                }
+
+        Mat expected = Mat::zeros(dsize, type), dst = expected.clone();
+        remap(src, expected, mapx, mapy, interpolation, borderMode, borderValue);
+
+        RemapPlan plan(mapx, mapy, src.size(), type, interpolation, borderMode, borderValue);
+        ASSERT_EQ(dsize, plan.dstSize());
+        setNumThreads(iter % 2 ? 4 : 1);
+        plan(src, dst);
+        setNumThreads(nthreads);
+
+        EXPECT_EQ(0, norm(dst, expected, NORM_INF)) << "iter " << iter << ", type " << type
+            << ", interpolation " << interpolation << ", border " << borderMode;
+    }
+}
+
 /* End of file. */
@@ -86,4 +86,26 @@ void CV_PhaseCorrelatorTest::run( int )
 
 TEST(Imgproc_PhaseCorrelatorTest, accuracy) { CV_PhaseCorrelatorTest test; test.safe_run(); }
 
+TEST(Imgproc_PhaseCorrelatorTest, reusedPlans)
+{
+    DFTPlan forward, inverse;
+    for( int i = 0; i < 6; i++ )
+    {
+        // the size changes once, the plans are recreated then
+        Size sz = i < 3 ? Size(129, 128) : Size(100, 90);
+        Mat r1 = Mat::ones(sz, CV_32F), r2 = Mat::ones(sz, CV_32F);
+        cv::rectangle(r1, Point(40 + i, 50), Point(50 + i, 60), Scalar::all(0), CV_FILLED);
+        cv::rectangle(r2, Point(30, 30 + i), Point(40, 40 + i), Scalar::all(0), CV_FILLED);
+
+        double response0 = 0, response = 0;
+        Point2d shift0 = phaseCorrelate(r1, r2, noArray(), &response0);
+        Point2d shift = phaseCorrelate(r1, r2, forward, inverse, noArray(), &response);
+        EXPECT_EQ(shift0, shift) << "frame " << i;
+        EXPECT_EQ(response0, response) << "frame " << i;
+        EXPECT_EQ(getOptimalDFTSize(sz.width), forward.size().width);
+        EXPECT_NEAR(-10 - i, shift.x, 1) << "frame " << i;
+        EXPECT_NEAR(-20 + i, shift.y, 1) << "frame " << i;
+    }
+}
+
 }
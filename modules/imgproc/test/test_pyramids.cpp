@@ -0,0 +1,145 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                        Intel License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000, Intel Corporation, all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of Intel Corporation may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+#include "test_precomp.hpp"
+
+using namespace cv;
+using namespace std;
+
+TEST(Imgproc_Pyramid, parallelAndVectorized)
+{
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16SC1, CV_16UC1, CV_32FC1 };
+    int nthreads = getNumThreads();
+    bool optimized = useOptimized();
+    RNG& rng = theRNG();
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+    {
+        int type = types[t];
+        // the odd size checks the last row and column of pyrDown and pyrUp
+        Mat src(479, 641, type);
+        rng.fill(src, RNG::UNIFORM, 0, CV_MAT_DEPTH(type) == CV_16S ? 20000 : 255);
+
+        // the reference is the serial scalar code
+        Mat dst[3][2];
+        for( int k = 0; k < 3; k++ )
+        {
+            setNumThreads(k == 1 ? 1 : 4);
+            setUseOptimized(k != 2);
+            pyrDown(src, dst[k][0]);
+            pyrUp(src, dst[k][1]);
+        }
+        setNumThreads(nthreads);
+        setUseOptimized(optimized);
+
+        double maxDiff = CV_MAT_DEPTH(type) == CV_32F ? 1e-3 : 0;
+        for( int i = 0; i < 2; i++ )
+        {
+            EXPECT_EQ(0, norm(dst[0][i], dst[1][i], NORM_INF)) << (i ? "pyrUp" : "pyrDown") << ", type " << type;
+            EXPECT_LE(norm(dst[0][i], dst[2][i], NORM_INF), maxDiff) << (i ? "pyrUp" : "pyrDown") << ", type " << type;
+        }
+    }
+}
+
+TEST(Imgproc_Pyramid, reuse)
+{
+    const int border = 16;
+    Mat img(240, 321, CV_8UC1);
+    theRNG().fill(img, RNG::UNIFORM, 0, 255);
+
+    Pyramid pyramid(img, 4, 2, border);
+    ASSERT_EQ(4, pyramid.maxLevel());
+
+    vector<Mat> ref;
+    buildPyramid(img, ref, 4);
+    vector<const uchar*> data;
+    for( int level = 0; level <= 4; level++ )
+    {
+        EXPECT_EQ(0, norm(ref[level], pyramid[level], NORM_INF)) << "level " << level;
+        // the levels are padded by the border
+        Mat padded = pyramid[level], bordered;
+        padded.adjustROI(border, border, border, border);
+        copyMakeBorder(ref[level], bordered, border, border, border, border, BORDER_REFLECT_101);
+        EXPECT_EQ(0, norm(bordered, padded, NORM_INF)) << "level " << level;
+        data.push_back(pyramid[level].data);
+    }
+
+    // the next frame of the same size is built in the same buffers
+    Mat img2 = img.clone();
+    theRNG().fill(img2, RNG::UNIFORM, 0, 255);
+    pyramid.build(img2, 4, 2, border);
+    buildPyramid(img2, ref, 4);
+    for( int level = 0; level <= 4; level++ )
+    {
+        EXPECT_EQ(data[level], pyramid[level].data) << "level " << level;
+        EXPECT_EQ(0, norm(ref[level], pyramid[level], NORM_INF)) << "level " << level;
+    }
+
+    // an image with enough pixels around is used as the level 0 directly
+    Mat whole(img.rows + border*2, img.cols + border*2, img.type());
+    Mat roi = whole(Rect(border, border, img.cols, img.rows));
+    img.copyTo(roi);
+    pyramid.build(roi, 2, 1.2, border);
+    EXPECT_EQ(roi.data, pyramid[0].data);
+    EXPECT_EQ(Size(cvRound(img.cols/1.44f), cvRound(img.rows/1.44f)), pyramid[2].size());
+}
+
+TEST(Imgproc_Pyramid, borderType)
+{
+    const int border = 8;
+    Mat img(97, 130, CV_8UC3);
+    theRNG().fill(img, RNG::UNIFORM, 0, 255);
+
+    Pyramid pyramid(img, 3, 2, border, BORDER_REPLICATE);
+    ASSERT_EQ(3, pyramid.maxLevel());
+
+    vector<Mat> ref;
+    buildPyramid(img, ref, 3, BORDER_REPLICATE);
+    for( int level = 0; level <= 3; level++ )
+    {
+        EXPECT_EQ(0, norm(ref[level], pyramid[level], NORM_INF)) << "level " << level;
+        Mat padded = pyramid[level], bordered;
+        padded.adjustROI(border, border, border, border);
+        copyMakeBorder(ref[level], bordered, border, border, border, border, BORDER_REPLICATE);
+        EXPECT_EQ(0, norm(bordered, padded, NORM_INF)) << "level " << level;
+    }
+}
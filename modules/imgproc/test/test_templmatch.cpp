@@ -334,3 +334,80 @@ void CV_TemplMatchTest::prepare_to_validation( int /*test_case_idx*/ )
 }
 
 TEST(Imgproc_MatchTemplate, accuracy) { CV_TemplMatchTest test; test.safe_run(); }
+
+TEST(Imgproc_MatchTemplate, threshold)
+{
+    RNG& rng = theRNG();
+    for( int iter = 0; iter < 16; iter++ )
+    {
+        int depth = iter % 2 == 0 ? CV_8U : CV_32F, cn = iter % 4 < 2 ? 1 : 3;
+        int method = iter < 8 ? CV_TM_SQDIFF : CV_TM_SQDIFF_NORMED;
+        Mat img(rng.uniform(40, 120), rng.uniform(40, 120), CV_MAKETYPE(depth, cn));
+        rng.fill(img, RNG::UNIFORM, Scalar::all(0), Scalar::all(255));
+        GaussianBlur(img, img, Size(5, 5), 1.5);
+        Size tsize(rng.uniform(1, 20), rng.uniform(1, 20));
+        Point origin(rng.uniform(0, img.cols - tsize.width), rng.uniform(0, img.rows - tsize.height));
+        Mat templ = img(Rect(origin, tsize)).clone();
+
+        Mat map;
+        matchTemplate(img, templ, map, method);
+        // a threshold that a few percent of the positions pass
+        Mat sorted;
+        cv::sort(map.reshape(1, 1), sorted, CV_SORT_ASCENDING);
+        double threshold = sorted.at<float>((int)(sorted.total()/30));
+
+        vector<Point> locations;
+        vector<float> responses;
+        matchTemplateThreshold(img, templ, locations, method, threshold, responses);
+        ASSERT_EQ(locations.size(), responses.size());
+
+        double eps = method == CV_TM_SQDIFF ? 1e-3*templ.total()*cn*255 : 1e-4;
+        Mat found = Mat::zeros(map.size(), CV_8U);
+        for( size_t i = 0; i < locations.size(); i++ )
+        {
+            Point p = locations[i];
+            ASSERT_TRUE(Rect(Point(), map.size()).contains(p));
+            EXPECT_LE(responses[i], threshold);
+            EXPECT_NEAR(map.at<float>(p), responses[i], eps) << "at " << p.x << "," << p.y;
+            if( i > 0 )
+            {
+                ASSERT_TRUE(p.y > locations[i-1].y || (p.y == locations[i-1].y && p.x > locations[i-1].x));
+            }
+            found.at<uchar>(p) = 1;
+        }
+        for( int y = 0; y < map.rows; y++ )
+            for( int x = 0; x < map.cols; x++ )
+                if( map.at<float>(y, x) < threshold - eps )
+                {
+                    EXPECT_EQ(1, found.at<uchar>(y, x)) << "at " << x << "," << y;
+                }
+
+        if( method == CV_TM_SQDIFF )
+        {
+            matchTemplateThreshold(img, templ, locations, method, 0);
+            EXPECT_TRUE(std::find(locations.begin(), locations.end(), origin) != locations.end());
+        }
+    }
+}
+
+TEST(Imgproc_MatchTemplate, reusedPlans)
+{
+    // more template sizes than the plans kept, each is matched twice
+    const Size tsizes[] = { Size(31, 17), Size(45, 45), Size(12, 60), Size(64, 33), Size(20, 20), Size(51, 8) };
+    const int ntsizes = (int)(sizeof(tsizes)/sizeof(tsizes[0]));
+    RNG& rng = theRNG();
+    Mat img(300, 400, CV_8UC3);
+    rng.fill(img, RNG::UNIFORM, Scalar::all(0), Scalar::all(255));
+    vector<Mat> results(ntsizes);
+
+    for( int iter = 0; iter < ntsizes*2; iter++ )
+    {
+        int k = iter % ntsizes;
+        Mat templ = img(Rect(Point(k*7, k*5), tsizes[k])).clone(), map;
+        matchTemplate(img, templ, map, CV_TM_CCORR);
+        if( iter < ntsizes )
+            results[k] = map;
+        else
+            EXPECT_EQ(0, norm(map, results[k], NORM_INF)) << "template " << tsizes[k].width << "x" << tsizes[k].height;
+    }
+}
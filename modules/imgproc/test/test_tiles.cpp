@@ -0,0 +1,157 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "test_precomp.hpp"
+
+using namespace cv;
+using namespace std;
+
+TEST(Imgproc_TilePipeline, accuracy)
+{
+    RNG& rng = theRNG();
+    int nthreads = getNumThreads();
+
+    for( int iter = 0; iter < 60; iter++ )
+    {
+        int cn = iter % 2 ? 3 : 1;
+        // at least 3 pixels, so that the image scaled by 0.2 is not empty
+        Mat src(rng.uniform(3, 300), rng.uniform(3, 300), CV_8UC(cn)), expected;
+        randu(src, 0, 256);
+        Size tileSize(rng.uniform(1, 100), rng.uniform(1, 100));
+        Mat kernel = getStructuringElement(MORPH_ELLIPSE, Size(rng.uniform(1, 8), rng.uniform(1, 8)));
+        int interpolation = rng.uniform(0, 5);
+        double fx = rng.uniform(0.2, 3.), fy = iter % 5 == 0 ? fx : rng.uniform(0.2, 3.);
+        if( iter % 7 == 0 )
+            fx = fy = 0.5;
+        int op = MORPH_ERODE + rng.uniform(0, 7), iterations = rng.uniform(1, 3);
+        int border = iter % 3 == 0 ? BORDER_REPLICATE : BORDER_REFLECT_101;
+
+        TilePipeline pipeline;
+        Mat t = src.clone();
+        switch( iter % 4 )
+        {
+        case 0:
+            // not GaussianBlur(), which shrinks the kernel on the images with a single row or column
+            pipeline.add(createFilterTileOp(createGaussianFilter(src.type(), Size(5, 7), 1.5, 2., border)));
+            createGaussianFilter(src.type(), Size(5, 7), 1.5, 2., border)->apply(t, t);
+            break;
+        case 1:
+            pipeline.add(createMorphologyTileOp(op, kernel, Point(-1, -1), iterations));
+            morphologyEx(t, t, op, kernel, Point(-1, -1), iterations);
+            break;
+        default:
+            pipeline.add(createResizeTileOp(Size(), fx, fy, interpolation));
+            // not in-place: the image of the same size would be overwritten while it is read
+            resize(src, t, Size(), fx, fy, interpolation);
+            break;
+        }
+
+        // a chain with the full-size intermediate results as the reference
+        if( iter % 4 == 3 )
+        {
+            if( cn == 3 )
+            {
+                pipeline.add(createCvtColorTileOp(COLOR_BGR2GRAY));
+                cvtColor(t, t, COLOR_BGR2GRAY);
+            }
+            Mat k2d = (Mat_<float>(3, 3) << 1, 2, 0, 0, -3, 1, 0, 1, 1);
+            pipeline.add(createFilterTileOp(createLinearFilter(CV_8U, CV_16S, k2d)));
+            filter2D(t, t, CV_16S, k2d);
+            pipeline.add(createThresholdTileOp(50, 1000, THRESH_BINARY));
+            threshold(t, t, 50, 1000, THRESH_BINARY);
+            pipeline.add(createMorphologyTileOp(MORPH_CLOSE, kernel, Point(-1, -1), iterations, BORDER_REFLECT));
+            morphologyEx(t, t, MORPH_CLOSE, kernel, Point(-1, -1), iterations, BORDER_REFLECT);
+        }
+        expected = t;
+
+        ASSERT_EQ(expected.size(), pipeline.dstSize(src.size()));
+        ASSERT_EQ(expected.type(), pipeline.dstType(src.type()));
+
+        Mat dst;
+        setNumThreads(iter % 2 ? 4 : 1);
+        pipeline.run(src, dst, tileSize);
+        setNumThreads(nthreads);
+
+        ASSERT_EQ(expected.size(), dst.size());
+        ASSERT_EQ(expected.type(), dst.type());
+        EXPECT_EQ(0, norm(dst, expected, NORM_INF)) << "iter " << iter << ", tile " << tileSize.width
+            << "x" << tileSize.height << ", interpolation " << interpolation << ", op " << op;
+    }
+}
+
+TEST(Imgproc_TilePipeline, rawFiles)
+{
+    Mat src(313, 517, CV_8UC3), expected, dst;
+    randu(src, 0, 256);
+    string srcname = cv::tempfile(".raw"), dstname = cv::tempfile(".raw");
+    int64 offset = 17;
+
+    FILE* f = fopen(srcname.c_str(), "wb");
+    ASSERT_TRUE(f != 0);
+    fwrite("header of 17 bytes", 1, (size_t)offset, f);
+    for( int y = 0; y < src.rows; y++ )
+        fwrite(src.ptr(y), 1, src.cols*src.elemSize(), f);
+    fclose(f);
+
+    TilePipeline pipeline;
+    pipeline.add(createResizeTileOp(Size(), 0.7, 0.6, INTER_AREA))
+            .add(createCvtColorTileOp(COLOR_BGR2HSV));
+    {
+        Ptr<TileSource> source = createRawFileTileSource(srcname, src.size(), src.type(), offset);
+        Ptr<TileSink> sink = createRawFileTileSink(dstname);
+        pipeline.run(*source, *sink, Size(64, 48), 200000);
+    }
+
+    resize(src, expected, Size(), 0.7, 0.6, INTER_AREA);
+    cvtColor(expected, expected, COLOR_BGR2HSV);
+
+    dst.create(expected.size(), expected.type());
+    f = fopen(dstname.c_str(), "rb");
+    ASSERT_TRUE(f != 0);
+    for( int y = 0; y < dst.rows; y++ )
+        ASSERT_EQ(dst.cols*dst.elemSize(), fread(dst.ptr(y), 1, dst.cols*dst.elemSize(), f));
+    fclose(f);
+    remove(srcname.c_str());
+    remove(dstname.c_str());
+
+    EXPECT_EQ(0, norm(dst, expected, NORM_INF));
+}
@@ -1094,9 +1094,11 @@ void CascadeClassifier::detectMultiScale( const Mat& image, vector<Rect>& object
                                           int flags, Size minObjectSize, Size maxObjectSize,
                                           bool outputRejectLevels )
 {
+    CV_TRACE_REGION("cv::CascadeClassifier::detectMultiScale");
     const double GROUP_EPS = 0.2;
 
     CV_Assert( scaleFactor > 1 && image.depth() == CV_8U );
+    CV_TRACE_BYTES(image.total()*image.elemSize());
 
     if( empty() )
         return;
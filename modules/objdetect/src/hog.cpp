@@ -1023,6 +1023,8 @@ void HOGDescriptor::detectMultiScale(
     double hitThreshold, Size winStride, Size padding,
     double scale0, double finalThreshold, bool useMeanshiftGrouping) const
 {
+    CV_TRACE_REGION("cv::HOGDescriptor::detectMultiScale");
+    CV_TRACE_BYTES(img.total()*img.elemSize());
     double scale = 1.;
     int levels = 0;
 